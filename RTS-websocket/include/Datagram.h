@@ -0,0 +1,103 @@
+#ifndef DATAGRAM_H
+#define DATAGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <netinet/in.h>
+
+/**
+ * @file Datagram.h
+ * @brief Minimal UDP transport for the UAVh <-> UAV signing exchange.
+ *
+ * The messages of this exchange (a signer set, a partial signature) fit in a single
+ * datagram, so they are sent without TCP's retransmission and head-of-line blocking:
+ *  - every datagram carries the session id, so replies are matched to their request
+ *    and replays of old requests can be recognised;
+ *  - each send is repeated `copies` times (repetition code), which masks
+ *    independent losses without a round trip;
+ *  - partial signatures are acknowledged (DG_ACK) and retransmitted until then,
+ *    requests are implicitly acknowledged by the reply;
+ *  - requests may be multicast to the whole swarm; they then carry a sequence
+ *    number so that members notice a missed request and ask for a unicast
+ *    repair (DG_NACK).
+ *
+ * Wire format (big endian):
+ *   'R' 'T' | version (1) | type (1) | session id (4) | index (2) | seq (4) | payload length (2) | payload
+ */
+
+enum DatagramType : uint8_t {
+    DG_REQUEST = 1,     // UAVh -> UAV: payload = slot#signer set
+    DG_SIGNATURE = 2,   // UAV -> UAVh: payload = partial signature, empty if not selected
+    DG_ACK = 3,         // UAVh -> UAV: signature of (session, index) received
+    DG_NACK = 4,        // UAV -> UAVh: multicast request `seq` never arrived, please repeat by unicast
+    DG_PING = 5,        // UAVh -> UAV: liveness heartbeat `seq`
+    DG_PONG = 6         // UAV -> UAVh: heartbeat answer, echoes seq and index
+};
+
+struct Datagram {
+    uint8_t type = 0;
+    uint32_t sid = 0;       // authentication session id
+    uint16_t index = 0;     // serial number of the UAV the datagram concerns
+    uint32_t seq = 0;       // multicast sequence number, 0 for unicast requests
+    std::string payload;
+};
+
+// Index of requests addressed to every UAV behind the receiving socket (multicast)
+const uint16_t kSwarmIndex = 0xffff;
+
+// Largest datagram sent, kept below a typical MTU to avoid IP fragmentation
+const size_t kMaxDatagram = 1400;
+const size_t kDatagramHeader = 16;
+
+/**
+ * @brief Serializes a datagram.
+ * @return The wire bytes, empty if the payload does not fit into kMaxDatagram.
+ */
+std::string encodeDatagram(const Datagram &dg);
+
+/**
+ * @brief Parses wire bytes.
+ * @return false on a bad magic, unknown version or truncated packet.
+ */
+bool decodeDatagram(const char *data, size_t len, Datagram &out);
+
+/**
+ * @brief Opens a UDP socket bound to the given port (0 = any free port).
+ * @return The socket descriptor, or -1 on failure.
+ */
+int openDatagramSocket(uint16_t port);
+
+/**
+ * @brief Opens a UDP socket that receives the multicast group `group` on `port`.
+ *        The port is shared (SO_REUSEADDR), so several members on one host can join.
+ * @return The socket descriptor, or -1 on failure.
+ */
+int openMulticastSocket(const std::string &group, uint16_t port);
+
+/**
+ * @brief Builds an IPv4 address from a dotted host string and a port.
+ */
+sockaddr_in datagramAddr(const std::string &host, uint16_t port);
+
+/**
+ * @brief Sends a datagram `copies` times.
+ * @return true if at least one copy left the socket.
+ */
+bool sendDatagram(int fd, const sockaddr_in &to, const Datagram &dg, int copies = 1);
+
+/**
+ * @brief Waits up to `timeoutMs` until one of the sockets is readable.
+ *        Any number of sockets may be passed (a host serves one per virtual UAV).
+ * @return The readable descriptor, or -1 on timeout.
+ */
+int waitDatagram(const int *fds, int count, int timeoutMs);
+
+/**
+ * @brief Waits up to `timeoutMs` for one valid datagram.
+ * @param from Receives the sender address.
+ * @return true if a datagram was received, false on timeout, error or invalid packet.
+ */
+bool recvDatagram(int fd, Datagram &out, sockaddr_in &from, int timeoutMs);
+
+#endif // DATAGRAM_H
@@ -1,10 +1,14 @@
+#ifndef RTS_H
+#define RTS_H
+
 #include "../../common/include/Tools.h"
+#include "../../common/include/ECP2Array.h"
+#include "../../common/include/SignerSet.h"
 #include <atomic>
+#include <map>
 
 namespace RTS_web {
     extern csprng rng_websocket;
-    extern gmp_randstate_t state_gmp_websocket;
-    extern  std::atomic<int> serialNumber;
 
     // Aggregator
     typedef struct {
@@ -16,7 +20,7 @@ namespace RTS_web {
     typedef struct {
         vector<mpz_class> c1;
         vector<mpz_class> c2;
-        vector<ECP2> PK;
+        ECP2Array PK;
         mpz_class ID;
         int serialNumber;
     } UAV;
@@ -28,7 +32,7 @@ namespace RTS_web {
         ECP2 P2;             // Generator of G2
         mpz_class g;         // Group generator
         mpz_class beta;      // System parameter
-        vector<ECP2> PK;     // Public key set
+        ECP2Array PK;        // Public key set
     } Params;
 
     typedef struct {
@@ -43,6 +47,56 @@ namespace RTS_web {
         vector<short> indices;  // Signer IDs
     } Sigma;
 
+    // One transformed element (aux_i, sig_i, index) of Sigma, as streamed to the verifier
+    typedef struct {
+        mpz_class aux;          // Auxiliary value
+        ECP sig;                // Transformed signature point
+        short index;            // Signer index
+    } SigmaShare;
+
+    // Per-request transformation state of the aggregator (computed once per PK_v)
+    typedef struct {
+        mpz_class rk;           // Re-encryption exponent derived from alpha and PK_v
+        mpz_class ge;           // g^e
+        mpz_class beta_e;       // beta^e
+    } AggContext;
+
+    // Incremental verification state of the verifier for one signer set S
+    typedef struct {
+        int t;                          // |S|
+        bool valid;                     // false once an invalid or duplicate share was seen
+        mpz_class hash;                 // Unblinding exponent H(beta^sk_v)
+        ECP Hm;                         // H(M)
+        ECP s;                          // Running sum of unblinded shares
+        std::map<short, mpz_class> Pis; // Lagrange coefficients of the signers still expected
+        std::map<short, ECP2> PKs;      // Public keys of the signers still expected
+    } VerifyContext;
+
+    // Signer-side state of one signer set S, shared by every signer of S (see SignInit)
+    typedef struct {
+        int t;                          // Threshold
+        vector<mpz_class> S;            // IDs of the selected signers
+        mpz_class prodX;                // Product of the first t IDs of S
+        ECP Hm;                         // H(M)
+    } SignContext;
+
+    // Transformation key of a swarm split, signed Schnorr-style with the head key alpha
+    typedef struct {
+        mpz_class gt;           // g^t, commitment of the signature
+        mpz_class stk;          // t + alpha * H(k, first, end, shares, g^t) mod q - 1
+        int shares;             // leading entries of c2 the members of the sub-swarm update
+        int k;                  // sub-head of the new sub-swarm
+        int first, end;         // UAV serials [first, end) of the sub-swarm
+    } SplitKey;
+
+    // Order of TA to split sub-swarm k off the swarm, signed Schnorr-style with alpha
+    typedef struct {
+        int k;                  // sub-head whose range is split off
+        uint64_t issued;        // UNIX time of signing in seconds, the order expires after SPLIT_ORDER_TTL
+        mpz_class gt;           // g^t, commitment of the signature
+        mpz_class s;            // t + alpha * H(k, issued, g^t) mod q - 1
+    } SplitOrder;
+
     /**
      * @brief Gets all prime factors of q-1 for the BLS12-381 curve order q
      * @return Vector of prime factors
@@ -71,9 +125,10 @@ namespace RTS_web {
      * @param alpha Aggregator’s private key
      * @param n Number of signers
      * @param tm Maximum threshold
+     * @param state Initialized random state owned by the caller
      * @return Public parameters of the CTS system
      */
-    Params Setup(mpz_class &alpha, int n, int tm);
+    Params Setup(mpz_class &alpha, int n, int tm, gmp_randstate_t state);
 
     /**
      * @brief Generates the public key set for CTS
@@ -88,48 +143,76 @@ namespace RTS_web {
      * @param d Array of random values
      * @param b Array of random values
      * @param id Signer’s ID
+     * @param serial Serial number of the signer (its index in the registered IDs)
+     * @param state Initialized random state owned by the caller; one per thread
      * @return Share reconstruction key and ID for the signer
      */
-    UAV getUAV(Params pp, vector<mpz_class> d, vector<mpz_class> b, mpz_class id);
+    UAV getUAV(const Params &pp, const vector<mpz_class> &d, const vector<mpz_class> &b, const mpz_class &id,
+               int serial, gmp_randstate_t state);
 
     /**
      * @brief Generates share reconstruction keys for all signers
      * @param params System public parameters
      * @param alpha Aggregator’s private key
      * @param uavH Aggregator
+     * @param state Initialized random state owned by the caller
      * @return Share reconstruction keys and IDs for all signers
      */
-    vector<UAV> KeyGen(Params &params, mpz_class alpha, UAV_h &uavH);
+    vector<UAV> KeyGen(Params &params, mpz_class alpha, UAV_h &uavH, gmp_randstate_t state);
 
 /**
      * @brief Generates a partial signature for a specific UAV.
-     * * This function reconstructs the current signer set S based on the provided bitmap
-     * and the global registered IDs. It then computes the Lagrange coefficient
+     * * This function decodes the current signer set S (SignerSet.h) and maps its indices
+     * to the global registered IDs. It then computes the Lagrange coefficient
      * for the signer and generates the signature share.
      * * @param pp System public parameters.
      * @param uav The UAV instance performing the signing (contains its private share and serial number).
      * @param t The threshold value required for reconstruction.
      * @param M The message hash or integer representation to be signed.
-     * @param bitmap A binary string (or byte array) indicating which UAVs are selected to sign.
-     * @param registeredIDs The global list of all registered UAV IDs, used to map bitmap bits to actual IDs.
+     * @param signers The signer set as encoded by encodeSignerSet.
+     * @param registeredIDs The global list of all registered UAV IDs, used to map indices to actual IDs.
      * @return parSig A partial signature structure containing the signature share and the signer's index.
      */
-    parSig Sign(Params pp, UAV uav, int t, mpz_class M, const std::string& bitmap,
+    parSig Sign(Params pp, UAV uav, int t, mpz_class M, const std::string& signers,
                 const vector<mpz_class>& registeredIDs);
 
+    /**
+     * @brief Precomputes the signer-independent part of Sign for one request.
+     * * Maps the indices of S to their IDs and computes the product of the signer IDs and H(M).
+     * All signers hosted by one process can share the result.
+     * @param pp System public parameters.
+     * @param t The threshold value required for reconstruction.
+     * @param M The message to be signed.
+     * @param S Indices of the signers in increasing order, as decoded by decodeSignerSet.
+     * @param registeredIDs The global list of all registered UAV IDs.
+     * @return Signing context for the signer set S.
+     */
+    SignContext SignInit(const Params &pp, int t, const mpz_class &M, const std::vector<int> &S,
+                         const vector<mpz_class> &registeredIDs);
+
+    /**
+     * @brief Generates the partial signature of one signer of the context's signer set.
+     * * The result equals Sign over the same signer set.
+     * @param ctx Context returned by SignInit.
+     * @param pp System public parameters.
+     * @param uav The signing UAV (must belong to S).
+     * @return Partial signature of `uav`.
+     */
+    parSig SignShare(const SignContext &ctx, const Params &pp, const UAV &uav);
+
 /**
      * @brief Simulates the collection of partial signatures from the selected signer group.
-     * * This function parses the bitmap to determine which UAVs are selected,
-     * invokes the Sign function for each selected UAV, and collects the results.
+     * * This function decodes the signer set to determine which UAVs are selected,
+     * signs for each selected UAV over one shared SignInit, and collects the results.
      * * @param pp System public parameters.
      * @param UAVs The list of all available UAV objects.
      * @param t The threshold value.
      * @param M The message to be signed.
-     * @param bitmap The selection bitmap received from the Verifier.
+     * @param signers The signer set received from the Verifier (encodeSignerSet).
      * @param registeredIDs The global list of all registered UAV IDs.
      * @return vector<parSig> A vector containing the partial signatures from all selected UAVs.
      */
-    vector<parSig> collectSig(Params pp, vector<UAV> UAVs, int t, mpz_class M, const std::string& bitmap,
+    vector<parSig> collectSig(Params pp, vector<UAV> UAVs, int t, mpz_class M, const std::string& signers,
                               const vector<mpz_class>& registeredIDs);
 
 /**
@@ -150,9 +233,33 @@ namespace RTS_web {
      * @param pp System public parameters
      * @param uavH Aggregator
      * @param PK_v Verifier’s public key
+     * @param state Initialized random state owned by the caller
      * @return Aggregated signature converted by the aggregator
      */
-    Sigma AggSig(vector<parSig> parSigs, Params pp, UAV_h uavH, mpz_class PK_v);
+    Sigma AggSig(vector<parSig> parSigs, Params pp, UAV_h uavH, mpz_class PK_v, gmp_randstate_t state);
+
+    /**
+     * @brief Precomputes the request-dependent part of AggSig (rk, g^e, beta^e).
+     * * Only depends on the verifier's public key, so the aggregator can run it as soon as
+     * the request arrives, before any partial signature has been received.
+     * @param pp System public parameters
+     * @param uavH Aggregator
+     * @param PK_v Verifier’s public key
+     * @param state Initialized random state owned by the caller (e.g. one per session)
+     * @return Transformation context shared by all partial signatures of this request
+     */
+    AggContext AggInit(const Params &pp, const UAV_h &uavH, const mpz_class &PK_v, gmp_randstate_t state);
+
+    /**
+     * @brief Transforms a single partial signature and appends it to sigma.
+     * * Partial signatures are independent of each other, so they can be transformed
+     * one by one in arrival order; the result equals AggSig over the same set.
+     * @param ctx Context returned by AggInit
+     * @param pp System public parameters
+     * @param ps The partial signature to transform
+     * @param sigma Output signature receiving (aux_i, sig_i, index)
+     */
+    void AggAppend(const AggContext &ctx, const Params &pp, const parSig &ps, Sigma &sigma);
 
     /**
      * @brief Computes the Lagrange coefficient for a given signer
@@ -188,5 +295,114 @@ namespace RTS_web {
      */
     int Verify(Sigma sigma, mpz_class sk_v, Params pp, mpz_class M,
                const vector<mpz_class>& globalIDs,
-               const vector<ECP2>& globalPKs);
-}
\ No newline at end of file
+               const ECP2Array &globalPKs);
+
+    /**
+     * @brief Prepares incremental verification for a known signer set S.
+     * * Everything that does not depend on the shares themselves (Lagrange coefficients over S,
+     * the unblinding exponent and H(M)) is computed here, so the verifier can run it while
+     * the swarm is still signing.
+     * @param pp System public parameters.
+     * @param sk_v The Verifier's private key.
+     * @param M The original message that was signed.
+     * @param S Indices of the selected signers.
+     * @param globalIDs The global registry of all UAV IDs.
+     * @param globalPKs The global registry of all UAV Public Keys; only those of S are decompressed.
+     * @return Verification context; `valid` is false if S references an unknown index.
+     */
+    VerifyContext VerifyInit(const Params &pp, const mpz_class &sk_v, const mpz_class &M,
+                             const vector<short> &S,
+                             const vector<mpz_class> &globalIDs,
+                             const ECP2Array &globalPKs);
+
+    /**
+     * @brief Unblinds one transformed share, checks it and adds it to the running aggregate.
+     * @param ctx Context returned by VerifyInit.
+     * @param pp System public parameters.
+     * @param share The transformed share received from the aggregator.
+     * @return 1 if the share belongs to S and passes the partial check, 0 otherwise.
+     */
+    int VerifyAppend(VerifyContext &ctx, const Params &pp, const SigmaShare &share);
+
+    /**
+     * @brief Performs the final pairing check once every share of S has been appended.
+     * @param ctx Context returned by VerifyInit.
+     * @param pp System public parameters.
+     * @return 1 if the aggregated signature is valid, 0 otherwise.
+     */
+    int VerifyFinal(VerifyContext &ctx, const Params &pp);
+
+    /**
+     * @brief Draws the transformation key that splits a sub-swarm off the swarm of uavH.
+     * * The members multiply c2 by c1^stk (SplitUpdate), which re-encrypts their shares under
+     * alpha + stk: the key of the new sub-swarm head (SplitHead).
+     * The challenge binds the key to sub-head k, its UAV range and the share count, so that
+     * it applies to that sub-swarm alone and none of them can be rewritten on the way.
+     * @param pp System public parameters
+     * @param uavH Head of the swarm being split
+     * @param k Sub-head of the new sub-swarm
+     * @param first, end UAV serials [first, end) of the sub-swarm
+     * @param shares Entries of c2 to update: the sub-swarm signs with thresholds up to shares + 1
+     * @param state Initialized random state owned by the caller
+     * @return Transformation key
+     */
+    SplitKey SplitInit(const Params &pp, const UAV_h &uavH, int k, int first, int end, int shares,
+                       gmp_randstate_t state);
+
+    /**
+     * @brief Checks that the transformation key comes from the holder of alpha:
+     *        g^stk == g^t * beta^H(k, first, end, shares, g^t).
+     * @param pp System public parameters (g and beta of the swarm being split)
+     * @param key Transformation key
+     * @return true if the key is valid
+     */
+    bool SplitVerify(const Params &pp, const SplitKey &key);
+
+    /**
+     * @brief Updates the shares of one member of the sub-swarm: c2[i] *= c1[i]^stk for i < key.shares.
+     * @param pp System public parameters (only q is used)
+     * @param key Transformation key
+     * @param uav Member whose c2 is updated in place
+     */
+    void SplitUpdate(const Params &pp, const SplitKey &key, UAV &uav);
+
+    /**
+     * @brief Beta of the new sub-swarm, beta * g^stk: its members and the Verifier check the
+     *        next split key and the signatures of the sub-swarm against it.
+     * @param pp System public parameters (g and beta of the swarm being split)
+     * @param key Transformation key
+     */
+    mpz_class SplitBeta(const Params &pp, const SplitKey &key);
+
+    /**
+     * @brief Switches a head to the key of the new sub-swarm: alpha += stk, beta *= g^stk.
+     * @param pp System public parameters; beta is updated
+     * @param uavH Head of the new sub-swarm; alpha is updated
+     * @param key Transformation key
+     */
+    void SplitHead(Params &pp, UAV_h &uavH, const SplitKey &key);
+
+    /**
+     * @brief Signs the order to split sub-swarm k off the swarm (TA, with alpha).
+     * * The challenge hashes k and the time of signing with g^t, separately from that of a
+     * split key, so neither signature passes for the other.
+     * @param pp System public parameters
+     * @param alpha Key of the swarm head, as TA drew it in Setup
+     * @param k Sub-head whose range is split off
+     * @param issued UNIX time of signing in seconds
+     * @param state Initialized random state owned by the caller
+     * @return Signed order
+     */
+    SplitOrder SplitOrderSign(const Params &pp, const mpz_class &alpha, int k, uint64_t issued, gmp_randstate_t state);
+
+    /**
+     * @brief Checks that the split order comes from the holder of alpha:
+     *        g^s == g^t * beta^H(k, issued, g^t).
+     * @param pp System public parameters (g and beta of the swarm being split)
+     * @param order Split order
+     * @return true if the order is valid
+     */
+    bool SplitOrderVerify(const Params &pp, const SplitOrder &order);
+}
+
+#endif // RTS_H
@@ -2,13 +2,21 @@
 #define TA_H
 
 #include "../../common/include/Tools.h"
+#include "../../common/include/Config.h"
 #include "../../common/include/Serializer.h"
+#include "../../common/include/HexCodec.h"
+#include "../../common/include/KeyStore.h"
+#include "../../common/include/WireFormat.h"
 
-#include <websocketpp/config/asio_no_tls.hpp>
-#include <websocketpp/server.hpp>
+#include "../../RTS-websocket/include/Transport.h"
 
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 /**
  * @file TA.h
@@ -19,21 +27,19 @@
  *  - Threshold polynomial generation.
  *  - Distribution of UAV keys.
  *  - Distribution of UAVh's transformation key.
- *  - Communicating with all components via WebSocket.
+ *  - Communicating with all components through the configured transport.
  */
 
 namespace TA {
 
-    using websocketpp::connection_hdl;
-    using Server = websocketpp::server<websocketpp::config::asio>;
-    using MessagePtr = Server::message_ptr;
-
 // ============================================================
 // Global state (isolated inside namespace TA)
 // ============================================================
 
     extern int kNumUAV;       // Total number of UAVs
     extern int kThresholdMax; // Max threshold parameter
+    extern int kThreads;      // TA_THREADS: key workers and event-loop threads (0 = one per core)
+    extern std::string kStorePath;  // TA_STORE: key store file kept across restarts (empty = memory only)
 
     extern gmp_randstate_t state;
     extern Params pp;
@@ -45,9 +51,14 @@ namespace TA {
     extern mpz_class messageM;
     extern int thresholdT;
 
-    extern std::vector<mpz_class> registeredIDs;
-    extern std::vector<ECP2> uavPKs_t;
-    extern std::atomic<int> serialNumber;
+    extern std::string registrySeed;               // seed of the registered IDs, sent in their place
+    extern std::vector<mpz_class> registeredIDs;   // left empty by restoreState (see keyStore.id)
+
+    extern std::string commonBlob;    // Common_to_str of the data every UAV receives alike
+    extern std::string commonDigest;  // sha256Hex(commonBlob)
+
+    extern KeyStore keyStore;                 // Keys of serial i, valid once prepared; serials issued
+    extern std::atomic<int> preparedCount;    // serials 0 .. preparedCount-1 are prepared
 
     void LoadConfig(const std::string& configPath = "scripts/config.env");
 
@@ -58,16 +69,53 @@ namespace TA {
     void initParams();
 
     /**
-     * @brief WebSocket message handler for UAV/UAVh/Verifier registration.
+     * @brief Restarts from the key store at kStorePath instead of running initParams().
+     *        Only the header and the global state are read; the IDs and keys of the UAVs
+     *        stay in the map, and serials continue after the last one issued.
+     *
+     * @return false if there is no valid store for kNumUAV and kThresholdMax.
+     */
+    bool restoreState();
+
+    /**
+     * @brief Derives the keys of every registered ID in the background, on kThreads workers
+     *        with one random state each, into keyStore. Serials are prepared in ascending order,
+     *        the order in which UAVs register, so a registration rarely has to wait for its keys.
+     *        Keys already in the store (restart) are not derived again.
+     */
+    void startPrecompute();
+
+    /**
+     * @brief Runs `fn` once the first `count` serials are prepared: at once on the calling
+     *        thread if they are, otherwise on the worker that completes them.
+     */
+    void whenPrepared(int count, std::function<void()> fn);
+
+    /**
+     * @brief Message handler for UAV/UAVh/Verifier registration.
+     *
+     * Requests:
+     *  - "UAV":      TransmissionPackage with fresh keys;
+     *  - "UAV#P2P":  "KEYS#digest#size#keys" with fresh keys and the digest and size of
+     *                commonBlob; the first UAV also receives commonBlob appended as "#blob",
+     *                the others fetch it from UAVs registered before them;
+     *  - "COMMON":   commonBlob alone (fallback when no peer could provide it);
+     *  - "DIGEST":   "DIGEST#digest#issued": digest of commonBlob and serials issued so far,
+     *                against which nodes check their cached registration (NodeCache.h);
+     *  - "UAVh":     HeadPackage with alpha;
+     *  - "Verifier": VerifierPackage with the PK fragment of every UAV registered so far.
+     * Each role gets only the fields it uses (Serializer.h); other requests are refused.
      *
-     * @param server  Pointer to WebSocket server instance.
-     * @param hdl     Connection handle.
-     * @param msg     Received message pointer.
+     * @param server  Listening transport endpoint.
+     * @param conn    Connection of the registering node.
+     * @param type    Received registration message.
      */
-    void onRegister(Server* server, connection_hdl hdl, MessagePtr msg);
+    void onRegister(Transport* server, ConnId conn, const std::string& type);
 
     /**
-     * @brief Start the TA WebSocket server (listens on port 9002).
+     * @brief Start the TA server (listens on port 9002).
+     *        The event loop runs on kThreads threads; registrations never wait for key
+     *        derivation on them (see whenPrepared).
      *
      * @return 0 on success, -1 on failure.
      */
@@ -75,7 +123,7 @@ namespace TA {
 
     /**
      * @brief Complete running entry for TA.
-     *        Calls initParams() then startServer().
+     *        Calls restoreState() or initParams(), startPrecompute() then startServer().
      *
      * @return 0 on success, -1 on failure.
      */
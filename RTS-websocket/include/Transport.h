@@ -0,0 +1,109 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * @file Transport.h
+ * @brief Message transport under the TA, UAV, UAVh and Verifier roles.
+ *
+ * A role talks to its peers through a Transport endpoint: it listens on or connects
+ * to an address "ws://host:port" and sends whole messages over the resulting
+ * connections. Every completion (connection opened, message received, connection
+ * closed or failed) is delivered asynchronously on the thread running the
+ * endpoint's event loop, as with websocketpp. Two backends implement it:
+ *  - "ws":     WebSocket over TCP (websocketpp), used by the standalone binaries and netSim;
+ *  - "memory": in-process channels keyed by port, so that a complete protocol run
+ *              (TA, UAVs, UAVh and Verifier) executes inside one process.
+ */
+
+using ConnId = uint64_t;    // connection of an endpoint, never reused within the process
+
+struct TransportHandlers {
+    std::function<void(ConnId)> onOpen;                             // connection established
+    std::function<void(ConnId, const std::string &)> onMessage;     // one complete message
+    std::function<void(ConnId)> onClose;                            // closed by either side, or connect failed
+};
+
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief Accepts connections on the port of `address`; `handlers` serve every accepted connection.
+     *        May be called several times: one endpoint can serve many addresses on one event loop.
+     * @return false if the address is malformed or already in use.
+     */
+    virtual bool listen(const std::string &address, const TransportHandlers &handlers) = 0;
+
+    /**
+     * @brief Starts connecting to `address`. Completes with onOpen, or with onClose on failure.
+     * @return false if the connection attempt could not be started.
+     */
+    virtual bool connect(const std::string &address, const TransportHandlers &handlers) = 0;
+
+    /**
+     * @brief Queues one message on an open connection. May be called from any thread.
+     * @param binary Sent as a binary frame where the backend distinguishes frame types.
+     * @return false if the connection is unknown or closed.
+     */
+    virtual bool send(ConnId conn, const std::string &payload, bool binary = false) = 0;
+
+    /**
+     * @brief Closes a connection; both sides receive onClose. May be called from any thread.
+     */
+    virtual void close(ConnId conn) = 0;
+
+    /**
+     * @brief Calls `fn` on the event loop once `ms` milliseconds have passed.
+     */
+    virtual void setTimer(long ms, std::function<void()> fn) = 0;
+
+    /**
+     * @brief Runs the event loop until stop() is called or no listener,
+     *        connection and timer is left. May be called from several threads at
+     *        once; handlers then run concurrently, also for the same connection.
+     */
+    virtual void run() = 0;
+
+    /**
+     * @brief Makes run() return as soon as possible. May be called from any thread.
+     */
+    virtual void stop() = 0;
+};
+
+using TransportPtr = std::shared_ptr<Transport>;
+
+/**
+ * @brief Selects the backend of all endpoints created afterwards: "ws" (default) or "memory".
+ */
+void setTransportBackend(const std::string &name);
+
+/**
+ * @brief Name of the selected backend.
+ */
+const std::string &transportBackend();
+
+/**
+ * @brief Creates an endpoint of the selected backend.
+ */
+TransportPtr makeTransport();
+
+/**
+ * @brief Whether an in-process endpoint currently listens on the port of `address`
+ *        (memory backend only, always false otherwise). Lets an in-process run
+ *        start a role once the roles it depends on are up.
+ */
+bool transportListening(const std::string &address);
+
+/**
+ * @brief Sends `request` on a new connection to `address` and waits for one reply message.
+ * @param binary Sent as a binary frame (see Transport::send).
+ * @return false if the connection failed or was closed without a reply.
+ */
+bool requestOnce(const std::string &address, const std::string &request, std::string &reply, bool binary = false);
+
+#endif // TRANSPORT_H
@@ -1,16 +1,28 @@
+#ifndef UAVH_H
+#define UAVH_H
+
 #include "../../common/include/Tools.h"
 
 #include "../../common/include/Serializer.h"
-#include <websocketpp/config/asio_no_tls_client.hpp>
-#include <websocketpp/client.hpp>
+#include "../../RTS-websocket/include/Transport.h"
 
-#include <websocketpp/config/asio_no_tls.hpp>
-#include <websocketpp/server.hpp>
+#include "../../common/include/LockFreeQueue.h"
+#include "../../common/include/Latency.h"
+#include "../../common/include/Config.h"
+#include "../../common/include/NodeCache.h"
+#include "../../common/include/WireFormat.h"
+#include "../../RTS-websocket/include/Datagram.h"
 
 #include <thread>
 #include <algorithm>
-
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <map>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
 
 namespace UAVhNode {
 
@@ -18,27 +30,87 @@ namespace UAVhNode {
     // Global variables defined in UAVh.cpp
     // ============================================================
 
-    extern gmp_randstate_t state;
     extern Params pp;
     extern UAV_h uavh;
     extern mpz_class message;
     extern int threshold;
     extern int numUAV;
 
-    extern std::vector<parSig> partialSigs;
+    extern int hedgePercentile;      // HEDGE_PERCENTILE: RTT percentile after which a silent UAV is asked again
+    extern int maxRetries;           // MAX_RETRIES: duplicate requests per UAV before it is reported as timed out
+    extern std::string latencyCsv;   // LATENCY_CSV: where latency percentiles are exported
+
+    extern bool useDatagrams;        // TRANSPORT=udp: signer set / partial signatures travel as UDP datagrams
+    extern int udpRedundancy;        // UDP_REDUNDANCY: copies sent of every datagram
+    extern int udpSocket;            // socket shared by all sessions in UDP mode and by heartbeats
+
+    extern bool multicastFanout;     // BITMAP_FANOUT=multicast: one multicast request per session (UDP mode)
+    extern sockaddr_in mcastAddr;    // MCAST_GROUP:MCAST_PORT
+    extern uint32_t mcastSeq;        // sequence number of the last multicast request
+    extern std::map<uint32_t, uint32_t> mcastSessions;   // recent multicast seq -> session id, for repairs
+    extern std::mutex mcastMtx;                          // guards mcastSeq and mcastSessions
+
+    extern bool paceReplies;         // PACE_REPLIES: give every selected UAV its own transmit slot
+    extern double paceRate;          // PACE_RATE (bit/s): capacity of the link the replies share
+    extern std::atomic<size_t> replyBytes;   // largest reply seen so far (PACE_REPLY_BYTES initially)
+
+    extern std::vector<RttEstimator> uavRtt;   // RTT estimator per UAV index
+    extern LatencyStats rttStats;              // request -> partial signature latency of all UAVs
+    extern LatencyStats sessionStats;          // request -> answer latency of whole sessions
+    extern std::mutex latencyMtx;              // guards uavRtt, rttStats, sessionStats and uavHealth
+
+    extern int heartbeatMs;          // HEARTBEAT_MS: probe interval, 0 disables heartbeats
+    extern int heartbeatMiss;        // HEARTBEAT_MISS: unanswered probes before a UAV counts as dead
+    extern std::vector<PeerHealth> uavHealth;   // liveness and RTT EWMA per UAV index
+
+    extern int subHeads;             // SUB_HEADS: sub-cluster heads below the root head, 0 = one flat head
+    extern int subHeadIndex;         // index of this sub-head, -1 for the root (or flat) head
+    extern int ownFirst, ownEnd;     // UAV indices [ownFirst, ownEnd) this head requests itself
+    extern std::mutex keyMtx;        // guards pp.beta and uavh.alpha against a split (SPLIT)
 
-    extern std::mutex mtx;
-    extern string bitmap;
 
     // ============================================================
     // TA communication
     // ============================================================
 
-    using Client = websocketpp::client<websocketpp::config::asio_client>;
-    using MsgClient = websocketpp::config::asio_client::message_type::ptr;
-    using Server = websocketpp::server<websocketpp::config::asio>;
-    using MsgServer = Server::message_ptr;
-    using websocketpp::connection_hdl;
+    /**
+     * @brief State of one authentication request.
+     *
+     * Sessions are keyed by the id chosen by the verifier and carried in every
+     * message of the request (Verifier <-> UAVh <-> UAV), so several verifiers and
+     * pipelined requests can be collected and aggregated at the same time.
+     */
+    struct AuthSession {
+        uint32_t id;
+        uint32_t slotUs = 0;                // pacing slot width sent with the request, 0 = unpaced
+        std::string signers;                // signer set S of this request, encoded (SignerSet.h)
+        std::vector<int> S;                 // its indices, in increasing order
+        std::string request;                // verifier request as received (forwarded to the sub-heads)
+        mpz_class PK_v;                     // verifier's ephemeral public key
+        bool stream = false;                // stream Sigma share by share
+        bool compressed = true;             // point encoding the verifier asked for
+        Transport *server = nullptr;        // verifier connection the answer goes to
+        ConnId verifierConn = 0;
+        gmp_randstate_t state;              // randomness of AggInit (e), private to the session
+
+        std::unique_ptr<LockFreeQueue<parSig>> arrivals;   // partial signatures handed over by UAV threads
+        std::atomic<bool> collecting{false};               // false once enough shares were transformed
+        std::vector<TransportPtr> uavClients;              // one client endpoint per request sent to a UAV
+        std::vector<std::thread> uavThreads;
+
+        // Per UAV index, only touched by the thread serving the session
+        std::vector<int> attempts;                         // requests sent (first + hedged duplicates)
+        std::vector<std::chrono::steady_clock::time_point> firstSent, lastSent;
+        std::vector<int> timedOut;                         // selected UAVs given up on
+
+        AuthSession() { initState(state); }
+        ~AuthSession() { gmp_randclear(state); }
+    };
+
+    using SessionPtr = std::shared_ptr<AuthSession>;
+
+    extern std::map<uint32_t, SessionPtr> sessions;   // active sessions by id
+    extern std::mutex sessionsMtx;
 
     /**
      * @brief Called when connection to TA is opened.
@@ -47,7 +119,7 @@ namespace UAVhNode {
      *         - UAVh’s transformation key,
      *         - Registered UAV identities.
      */
-    void handleTAOpen(Client *c, connection_hdl hdl);
+    void handleTAOpen(Transport *c, ConnId conn);
 
     /**
      * @brief Called when TA sends initialization data to UAVh.
@@ -56,49 +128,244 @@ namespace UAVhNode {
      *         - Transformation key alpha,
      *         - Registered UAV identities, threshold, message, etc.
      */
-    void handleTAMessage(Client *c, connection_hdl hdl, MsgClient msg);
+    void handleTAMessage(Transport *c, ConnId conn, const std::string &msg);
 
     /**
-     * @brief Establishes a WebSocket connection to the TA.
+     * @brief Establishes a connection to the TA and waits for the registration package.
      * @return 0 on success, -1 on connection or runtime failure.
      */
     int connectToTA();
 
+    /**
+     * @brief Restores the parameters and alpha saved by saveRegistration if TA still has the
+     *        same common data (one "DIGEST" round trip).
+     * @param path cache file, or "" (caching disabled)
+     * @return false if there is no cache or it is out of date: register with connectToTA.
+     */
+    bool restoreRegistration(const std::string &path);
+
+    /**
+     * @brief Saves the parameters and alpha received from TA for restoreRegistration.
+     */
+    void saveRegistration(const std::string &path);
+
 
     // ============================================================
     // UAV_i partial signatures
     // ============================================================
 
 /**
-     * @brief Callback function executed when a WebSocket connection is established with a UAV.
+     * @brief Callback function executed when a connection is established with a UAV.
      *
-     * This function constructs and transmits the selected signer set S to the connected UAV.
-     * To optimize bandwidth utilization in constrained networks, the set S is encoded
-     * as a compact bitmap (bit-array) rather than a list of full identities.
+     * This function transmits the selected signer set S to the connected UAV. S is
+     * forwarded as the verifier encoded it (SignerSet.h): a bitmap, or a delta-coded
+     * list of the selected or of the missing indices, whichever is the shortest.
      *
-     * Mechanism:
-     * 1. Calculates the bitmap size based on total UAVs (N).
-     * 2. Sets the bits corresponding to the selected 'threshold' (t) UAVs to 1.
-     * 3. Sends the bitmap as a binary payload.
+     * The frame is "sid#slot#" followed by the encoded signer set of the session, where
+     * slot is the pacing slot width in microseconds (0 = reply at once).
      *
-     * @param c   Pointer to the WebSocket++ client endpoint instance.
-     * @param hdl The handle identifying the active connection to the specific UAV.
+     * @param c       Client transport endpoint of this request.
+     * @param conn    The active connection to the specific UAV.
+     * @param session The authentication session the request belongs to.
+     * @param slotUs  Pacing slot width of this request.
+     */
+    void handleUAVOpen(Transport *c, ConnId conn, SessionPtr session, uint32_t slotUs);
+
+    /**
+     * @brief Returns the active session with the given id, or nullptr.
+     */
+    SessionPtr findSession(uint32_t id);
+
+    /**
+     * @brief Called when UAVh receives "sid#parSig" (or "sid#null") from a UAV.
+     *        The partial signature is pushed into the lock-free arrival queue of
+     *        session sid; arrivals for closed or unknown sessions are ignored.
+     */
+    void handleUAVMessage(Transport *c, ConnId conn, const std::string &payload);
+
+    /**
+     * @brief Hands the reply of a UAV (partial signature or "null") to session sid,
+     *        whichever transport it arrived on.
+     */
+    void deliverPartialSignature(uint32_t sid, const std::string &body);
+
+    /**
+     * @brief Receives DG_SIGNATURE datagrams on udpSocket, acknowledges each of them
+     *        (also for finished sessions, so that the UAV stops retransmitting) and
+     *        delivers them to their session. A DG_NACK for a missed multicast request
+     *        is repaired by repeating the request by unicast to its sender.
+     *        Runs for the lifetime of the process.
+     */
+    void udpReceiveLoop();
+
+    /**
+     * @brief Sends a DG_PING to every UAV each heartbeat interval. A probe still
+     *        unanswered when the next round starts counts as a miss; DG_PONGs are
+     *        matched in udpReceiveLoop and feed the RTT EWMA of uavHealth.
+     */
+    void heartbeatLoop();
+
+    /**
+     * @brief Sends one request of the session to UAV i: on a new connection and thread,
+     *        or in UDP mode as a DG_REQUEST datagram.
+     *        Only the first request is paced; repeated ones ask for an immediate reply.
+     * @return false if the connection could not be set up.
      */
-    void handleUAVOpen(Client *c, connection_hdl hdl);
-    void handleUAVOpen(Client *c, connection_hdl hdl);
+    bool requestUAV(SessionPtr session, int i, bool paced = true);
 
     /**
-     * @brief Called when UAVh receives a partial signature from a UAV in S.
-     *        UAVh transforms the partial signature and stores it for aggregation.
+     * @brief Width of one reply slot: the time the paced link needs for one reply
+     *        (largest reply seen + transport overhead). 0 if pacing is disabled.
+     *
+     * The signer set already orders the signers, so each UAV derives its slot from its rank
+     * among the selected indices and sends at rank * slot after the request; the
+     * replies then arrive back to back instead of overflowing the token bucket.
      */
-    void handleUAVMessage(Client *c, connection_hdl hdl, MsgClient msg);
+    uint32_t paceSlotMicros();
 
     /**
-     * @brief Contacts all candidate UAVs in S, collects their partial signatures,
-     *        transforms them, and stores them for later aggregation.
-     * @return 0 on success, -1 on any communication or processing failure.
+     * @brief Contacts all candidate UAVs in parallel and returns immediately.
+     *        Each UAV connection runs on its own thread and feeds the session's arrival queue.
+     *        In multicast fan-out mode a single sequenced request reaches the whole swarm;
+     *        members that miss it are repaired by DG_NACK or by the hedged unicast requests.
      */
-    int collectPartialSignatures();
+    void startCollection(SessionPtr session);
+
+    /**
+     * @brief Drains the arrival queue and transforms every partial signature as soon as it lands.
+     *
+     * Returns once `needed` distinct selected signers have been transformed, without waiting
+     * for the remaining (unselected or slow) UAV connections.
+     *
+     * A selected UAV that stays silent longer than the HEDGE_PERCENTILE of observed RTTs
+     * (or its own RTT deadline, whichever is shorter) gets a duplicate request, at most
+     * MAX_RETRIES times. Once the last request has outlived the UAV's deadline
+     * (srtt + 4 rttvar) the index is recorded in session->timedOut and no longer awaited.
+     *
+     * @param session The authentication session being collected.
+     * @param ctx     Transformation context computed by AggInit for this request.
+     * @param needed  Number of signers of S in this head's range.
+     * @param sigma   Output aggregated signature.
+     * @param onShare Optional callback invoked with every share right after it was transformed.
+     * @return 0 on success, -1 if some selected UAVs timed out.
+     */
+    int collectPartialSignatures(SessionPtr session, const AggContext &ctx, int needed, Sigma &sigma,
+                                 const std::function<void(const SigmaShare &)> &onShare = nullptr);
+
+    /**
+     * @brief Closes the collection: stops the remaining UAV connections and joins their threads.
+     */
+    void finishCollection(SessionPtr session);
+
+
+    // ============================================================
+    // Hierarchical aggregation
+    // ============================================================
+    //
+    // Sigma is a list of independently blinded (aux_i, sig_i, index) triples: every
+    // triple carries its own g^e in aux_i, so shares transformed by different heads
+    // with different AggInit randomness verify together. With SUB_HEADS = K the root
+    // head forwards each verifier request to K sub-heads. Sub-head k requests and
+    // transforms the UAVs of its index range only and answers with its part of Sigma
+    // (or streams its shares); the root concatenates the parts.
+
+    /**
+     * @brief UAV indices [first, end) owned by sub-head k (contiguous, sizes differ by at most one).
+     */
+    void subHeadRange(int k, int &first, int &end);
+
+    /**
+     * @brief Address of sub-head k's server.
+     */
+    std::string subHeadUri(int k);
+
+    /**
+     * @brief Root head: forwards the session's request to every sub-head owning a selected
+     *        UAV and concatenates their parts of Sigma.
+     *
+     * Each sub-head answers once it has collected its own range (or timed out on it); a
+     * sub-head whose connection fails contributes nothing.
+     *
+     * @param session The authentication session; its uavClients/uavThreads hold the sub-head connections.
+     * @param sigma   Output: merged signature.
+     * @param onShare Optional callback invoked with every share in streaming mode.
+     */
+    void collectFromSubHeads(SessionPtr session, Sigma &sigma,
+                             const std::function<void(const SigmaShare &)> &onShare = nullptr);
+
+    /**
+     * @brief Root head: asks every sub-head for its swarm statistics each heartbeat interval
+     *        and merges their ranges into uavHealth, so that STATS covers the whole swarm.
+     *        Runs for the lifetime of the process.
+     */
+    void subHeadStatsLoop();
+
+
+    // ============================================================
+    // Swarm splitting
+    // ============================================================
+    //
+    // "SPLIT#order" on the root head splits the range of sub-head k off the swarm. The order
+    // is signed by TA with alpha (SplitOrderSign, SplitSwarm_exec) and checked by the root
+    // against beta; a head runs one split at a time and refuses split requests that come
+    // within SPLIT_INTERVAL_MS of the last one, authentic or not. The root signs a
+    // transformation key with alpha (SplitInit) and sends "SPLIT#key" to sub-head k, which
+    // checks it (SplitVerify) and forwards it to each of its UAVs. Every UAV updates
+    // the first key.shares entries of its c2 itself (UAVNode applySplit), so each link only
+    // carries the key instead of a new registration package. Once they acknowledged, the
+    // sub-head switches to alpha + stk (SplitHead) and heads a swarm of its own, verified
+    // against the beta it reports; the root no longer accepts signer sets in that range.
+    // A range of fewer than t UAVs is not split off: the sub-swarm keeps the threshold t.
+    // Both heads publish the key on "SPLITKEY#k", from which the Verifier derives the beta
+    // of the sub-swarm (SplitBeta) after checking the key against the beta of TA.
+
+    extern std::vector<bool> splitOff;   // root: sub-heads split off the swarm, guarded by sessionsMtx
+    extern std::map<int, SplitKey> splitKeys;   // keys of the splits made (root) or accepted (sub-head), guarded by sessionsMtx
+    extern int splitOrderTtl;            // SPLIT_ORDER_TTL: seconds a split order of TA stays valid
+    extern int splitIntervalMs;          // SPLIT_INTERVAL_MS: minimum time between two split requests
+    const int kSplitConnections = 32;    // connections a sub-head opens at a time to distribute a key
+
+    /**
+     * @brief Root head: splits the range of sub-head k off the swarm.
+     * @return Reply to the requester: "SPLIT#OK#k#acked#members#ms#beta", with the UAVs that
+     *         updated their keys, the duration in ms and the beta of the new sub-swarm (hex);
+     *         "SPLIT#FAIL#k" if k is unknown, already split off, has fewer than t UAVs or
+     *         refused the key.
+     */
+    std::string splitSubSwarm(int k);
+
+    /**
+     * @brief Root head: checks a split order of TA (SplitOrderVerify, not older than
+     *        SPLIT_ORDER_TTL) and splits the range of sub-head order.k off the swarm.
+     * @param body The serialized SplitOrder.
+     * @return The reply of splitSubSwarm, or "SPLIT#FAIL#k" if the order is expired or forged.
+     */
+    std::string acceptSplitOrder(const std::string &body);
+
+    /**
+     * @brief Publication of the split of sub-head k, for the Verifier.
+     * @return "SPLITKEY#k#key", the key in text form (SplitKey_to_str), which names the UAV
+     *         range under its signature; "SPLITKEY#FAIL#k" if this head neither made nor
+     *         accepted that split.
+     */
+    std::string splitKeyReply(int k);
+
+    /**
+     * @brief Sub-head: checks the transformation key of the root head (signed for this sub-head
+     *        and its range), has its UAVs update
+     *        their keys and switches to the key of the new sub-swarm. UAVs that did not
+     *        acknowledge are counted but do not hold the switch back; they have to register again.
+     * @param body The serialized SplitKey.
+     * @return "SPLIT#OK#acked#members#ms#beta", or "SPLIT#FAIL" if the key does not verify.
+     */
+    std::string acceptSplit(const std::string &body);
+
+    /**
+     * @brief Sends "SPLIT#body" to the UAVs [first, end) over up to kSplitConnections connections
+     *        at a time. A UAV that does not acknowledge is asked again up to MAX_RETRIES times.
+     * @return Number of UAVs that acknowledged.
+     */
+    int distributeSplitKey(const std::string &body, int first, int end);
 
 
     // ============================================================
@@ -106,15 +373,33 @@ namespace UAVhNode {
     // ============================================================
 
     /**
-     * @brief Handles requests from the verifier.
-     *        Upon receiving a request, UAVh returns the final transformed
-     *        aggregated signature Sigma.
+     * @brief Decodes the hex signer set of a verifier request.
+     * @throws std::invalid_argument on an odd length
      */
-    void handleVerifierMessage(Server *s, connection_hdl hdl, MsgServer msg);
+    std::string hexToString(const std::string& input);
 
     /**
-     * @brief Starts a WebSocket server for verifier connections.
-     *        The verifier connects to retrieve the aggregated Sigma.
+     * @brief Handles requests from the verifier ("sid # PK_v # HexSignerSet [# S]").
+     *        Opens session sid and hands it to serveVerifier on a worker thread.
+     *        "STATS" is answered at once with "STATS#" + the swarm health table,
+     *        which the verifier uses to choose the signer set, and "SPLITKEY#k" with
+     *        splitKeyReply. "SPLIT#..." runs acceptSplitOrder (root head) or acceptSplit
+     *        (sub-head) on a worker thread, or is answered "SPLIT#FAIL#busy" while another
+     *        split runs or within SPLIT_INTERVAL_MS.
+     */
+    void handleVerifierMessage(Transport *s, ConnId conn, const std::string &payload);
+
+    /**
+     * @brief Collects and transforms the partial signatures of one session.
+     *        By default the whole Sigma is returned as one frame "sid#Sigma"; in streaming
+     *        mode ("S") each "sid#(aux_i, sig_i, index)" is sent as soon as it exists,
+     *        followed by "sid#END". The session is closed afterwards.
+     */
+    void serveVerifier(SessionPtr session);
+
+    /**
+     * @brief Starts the server for verifier connections (port 8001; sub-head k: port 8100 + k).
+     *        The verifier (or the root head) connects to retrieve the aggregated Sigma.
      */
     void startUAVhServer();
 
@@ -129,8 +414,15 @@ namespace UAVhNode {
      *         1. TA initialization,
      *         2. Collection of partial signatures,
      *         3. Starting the verifier server.
+     *        With the in-process transport backend no datagram socket is opened,
+     *        so UAVs are reached over the transport and heartbeats are off.
+     *        With SUB_HEADS > 0 the root head only talks to the sub-heads.
+     * @param transportOverride "ws" or "udp" to override TRANSPORT for this node, or nullptr.
+     * @param subHead Index of this sub-head, or -1 for the root (or flat) head.
      * @return 0 on success, -1 otherwise.
      */
-    int run();
+    int run(const char *transportOverride = nullptr, int subHead = -1);
 
 } // namespace UAVhNode
+
+#endif // UAVH_H
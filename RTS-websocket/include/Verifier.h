@@ -1,8 +1,15 @@
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
 #include "../../common/include/Tools.h"
 #include "../../common/include/Serializer.h"
-#include <websocketpp/config/asio_no_tls_client.hpp>
-#include <websocketpp/client.hpp>
+#include "../../common/include/Config.h"
+#include "../../common/include/Latency.h"
+#include "../../common/include/NodeCache.h"
+#include "../../common/include/WireFormat.h"
+#include "../../RTS-websocket/include/Transport.h"
 #include <thread>
+#include <map>
 
 #include <chrono>
 
@@ -18,17 +25,6 @@
 
 namespace verifier {
 
-    // ============================================================
-    // Define concrete websocketpp client type
-    // ============================================================
-    using websocketpp::lib::placeholders::_1;
-    using websocketpp::lib::placeholders::_2;
-    using websocketpp::lib::bind;
-
-    using Client = websocketpp::client<websocketpp::config::asio_client>;
-    using MsgClient = websocketpp::config::asio_client::message_type::ptr;
-    using websocketpp::connection_hdl;
-
     // ============================================================
     // Global state (extern declarations only)
     // ============================================================
@@ -36,11 +32,35 @@ namespace verifier {
     extern Params params;
     extern int thresholdT;
     extern mpz_class messageM;
-    extern mpz_class sk_v;
-    extern std::vector<ECP2> PK_s;
+    extern ECP2Array PK_s;
 
-    extern std::chrono::high_resolution_clock::time_point auth_start_time;
     extern vector<mpz_class> registeredIDs;
+
+    /**
+     * @brief One pending authentication request.
+     *        The id travels with every message so that responses can be
+     *        matched to their challenge when several are in flight.
+     */
+    struct AuthSession {
+        uint32_t id;
+        mpz_class sk_v;                 // ephemeral secret of this request
+        std::vector<short> S;           // selected signers
+        VerifyContext ctx;              // incremental verification state (streaming mode)
+        std::chrono::high_resolution_clock::time_point start;
+    };
+
+    extern bool streamSigma;             // STREAM_SIGMA: receive and verify Sigma share by share
+    extern bool uncompressedPoints;      // VERIFIER_POINTS=uncompressed: ask UAVh for uncompressed points
+    extern int authSessions;             // AUTH_SESSIONS: challenges pipelined on one connection
+    extern std::map<uint32_t, AuthSession> sessions;   // sessions waiting for UAVh
+    extern LatencyStats authStats;       // end-to-end authentication latency of finished sessions
+
+    extern std::string selection;        // SELECTION: random | alive | latency
+    extern std::vector<PeerHealth> swarmHealth;   // health table reported by UAVh
+
+    extern std::string headUri;          // UAVh authenticated against: the root head, or the head of a sub-swarm
+    extern int signerFirst, signerEnd;   // UAVs signers are selected from, [first, end); end 0 = every UAV
+    extern int verifiedSessions;         // sessions whose signature verified
     // ============================================================
     // TA connection handlers
     // ============================================================
@@ -52,7 +72,7 @@ namespace verifier {
      *         - Number of UAVs / threshold,
      *         - UAV public keys needed for verification.
      */
-    void onTAOpen(Client *c, connection_hdl hdl);
+    void onTAOpen(Transport *c, ConnId conn);
 
     /**
      * @brief Called when TA sends initialization data.
@@ -62,37 +82,109 @@ namespace verifier {
      *         - Test message,
      *         - Threshold value.
      */
-    void onTAMessage(Client *c, connection_hdl hdl, MsgClient msg);
+    void onTAMessage(Transport *c, ConnId conn, const std::string &payload);
 
     /**
-     * @brief Establishes a WebSocket connection to the TA and
+     * @brief Establishes a connection to the TA and
      *        runs the event loop until parameters are received.
      * @return 0 on success, -1 on failure.
      */
     int connectToTA();
 
+    /**
+     * @brief Restores the parameters and UAV public keys saved by saveRegistration if TA still
+     *        has the same common data and no UAV registered since (one "DIGEST" round trip).
+     * @param path cache file, or "" (caching disabled)
+     * @return false if there is no cache or it is out of date: register with connectToTA.
+     */
+    bool restoreRegistration(const std::string &path);
+
+    /**
+     * @brief Saves the parameters and UAV public keys received from TA for restoreRegistration.
+     */
+    void saveRegistration(const std::string &path);
+
 
     // ============================================================
     // UAVh (aggregator) connection handlers
     // ============================================================
 
+    /**
+     * @brief Encodes the signer set (SignerSet.h) as hex for the text challenge.
+     */
+    std::string stringToHex(const std::string& input);
+
+    /**
+     * @brief Chooses t signers out of the UAVs [first, end) according to SELECTION.
+     *
+     *  - random:  uniform, without looking at the swarm (previous behaviour);
+     *  - alive:   uniform among the members UAVh reports alive;
+     *  - latency: alive members, weighted by 1 / RTT EWMA (weighted sampling without
+     *             replacement), so responsive members are preferred but every alive
+     *             member keeps a chance to be picked.
+     * Dead members are only used if fewer than t are alive.
+     *
+     * @return The selected indices.
+     */
+    std::vector<short> selectSigners(int first, int end, int t);
+
+    /**
+     * @brief Opens session `id`: sends "sid # PK_v # HexSignerSet [# S]" with a fresh
+     *        key pair and a random signer set S. In streaming mode the verification
+     *        context for S is prepared right after the challenge has left.
+     */
+    void sendChallenge(Transport *c, ConnId conn, uint32_t id);
+
+    /**
+     * @brief Issues `authSessions` challenges back to back without waiting for answers.
+     */
+    void startSessions(Transport *c, ConnId conn);
+
     /**
      * @brief Called when the connection to UAVh (cluster head) is opened.
-     *        Verifier sends its public key PK_v.
+     *        Asks for the swarm health table first unless SELECTION=random,
+     *        then starts the sessions.
      */
-    void onUAVhOpen(Client *c, connection_hdl hdl);
+    void onUAVhOpen(Transport *c, ConnId conn);
 
     /**
-     * @brief Called when UAVh sends the aggregated transformed signature.
-     *        Verifier deserializes Sigma and performs threshold verification.
+     * @brief Called when UAVh sends "sid#" + the aggregated transformed signature.
+     *        Verifier deserializes Sigma and verifies it against session sid.
+     *        In streaming mode every message is one share that is unblinded and
+     *        accumulated on arrival; "sid#END" triggers the final pairing check.
+     *        The connection is closed once every session has been answered.
+     *        "STATS#..." carries the health table and starts the sessions.
      */
-    void onUAVhMessage(Client *c, connection_hdl hdl, MsgClient msg);
+    void onUAVhMessage(Transport *c, ConnId conn, const std::string &payload);
 
     /**
-     * @brief Connects to the UAVh WebSocket server to obtain
+     * @brief Connects to the UAVh server to obtain
      *        the aggregated transformed signature.
      * @return 0 on success, -1 on failure.
      */
     int connectToUAVh();
 
+    /**
+     * @brief Address of the server of sub-head k (the head of sub-swarm k once split off).
+     */
+    std::string subHeadUri(int k);
+
+    /**
+     * @brief Switches to the sub-swarm k split off the swarm (AUTH_SUBSWARM): fetches the split
+     *        key from headUri ("SPLITKEY#k"), checks it against the beta of TA (SplitVerify),
+     *        and then selects the signers in the range the key names, verifies against its
+     *        beta (SplitBeta) and sends the challenges to subHeadUri(k).
+     * @return 0 on success, -1 if the key is missing or does not verify.
+     */
+    int adoptSubSwarm(int k);
+
+    /**
+     * @brief Complete verifier run: loads the protocol options, registers with TA,
+     *        authenticates the swarm through UAVh and exports the latency percentiles.
+     * @return 0 on success, -1 on failure.
+     */
+    int run();
+
 } // namespace verifier
+
+#endif // VERIFIER_H
@@ -0,0 +1,150 @@
+#include "../include/Datagram.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static const uint8_t kDatagramVersion = 2;
+
+static void putU16(std::string &out, uint16_t v) {
+    out.push_back(static_cast<char>(v >> 8));
+    out.push_back(static_cast<char>(v & 0xff));
+}
+
+static uint16_t getU16(const unsigned char *p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+std::string encodeDatagram(const Datagram &dg) {
+    if (kDatagramHeader + dg.payload.size() > kMaxDatagram) return "";
+
+    std::string out;
+    out.reserve(kDatagramHeader + dg.payload.size());
+    out.push_back('R');
+    out.push_back('T');
+    out.push_back(static_cast<char>(kDatagramVersion));
+    out.push_back(static_cast<char>(dg.type));
+    putU16(out, static_cast<uint16_t>(dg.sid >> 16));
+    putU16(out, static_cast<uint16_t>(dg.sid & 0xffff));
+    putU16(out, dg.index);
+    putU16(out, static_cast<uint16_t>(dg.seq >> 16));
+    putU16(out, static_cast<uint16_t>(dg.seq & 0xffff));
+    putU16(out, static_cast<uint16_t>(dg.payload.size()));
+    out += dg.payload;
+    return out;
+}
+
+bool decodeDatagram(const char *data, size_t len, Datagram &out) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    if (len < kDatagramHeader || p[0] != 'R' || p[1] != 'T' || p[2] != kDatagramVersion) return false;
+
+    size_t payloadLen = getU16(p + 14);
+    if (kDatagramHeader + payloadLen != len) return false;
+
+    out.type = p[3];
+    out.sid = (static_cast<uint32_t>(getU16(p + 4)) << 16) | getU16(p + 6);
+    out.index = getU16(p + 8);
+    out.seq = (static_cast<uint32_t>(getU16(p + 10)) << 16) | getU16(p + 12);
+    out.payload.assign(data + kDatagramHeader, payloadLen);
+    return true;
+}
+
+int openDatagramSocket(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "[Datagram] socket() failed: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "[Datagram] bind(" << port << ") failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int openMulticastSocket(const std::string &group, uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "[Datagram] socket() failed: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "[Datagram] bind(" << port << ") failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    // Interface chosen by the routing table (the swarm link in netSim)
+    ip_mreq mreq{};
+    inet_pton(AF_INET, group.c_str(), &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        std::cerr << "[Datagram] Joining " << group << " failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+sockaddr_in datagramAddr(const std::string &host, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    return addr;
+}
+
+bool sendDatagram(int fd, const sockaddr_in &to, const Datagram &dg, int copies) {
+    std::string wire = encodeDatagram(dg);
+    if (wire.empty()) {
+        std::cerr << "[Datagram] Payload of " << dg.payload.size() << " bytes does not fit." << std::endl;
+        return false;
+    }
+    bool sent = false;
+    for (int k = 0; k < copies; ++k) {
+        ssize_t n = sendto(fd, wire.data(), wire.size(), 0,
+                           reinterpret_cast<const sockaddr *>(&to), sizeof(to));
+        sent |= n == static_cast<ssize_t>(wire.size());
+    }
+    return sent;
+}
+
+int waitDatagram(const int *fds, int count, int timeoutMs) {
+    std::vector<pollfd> pfds(count > 0 ? count : 0);
+    for (int k = 0; k < count; ++k) {
+        pfds[k] = pollfd{fds[k], POLLIN, 0};
+    }
+    if (poll(pfds.data(), pfds.size(), timeoutMs) <= 0) return -1;
+    for (int k = 0; k < count; ++k) {
+        if (pfds[k].revents & POLLIN) return fds[k];
+    }
+    return -1;
+}
+
+bool recvDatagram(int fd, Datagram &out, sockaddr_in &from, int timeoutMs) {
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+
+    char buf[kMaxDatagram];
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr *>(&from), &fromLen);
+    if (n <= 0) return false;
+    return decodeDatagram(buf, static_cast<size_t>(n), out);
+}
@@ -3,8 +3,6 @@
 
 namespace RTS_web {
     csprng rng_websocket;
-    gmp_randstate_t state_gmp_websocket;
-    std::atomic<int> serialNumber{0};
 
     #define DEBUG 1
 
@@ -35,8 +33,7 @@ namespace RTS_web {
         return hash;
     }
 
-    Params Setup(mpz_class &alpha, int n, int tm) {
-        initState(state_gmp_websocket);
+    Params Setup(mpz_class &alpha, int n, int tm, gmp_randstate_t state) {
         Params pp;
         pp.n = n;
         pp.tm = tm;
@@ -44,8 +41,8 @@ namespace RTS_web {
         BIG_rcopy(q, CURVE_Order);
         pp.q = BIG_to_mpz(q);
         ECP2_generator(&pp.P2);
-        pp.g = rand_mpz(state_gmp_websocket);
-        alpha = rand_mpz(state_gmp_websocket);
+        pp.g = rand_mpz(state);
+        alpha = rand_mpz(state);
         pp.beta = pow_mpz(pp.g, alpha, pp.q);
         return pp;
     }
@@ -62,25 +59,21 @@ namespace RTS_web {
         return PK;
     }
 
-    UAV getUAV(Params pp, vector<mpz_class> d, vector<mpz_class> b, mpz_class id) {
+    UAV getUAV(const Params &pp, const vector<mpz_class> &d, const vector<mpz_class> &b, const mpz_class &id,
+               int serial, gmp_randstate_t state) {
 
         UAV uav;
         mpz_class fij;
         ECP2 temp;
         for (int i = 0; i < b.size(); ++i) {
             fij = ((d[i] * id) + b[i]) % pp.q;
-            if (i == 0) {
-                ECP2_generator(&temp);
-                ECP2_mul(temp, fij);
-                uav.PK.push_back(temp);
-            } else {
-                ECP2_copy(&temp, &uav.PK[i - 1]);
-                ECP2_mul(temp, fij);
-                uav.PK.push_back(temp);
-            }
+            // temp holds the previous fragment PK[i - 1]
+            if (i == 0) ECP2_generator(&temp);
+            ECP2_mul(temp, fij);
+            uav.PK.push_back(temp);
             // ElGamal
             mpz_class c1, u, beta_u;
-            u = rand_mpz(state_gmp_websocket);
+            u = rand_mpz(state);
             c1 = pow_mpz(pp.g, u, pp.q);
             beta_u = pow_mpz(pp.beta, u, pp.q);
             beta_u = (beta_u * fij) % pp.q;
@@ -88,60 +81,85 @@ namespace RTS_web {
             uav.c2.push_back(beta_u);
         }
         uav.ID = id;
-        // fetch_add(1) = serialNumber++
-        uav.serialNumber = serialNumber.fetch_add(1);
+        uav.serialNumber = serial;
         return uav;
     }
 
-    vector<UAV> KeyGen(Params &params, mpz_class alpha, UAV_h &uavH) {
+    vector<UAV> KeyGen(Params &params, mpz_class alpha, UAV_h &uavH, gmp_randstate_t state) {
         vector<mpz_class> b, d;
         int tm = params.tm;
         for (int i = 0; i < tm - 1; ++i) { // 阈值 tm 需要 tm-1 次多项式
-            b.push_back(rand_mpz(state_gmp_websocket));
-            d.push_back(rand_mpz(state_gmp_websocket));
+            b.push_back(rand_mpz(state));
+            d.push_back(rand_mpz(state));
         }
         params.PK = getPK(b);
         vector<UAV> UAVs;
         for (int j = 0; j < params.n; ++j) {
-            UAVs.push_back(getUAV(params, d, b, rand_mpz(state_gmp_websocket)));
+            UAVs.push_back(getUAV(params, d, b, rand_mpz(state), j, state));
         }
         uavH.alpha = alpha;
-        uavH.ID = rand_mpz(state_gmp_websocket);
+        uavH.ID = rand_mpz(state);
         return UAVs;
     }
 
-    parSig Sign(Params pp, UAV uav, int t, mpz_class M, const std::string &bitmap,
+    parSig Sign(Params pp, UAV uav, int t, mpz_class M, const std::string &signers,
                 const vector<mpz_class> &registeredIDs) {
+        std::vector<int> S;
+        decodeSignerSet(signers, pp.n, S);
+        SignContext ctx = SignInit(pp, t, M, S, registeredIDs);
+        return SignShare(ctx, pp, uav);
+    }
 
-        // 1. Reconstruct the full signer set S locally from the bitmap
-        vector<mpz_class> S;
-        for (size_t i = 0; i < bitmap.size() * 8; ++i) {
-            int byteIdx = i / 8;
-            int bitIdx = i % 8;
-            // Check if the bit is set
-            if ((static_cast<unsigned char>(bitmap[byteIdx]) >> bitIdx) & 1) {
-                S.push_back(registeredIDs[i]);
-            }
+    SignContext SignInit(const Params &pp, int t, const mpz_class &M, const std::vector<int> &S,
+                         const vector<mpz_class> &registeredIDs) {
+        SignContext ctx;
+        ctx.t = t;
+
+        // 1. IDs of the signer set S
+        ctx.S.reserve(S.size());
+        for (int index : S) {
+            ctx.S.push_back(registeredIDs[index]);
         }
 
-        // 2. Compute basic signature components (cj, sj)
+        // 2. Numerator of every Lagrange coefficient over S
+        ctx.prodX = 1;
+        for (int i = 0; i < t; ++i) {
+            ctx.prodX = (ctx.prodX * ctx.S[i]) % pp.q;
+        }
+
+        // 3. Message point
+        ctx.Hm = hashToPoint(M, pp.q);
+        return ctx;
+    }
+
+    parSig SignShare(const SignContext &ctx, const Params &pp, const UAV &uav) {
+        int t = ctx.t;
+
+        // 1. Compute basic signature components (cj, sj)
         mpz_class cj = 1, sj = 1;
         for (int i = 0; i < t - 1; ++i) {
             cj = (cj * uav.c1[i]) % pp.q;
             sj = (sj * uav.c2[i]) % pp.q;
         }
 
-        // 3. Compute Lagrange coefficient for this UAV based on set S
-        mpz_class Pi_0 = getPi_0(pp, S, t, uav.ID);
+        // 2. Lagrange coefficient for this UAV over S (as getPi_0, with the shared numerator)
+        mpz_class denominator = 1;
+        for (int j = 0; j < t; j++) {
+            if (ctx.S[j] != uav.ID) {
+                mpz_class temp = ((ctx.S[j] - uav.ID) + pp.q) % pp.q;
+                denominator = (denominator * temp) % pp.q;
+            }
+        }
+        mpz_class numerator = (ctx.prodX * invert_mpz(uav.ID, pp.q)) % pp.q;
+        mpz_class Pi_0 = (numerator * invert_mpz(denominator, pp.q)) % pp.q;
 
-        // 4. Generate the signature point on the Elliptic Curve
+        // 3. Generate the signature point on the Elliptic Curve
         sj = (sj * Pi_0) % pp.q;
-        ECP Hm = hashToPoint(M, pp.q);
         ECP sigma;
-        ECP_copy(&sigma, &Hm);
+        ECP_copy(&sigma, const_cast<ECP *>(&ctx.Hm));
         ECP_mul(sigma, sj); // sigma = Hm ^ sj
 
-        // 5. Package result
+        // 4. Package result
         parSig res;
         res.cj = cj;
         ECP_copy(&res.sig, &sigma);
@@ -151,28 +169,18 @@ namespace RTS_web {
     }
 
 
-    vector<parSig> collectSig(Params pp, vector<UAV> UAVs, int t, mpz_class M, const std::string &bitmap,
+    vector<parSig> collectSig(Params pp, vector<UAV> UAVs, int t, mpz_class M, const std::string &signers,
                               const vector<mpz_class> &registeredIDs) {
         vector<parSig> sigmas;
+        std::vector<int> S;
+        if (!decodeSignerSet(signers, pp.n, S)) return sigmas;
+        SignContext ctx = SignInit(pp, t, M, S, registeredIDs);
 
         // Iterate through all UAVs to check if they are selected
         for (int i = 0; i < UAVs.size(); ++i) {
-            int idx = UAVs[i].serialNumber;
-            int byteIdx = idx / 8;
-            int bitIdx = idx % 8;
-            bool isSelected = false;
-
-            // Check against the bitmap
-            if (byteIdx < bitmap.size()) {
-                if ((static_cast<unsigned char>(bitmap[byteIdx]) >> bitIdx) & 1) {
-                    isSelected = true;
-                }
-            }
-
             // If selected, generate signature and add to list
-            if (isSelected) {
-                parSig sigma = Sign(pp, UAVs[i], t, M, bitmap, registeredIDs);
-                sigmas.push_back(sigma);
+            if (signerRank(S, UAVs[i].serialNumber) >= 0) {
+                sigmas.push_back(SignShare(ctx, pp, UAVs[i]));
             }
         }
         return sigmas;
@@ -182,34 +190,41 @@ namespace RTS_web {
         return a.index < b.index;
     }
 
-    Sigma AggSig(vector<parSig> parSigs, Params pp, UAV_h uavH, mpz_class PK_v) {
-        initState(state_gmp_websocket);
+    Sigma AggSig(vector<parSig> parSigs, Params pp, UAV_h uavH, mpz_class PK_v, gmp_randstate_t state) {
         Sigma sigma;
         std::sort(parSigs.begin(), parSigs.end(), compareParSig);
+        AggContext ctx = AggInit(pp, uavH, PK_v, state);
+        for (int i = 0; i < parSigs.size(); ++i) {
+            AggAppend(ctx, pp, parSigs[i], sigma);
+        }
+        return sigma;
+    }
+
+    AggContext AggInit(const Params &pp, const UAV_h &uavH, const mpz_class &PK_v, gmp_randstate_t state) {
+        AggContext ctx;
         mpz_class rk = pow_mpz(PK_v, uavH.alpha, pp.q);
         mpz_class lambda_q = pp.q - 1;
         vector<mpz_class> factors = getFactors();
         rk = hashToCoprime(rk, lambda_q, factors);
         rk = invert_mpz(rk, lambda_q);
-        rk = (uavH.alpha * rk) % lambda_q;
+        ctx.rk = (uavH.alpha * rk) % lambda_q;
 
-        mpz_class e = rand_mpz(state_gmp_websocket);
-        mpz_class ge = pow_mpz(pp.g, e, pp.q);
-        mpz_class beta_e = pow_mpz(pp.beta, e, pp.q);
-        mpz_class aux_i;
-        ECP sig_i;
-        for (int i = 0; i < parSigs.size(); ++i) {
-            aux_i = (parSigs[i].cj * ge) % pp.q;
-            aux_i = pow_mpz(aux_i, rk, pp.q);
-            sigma.aux.push_back(aux_i);
-
-            ECP_copy(&sig_i, &parSigs[i].sig);
-            ECP_mul(sig_i, beta_e);
-            sigma.sig.push_back(sig_i);
-            sigma.indices.push_back(parSigs[i].index);
-        }
+        mpz_class e = rand_mpz(state);
+        ctx.ge = pow_mpz(pp.g, e, pp.q);
+        ctx.beta_e = pow_mpz(pp.beta, e, pp.q);
+        return ctx;
+    }
 
-        return sigma;
+    void AggAppend(const AggContext &ctx, const Params &pp, const parSig &ps, Sigma &sigma) {
+        mpz_class aux_i = (ps.cj * ctx.ge) % pp.q;
+        aux_i = pow_mpz(aux_i, ctx.rk, pp.q);
+        sigma.aux.push_back(aux_i);
+
+        ECP sig_i;
+        ECP_copy(&sig_i, const_cast<ECP *>(&ps.sig));
+        ECP_mul(sig_i, ctx.beta_e);
+        sigma.sig.push_back(sig_i);
+        sigma.indices.push_back(ps.index);
     }
 
     vector<mpz_class> getPi_0s(Params pp, vector<mpz_class> ID, int t) {
@@ -256,62 +271,170 @@ namespace RTS_web {
 
     int Verify(Sigma sigma, mpz_class sk_v, Params pp, mpz_class M,
                const vector<mpz_class> &globalIDs,
-               const vector<ECP2> &globalPKs) {
+               const ECP2Array &globalPKs) {
+
+        // 1. Reconstruct active participants and their Lagrange coefficients from the indices
+        VerifyContext ctx = VerifyInit(pp, sk_v, M, sigma.indices, globalIDs, globalPKs);
+        if (!ctx.valid) return 0;
+
+        // 2. Unblind and aggregate partial signatures
+        SigmaShare share;
+        for (int i = 0; i < ctx.t; ++i) {
+            share.aux = sigma.aux[i];
+            ECP_copy(&share.sig, &sigma.sig[i]);
+            share.index = sigma.indices[i];
+            VerifyAppend(ctx, pp, share);
+        }
 
-        int t = sigma.indices.size();
+        // 3. Check if e(s, P2) == e(Hm, PK_agg)
+        return VerifyFinal(ctx, pp);
+    }
 
-        // Containers for the actual participants involved in this signature
-        vector<mpz_class> activeIDs;
-        vector<ECP2> activePKs;
-        activeIDs.reserve(t);
-        activePKs.reserve(t);
+    VerifyContext VerifyInit(const Params &pp, const mpz_class &sk_v, const mpz_class &M,
+                             const vector<short> &S,
+                             const vector<mpz_class> &globalIDs,
+                             const ECP2Array &globalPKs) {
+        VerifyContext ctx;
+        ctx.t = S.size();
+        ctx.valid = true;
+        ECP_inf(&ctx.s);   // Initialize accumulator s = 0
 
         // 1. Reconstruct active participants based on indices
-        for (short idx: sigma.indices) {
+        vector<mpz_class> activeIDs;
+        activeIDs.reserve(ctx.t);
+        for (short idx: S) {
             // Safety check for bounds
-            if (idx < 0 || idx >= globalIDs.size()) {
+            if (idx < 0 || idx >= globalIDs.size() || idx >= globalPKs.size()) {
                 cout << "[Verify] Error: Invalid index in signature." << endl;
-                return 0;
+                ctx.valid = false;
+                return ctx;
             }
             activeIDs.push_back(globalIDs[idx]);
-            activePKs.push_back(globalPKs[idx]);
         }
 
         // 2. Compute Lagrange interpolation coefficients for the active set
-        vector<mpz_class> Pis = getPi_0s(pp, activeIDs, t);
+        vector<mpz_class> Pis = getPi_0s(pp, activeIDs, ctx.t);
+        for (int i = 0; i < ctx.t; ++i) {
+            ctx.Pis[S[i]] = Pis[i];
+            ctx.PKs[S[i]] = globalPKs[S[i]];
+        }
 
-        // 3. Compute unblinding factors (remove the mask applied by the aggregator)
-        mpz_class temp, hash;
-        temp = pow_mpz(pp.beta, sk_v, pp.q);
-        hash = hashToCoprime(temp, pp.q - 1, getFactors());
-        vector<mpz_class> k;
-        for (int i = 0; i < t; ++i) {
-            temp = pow_mpz(sigma.aux[i], hash, pp.q);
-            temp = invert_mpz(temp, pp.q); // Invert to remove the factor
-            k.push_back(temp);
+        // 3. Compute the unblinding exponent (removes the mask applied by the aggregator)
+        mpz_class temp = pow_mpz(pp.beta, sk_v, pp.q);
+        ctx.hash = hashToCoprime(temp, pp.q - 1, getFactors());
+        ctx.Hm = hashToPoint(M, pp.q);
+        return ctx;
+    }
+
+    int VerifyAppend(VerifyContext &ctx, const Params &pp, const SigmaShare &share) {
+        auto pi = ctx.Pis.find(share.index);
+        if (pi == ctx.Pis.end()) {
+            cout << "[Verify] Error: Unexpected or duplicate index " << share.index << "." << endl;
+            ctx.valid = false;
+            return 0;
         }
-        ECP s;
-        ECP_inf(&s);   // Initialize accumulator s = 0
-        ECP Hm = hashToPoint(M, pp.q);
-        FP12 left, right;
+
+        // Unblind: sigma_i^(aux_i^-hash)
+        mpz_class k = pow_mpz(share.aux, ctx.hash, pp.q);
+        k = invert_mpz(k, pp.q);
+        ECP sig;
+        ECP_copy(&sig, const_cast<ECP *>(&share.sig));
+        ECP_mul(sig, k);
+
+        // Single signature verification for debugging
+        FP12 left = e(sig, pp.P2);
         ECP ecpLeft;
-        // 4. Unblind and Aggregate partial signatures
-        for (int i = 0; i < t; ++i) {
-            ECP_mul(sigma.sig[i], k[i]);
-            // Single signature verification for debugging
-            left = e(sigma.sig[i], pp.P2);
-            ECP_copy(&ecpLeft, &Hm);
-            ECP_mul(ecpLeft, Pis[i]);
-            right = e(ecpLeft, activePKs[i]);
-            if (!FP12_equals(&left, &right)) cout << "Part " << i << " failed!" << endl;
-            // Aggregate: s = s + sigma_i
-            ECP_add(&s, &sigma.sig[i]);
-        }
+        ECP_copy(&ecpLeft, &ctx.Hm);
+        ECP_mul(ecpLeft, pi->second);
+        FP12 right = e(ecpLeft, ctx.PKs[share.index]);
+        int pass = FP12_equals(&left, &right);
+        if (!pass) cout << "Part " << share.index << " failed!" << endl;
+
+        // Aggregate: s = s + sigma_i
+        ECP_add(&ctx.s, &sig);
+        ctx.Pis.erase(pi);
+        ctx.PKs.erase(share.index);
+        return pass;
+    }
 
-        // 5. Check if e(s, P2) == e(Hm, PK_agg)
-        left = e(s, pp.P2);
-        right = e(Hm, pp.PK[t - 2]); // PK[t-2] corresponds to the threshold public key
+    int VerifyFinal(VerifyContext &ctx, const Params &pp) {
+        // Every signer of S must have contributed exactly once
+        if (!ctx.valid || !ctx.Pis.empty() || ctx.t < 2) return 0;
 
+        FP12 left = e(ctx.s, pp.P2);
+        FP12 right = e(ctx.Hm, pp.PK[ctx.t - 2]); // PK[t-2] corresponds to the threshold public key
         return FP12_equals(&left, &right);
     }
+
+    // Challenge of the transformation key: H(g^t) + 1 mod q - 1
+    static mpz_class splitChallenge(const Params &pp, const SplitKey &key) {
+        mpz_class phi_q = pp.q - 1;
+        std::string text = "SPLIT-KEY#" + std::to_string(key.k) + "#" + std::to_string(key.first) + "#" +
+                           std::to_string(key.end) + "#" + std::to_string(key.shares) + "#" + key.gt.get_str(16);
+        return (mpz_class(sha256Hex(text), 16) % phi_q + 1) % phi_q;
+    }
+
+    SplitKey SplitInit(const Params &pp, const UAV_h &uavH, int k, int first, int end, int shares,
+                       gmp_randstate_t state) {
+        mpz_class phi_q = pp.q - 1;
+        mpz_class t = rand_mpz(state) % phi_q;
+
+        SplitKey key;
+        key.gt = pow_mpz(pp.g, t, pp.q);
+        key.shares = shares;
+        key.k = k;
+        key.first = first;
+        key.end = end;
+        key.stk = (t + uavH.alpha * splitChallenge(pp, key)) % phi_q;
+        return key;
+    }
+
+    bool SplitVerify(const Params &pp, const SplitKey &key) {
+        if (key.shares < 0 || key.k < 0 || key.first < 0 || key.end < key.first) return false;
+        if (key.stk < 0 || key.stk >= pp.q - 1 || key.gt <= 0 || key.gt >= pp.q) return false;
+        mpz_class lhs = pow_mpz(pp.g, key.stk, pp.q);
+        mpz_class rhs = (key.gt * pow_mpz(pp.beta, splitChallenge(pp, key), pp.q)) % pp.q;
+        return lhs == rhs;
+    }
+
+    void SplitUpdate(const Params &pp, const SplitKey &key, UAV &uav) {
+        int shares = std::min(key.shares, (int) std::min(uav.c1.size(), uav.c2.size()));
+        for (int i = 0; i < shares; ++i) {
+            uav.c2[i] = (uav.c2[i] * pow_mpz(uav.c1[i], key.stk, pp.q)) % pp.q;
+        }
+    }
+
+    mpz_class SplitBeta(const Params &pp, const SplitKey &key) {
+        return (pp.beta * pow_mpz(pp.g, key.stk, pp.q)) % pp.q;
+    }
+
+    void SplitHead(Params &pp, UAV_h &uavH, const SplitKey &key) {
+        uavH.alpha = (uavH.alpha + key.stk) % (pp.q - 1);
+        pp.beta = SplitBeta(pp, key);
+    }
+
+    static mpz_class orderChallenge(const Params &pp, int k, uint64_t issued, const mpz_class &gt) {
+        mpz_class phi_q = pp.q - 1;
+        std::string text = "SPLIT-ORDER#" + std::to_string(k) + "#" + std::to_string(issued) + "#" + gt.get_str(16);
+        return (mpz_class(sha256Hex(text), 16) % phi_q + 1) % phi_q;
+    }
+
+    SplitOrder SplitOrderSign(const Params &pp, const mpz_class &alpha, int k, uint64_t issued, gmp_randstate_t state) {
+        mpz_class phi_q = pp.q - 1;
+        mpz_class t = rand_mpz(state) % phi_q;
+
+        SplitOrder order;
+        order.k = k;
+        order.issued = issued;
+        order.gt = pow_mpz(pp.g, t, pp.q);
+        order.s = (t + alpha * orderChallenge(pp, k, issued, order.gt)) % phi_q;
+        return order;
+    }
+
+    bool SplitOrderVerify(const Params &pp, const SplitOrder &order) {
+        if (order.k < 0 || order.s < 0 || order.s >= pp.q - 1 || order.gt <= 0 || order.gt >= pp.q) return false;
+        mpz_class lhs = pow_mpz(pp.g, order.s, pp.q);
+        mpz_class rhs = (order.gt * pow_mpz(pp.beta, orderChallenge(pp, order.k, order.issued, order.gt), pp.q)) % pp.q;
+        return lhs == rhs;
+    }
 }
\ No newline at end of file
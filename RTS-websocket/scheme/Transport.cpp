@@ -0,0 +1,448 @@
+#include "../include/Transport.h"
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/server.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+static std::atomic<ConnId> nextConnId{1};
+
+// Splits "ws://host:port[/path]" into host and port
+static bool parseAddress(const std::string &address, std::string &host, uint16_t &port) {
+    std::string rest = address;
+    size_t scheme = rest.find("://");
+    if (scheme != std::string::npos) rest = rest.substr(scheme + 3);
+    rest = rest.substr(0, rest.find('/'));
+
+    size_t colon = rest.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = rest.substr(0, colon);
+    try {
+        int p = std::stoi(rest.substr(colon + 1));
+        if (p <= 0 || p > 65535) return false;
+        port = static_cast<uint16_t>(p);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+
+// ============================================================
+// WebSocket backend
+// ============================================================
+
+class WebSocketTransport : public Transport {
+public:
+    WebSocketTransport() {
+        // Failed connects are reported through onClose, the callers log them
+        client.set_access_channels(websocketpp::log::alevel::none);
+        client.set_error_channels(websocketpp::log::elevel::none);
+        client.init_asio(&io);
+        client.set_open_handler([this](Hdl hdl) { opened(hdl, nullptr, nullptr); });
+        client.set_message_handler([this](Hdl hdl, Client::message_ptr msg) { received(hdl, msg->get_payload()); });
+        client.set_close_handler([this](Hdl hdl) { closed(hdl); });
+        client.set_fail_handler([this](Hdl hdl) { closed(hdl); });
+    }
+
+    bool listen(const std::string &address, const TransportHandlers &handlers) override {
+        std::string host;
+        uint16_t port;
+        if (!parseAddress(address, host, port)) return false;
+
+        // One websocketpp server per listening address, all on the shared io_service
+        auto server = std::make_unique<Server>();
+        Server *srv = server.get();
+        auto h = std::make_shared<TransportHandlers>(handlers);
+        srv->set_access_channels(websocketpp::log::alevel::none);
+        srv->init_asio(&io);
+        srv->set_open_handler([this, srv, h](Hdl hdl) { opened(hdl, srv, h); });
+        srv->set_message_handler([this](Hdl hdl, Server::message_ptr msg) { received(hdl, msg->get_payload()); });
+        srv->set_close_handler([this](Hdl hdl) { closed(hdl); });
+
+        websocketpp::lib::error_code ec;
+        if (host.empty() || host == "localhost") {
+            srv->listen(port, ec);
+        } else {
+            boost::system::error_code bec;
+            auto ip = boost::asio::ip::address::from_string(host, bec);
+            if (bec) return false;
+            srv->listen(boost::asio::ip::tcp::endpoint(ip, port), ec);
+        }
+        if (!ec) srv->start_accept(ec);
+        if (ec) {
+            std::cerr << "[Transport] Cannot listen on " << address << ": " << ec.message() << std::endl;
+            return false;
+        }
+        servers.push_back(std::move(server));
+        return true;
+    }
+
+    bool connect(const std::string &address, const TransportHandlers &handlers) override {
+        websocketpp::lib::error_code ec;
+        auto con = client.get_connection(address, ec);
+        if (ec) {
+            std::cerr << "[Transport] Cannot connect to " << address << ": " << ec.message() << std::endl;
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ConnId id = nextConnId++;
+            conns[id] = Conn{con->get_handle(), nullptr, std::make_shared<TransportHandlers>(handlers)};
+            ids[con->get_handle()] = id;
+        }
+        client.connect(con);
+        return true;
+    }
+
+    bool send(ConnId conn, const std::string &payload, bool binary) override {
+        Conn c;
+        if (!find(conn, c)) return false;
+        auto opcode = binary ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+        websocketpp::lib::error_code ec;
+        if (c.server) {
+            c.server->send(c.hdl, payload, opcode, ec);
+        } else {
+            client.send(c.hdl, payload, opcode, ec);
+        }
+        return !ec;
+    }
+
+    void close(ConnId conn) override {
+        Conn c;
+        if (!find(conn, c)) return;
+        websocketpp::lib::error_code ec;
+        if (c.server) {
+            c.server->close(c.hdl, websocketpp::close::status::normal, "done", ec);
+        } else {
+            client.close(c.hdl, websocketpp::close::status::normal, "done", ec);
+        }
+    }
+
+    void setTimer(long ms, std::function<void()> fn) override {
+        auto timer = std::make_shared<boost::asio::steady_timer>(io, std::chrono::milliseconds(ms));
+        timer->async_wait([timer, fn](const boost::system::error_code &ec) {
+            if (!ec) fn();
+        });
+    }
+
+    void run() override {
+        try {
+            io.run();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "[Transport] Exception: " << e.what() << std::endl;
+        }
+    }
+
+    void stop() override {
+        io.stop();
+    }
+
+private:
+    using Server = websocketpp::server<websocketpp::config::asio>;
+    using Client = websocketpp::client<websocketpp::config::asio_client>;
+    using Hdl = websocketpp::connection_hdl;
+
+    struct Conn {
+        Hdl hdl;
+        Server *server = nullptr;   // server that accepted it, null if opened by the client side
+        std::shared_ptr<TransportHandlers> handlers;
+    };
+
+    bool find(ConnId conn, Conn &out) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = conns.find(conn);
+        if (it == conns.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    // `server` and `listenHandlers` are set for accepted connections
+    void opened(Hdl hdl, Server *server, const std::shared_ptr<TransportHandlers> &listenHandlers) {
+        ConnId id;
+        std::shared_ptr<TransportHandlers> h;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (server) {
+                id = nextConnId++;
+                conns[id] = Conn{hdl, server, listenHandlers};
+                ids[hdl] = id;
+            } else {
+                auto it = ids.find(hdl);
+                if (it == ids.end()) return;
+                id = it->second;
+            }
+            h = conns[id].handlers;
+        }
+        if (h && h->onOpen) h->onOpen(id);
+    }
+
+    void received(Hdl hdl, const std::string &payload) {
+        ConnId id;
+        std::shared_ptr<TransportHandlers> h;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = ids.find(hdl);
+            if (it == ids.end()) return;
+            id = it->second;
+            h = conns[id].handlers;
+        }
+        if (h && h->onMessage) h->onMessage(id, payload);
+    }
+
+    void closed(Hdl hdl) {
+        ConnId id;
+        std::shared_ptr<TransportHandlers> h;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = ids.find(hdl);
+            if (it == ids.end()) return;
+            id = it->second;
+            h = conns[id].handlers;
+            conns.erase(id);
+            ids.erase(it);
+        }
+        if (h && h->onClose) h->onClose(id);
+    }
+
+    boost::asio::io_service io;     // shared by all servers and the client, destroyed after them
+    std::vector<std::unique_ptr<Server>> servers;   // one per listen(), only grows
+    Client client;
+
+    std::mutex mtx;                 // guards conns and ids (sends come from any thread)
+    std::map<ConnId, Conn> conns;
+    std::map<Hdl, ConnId, std::owner_less<Hdl>> ids;
+};
+
+
+// ============================================================
+// In-process backend
+// ============================================================
+
+class MemoryTransport;
+
+// One lock for the whole in-process network: connecting, sending and closing touch
+// both ends atomically, so a peer never sees a message before its connection opened.
+static std::mutex hubMtx;
+static std::map<uint16_t, std::weak_ptr<MemoryTransport>> listeners;
+
+class MemoryTransport : public Transport, public std::enable_shared_from_this<MemoryTransport> {
+public:
+    ~MemoryTransport() override {
+        std::vector<std::shared_ptr<MemoryTransport>> peers;   // released after the lock
+        std::lock_guard<std::mutex> lock(hubMtx);
+        for (auto &entry: listenHandlers) {
+            auto it = listeners.find(entry.first);
+            if (it != listeners.end() && it->second.expired()) listeners.erase(it);
+        }
+        for (auto &entry: links) {
+            peers.push_back(entry.second.peer.lock());
+            if (peers.back()) peers.back()->dropLocked(entry.second.peerConn);
+        }
+    }
+
+    bool listen(const std::string &address, const TransportHandlers &handlers) override {
+        std::string host;
+        uint16_t p;
+        if (!parseAddress(address, host, p)) return false;
+
+        std::lock_guard<std::mutex> lock(hubMtx);
+        auto it = listeners.find(p);
+        if (it != listeners.end() && !it->second.expired()) {
+            std::cerr << "[Transport] Port " << p << " already in use." << std::endl;
+            return false;
+        }
+        listeners[p] = shared_from_this();
+        listenHandlers[p] = std::make_shared<TransportHandlers>(handlers);
+        return true;
+    }
+
+    bool connect(const std::string &address, const TransportHandlers &handlers) override {
+        std::string host;
+        uint16_t p;
+        if (!parseAddress(address, host, p)) return false;
+        auto h = std::make_shared<TransportHandlers>(handlers);
+
+        std::shared_ptr<MemoryTransport> peer;   // released after the lock
+        std::lock_guard<std::mutex> lock(hubMtx);
+        ConnId id = nextConnId++;
+        auto it = listeners.find(p);
+        if (it != listeners.end()) peer = it->second.lock();
+        if (!peer) {
+            // Connection refused
+            postLocked([h, id]() { if (h->onClose) h->onClose(id); });
+            return true;
+        }
+
+        ConnId peerId = nextConnId++;
+        auto ph = peer->listenHandlers[p];
+        links[id] = Link{peer, peerId, h};
+        peer->links[peerId] = Link{shared_from_this(), id, ph};
+        peer->postLocked([ph, peerId]() { if (ph->onOpen) ph->onOpen(peerId); });
+        postLocked([h, id]() { if (h->onOpen) h->onOpen(id); });
+        return true;
+    }
+
+    bool send(ConnId conn, const std::string &payload, bool) override {
+        std::shared_ptr<MemoryTransport> peer;   // released after the lock
+        std::lock_guard<std::mutex> lock(hubMtx);
+        auto it = links.find(conn);
+        if (it == links.end()) return false;
+        peer = it->second.peer.lock();
+        if (!peer) return false;
+
+        ConnId peerConn = it->second.peerConn;
+        auto pit = peer->links.find(peerConn);
+        if (pit == peer->links.end()) return false;
+        auto ph = pit->second.handlers;
+        peer->postLocked([ph, peerConn, payload]() { if (ph->onMessage) ph->onMessage(peerConn, payload); });
+        return true;
+    }
+
+    void close(ConnId conn) override {
+        std::shared_ptr<MemoryTransport> peer;   // released after the lock
+        std::lock_guard<std::mutex> lock(hubMtx);
+        auto it = links.find(conn);
+        if (it == links.end()) return;
+        peer = it->second.peer.lock();
+        ConnId peerConn = it->second.peerConn;
+        dropLocked(conn);
+        if (peer) peer->dropLocked(peerConn);
+    }
+
+    void setTimer(long ms, std::function<void()> fn) override {
+        std::lock_guard<std::mutex> lock(hubMtx);
+        timers.emplace(Clock::now() + std::chrono::milliseconds(ms), std::move(fn));
+        cv.notify_one();
+    }
+
+    void run() override {
+        std::unique_lock<std::mutex> lock(hubMtx);
+        while (!stopped) {
+            auto now = Clock::now();
+            while (!timers.empty() && timers.begin()->first <= now) {
+                tasks.push_back(std::move(timers.begin()->second));
+                timers.erase(timers.begin());
+            }
+            if (!tasks.empty()) {
+                auto task = std::move(tasks.front());
+                tasks.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+                continue;
+            }
+            // Out of work, like an io_service without handlers
+            if (listenHandlers.empty() && links.empty() && timers.empty()) break;
+
+            if (timers.empty()) {
+                cv.wait(lock);
+            } else {
+                cv.wait_until(lock, timers.begin()->first);
+            }
+        }
+    }
+
+    void stop() override {
+        std::lock_guard<std::mutex> lock(hubMtx);
+        stopped = true;
+        cv.notify_one();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Link {
+        std::weak_ptr<MemoryTransport> peer;
+        ConnId peerConn = 0;
+        std::shared_ptr<TransportHandlers> handlers;
+    };
+
+    // The methods below require hubMtx to be held
+
+    void postLocked(std::function<void()> task) {
+        tasks.push_back(std::move(task));
+        cv.notify_one();
+    }
+
+    // Removes this side of a connection and schedules its onClose
+    void dropLocked(ConnId conn) {
+        auto it = links.find(conn);
+        if (it == links.end()) return;
+        auto h = it->second.handlers;
+        links.erase(it);
+        postLocked([h, conn]() { if (h->onClose) h->onClose(conn); });
+    }
+
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;                    // completions ready to run
+    std::multimap<Clock::time_point, std::function<void()>> timers;
+    std::map<ConnId, Link> links;
+    std::map<uint16_t, std::shared_ptr<TransportHandlers>> listenHandlers;   // by listening port
+    bool stopped = false;
+};
+
+
+// ============================================================
+// Backend selection
+// ============================================================
+
+static std::string selectedBackend = "ws";
+
+void setTransportBackend(const std::string &name) {
+    if (name != "ws" && name != "memory") {
+        std::cerr << "[Transport] Unknown backend " << name << ", keeping " << selectedBackend << "." << std::endl;
+        return;
+    }
+    selectedBackend = name;
+}
+
+const std::string &transportBackend() {
+    return selectedBackend;
+}
+
+TransportPtr makeTransport() {
+    if (selectedBackend == "memory") return std::make_shared<MemoryTransport>();
+    return std::make_shared<WebSocketTransport>();
+}
+
+bool transportListening(const std::string &address) {
+    std::string host;
+    uint16_t port;
+    if (!parseAddress(address, host, port)) return false;
+
+    std::lock_guard<std::mutex> lock(hubMtx);
+    auto it = listeners.find(port);
+    return it != listeners.end() && !it->second.expired();
+}
+
+bool requestOnce(const std::string &address, const std::string &request, std::string &reply, bool binary) {
+    TransportPtr client = makeTransport();
+    Transport *endpoint = client.get();
+    bool received = false;
+
+    TransportHandlers handlers;
+    handlers.onOpen = [endpoint, &request, binary](ConnId conn) {
+        endpoint->send(conn, request, binary);
+    };
+    handlers.onMessage = [endpoint, &reply, &received](ConnId conn, const std::string &msg) {
+        reply = msg;
+        received = true;
+        endpoint->close(conn);
+    };
+
+    if (!client->connect(address, handlers)) return false;
+    client->run();
+    return received;
+}
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# Get the script directory to ensure config.env can be found
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+CONFIG_FILE="$SCRIPT_DIR/config.env"
+
+# ================= 1. Load Configuration =================
+if [ -f "$CONFIG_FILE" ]; then
+    source "$CONFIG_FILE"
+    echo "[Config] Loaded config file: $CONFIG_FILE"
+else
+    echo "Error: Config file not found: $CONFIG_FILE"
+    exit 1
+fi
+
+# ================= 2. Check Configuration Items =================
+if [[ -z "$SUB_HEADS" || "$SUB_HEADS" -le 0 ]]; then
+    echo "Error: 'SUB_HEADS' must be > 0 in the config file."
+    exit 1
+fi
+
+# ================= 3. Startup Logic =================
+# Sub-head k listens on BASE_PORT + k and owns a contiguous range of UAV indices;
+# start them after the UAVs and before the root UAVh (./UAVh_exec)
+BASE_PORT=8100
+
+echo "[*] Starting $SUB_HEADS sub-heads (Base Port: $BASE_PORT)..."
+
+for ((k=0; k<SUB_HEADS; k++)); do
+    echo " -> Starting sub-head $k on port $((BASE_PORT + k)) ..."
+    ./UAVh_exec $k &
+    sleep 0.2
+done
+
+echo "All $SUB_HEADS sub-heads started."
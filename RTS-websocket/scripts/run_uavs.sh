@@ -23,6 +23,15 @@ fi
 # ================= 3. Startup Logic =================
 BASE_PORT=8002
 
+if [[ "$UAV_HOST" == "1" ]]; then
+    # One process registers and serves every UAV (ports BASE_PORT .. BASE_PORT+NUM_UAV-1)
+    echo "[*] Starting UAVHost with $NUM_UAV UAVs (Base Port: $BASE_PORT)..."
+    ulimit -n "$(ulimit -Hn)"
+    ./UAVHost_exec $NUM_UAV &
+    echo "UAVHost started."
+    exit 0
+fi
+
 echo "[*] Starting $NUM_UAV UAV nodes (Base Port: $BASE_PORT)..."
 
 for ((i=0; i<NUM_UAV; i++)); do
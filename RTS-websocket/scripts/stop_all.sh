@@ -7,6 +7,8 @@ echo "[*] Terminating all UAV processes..."
 # -9: Force kill
 sudo killall -9 -q UAV_exec
 sudo killall -9 -q UAV_netSim
+sudo killall -9 -q UAVHost_exec
+sudo killall -9 -q UAVHost_netSim
 
 # Just in case, kill the original name too
 sudo killall -9 -q _netSim
@@ -16,7 +18,7 @@ sleep 1
 
 # Check if any processes remain
 # grep -v grep: Excludes the grep search itself from results
-COUNT=$(ps -ef | grep -E "UAV_exec|UAV_netSim" | grep -v grep | wc -l)
+COUNT=$(ps -ef | grep -E "UAV_exec|UAV_netSim|UAVHost_exec|UAVHost_netSim" | grep -v grep | wc -l)
 
 if [ $COUNT -eq 0 ]; then
     echo "All UAV processes cleaned up. Ports released."
@@ -0,0 +1,78 @@
+#include "../include/TA.h"
+#include "../include/UAV.h"
+#include "../include/UAVh.h"
+#include "../include/Verifier.h"
+#include "support/TestSupport.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * @file InProcess.cpp
+ * @brief Runs one complete protocol round (TA, NUM_UAV UAVs, UAVh and Verifier)
+ *        inside a single process over the in-memory transport backend.
+ *
+ * The role sources are compiled into this target with RTS_IN_PROCESS, which drops
+ * their standalone main().
+ */
+
+// Roles serve forever; set if one of them gave up
+static std::atomic<bool> roleExited{false};
+
+// Starts a role on its own thread
+static void startRole(const std::string& name, std::function<int()> role) {
+    std::thread([name, role]() {
+        int rc = role();
+        std::cerr << "[InProcess] " << name << " stopped (" << rc << ")." << std::endl;
+        roleExited = true;
+    }).detach();
+}
+
+// Waits until a role listens on `address`, unless one of them gave up
+static bool roleListening(const std::string& address) {
+    return waitListening(address, []() { return roleExited.load(); });
+}
+
+int main() {
+    setTransportBackend("memory");
+    Config cfg = loadConfig("scripts/config.env");
+    int numUAV = configInt(cfg, "NUM_UAV", 2);
+    auto start = std::chrono::steady_clock::now();
+
+    // 1. TA first: every other role registers with it
+    startRole("TA", []() {
+        TA::LoadConfig("scripts/config.env");
+        return TA::run();
+    });
+    if (!roleListening(kTAUri)) finish(1);
+
+    // 2. UAVs one at a time: TA hands out serial numbers in registration order,
+    //    and UAVh expects serial number i behind port 8002 + i
+    for (int i = 0; i < numUAV; ++i) {
+        int port = 8002 + i;
+        startRole("UAV " + std::to_string(i), [port]() { return UAVNode::run(port, "ws"); });
+        if (!roleListening("ws://localhost:" + std::to_string(port))) finish(1);
+    }
+
+    // 3. UAVh once TA knows every UAV public key. Its options are process-wide,
+    //    so sub-heads and their root cannot share this process
+    if (configInt(cfg, "SUB_HEADS", 0) > 0) {
+        std::cerr << "[InProcess] SUB_HEADS needs one process per head; set SUB_HEADS=0." << std::endl;
+        finish(1);
+    }
+    startRole("UAVh", []() { return UAVhNode::run("ws"); });
+    if (!roleListening("ws://localhost:8001")) finish(1);
+
+    auto ready = std::chrono::steady_clock::now();
+    std::cout << "[InProcess] Swarm of " << numUAV << " UAVs registered in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(ready - start).count()
+              << " ms." << std::endl;
+
+    // 4. Verifier authenticates the swarm and returns
+    int rc = verifier::run();
+    finish(rc == 0 ? 0 : 1);
+}
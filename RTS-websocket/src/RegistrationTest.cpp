@@ -0,0 +1,73 @@
+#include "../include/TA.h"
+#include "../include/UAV.h"
+#include "../include/UAVh.h"
+#include "../include/Verifier.h"
+#include "support/TestSupport.h"
+
+#include <string>
+
+/**
+ * @file RegistrationTest.cpp
+ * @brief Registers every role with an in-process TA through the role's own code
+ *        (connectToTA) and checks what each of them received.
+ *
+ *   ./RegistrationTest_exec        (ctest: registration)
+ *
+ * A request type TA does not answer is closed without a package, so a role whose
+ * request TA does not know fails here. Exits 1 if any check fails.
+ */
+
+int main() {
+    setTransportBackend("memory");
+
+    // 1. Own TA for a small swarm, fresh every run
+    if (!startInProcessTA(4, 3)) finishChecks("Registration");
+
+    try {
+        // 2. UAVs: keys only first (serial 0 receives the common data with them), then a full package
+        UAVNode::UAVContext first, second;
+        UAVNode::commonP2P = true;
+        check(UAVNode::connectToTA(first) == 0 && first.swarm, "UAV registers with \"" + std::string(kRegisterUAVKeysOnly) + "\"");
+        UAVNode::commonP2P = false;
+        check(UAVNode::connectToTA(second) == 0 && second.swarm, "UAV registers with \"" + std::string(kRegisterUAV) + "\"");
+        if (!first.swarm || !second.swarm) finishChecks("Registration");
+
+        for (const UAVNode::UAVContext *ctx : {&first, &second}) {
+            const UAVNode::SwarmParams &swarm = *ctx->swarm;
+            int serial = ctx->uav.serialNumber;
+            check(serial >= 0 && serial < static_cast<int>(swarm.registeredIDs.size())
+                  && ctx->uav.ID == swarm.registeredIDs[serial], "UAV " + std::to_string(serial) + " has its registered ID");
+            check(static_cast<int>(ctx->uav.c1.size()) >= swarm.threshold - 1 && ctx->uav.c1.size() == ctx->uav.c2.size(),
+                  "UAV " + std::to_string(serial) + " has t - 1 shares");
+        }
+        check(first.swarm->pp.g == TA::pp.g && first.swarm->pp.beta == TA::pp.beta,
+              "UAV package carries g and beta, against which a split key is checked");
+        check(first.uav.serialNumber != second.uav.serialNumber, "UAVs receive distinct serial numbers");
+        check(first.swarm->registeredIDs == second.swarm->registeredIDs && first.swarm->message == second.swarm->message
+              && first.swarm->threshold == second.swarm->threshold, "Both packages carry the same common data");
+
+        // 3. Requests a UAV makes outside its registration
+        std::string blob, reply, digest;
+        int issued = -1;
+        check(UAVNode::fetchCommonFromTA(blob) && sha256Hex(blob) == first.swarm->commonDigest,
+              "TA answers \"" + std::string(kRequestCommon) + "\" with the common data");
+        check(requestOnce(kTAUri, kRequestDigest, reply) && parseDigestReply(reply, digest, issued)
+              && digest == first.swarm->commonDigest && issued == 2,
+              "TA answers \"" + std::string(kRequestDigest) + "\" with the digest and 2 serials issued");
+
+        // 4. Cluster head and Verifier
+        check(UAVhNode::connectToTA() == 0 && UAVhNode::uavh.alpha != 0, "UAVh registers with \"" + std::string(kRegisterHead) + "\"");
+        check(UAVhNode::numUAV == TA::kNumUAV && UAVhNode::threshold == first.swarm->threshold
+              && UAVhNode::pp.beta == TA::pp.beta, "UAVh has the swarm size, threshold and beta");
+        check(verifier::connectToTA() == 0, "Verifier registers with \"" + std::string(kRegisterVerifier) + "\"");
+        check(verifier::PK_s.size() == 2 && verifier::registeredIDs == first.swarm->registeredIDs
+              && verifier::thresholdT == first.swarm->threshold, "Verifier has the PK fragments of both UAVs and the registry");
+
+        // 5. Anything else is refused, as the former ID-based request of the Verifier
+        check(!requestOnce(kTAUri, mpz_to_str(0x6666666666666666666666666666666666666666666666666666666666666666_mpz), reply),
+              "TA refuses an unknown request type");
+    } catch (const std::exception &e) {
+        check(false, std::string("Malformed package: ") + e.what());
+    }
+    finishChecks("Registration");
+}
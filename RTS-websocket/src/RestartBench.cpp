@@ -0,0 +1,175 @@
+#include "benchmark/benchmark.h"
+
+#include "../../common/include/NodeCache.h"
+
+#include <cstdio>
+
+/**
+ * @file RestartBench.cpp
+ * @brief Restart cost of a UAV and of the Verifier: parsing the TA package they download
+ *        at registration, against restoring the same state from their node cache (NodeCache.h).
+ *
+ *   ./RestartBench_exec
+ *
+ * Arguments: n = NUM_UAV (= THRESHOLD_M). The counters give the bytes each start reads and
+ * the time the TA package alone would take over a 128 kbit/s link; a cached start only
+ * downloads the "DIGEST" reply (about 70 bytes).
+ */
+
+static const double kLinkRate = 128e3;   // bit/s
+static const char *kCacheFile = "restart_bench.cache";
+
+// A TA state for n UAVs with the UAV package of serial 0 and the Verifier package
+struct Registration {
+    TransmissionPackage uavPkg;
+    VerifierPackage verifierPkg;
+};
+
+static Registration makeRegistration(int n) {
+    gmp_randstate_t rs;
+    initState(rs);
+    Registration reg;
+    mpz_class alpha;
+    Params pp = Setup(alpha, n, n, rs);
+    vector<mpz_class> d, b;
+    for (int i = 0; i < n - 1; ++i) {
+        d.push_back(rand_mpz(rs));
+        b.push_back(rand_mpz(rs));
+    }
+    pp.PK = getPK(b);
+    std::string seed = newRegistrySeed(rs);
+    vector<mpz_class> ids = expandRegistry(seed, n, pp.q);
+
+    reg.uavPkg.pp = pp;
+    reg.uavPkg.M = 123456789;
+    reg.uavPkg.t = n;
+    reg.uavPkg.registrySeed = seed;
+    reg.uavPkg.registeredIDs = ids;
+    reg.uavPkg.uav = getUAV(pp, d, b, ids[0], 0, rs);
+    reg.verifierPkg.pp = pp;
+    reg.verifierPkg.M = reg.uavPkg.M;
+    reg.verifierPkg.t = n;
+    reg.verifierPkg.registrySeed = seed;
+    reg.verifierPkg.registeredIDs = ids;
+    for (int i = 0; i < n; ++i) {
+        reg.verifierPkg.PK_s.push_back(getUAV(pp, d, b, ids[i], i, rs).PK[n - 2]);
+    }
+    gmp_randclear(rs);
+    return reg;
+}
+
+static void reportBytes(benchmark::State &state, size_t bytes) {
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.counters["ms_at_128kbit"] = bytes * 8 / kLinkRate * 1000;
+}
+
+static size_t fileSize(const char *path) {
+    FILE *f = std::fopen(path, "rb");
+    if (!f) return 0;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fclose(f);
+    return size < 0 ? 0 : static_cast<size_t>(size);
+}
+
+// UAV: full package from TA
+static void BM_UAVRegisterParse(benchmark::State &state) {
+    Registration reg = makeRegistration(static_cast<int>(state.range(0)));
+    std::string msg = Package_to_str(reg.uavPkg);
+    for (auto _: state) {
+        TransmissionPackage pkg = str_to_Package(msg);
+        benchmark::DoNotOptimize(pkg);
+    }
+    reportBytes(state, msg.size());
+}
+
+// UAV: same state from its cache (as UAVNode::restoreRegistration, without the DIGEST round trip)
+static void BM_UAVCacheRestore(benchmark::State &state) {
+    Registration reg = makeRegistration(static_cast<int>(state.range(0)));
+    const TransmissionPackage &pkg = reg.uavPkg;
+    CacheWriter writer;
+    writer.params(pkg.pp);
+    writer.scalar(pkg.M);
+    writer.u32(static_cast<uint32_t>(pkg.t));
+    writer.scalars(pkg.registeredIDs);
+    writer.bytes("");
+    writer.bytes("");
+    writer.scalar(pkg.uav.ID);
+    writer.scalars(pkg.uav.c1);
+    writer.scalars(pkg.uav.c2);
+    writer.u32(static_cast<uint32_t>(pkg.uav.serialNumber));
+    writer.save(kCacheFile, "UAV", std::string(64, '0'));
+
+    for (auto _: state) {
+        CacheReader cache;
+        if (!cache.load(kCacheFile, "UAV")) {
+            state.SkipWithError("cache not readable");
+            break;
+        }
+        TransmissionPackage restored;
+        restored.pp = cache.params();
+        restored.M = cache.scalar();
+        restored.t = static_cast<int>(cache.u32());
+        restored.registeredIDs = cache.scalars();
+        cache.bytes();
+        cache.bytes();
+        restored.uav.ID = cache.scalar();
+        restored.uav.c1 = cache.scalars();
+        restored.uav.c2 = cache.scalars();
+        restored.uav.serialNumber = static_cast<int>(cache.u32());
+        benchmark::DoNotOptimize(restored);
+    }
+    state.counters["bytes"] = static_cast<double>(fileSize(kCacheFile));
+    std::remove(kCacheFile);
+}
+
+// Verifier: package with the PK fragment of every UAV
+static void BM_VerifierRegisterParse(benchmark::State &state) {
+    Registration reg = makeRegistration(static_cast<int>(state.range(0)));
+    std::string msg = VerifierPackage_to_str(reg.verifierPkg);
+    for (auto _: state) {
+        VerifierPackage pkg = str_to_VerifierPackage(msg);
+        benchmark::DoNotOptimize(pkg);
+    }
+    reportBytes(state, msg.size());
+}
+
+// Verifier: same state from its cache (as verifier::restoreRegistration)
+static void BM_VerifierCacheRestore(benchmark::State &state) {
+    Registration reg = makeRegistration(static_cast<int>(state.range(0)));
+    const VerifierPackage &pkg = reg.verifierPkg;
+    CacheWriter writer;
+    writer.params(pkg.pp);
+    writer.points(pkg.PK_s);
+    writer.scalar(pkg.M);
+    writer.u32(static_cast<uint32_t>(pkg.t));
+    writer.scalars(pkg.registeredIDs);
+    writer.save(kCacheFile, "Verifier", std::string(64, '0'));
+
+    for (auto _: state) {
+        CacheReader cache;
+        if (!cache.load(kCacheFile, "Verifier")) {
+            state.SkipWithError("cache not readable");
+            break;
+        }
+        Params pp = cache.params();
+        std::vector<ECP2> pks = cache.points();
+        mpz_class M = cache.scalar();
+        int t = static_cast<int>(cache.u32());
+        vector<mpz_class> ids = cache.scalars();
+        benchmark::DoNotOptimize(pp);
+        benchmark::DoNotOptimize(pks);
+        benchmark::DoNotOptimize(M);
+        benchmark::DoNotOptimize(t);
+        benchmark::DoNotOptimize(ids);
+    }
+    state.counters["bytes"] = static_cast<double>(fileSize(kCacheFile));
+    std::remove(kCacheFile);
+}
+
+BENCHMARK(BM_UAVRegisterParse)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UAVCacheRestore)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VerifierRegisterParse)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VerifierCacheRestore)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
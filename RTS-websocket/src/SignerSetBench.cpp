@@ -0,0 +1,104 @@
+#include "benchmark/benchmark.h"
+
+#include "../../common/include/SignerSet.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+/**
+ * @file SignerSetBench.cpp
+ * @brief Size and decoding time of the signer set S (SignerSet.h) sent with every request.
+ *
+ *   ./SignerSetBench_exec
+ *
+ * Arguments: n (registered UAVs) and t (signers). The counters give the encoded size, the
+ * size of the hex bitmap the verifier sent before, and the representation chosen.
+ * BM_BitmapScan times the former decoding: a scan of all n bits of the bitmap.
+ */
+
+// t distinct random indices out of n, as selectSigners draws them
+static std::vector<int> randomSet(int n, int t) {
+    std::vector<int> all(n);
+    std::iota(all.begin(), all.end(), 0);
+    std::mt19937 rng(12345);
+    std::shuffle(all.begin(), all.end(), rng);
+    all.resize(t);
+    return all;
+}
+
+static void setCounters(benchmark::State &state, const std::string &encoded, int n) {
+    state.counters["bytes"] = static_cast<double>(encoded.size());
+    state.counters["bitmap_hex_bytes"] = static_cast<double>(2 * ((n + 7) / 8));
+    state.SetLabel(signerSetKindName(signerSetKind(encoded)));
+}
+
+static void BM_SignerSetEncode(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0)), t = static_cast<int>(state.range(1));
+    std::vector<int> S = randomSet(n, t);
+    std::string encoded;
+    for (auto _: state) {
+        encoded = encodeSignerSet(S, n);
+        benchmark::DoNotOptimize(encoded);
+    }
+    setCounters(state, encoded, n);
+}
+
+static void BM_SignerSetDecode(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0)), t = static_cast<int>(state.range(1));
+    std::vector<int> S = randomSet(n, t);
+    std::string encoded = encodeSignerSet(S, n);
+    std::vector<int> decoded;
+    std::sort(S.begin(), S.end());
+    if (!decodeSignerSet(encoded, n, decoded) || decoded != S) {
+        state.SkipWithError("round trip changed the signer set");
+        return;
+    }
+    for (auto _: state) {
+        decodeSignerSet(encoded, n, decoded);
+        benchmark::DoNotOptimize(decoded);
+    }
+    setCounters(state, encoded, n);
+}
+
+// Decoding of the plain bitmap, for the densities at which the encoder picks it
+static void BM_SignerSetDecodeBitmap(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0)), t = static_cast<int>(state.range(1));
+    std::string encoded = encodeSignerSet(randomSet(n, t), n, SIGNERS_BITMAP);
+    std::vector<int> decoded;
+    for (auto _: state) {
+        decodeSignerSet(encoded, n, decoded);
+        benchmark::DoNotOptimize(decoded);
+    }
+    setCounters(state, encoded, n);
+}
+
+// Former decoding: every bit of the bitmap is tested
+static void BM_BitmapScan(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0)), t = static_cast<int>(state.range(1));
+    std::string bitmap((n + 7) / 8, 0);
+    for (int index : randomSet(n, t)) bitmap[index / 8] |= (1 << (index % 8));
+    std::vector<int> decoded;
+    for (auto _: state) {
+        decoded.clear();
+        for (size_t i = 0; i < bitmap.size() * 8; ++i) {
+            if ((static_cast<unsigned char>(bitmap[i / 8]) >> (i % 8)) & 1) decoded.push_back(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(decoded);
+    }
+    state.counters["bitmap_hex_bytes"] = static_cast<double>(2 * bitmap.size());
+}
+
+// Sparse (t = 16), half and nearly full signer sets, from 64 to 100k registered UAVs
+#define SIGNER_SET_ARGS \
+    Args({64, 16})->Args({64, 32})->Args({64, 60}) \
+    ->Args({1000, 16})->Args({1000, 500})->Args({1000, 990}) \
+    ->Args({10000, 16})->Args({10000, 5000})->Args({10000, 9990}) \
+    ->Args({100000, 16})->Args({100000, 50000})->Args({100000, 99990})
+
+BENCHMARK(BM_SignerSetEncode)->SIGNER_SET_ARGS->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SignerSetDecode)->SIGNER_SET_ARGS->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SignerSetDecodeBitmap)->SIGNER_SET_ARGS->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BitmapScan)->SIGNER_SET_ARGS->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
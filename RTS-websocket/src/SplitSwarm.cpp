@@ -0,0 +1,45 @@
+#include "../include/TA.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/**
+ * @file SplitSwarm.cpp
+ * @brief Operator tool of TA: signs the order to split the range of sub-head k off the
+ *        swarm and sends it to the root UAVh.
+ *
+ *   ./SplitSwarm_exec k [root-uri]        (root-uri defaults to ws://localhost:8001)
+ *
+ * Runs on the TA host: alpha is read from the key store of TA (TA_STORE), so TA must
+ * keep one. The root checks the order against beta (SplitOrderVerify) and refuses it
+ * after SPLIT_ORDER_TTL seconds. Prints the reply of the root and exits 1 unless the
+ * split succeeded.
+ */
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: ./SplitSwarm k [root-uri]" << std::endl;
+        return -1;
+    }
+    int k = std::stoi(argv[1]);
+    std::string rootUri = argc > 2 ? argv[2] : "ws://localhost:8001";
+
+    TA::LoadConfig("scripts/config.env");
+    if (!TA::restoreState()) {
+        std::cerr << "[SplitSwarm] No key store of TA (TA_STORE) to sign the order with." << std::endl;
+        return -1;
+    }
+
+    auto issued = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    SplitOrder order = SplitOrderSign(TA::pp, TA::alpha, k, issued, TA::state);
+
+    std::string reply;
+    if (!requestOnce(rootUri, "SPLIT#" + SplitOrder_to_wire(order), reply, wireBinary())) {
+        std::cerr << "[SplitSwarm] No reply from " << rootUri << "." << std::endl;
+        return 1;
+    }
+    std::cout << reply << std::endl;
+    return reply.rfind("SPLIT#OK#", 0) == 0 ? 0 : 1;
+}
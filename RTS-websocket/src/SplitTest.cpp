@@ -0,0 +1,150 @@
+#include "../include/TA.h"
+#include "../include/UAV.h"
+#include "../include/UAVh.h"
+#include "../include/Verifier.h"
+#include "support/TestSupport.h"
+
+#include <string>
+#include <thread>
+
+/**
+ * @file SplitTest.cpp
+ * @brief Splits a sub-swarm off an in-process swarm and authenticates it through its own
+ *        head, under the beta the Verifier derives from the published split key.
+ *
+ *   ./SplitTest_exec        (ctest: split)
+ *
+ * The swarm has 8 UAVs, t = 3 and two sub-heads; UAVs 0..3 and sub-head 0 (port 8100) run
+ * in this process. UAVh options are process-wide, so the test plays the root head itself:
+ * it signs the split keys with the alpha of TA, as the root does with its own. UAV 4, of the
+ * range of sub-head 1, is registered without a server to apply keys directly. Exits 1 if any check fails.
+ */
+
+static std::string splitRequest(const SplitKey &key) {
+    return "SPLIT#" + SplitKey_to_wire(key);
+}
+
+int main() {
+    setTransportBackend("memory");
+
+    // 1. Own TA for a swarm of 8, fresh every run
+    if (!startInProcessTA(8, 3)) finishChecks("Split");
+
+    // 2. UAVs 0..3 make up the range of sub-head 0; they register in order of their ports
+    for (int i = 0; i < 4; ++i) {
+        int port = 8002 + i;
+        std::thread([port]() { UAVNode::run(port, "ws"); }).detach();
+        if (!waitListening("ws://localhost:" + std::to_string(port))) finishChecks("Split");
+    }
+    UAVNode::UAVContext member;
+    UAVNode::commonP2P = false;
+    if (UAVNode::connectToTA(member) != 0 || !member.swarm) {
+        check(false, "UAV 4 registers");
+        finishChecks("Split");
+    }
+
+    // 3. Sub-head 0 of 2, set up as UAVhNode::run does for an in-process sub-head
+    UAVhNode::subHeads = 2;
+    UAVhNode::subHeadIndex = 0;
+    UAVhNode::heartbeatMs = 0;
+    UAVhNode::splitIntervalMs = 0;
+    if (UAVhNode::connectToTA() != 0) {
+        check(false, "Sub-head 0 registers");
+        finishChecks("Split");
+    }
+    UAVhNode::uavRtt.assign(UAVhNode::numUAV, RttEstimator());
+    UAVhNode::uavHealth.assign(UAVhNode::numUAV, PeerHealth());
+    UAVhNode::subHeadRange(0, UAVhNode::ownFirst, UAVhNode::ownEnd);
+    std::thread(&UAVhNode::startUAVhServer).detach();
+    const std::string subHead = UAVhNode::subHeadUri(0);
+    if (!waitListening(subHead)) finishChecks("Split");
+
+    try {
+        gmp_randstate_t state;
+        initState(state);
+
+        // 4. Split orders: only TA's alpha signs one, for one sub-head and time
+        SplitOrder order = SplitOrderSign(TA::pp, TA::alpha, 0, 1000, state);
+        check(SplitOrderVerify(TA::pp, wire_to_SplitOrder(SplitOrder_to_wire(order))), "An order of TA verifies after the wire");
+        SplitOrder other = order;
+        other.k = 1;
+        check(!SplitOrderVerify(TA::pp, other), "An order does not pass for another sub-head");
+        other = order;
+        other.issued += 1;
+        check(!SplitOrderVerify(TA::pp, other), "An order does not pass for another time");
+        other = SplitOrderSign(TA::pp, TA::alpha + 1, 0, 1000, state);
+        check(!SplitOrderVerify(TA::pp, other), "An order signed with another key is rejected");
+
+        // 5. Keys bound to a sub-head and its range: sub-head 0 holds UAVs 0..3, UAV 4 belongs to sub-head 1
+        UAV_h root, forger;
+        root.alpha = TA::alpha;
+        forger.alpha = TA::alpha + 1;
+        int shares = TA::kThresholdMax - 1;
+        SplitKey key0 = SplitInit(TA::pp, root, 0, 0, 4, shares, state);
+        SplitKey key1 = SplitInit(TA::pp, root, 1, 4, 8, shares, state);
+        check(SplitVerify(TA::pp, wire_to_SplitKey(SplitKey_to_wire(key0))), "A key of the root verifies after the wire");
+        SplitKey rewritten = key1;
+        rewritten.shares = 1;
+        check(!SplitVerify(TA::pp, rewritten), "A key does not pass with another share count");
+        rewritten = key1;
+        rewritten.k = 0;
+        rewritten.first = 0;
+        rewritten.end = 4;
+        check(!SplitVerify(TA::pp, rewritten), "A key does not pass for another sub-head and range");
+
+        // 6. A key not signed with alpha, or not for this sub-head or UAV, changes nothing
+        std::vector<mpz_class> c2 = member.uav.c2;
+        std::string reply;
+        check(requestOnce(subHead, splitRequest(SplitInit(TA::pp, forger, 0, 0, 4, shares, state)), reply, wireBinary())
+              && reply == "SPLIT#FAIL", "Sub-head rejects a key not signed with alpha");
+        check(requestOnce(subHead, splitRequest(key1), reply, wireBinary()) && reply == "SPLIT#FAIL",
+              "Sub-head 0 rejects the key of sub-head 1");
+        check(UAVNode::applySplit(member, SplitKey_to_wire(SplitInit(TA::pp, forger, 1, 4, 8, shares, state))) == "SPLIT#FAIL"
+              && member.uav.c2 == c2, "UAV rejects a key not signed with alpha and keeps its shares");
+        check(UAVNode::applySplit(member, SplitKey_to_wire(key0)) == "SPLIT#FAIL" && member.uav.c2 == c2,
+              "UAV 4 rejects the key of UAVs 0..3 and keeps its shares");
+
+        // 7. The keys of the root: sub-head 0 and its 4 UAVs switch to alpha + stk, UAV 4 to that of sub-head 1
+        check(requestOnce(subHead, splitRequest(key0), reply, wireBinary()) && reply.rfind("SPLIT#OK#4#4#", 0) == 0,
+              "Sub-head accepts its key and all 4 UAVs apply it");
+        check(UAVhNode::pp.beta == SplitBeta(TA::pp, key0), "Sub-head moves to the beta of the sub-swarm");
+        check(UAVNode::applySplit(member, SplitKey_to_wire(key1)) == "SPLIT#OK" && member.uav.c2 != c2,
+              "UAV applies the key of its range");
+        c2 = member.uav.c2;
+        check(UAVNode::applySplit(member, SplitKey_to_wire(key1)) == "SPLIT#OK" && member.uav.c2 == c2,
+              "UAV acknowledges the same key again without applying it twice");
+        SplitKey stale = SplitInit(TA::pp, root, 1, 4, 8, shares, state);
+        check(UAVNode::applySplit(member, SplitKey_to_wire(stale)) == "SPLIT#FAIL" && member.uav.c2 == c2,
+              "UAV rejects a key signed with the alpha of the swarm it left");
+        check(requestOnce(subHead, splitRequest(key0), reply, wireBinary()) && reply == "SPLIT#FAIL",
+              "Sub-head rejects the replayed key");
+        gmp_randclear(state);
+
+        // 8. The Verifier adopts the published key and authenticates the sub-swarm
+        if (verifier::connectToTA() != 0) {
+            check(false, "Verifier registers");
+            finishChecks("Split");
+        }
+        verifier::selection = "random";
+        verifier::authSessions = 2;
+        verifier::headUri = subHead;
+        check(verifier::adoptSubSwarm(1) != 0, "Verifier finds no split of sub-head 1 there");
+        check(verifier::adoptSubSwarm(0) == 0 && verifier::params.beta == UAVhNode::pp.beta
+              && verifier::signerFirst == 0 && verifier::signerEnd == 4 && verifier::headUri == subHead,
+              "Verifier adopts the published key of sub-swarm 0");
+        verifier::verifiedSessions = 0;
+        auto completed = verifier::authStats.total;
+        check(verifier::connectToUAVh() == 0 && verifier::authStats.total == completed + 2
+              && verifier::verifiedSessions == 2, "Sub-swarm 0 authenticates under its own beta");
+
+        // Under the beta of TA, both sessions are answered but neither signature verifies
+        verifier::params.beta = TA::pp.beta;
+        verifier::verifiedSessions = 0;
+        completed = verifier::authStats.total;
+        check(verifier::connectToUAVh() == 0 && verifier::authStats.total == completed + 2
+              && verifier::verifiedSessions == 0, "Sub-swarm 0 does not authenticate under the beta of TA");
+    } catch (const std::exception &e) {
+        check(false, std::string("Malformed message: ") + e.what());
+    }
+    finishChecks("Split");
+}
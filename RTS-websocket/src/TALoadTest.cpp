@@ -0,0 +1,110 @@
+#include "../include/TA.h"
+#include "support/TestSupport.h"
+
+#include "../../common/include/Config.h"
+#include "../../common/include/Latency.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+/**
+ * @file TALoadTest.cpp
+ * @brief Registers N UAVs with TA over `concurrency` simultaneous connections and
+ *        reports the registration throughput and latency.
+ *
+ *   ./TALoadTest_exec [N] [concurrency] [memory]
+ *
+ * Without "memory" it loads a running TA (ws://localhost:9002), which must have at
+ * least N IDs left. With "memory" it starts its own TA for N UAVs in this process,
+ * over the in-memory transport, so that only TA's work is measured. Registrations
+ * ask for keys only when COMMON_P2P=1, as the UAVs would.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg = loadConfig("scripts/config.env");
+    int total = argc > 1 ? std::stoi(argv[1]) : configInt(cfg, "NUM_UAV", 2);
+    int concurrency = argc > 2 ? std::stoi(argv[2]) : 64;
+    bool inProcess = argc > 3 && std::string(argv[3]) == "memory";
+    std::string request = configInt(cfg, "COMMON_P2P", 0) != 0 ? kRegisterUAVKeysOnly : kRegisterUAV;
+    if (total <= 0 || concurrency <= 0) {
+        std::cout << "Usage: ./TALoadTest [N] [concurrency] [memory]" << std::endl;
+        return -1;
+    }
+
+    // 1. Own TA, sized for this test
+    if (inProcess) {
+        setTransportBackend("memory");
+        auto setupStart = Clock::now();
+        if (!startInProcessTA(total)) finish(1);
+        std::cout << "[LoadTest] TA setup for " << total << " UAVs: " << msSince(setupStart) << " ms" << std::endl;
+    }
+
+    // 2. Keep `concurrency` registrations in flight until N have been answered
+    TransportPtr client = makeTransport();
+    Transport* endpoint = client.get();
+    const std::string uri = kTAUri;
+
+    int started = 0, answered = 0, failed = 0;
+    uint64_t bytes = 0;
+    LatencyStats latency;
+    latency.window = static_cast<size_t>(total);
+    std::map<ConnId, Clock::time_point> sentAt;
+    std::set<ConnId> done;
+
+    std::function<void()> startOne;
+    TransportHandlers handlers;
+    handlers.onOpen = [&](ConnId conn) {
+        sentAt[conn] = Clock::now();
+        endpoint->send(conn, request);
+    };
+    handlers.onMessage = [&](ConnId conn, const std::string& msg) {
+        auto it = sentAt.find(conn);
+        if (it == sentAt.end()) return;
+        latencyAdd(latency, msSince(it->second));
+        sentAt.erase(it);
+        done.insert(conn);
+        bytes += msg.size();
+        ++answered;
+        endpoint->close(conn);
+    };
+    handlers.onClose = [&](ConnId conn) {
+        // Closed before an answer: refused, or TA ran out of IDs
+        sentAt.erase(conn);
+        if (done.erase(conn) == 0) ++failed;
+        startOne();
+    };
+    startOne = [&]() {
+        while (started < total) {
+            ++started;
+            if (client->connect(uri, handlers)) return;
+            ++failed;
+        }
+        if (answered + failed == total) endpoint->stop();
+    };
+
+    auto start = Clock::now();
+    for (int i = 0; i < concurrency; ++i) startOne();
+    client->run();
+    double elapsed = msSince(start);
+
+    // 3. Report
+    std::cout << "[LoadTest] " << answered << "/" << total << " registrations ("
+              << concurrency << " concurrent, \"" << request << "\") in " << elapsed << " ms" << std::endl;
+    std::cout << "[LoadTest] Throughput: " << (elapsed > 0 ? answered * 1000.0 / elapsed : 0) << " registrations/s, "
+              << (answered > 0 ? bytes / answered : 0) << " bytes each" << std::endl;
+    std::cout << "[LoadTest] Latency (ms): p50 " << latencyPercentile(latency, 50)
+              << ", p90 " << latencyPercentile(latency, 90)
+              << ", p99 " << latencyPercentile(latency, 99)
+              << ", max " << latencyPercentile(latency, 100) << std::endl;
+
+    finish(answered == total ? 0 : 1);
+}
@@ -0,0 +1,135 @@
+#include "benchmark/benchmark.h"
+
+#include "../../common/include/Serializer.h"
+#include "../../common/include/HexCodec.h"
+
+/**
+ * @file TextCodecBench.cpp
+ * @brief Encoding and decoding time of the text format (Serializer.h) for large packages,
+ *        and throughput of the hex kernels (HexCodec.h) it relies on.
+ *
+ *   ./TextCodecBench_exec
+ *
+ * Arguments of the package benchmarks: tm (THRESHOLD_M) and n (NUM_UAV). The parse leaves
+ * the G2 points compressed (ECP2Array.h); BM_StrToVerifierPackageDecompressed parses the
+ * Verifier package, which holds n of them, and decompresses all of them on the number of
+ * threads given as third argument (0: one per core). The hex benchmarks take the kernel
+ * (0 scalar, 1 SSSE3, 2 AVX2) and skip those the CPU lacks.
+ */
+
+static TransmissionPackage makePackage(int tm, int n) {
+    gmp_randstate_t rs;
+    initState(rs);
+    TransmissionPackage pkg;
+    mpz_class alpha;
+    pkg.pp = Setup(alpha, n, tm, rs);
+    vector<mpz_class> d, b;
+    for (int i = 0; i < tm - 1; ++i) {
+        d.push_back(rand_mpz(rs));
+        b.push_back(rand_mpz(rs));
+    }
+    pkg.pp.PK = getPK(b);
+    pkg.registrySeed = newRegistrySeed(rs);
+    pkg.registeredIDs = expandRegistry(pkg.registrySeed, n, pkg.pp.q);
+    pkg.M = 123456789;
+    pkg.t = tm;
+    pkg.uav = getUAV(pkg.pp, d, b, pkg.registeredIDs[0], 0, rs);
+    gmp_randclear(rs);
+    return pkg;
+}
+
+static void BM_PackageToStr(benchmark::State &state) {
+    TransmissionPackage pkg = makePackage(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::string msg;
+    for (auto _: state) {
+        msg = Package_to_str(pkg);
+        benchmark::DoNotOptimize(msg);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * msg.size()));
+    state.counters["bytes"] = static_cast<double>(msg.size());
+}
+
+static void BM_StrToPackage(benchmark::State &state) {
+    std::string msg = Package_to_str(makePackage(static_cast<int>(state.range(0)), static_cast<int>(state.range(1))));
+    // The text format must survive a round trip unchanged
+    if (Package_to_str(str_to_Package(msg)) != msg) {
+        state.SkipWithError("round trip changed the package");
+        return;
+    }
+    for (auto _: state) {
+        TransmissionPackage pkg = str_to_Package(msg);
+        benchmark::DoNotOptimize(pkg);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * msg.size()));
+    state.counters["bytes"] = static_cast<double>(msg.size());
+}
+
+static void BM_StrToVerifierPackageDecompressed(benchmark::State &state) {
+    TransmissionPackage uavPkg = makePackage(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    VerifierPackage verifierPkg;
+    verifierPkg.pp = uavPkg.pp;
+    verifierPkg.M = uavPkg.M;
+    verifierPkg.t = uavPkg.t;
+    verifierPkg.registrySeed = uavPkg.registrySeed;
+    // One fragment per UAV; those of UAV 0 stand in for the others, they decompress alike
+    for (int i = 0; i < uavPkg.pp.n; ++i) verifierPkg.PK_s.push_back(uavPkg.uav.PK[i % uavPkg.uav.PK.size()]);
+    std::string msg = VerifierPackage_to_str(verifierPkg);
+
+    unsigned threads = static_cast<unsigned>(state.range(2));
+    for (auto _: state) {
+        VerifierPackage pkg = str_to_VerifierPackage(msg);
+        pkg.PK_s.decompressAll(threads);
+        benchmark::DoNotOptimize(pkg);
+    }
+    state.counters["points"] = static_cast<double>(state.range(1));
+    state.counters["bytes"] = static_cast<double>(msg.size());
+}
+
+// Bytes of 3 * 127 compressed G2 points
+static const size_t kHexBytes = 3 * 127 * 97;
+
+static void BM_HexEncode(benchmark::State &state) {
+    HexKernel previous = hexKernel();
+    if (!setHexKernel(static_cast<HexKernel>(state.range(0)))) {
+        state.SkipWithError("kernel not supported by this CPU");
+        return;
+    }
+    state.SetLabel(hexKernelName(hexKernel()));
+    std::vector<uint8_t> src(kHexBytes);
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<uint8_t>(i * 131 + 7);
+    std::string dst(2 * kHexBytes, '\0');
+    for (auto _: state) {
+        hexEncode(src.data(), src.size(), &dst[0]);
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size()));
+    setHexKernel(previous);
+}
+
+static void BM_HexDecode(benchmark::State &state) {
+    HexKernel previous = hexKernel();
+    if (!setHexKernel(static_cast<HexKernel>(state.range(0)))) {
+        state.SkipWithError("kernel not supported by this CPU");
+        return;
+    }
+    state.SetLabel(hexKernelName(hexKernel()));
+    std::vector<uint8_t> src(kHexBytes), dst(kHexBytes);
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<uint8_t>(i * 131 + 7);
+    std::string hex(2 * kHexBytes, '\0');
+    hexEncode(src.data(), src.size(), &hex[0]);
+    for (auto _: state) {
+        bool ok = hexDecode(hex.data(), dst.size(), dst.data());
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * dst.size()));
+    setHexKernel(previous);
+}
+
+BENCHMARK(BM_PackageToStr)->Args({64, 256})->Args({128, 1000})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StrToPackage)->Args({64, 256})->Args({128, 1000})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StrToVerifierPackageDecompressed)->Args({128, 1000, 1})->Args({128, 1000, 0})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HexEncode)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_HexDecode)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
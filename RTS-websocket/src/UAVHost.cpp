@@ -0,0 +1,127 @@
+#include "../include/UAVHost.h"
+
+#include <fstream>
+#include <sys/resource.h>
+
+namespace UAVHostNode {
+
+    using namespace UAVNode;
+
+// ============================================================
+// Process-wide options
+// ============================================================
+
+    std::string usageCsv = "uav_usage.csv";
+    int usageMs = 1000;
+
+
+// ============================================================
+// Resources and accounting
+// ============================================================
+
+    void raiseFileLimit() {
+        rlimit lim{};
+        if (getrlimit(RLIMIT_NOFILE, &lim) != 0 || lim.rlim_cur >= lim.rlim_max) return;
+        lim.rlim_cur = lim.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &lim) != 0) {
+            std::cerr << "[UAVHost] Cannot raise the open file limit." << std::endl;
+        }
+    }
+
+    void writeUsage(const std::vector<std::shared_ptr<UAVContext>>& uavs, const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[UAVHost] Cannot write " << path << std::endl;
+            return;
+        }
+        out << "serial,requests,signatures,cpu_ms\n";
+        for (auto& ctx : uavs) {
+            out << ctx->uav.serialNumber << ","
+                << ctx->usage.requests.load() << ","
+                << ctx->usage.signatures.load() << ","
+                << ctx->usage.cpuUs.load() / 1000.0 << "\n";
+        }
+    }
+
+
+// ============================================================
+// Entry point for the host process
+// ============================================================
+
+    int run(int count, const char* transportOverride) {
+        loadOptions(transportOverride);
+        Config cfg = loadConfig("scripts/config.env");
+        usageCsv = configStr(cfg, "HOST_USAGE_CSV", usageCsv);
+        usageMs  = configInt(cfg, "HOST_USAGE_MS", usageMs);
+        raiseFileLimit();
+
+        // Step 1: register every virtual UAV over one TA connection
+        auto cache = std::make_shared<SignCache>();
+        std::vector<std::shared_ptr<UAVContext>> uavs;
+        for (int i = 0; i < count; ++i) {
+            uavs.push_back(std::make_shared<UAVContext>());
+            uavs.back()->signCache = cache;
+        }
+        int registered = connectToTA(uavs);
+        if (registered <= 0) return -1;
+        uavs.resize(registered);
+        std::cout << "[UAVHost] Registered " << registered << " UAVs." << std::endl;
+
+        // Step 2: one UDP socket per UAV port, all served by one loop (in-process runs have no sockets)
+        if (transportBackend() != "memory") {
+            std::vector<int> ports;
+            for (auto& ctx : uavs) ports.push_back(8002 + ctx->uav.serialNumber);
+            std::thread([uavs, ports]() { serveDatagrams(uavs, ports); }).detach();
+        }
+
+        // Step 3: one endpoint listens for UAVh on the port of every UAV
+        TransportPtr server = makeTransport();
+        Transport* endpoint = server.get();
+        int listening = 0;
+        for (auto& ctx : uavs) {
+            UAVContext* uav = ctx.get();
+            int port = 8002 + uav->uav.serialNumber;
+
+            TransportHandlers handlers;
+            handlers.onMessage = [uav, endpoint](ConnId conn, const std::string& msg) {
+                serverOnMessage(*uav, endpoint, conn, msg);
+            };
+            if (server->listen("ws://0.0.0.0:" + std::to_string(port), handlers)) {
+                ++listening;
+            } else {
+                std::cerr << "[UAVHost] UAV " << uav->uav.serialNumber << " cannot listen on port " << port << std::endl;
+            }
+        }
+        if (listening == 0) return -1;
+        std::cout << "[UAVHost] Serving " << listening << " UAVs on ports 8002+serial." << std::endl;
+
+        // Step 4: export the per-UAV usage periodically
+        if (!usageCsv.empty() && usageMs > 0) {
+            auto report = std::make_shared<std::function<void()>>();
+            *report = [uavs, endpoint, report]() {
+                writeUsage(uavs, usageCsv);
+                endpoint->setTimer(usageMs, *report);
+            };
+            endpoint->setTimer(usageMs, *report);
+        }
+
+        server->run();
+        return 0;
+    }
+
+} // namespace UAVHostNode
+
+
+// ============================================================
+// Standalone main
+// ============================================================
+int main(int argc, char* argv[]) {
+    // ./UAVHost_exec [count] [ws|udp]; count defaults to NUM_UAV
+    int count = configInt(loadConfig("scripts/config.env"), "NUM_UAV", 1);
+    if (argc > 1) count = std::stoi(argv[1]);
+    if (count <= 0) {
+        std::cout << "Usage: ./UAVHost [count] [ws|udp]" << std::endl;
+        return -1;
+    }
+    return UAVHostNode::run(count, argc > 2 ? argv[2] : nullptr);
+}
@@ -0,0 +1,324 @@
+#include "benchmark/benchmark.h"
+
+#include "../../common/include/WireFormat.h"
+#include "../../common/include/HexCodec.h"
+
+/**
+ * @file WireBench.cpp
+ * @brief Size and encode/decode time of the text messages (Serializer.h) against the
+ *        binary wire format (WireFormat.h).
+ *
+ *   ./WireBench_exec
+ *
+ * Arguments: n = NUM_UAV (= THRESHOLD_M), the package is the one TA sends a UAV; the
+ * Sigma holds n transformed shares. The counters give the bytes of the message and the
+ * time it takes over a 128 kbit/s link.
+ *
+ * BM_SigmaDecodePoints decodes a Sigma with compressed (second argument 1) or uncompressed
+ * points (VERIFIER_POINTS), and BM_PointEncodingCrossover gives the link rate below which
+ * the bytes compression saves outweigh the square roots it costs the Verifier.
+ *
+ * BM_RegistryExpand times the expansion of the n registered IDs from the registry seed
+ * (IDRegistry.h) a package carries, against the bytes the list of IDs itself would take.
+ *
+ * BM_RegistrationBytes gives the size of the registration package of each role (first
+ * argument: 0 UAV, 1 UAVh, 2 Verifier) in both formats, against the package every role
+ * got before: the whole of pp and a Keys message with PK fragments (the UAV's own, or
+ * those of all n UAVs for UAVh and the Verifier, alpha and n passed in c2).
+ */
+
+static const double kLinkRate = 128e3;   // bit/s
+
+static TransmissionPackage makePackage(int n, mpz_class *alphaOut = nullptr) {
+    gmp_randstate_t rs;
+    initState(rs);
+    TransmissionPackage pkg;
+    mpz_class alpha;
+    pkg.pp = Setup(alpha, n, n, rs);
+    if (alphaOut) *alphaOut = alpha;
+    vector<mpz_class> d, b;
+    for (int i = 0; i < n - 1; ++i) {
+        d.push_back(rand_mpz(rs));
+        b.push_back(rand_mpz(rs));
+    }
+    pkg.pp.PK = getPK(b);
+    pkg.registrySeed = newRegistrySeed(rs);
+    pkg.registeredIDs = expandRegistry(pkg.registrySeed, n, pkg.pp.q);
+    pkg.M = 123456789;
+    pkg.t = n;
+    pkg.uav = getUAV(pkg.pp, d, b, pkg.registeredIDs[0], 0, rs);
+    gmp_randclear(rs);
+    return pkg;
+}
+
+static Sigma makeSigma(int n) {
+    gmp_randstate_t rs;
+    initState(rs);
+    Sigma sg;
+    ECP G;
+    ECP_generator(&G);
+    for (int i = 0; i < n; ++i) {
+        ECP point;
+        ECP_copy(&point, &G);
+        ECP_mul(point, rand_mpz(rs));
+        sg.aux.push_back(rand_mpz(rs));
+        sg.sig.push_back(point);
+        sg.indices.push_back(static_cast<short>(i));
+    }
+    gmp_randclear(rs);
+    return sg;
+}
+
+static void reportBytes(benchmark::State &state, size_t bytes) {
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.counters["ms_at_128kbit"] = bytes * 8 / kLinkRate * 1000;
+}
+
+// ------------------------------
+// TA package of one UAV
+// ------------------------------
+
+static void BM_PackageEncodeText(benchmark::State &state) {
+    TransmissionPackage pkg = makePackage(static_cast<int>(state.range(0)));
+    std::string msg;
+    for (auto _: state) {
+        msg = Package_to_str(pkg);
+        benchmark::DoNotOptimize(msg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_PackageEncodeBinary(benchmark::State &state) {
+    TransmissionPackage pkg = makePackage(static_cast<int>(state.range(0)));
+    std::string msg;
+    for (auto _: state) {
+        msg = Package_to_bin(pkg);
+        benchmark::DoNotOptimize(msg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_PackageDecodeText(benchmark::State &state) {
+    std::string msg = Package_to_str(makePackage(static_cast<int>(state.range(0))));
+    for (auto _: state) {
+        TransmissionPackage pkg = str_to_Package(msg);
+        benchmark::DoNotOptimize(pkg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_PackageDecodeBinary(benchmark::State &state) {
+    std::string msg = Package_to_bin(makePackage(static_cast<int>(state.range(0))));
+    for (auto _: state) {
+        TransmissionPackage pkg = bin_to_Package(msg);
+        benchmark::DoNotOptimize(pkg);
+    }
+    reportBytes(state, msg.size());
+}
+
+// ------------------------------
+// Aggregated signature sent to the Verifier
+// ------------------------------
+
+static void BM_SigmaEncodeText(benchmark::State &state) {
+    Sigma sg = makeSigma(static_cast<int>(state.range(0)));
+    std::string msg;
+    for (auto _: state) {
+        msg = Sigma_to_str(sg);
+        benchmark::DoNotOptimize(msg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_SigmaEncodeBinary(benchmark::State &state) {
+    Sigma sg = makeSigma(static_cast<int>(state.range(0)));
+    std::string msg;
+    for (auto _: state) {
+        msg = Sigma_to_bin(sg);
+        benchmark::DoNotOptimize(msg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_SigmaDecodeText(benchmark::State &state) {
+    std::string msg = Sigma_to_str(makeSigma(static_cast<int>(state.range(0))));
+    for (auto _: state) {
+        Sigma sg = str_to_Sigma(msg);
+        benchmark::DoNotOptimize(sg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_SigmaDecodeBinary(benchmark::State &state) {
+    std::string msg = Sigma_to_bin(makeSigma(static_cast<int>(state.range(0))));
+    for (auto _: state) {
+        Sigma sg = bin_to_Sigma(msg);
+        benchmark::DoNotOptimize(sg);
+    }
+    reportBytes(state, msg.size());
+}
+
+// ------------------------------
+// Point encoding of the Sigma sent to the Verifier
+// ------------------------------
+
+static void BM_SigmaDecodePoints(benchmark::State &state) {
+    bool compressed = state.range(1) != 0;
+    std::string msg = Sigma_to_bin(makeSigma(static_cast<int>(state.range(0))), compressed);
+    state.SetLabel(compressed ? "compressed" : "uncompressed");
+    for (auto _: state) {
+        Sigma sg = bin_to_Sigma(msg);
+        benchmark::DoNotOptimize(sg);
+    }
+    reportBytes(state, msg.size());
+}
+
+static void BM_PointEncodingCrossover(benchmark::State &state) {
+    Sigma sg = makeSigma(static_cast<int>(state.range(0)));
+    std::string compressed = Sigma_to_bin(sg, true);
+    std::string uncompressed = Sigma_to_bin(sg, false);
+    double compressedSec = 0, uncompressedSec = 0;
+    for (auto _: state) {
+        auto t0 = std::chrono::steady_clock::now();
+        Sigma a = bin_to_Sigma(compressed);
+        auto t1 = std::chrono::steady_clock::now();
+        Sigma b = bin_to_Sigma(uncompressed);
+        auto t2 = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        compressedSec += std::chrono::duration<double>(t1 - t0).count();
+        uncompressedSec += std::chrono::duration<double>(t2 - t1).count();
+    }
+    // Uncompressed points pay off on links faster than extra bits / time saved
+    double saved = (compressedSec - uncompressedSec) / state.iterations();
+    double extraBits = 8.0 * (uncompressed.size() - compressed.size());
+    state.counters["extra_bytes"] = extraBits / 8;
+    state.counters["saved_us"] = saved * 1e6;
+    state.counters["crossover_kbit"] = saved > 0 ? extraBits / saved / 1e3 : 0;
+}
+
+// ------------------------------
+// Registered IDs
+// ------------------------------
+
+static void BM_RegistryExpand(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0));
+    gmp_randstate_t rs;
+    initState(rs);
+    mpz_class alpha;
+    Params pp = Setup(alpha, n, 2, rs);
+    std::string seed = newRegistrySeed(rs);
+    gmp_randclear(rs);
+    std::vector<mpz_class> ids;
+    for (auto _: state) {
+        ids = expandRegistry(seed, n, pp.q);
+        benchmark::DoNotOptimize(ids);
+    }
+    WireWriter list;
+    list.scalars(ids);
+    state.counters["seed_bytes"] = static_cast<double>(kRegistrySeedBytes);
+    state.counters["ids_text_bytes"] = static_cast<double>(mpzArr_to_str(ids).size());
+    state.counters["ids_binary_bytes"] = static_cast<double>(list.data().size());
+}
+
+// ------------------------------
+// Registration package of each role
+// ------------------------------
+
+// Package of the former layout, which every role received: pp, M, t, a Keys message with PK, seed
+static std::string formerPackage(const TransmissionPackage &pkg, const UAV &keys, bool binary) {
+    if (binary) {
+        WireWriter w;
+        w.header(WIRE_PACKAGE);
+        w.varint(static_cast<uint64_t>(pkg.pp.n));
+        w.varint(static_cast<uint64_t>(pkg.pp.tm));
+        w.scalar(pkg.pp.q);
+        w.g2(pkg.pp.P2);
+        w.scalar(pkg.pp.g);
+        w.scalar(pkg.pp.beta);
+        w.g2s(pkg.pp.PK);
+        w.scalar(pkg.M);
+        w.varint(static_cast<uint64_t>(pkg.t));
+        w.header(WIRE_KEYS);
+        w.scalar(keys.ID);
+        w.scalars(keys.c1);
+        w.scalars(keys.c2);
+        w.g2s(keys.PK);
+        w.varint(static_cast<uint64_t>(keys.serialNumber));
+        w.raw(pkg.registrySeed);
+        return w.data();
+    }
+    std::string out = std::to_string(pkg.pp.n) + "#" + std::to_string(pkg.pp.tm) + "#" + mpz_to_str(pkg.pp.q)
+                      + "#" + ECP2_to_str(pkg.pp.P2) + "#" + mpz_to_str(pkg.pp.g) + "#" + mpz_to_str(pkg.pp.beta)
+                      + "#" + ECP2Arr_to_str(pkg.pp.PK.points()) + "#" + mpz_to_str(pkg.M) + "#" + std::to_string(pkg.t)
+                      + "#" + mpz_to_str(keys.ID) + "#" + mpzArr_to_str(keys.c1) + "#" + mpzArr_to_str(keys.c2)
+                      + "#" + ECP2Arr_to_str(keys.PK.points()) + "#" + std::to_string(keys.serialNumber) + "#";
+    appendHex(out, reinterpret_cast<const uint8_t *>(pkg.registrySeed.data()), pkg.registrySeed.size());
+    return out;
+}
+
+static void BM_RegistrationBytes(benchmark::State &state) {
+    static const char *kRoles[] = {"UAV", "UAVh", "Verifier"};
+    int role = static_cast<int>(state.range(0)), n = static_cast<int>(state.range(1));
+    mpz_class alpha;
+    TransmissionPackage pkg = makePackage(n, &alpha);
+
+    // The PK fragments of all n UAVs; the UAV's own stand in for the others, the size is the same
+    ECP2Array fragments;
+    for (int i = 0; i < n; ++i) fragments.push_back(pkg.uav.PK[i % pkg.uav.PK.size()]);
+    UAV formerKeys = pkg.uav;
+    if (role != 0) {
+        formerKeys.ID = 0;
+        formerKeys.c1.clear();
+        formerKeys.c2 = {alpha, n};
+        formerKeys.PK = fragments;
+        formerKeys.serialNumber = 0;
+    }
+
+    HeadPackage head;
+    head.pp = pkg.pp;
+    head.M = pkg.M;
+    head.t = pkg.t;
+    head.uavh.ID = 0;
+    head.uavh.alpha = alpha;
+
+    VerifierPackage verifier;
+    verifier.pp = pkg.pp;
+    verifier.M = pkg.M;
+    verifier.t = pkg.t;
+    verifier.PK_s = fragments;
+    verifier.registrySeed = pkg.registrySeed;
+
+    std::string binary, text;
+    for (auto _: state) {
+        if (role == 0) binary = Package_to_bin(pkg);
+        else if (role == 1) binary = HeadPackage_to_bin(head);
+        else binary = VerifierPackage_to_bin(verifier);
+        benchmark::DoNotOptimize(binary);
+    }
+    text = role == 0 ? Package_to_str(pkg) : role == 1 ? HeadPackage_to_str(head) : VerifierPackage_to_str(verifier);
+
+    size_t former = formerPackage(pkg, formerKeys, true).size();
+    state.SetLabel(kRoles[role]);
+    reportBytes(state, binary.size());
+    state.counters["former_bytes"] = static_cast<double>(former);
+    state.counters["text_bytes"] = static_cast<double>(text.size());
+    state.counters["former_text_bytes"] = static_cast<double>(formerPackage(pkg, formerKeys, false).size());
+    state.counters["saved_pct"] = 100.0 * (1.0 - static_cast<double>(binary.size()) / former);
+}
+
+BENCHMARK(BM_PackageEncodeText)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PackageEncodeBinary)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PackageDecodeText)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PackageDecodeBinary)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SigmaEncodeText)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SigmaEncodeBinary)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SigmaDecodeText)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SigmaDecodeBinary)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SigmaDecodePoints)->Args({64, 1})->Args({64, 0})->Args({256, 1})->Args({256, 0})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PointEncodingCrossover)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RegistryExpand)->Arg(256)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RegistrationBytes)->Args({0, 64})->Args({0, 128})->Args({1, 64})->Args({1, 128})
+        ->Args({2, 64})->Args({2, 128})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,50 @@
+#ifndef RTS_TEST_SUPPORT_H
+#define RTS_TEST_SUPPORT_H
+
+#include <functional>
+#include <string>
+
+/**
+ * @file TestSupport.h
+ * @brief What the in-process tests share: counted checks, the way out of a process whose
+ *        roles still serve, and an own TA started in this process.
+ *
+ * Linked into RegistrationTest, SplitTest, TALoadTest and InProcess; it lives below src/
+ * so that it does not become an executable of its own.
+ */
+
+/** @brief Where the in-process TA listens. */
+extern const std::string kTAUri;
+
+/**
+ * @brief Prints the outcome of one check and counts it if it failed.
+ */
+void check(bool ok, const std::string &what);
+
+/**
+ * @brief Leaves with `rc`. The roles still serve on their own threads: exit without the
+ *        static destructors they depend on.
+ */
+[[noreturn]] void finish(int rc);
+
+/**
+ * @brief Prints the verdict of the checks under `tag` and finishes: 0 if all passed, 1 otherwise.
+ */
+[[noreturn]] void finishChecks(const std::string &tag);
+
+/**
+ * @brief Waits until something listens on `address`.
+ * @param gaveUp Polled while waiting; if it returns true, waiting stops early
+ * @return false, with a failed check, after 60 s or once `gaveUp` returns true
+ */
+bool waitListening(const std::string &address, const std::function<bool()> &gaveUp = nullptr);
+
+/**
+ * @brief Starts a fresh TA (no key store) in this process and waits until it listens.
+ * @param numUAV Size of the swarm
+ * @param thresholdMax Largest threshold TA issues; 0 keeps THRESHOLD_M of the config
+ * @return false if TA does not listen
+ */
+bool startInProcessTA(int numUAV, int thresholdMax = 0);
+
+#endif // RTS_TEST_SUPPORT_H
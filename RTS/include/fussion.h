@@ -168,18 +168,34 @@ int Verify(Sigma sigma, mpz_class sk_v, Params pp, mpz_class M, int t,vector<ECP
  */
 int BatchVerify(Sigma sigma, mpz_class sk_v, Params pp, mpz_class M, int t, vector<ECP2> PKs);
 
+/**
+ * @brief Updates the share reconstruction keys of a sub-swarm: c2[i] *= c1[i]^stk for the
+ *        first `shares` entries of every member
+ * @note The updates are independent and all use the exponent stk. They are handed out as one
+ * batch of (member, share) jobs to `threads` workers, so that a pool stays busy even when
+ * the sub-swarm has fewer members than there are threads.
+ * @param pp System public parameters
+ * @param stk Transformation key
+ * @param subSwarm The list of UAVs forming the new sub-swarm
+ * @param shares Entries of c2 updated per member (capped at the member's c1.size())
+ * @param threads Number of worker threads, 0 for one per core
+ */
+void updateShares(const Params &pp, const mpz_class &stk, vector<UAV> &subSwarm, int shares, unsigned threads);
+
 /**
  * @brief Executes the swarm splitting process and updates keys for the sub-swarm
  * @param pp System public parameters
  * @param oldHead The cluster head of the original swarm
  * @param subSwarm The list of UAVs forming the new sub-swarm
+ * @param threads Worker threads of the key update (updateShares), 0 for one per core
  */
-void SwarmSplitting(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm);
+void SwarmSplitting(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm, unsigned threads = 0);
 
 /**
  * @brief Executes the optimized swarm splitting process with O(log tm) complexity
  * @param pp System public parameters
  * @param oldHead The cluster head of the original swarm
  * @param subSwarm The list of UAVs forming the new sub-swarm
+ * @param threads Worker threads of the key update (updateShares), 0 for one per core
  */
-void SwarmSplittingOptimized(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm);
+void SwarmSplittingOptimized(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm, unsigned threads = 0);
@@ -135,40 +135,56 @@ void BM_hash(benchmark::State &state) {
     }
 }
 
-static void BM_SwarmSplitting(benchmark::State &state) {
-    initState(state_test);
-    initRNG(&rng_test);
-    mpz_class alpha;
-    Params pp = Setup(alpha, N, TM);
+// Swarm of the splitting benchmarks, generated once: KeyGen dominates their setup
+struct SplittingSwarm {
+    Params pp;
     UAV_h uavH;
-    vector<UAV> UAVs = KeyGen(pp, alpha, uavH);
-    vector<UAV> subSwarm;
-    int subSwarmSize = N;
-    for (int i = 0; i < subSwarmSize; ++i) {
-        subSwarm.push_back(UAVs[i]);
-    }
+    vector<UAV> UAVs;
+};
+
+static SplittingSwarm &splittingSwarm() {
+    static SplittingSwarm *swarm = [] {
+        initState(state_test);
+        initRNG(&rng_test);
+        auto *s = new SplittingSwarm;
+        mpz_class alpha;
+        s->pp = Setup(alpha, N, TM);
+        s->UAVs = KeyGen(s->pp, alpha, s->uavH);
+        return s;
+    }();
+    return *swarm;
+}
+
+// Arguments: sub-swarm size and worker threads of the key update
+static void BM_SwarmSplitting(benchmark::State &state) {
+    SplittingSwarm &swarm = splittingSwarm();
+    int subSwarmSize = static_cast<int>(state.range(0));
+    unsigned threads = static_cast<unsigned>(state.range(1));
+    vector<UAV> subSwarm(swarm.UAVs.begin(), swarm.UAVs.begin() + subSwarmSize);
     for (auto _: state) {
-        SwarmSplitting(pp, uavH, subSwarm);
+        SwarmSplitting(swarm.pp, swarm.uavH, subSwarm, threads);
     }
+    state.counters["modexps"] = subSwarmSize * std::min(TM - 1, subSwarmSize);
 }
 
 static void BM_SwarmSplittingOptimized(benchmark::State &state) {
-    initState(state_test);
-    initRNG(&rng_test);
-    mpz_class alpha;
-    Params pp = Setup(alpha, N, TM);
-    UAV_h uavH;
-    vector<UAV> UAVs = KeyGen(pp, alpha, uavH);
-    vector<UAV> subSwarm;
-    int subSwarmSize = N;
-    for (int i = 0; i < subSwarmSize; ++i) {
-        subSwarm.push_back(UAVs[i]);
-    }
+    SplittingSwarm &swarm = splittingSwarm();
+    int subSwarmSize = static_cast<int>(state.range(0));
+    unsigned threads = static_cast<unsigned>(state.range(1));
+    vector<UAV> subSwarm(swarm.UAVs.begin(), swarm.UAVs.begin() + subSwarmSize);
     for (auto _: state) {
-        SwarmSplittingOptimized(pp, uavH, subSwarm);
+        SwarmSplittingOptimized(swarm.pp, swarm.uavH, subSwarm, threads);
     }
+    state.counters["modexps"] = subSwarmSize * std::min(TM - 1, (int) ceil(log2((double) subSwarmSize + 1)));
 }
 
+// Sub-swarms of 16 to N UAVs, updated by 1 (the former sequential loop) to 8 threads
+#define SPLITTING_ARGS \
+    Args({16, 1})->Args({16, 2})->Args({16, 4})->Args({16, 8}) \
+    ->Args({32, 1})->Args({32, 2})->Args({32, 4})->Args({32, 8}) \
+    ->Args({64, 1})->Args({64, 2})->Args({64, 4})->Args({64, 8}) \
+    ->Args({N, 1})->Args({N, 2})->Args({N, 4})->Args({N, 8})
+
 // 注册基准测试
 BENCHMARK(BM_Setup);
 BENCHMARK(BM_KeyGen);
@@ -177,8 +193,9 @@ BENCHMARK(BM_Tran);
 BENCHMARK(BM_Verify);
 BENCHMARK(BM_BatchVerify);
 BENCHMARK(BM_hash);
-BENCHMARK(BM_SwarmSplitting);
-BENCHMARK(BM_SwarmSplittingOptimized);
+// Wall-clock time: the worker threads' CPU time is not charged to the benchmark thread
+BENCHMARK(BM_SwarmSplitting)->SPLITTING_ARGS->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SwarmSplittingOptimized)->SPLITTING_ARGS->UseRealTime()->Unit(benchmark::kMillisecond);
 
 
 // benchmark main
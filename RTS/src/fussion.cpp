@@ -1,5 +1,8 @@
 #include "../include/fussion.h"
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 csprng rng;
 gmp_randstate_t state_gmp;
@@ -326,7 +329,42 @@ int BatchVerify(Sigma sigma, mpz_class sk_v, Params pp, mpz_class M, int t, vect
     return pass && FP12_equals(&left, &right);
 }
 
-void SwarmSplitting(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm) {
+// Jobs a worker takes from the shared counter at a time (one job is one modexp)
+static const size_t kSharesPerTake = 8;
+
+void updateShares(const Params &pp, const mpz_class &stk, vector<UAV> &subSwarm, int shares, unsigned threads) {
+    size_t widest = 0;
+    for (const UAV &uav : subSwarm) widest = std::max(widest, uav.c1.size());
+    size_t perMember = std::min<size_t>(std::max(shares, 0), widest);
+    size_t jobs = subSwarm.size() * perMember;
+    if (jobs == 0) return;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, (jobs + kSharesPerTake - 1) / kSharesPerTake));
+
+    // Job k is share k % perMember of member k / perMember; each worker keeps one temporary
+    std::atomic<size_t> next{0};
+    auto work = [&pp, &stk, &subSwarm, &next, perMember, jobs] {
+        mpz_class factor;
+        for (size_t first; (first = next.fetch_add(kSharesPerTake, std::memory_order_relaxed)) < jobs;) {
+            size_t last = std::min(first + kSharesPerTake, jobs);
+            for (size_t k = first; k < last; ++k) {
+                UAV &uav = subSwarm[k / perMember];
+                size_t i = k % perMember;
+                if (i >= uav.c1.size()) continue;
+                // Calculate update factor: (c1_old)^stk ; Note: c1 is c_ij, c2 is s_ij
+                mpz_powm(factor.get_mpz_t(), uav.c1[i].get_mpz_t(), stk.get_mpz_t(), pp.q.get_mpz_t());
+                mpz_mul(uav.c2[i].get_mpz_t(), uav.c2[i].get_mpz_t(), factor.get_mpz_t());
+                mpz_mod(uav.c2[i].get_mpz_t(), uav.c2[i].get_mpz_t(), pp.q.get_mpz_t());
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto &thread : pool) thread.join();
+}
+
+void SwarmSplitting(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm, unsigned threads) {
 
     // Step 1: Distributing the Transformation Key (stk)
     mpz_class phi_q = pp.q - 1;
@@ -374,17 +412,10 @@ void SwarmSplitting(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm) {
 
     // Step 2: Updating the Share Reconstruction Keys
     int sub_swarm_size = subSwarm.size();
-    for (int j = 0; j < sub_swarm_size; ++j) {
-        int num_shares = std::min((int)subSwarm[j].c1.size(), sub_swarm_size);
-        for (int i = 0; i < num_shares; ++i) {
-            // Calculate update factor: (c1_old)^stk ; Note: c1 is c_ij, c2 is s_ij
-            mpz_class update_factor = pow_mpz(subSwarm[j].c1[i], stk, pp.q);
-            subSwarm[j].c2[i] = (subSwarm[j].c2[i] * update_factor) % pp.q;
-        }
-    }
+    updateShares(pp, stk, subSwarm, sub_swarm_size, threads);
 }
 
-void SwarmSplittingOptimized(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm) {
+void SwarmSplittingOptimized(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm, unsigned threads) {
 
     // Step 1: Distributing the Transformation Key (stk)
     mpz_class phi_q = pp.q - 1;
@@ -431,14 +462,7 @@ void SwarmSplittingOptimized(Params &pp, UAV_h &oldHead, vector<UAV> &subSwarm)
     // Step 2: Updating the Share Reconstruction Keys (Optimized)
     int sub_swarm_size = subSwarm.size();
     int needed_log_shares = (int)ceil(log2((double)sub_swarm_size + 1));
-
-    for (int j = 0; j < sub_swarm_size; ++j) {
-        int actual_shares = std::min((int)subSwarm[j].c1.size(), needed_log_shares);
-        for (int i = 0; i < actual_shares; ++i) {
-            mpz_class update_factor = pow_mpz(subSwarm[j].c1[i], stk, pp.q);
-            subSwarm[j].c2[i] = (subSwarm[j].c2[i] * update_factor) % pp.q;
-        }
-    }
+    updateShares(pp, stk, subSwarm, needed_log_shares, threads);
 }
 
 int fussion() {
@@ -0,0 +1,69 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <map>
+#include <string>
+
+/**
+ * @file Config.h
+ * @brief Reader for the shell-style `config.env` files shared with the scripts.
+ *
+ * Lines have the form KEY=VALUE; everything after '#' is a comment and
+ * surrounding quotes are stripped, so the same file can be sourced by bash.
+ */
+
+typedef std::map<std::string, std::string> Config;
+
+/**
+ * @brief Loads all KEY=VALUE pairs of a config file.
+ * @param path Path of the config file.
+ * @return The parsed entries, empty if the file could not be opened.
+ */
+Config loadConfig(const std::string &path = "scripts/config.env");
+
+/**
+ * @brief Looks up a string entry.
+ * @param cfg Parsed configuration.
+ * @param key Entry name.
+ * @param def Value returned if the entry is missing.
+ * @return The configured value or `def`.
+ */
+std::string configStr(const Config &cfg, const std::string &key, const std::string &def);
+
+/**
+ * @brief Looks up an integer entry.
+ * @param cfg Parsed configuration.
+ * @param key Entry name.
+ * @param def Value returned if the entry is missing or not a number.
+ * @return The configured value or `def`.
+ */
+int configInt(const Config &cfg, const std::string &key, int def);
+
+/**
+ * @brief Looks up a rate written in `tc` notation ("128kbit", "1mbit", "16kbps", "9600bit").
+ * @param cfg Parsed configuration.
+ * @param key Entry name.
+ * @param def Value returned if the entry is missing or malformed.
+ * @return The rate in bit/s or `def`.
+ */
+double configRate(const Config &cfg, const std::string &key, double def);
+
+/**
+ * @brief Looks up a duration written in `tc` notation ("50ms", "1s", "250us"); a bare number is in ms.
+ * @param cfg Parsed configuration.
+ * @param key Entry name.
+ * @param def Value returned if the entry is missing or malformed.
+ * @return The duration in milliseconds or `def`.
+ */
+double configMillis(const Config &cfg, const std::string &key, double def);
+
+/**
+ * @brief Looks up a percentage ("10%", "0.5%"); the '%' sign is optional.
+ * @param cfg Parsed configuration.
+ * @param key Entry name.
+ * @param def Value returned if the entry is missing or malformed.
+ * @return The fraction in [0, 1] or `def`.
+ */
+double configPercent(const Config &cfg, const std::string &key, double def);
+
+#endif // CONFIG_H
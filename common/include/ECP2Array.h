@@ -0,0 +1,89 @@
+#ifndef ECP2_ARRAY_H
+#define ECP2_ARRAY_H
+
+#include "Tools.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file ECP2Array.h
+ * @brief Array of G2 points that keeps the points it was parsed from compressed.
+ *
+ * Decompressing a G2 point (ECP2_fromOctet) takes a square root in Fp2, and the Verifier
+ * package carries one PK fragment per UAV while a session uses those of the signers of
+ * its S only. An array built by the parsers (fromOctets) decompresses a point on its
+ * first access; decompressAll does all the remaining ones on several threads, for the
+ * roles that need every point.
+ *
+ * Copies share their points, including the work of decompressing them, so copying
+ * Params is cheap; a modified copy gets its own points. Concurrent reads are safe, a
+ * modification is not safe against readers of the same object.
+ */
+class ECP2Array {
+public:
+    /** Bytes of the MIRACL compressed octet of a G2 point: 0x02/0x03, then x. */
+    static const size_t kOctetBytes = 2 * 48 + 1;
+
+    ECP2Array() = default;
+    ECP2Array(const std::vector<ECP2> &points);
+    ECP2Array(std::vector<ECP2> &&points);
+    ECP2Array(size_t count, const ECP2 &value);
+
+    /**
+     * @brief Array of `count` points given as compressed octets of kOctetBytes each
+     *        (0x00 followed by zeros for the point at infinity). Nothing is decompressed yet.
+     */
+    static ECP2Array fromOctets(std::string octets, size_t count);
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Point i, decompressed on first access; an invalid point reads as infinity.
+     */
+    const ECP2 &operator[](size_t i) const;
+
+    /**
+     * @brief Compressed octet of point i as it was parsed, so that it can be sent again
+     *        without compressing it.
+     * @return false if the point was computed in memory (or modified) and has no octet
+     */
+    bool storedOctet(size_t i, const uint8_t *&bytes, size_t &length) const;
+
+    bool decompressed(size_t i) const;
+
+    /**
+     * @brief Decompresses every point not decompressed yet.
+     * @param threads Number of threads, 0 for one per core
+     */
+    void decompressAll(unsigned threads = 0) const;
+
+    /**
+     * @brief All points (decompressAll first).
+     */
+    const std::vector<ECP2> &points() const;
+    operator const std::vector<ECP2> &() const { return points(); }
+
+    void push_back(const ECP2 &point);
+    void set(size_t i, const ECP2 &point);
+    void clear();
+
+private:
+    struct Store {
+        std::vector<ECP2> points;
+        std::string octets;                               // size() * kOctetBytes, or empty
+        std::unique_ptr<std::atomic<uint8_t>[]> state;    // per point, null once built decompressed
+    };
+
+    static void ensure(Store &s, size_t i);
+    Store &own();
+
+    std::shared_ptr<Store> store;
+};
+
+#endif // ECP2_ARRAY_H
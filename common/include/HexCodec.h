@@ -0,0 +1,48 @@
+#ifndef HEX_CODEC_H
+#define HEX_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file HexCodec.h
+ * @brief Hex encoding and decoding of the byte strings in the text messages (points, FP12).
+ *
+ * On x86 the SSSE3 or AVX2 kernel is picked at start-up from the CPU; elsewhere, or if the
+ * CPU has neither, the scalar kernel is used. All kernels give the same result.
+ */
+
+enum class HexKernel { Scalar, SSSE3, AVX2 };
+
+/**
+ * @brief Kernel in use.
+ */
+HexKernel hexKernel();
+
+/**
+ * @brief Forces a kernel (benchmarks).
+ * @return false if the CPU does not support it; the kernel is left unchanged.
+ */
+bool setHexKernel(HexKernel kernel);
+
+const char *hexKernelName(HexKernel kernel);
+
+/**
+ * @brief Writes 2 * length hex digits of `src` to `dst`.
+ * @param upper Upper-case digits (ECP_to_str, ECP2_to_str) or lower-case.
+ */
+void hexEncode(const uint8_t *src, size_t length, char *dst, bool upper = true);
+
+/**
+ * @brief Appends 2 * length upper-case hex digits of `src` to `out`.
+ */
+void appendHex(std::string &out, const uint8_t *src, size_t length);
+
+/**
+ * @brief Decodes 2 * length hex digits (either case) of `src` into `length` bytes of `dst`.
+ * @return false if `src` holds anything but hex digits.
+ */
+bool hexDecode(const char *src, size_t length, uint8_t *dst);
+
+#endif // HEX_CODEC_H
@@ -0,0 +1,43 @@
+#ifndef ID_REGISTRY_H
+#define ID_REGISTRY_H
+
+#include "Tools.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @file IDRegistry.h
+ * @brief Registered IDs derived from a public seed instead of being sent one by one.
+ *
+ * The ID of serial i is SHA-256("RTS-ID" || seed || i as 4 bytes big-endian) mod q.
+ * TA draws the seed at setup and every package carries the seed (32 bytes) instead of
+ * n IDs, so its size no longer grows with n. Receivers expand the n IDs locally, which
+ * costs one hash per ID.
+ */
+
+const size_t kRegistrySeedBytes = 32;
+
+/**
+ * @brief Draws a fresh registry seed of kRegistrySeedBytes bytes.
+ */
+std::string newRegistrySeed(gmp_randstate_t state);
+
+/**
+ * @brief ID of serial `index` in the registry of `seed`.
+ */
+mpz_class registryID(const std::string &seed, int index, const mpz_class &q);
+
+/**
+ * @brief IDs of serials 0 .. n-1 in the registry of `seed`.
+ */
+std::vector<mpz_class> expandRegistry(const std::string &seed, int n, const mpz_class &q);
+
+/**
+ * @brief Whether the IDs can serve as interpolation points: non-zero and pairwise distinct.
+ *        TA draws another seed otherwise (which happens with negligible probability).
+ */
+bool registryUsable(const std::vector<mpz_class> &ids);
+
+#endif // ID_REGISTRY_H
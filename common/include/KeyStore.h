@@ -0,0 +1,129 @@
+#ifndef KEY_STORE_H
+#define KEY_STORE_H
+
+#include "Serializer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file KeyStore.h
+ * @brief Versioned, memory-mapped store of the TA state.
+ *
+ * Layout (all offsets from the start of the file):
+ *  - header:  magic, version, n, tm, t, section offsets, digest of the common data
+ *             and a SHA-256 checksum of the header and the global section;
+ *  - global:  alpha, q, g, beta, M, P2, pp.PK, poly_d, poly_b;
+ *  - IDs:     n registered IDs;
+ *  - common:  the common data exactly as TA sends it (Common_to_str or Common_to_bin);
+ *  - records: one per UAV: its keys (c1, c2, PK), filled in as TA derives them,
+ *             each with its own checksum. A UAV gets c1 and c2, the Verifier PK[t - 2].
+ * Scalars take kScalarBytes (big-endian) and points kPointBytes (compressed ECP2),
+ * so every field has a fixed offset. Opening a store only checks the header and the
+ * global section: IDs and records are read from the map when a UAV needs them, so a
+ * restart takes the same time for 100 or 100k UAVs.
+ * The number of serials issued is kept in the header and survives a restart.
+ */
+class KeyStore {
+public:
+    static const uint32_t kVersion = 4;     // 4: the common data carries g and beta again (split keys)
+    static const size_t kScalarBytes = 48;          // BIG of BLS12381
+    static const size_t kPointBytes = 2 * 48 + 1;   // compressed ECP2
+
+    KeyStore() = default;
+    ~KeyStore();
+
+    KeyStore(const KeyStore &) = delete;
+    KeyStore &operator=(const KeyStore &) = delete;
+
+    /**
+     * @brief Creates a store holding the given TA state; no UAV keys yet, no serial issued.
+     * @param path File to create (replaced if it exists), or empty for anonymous memory.
+     * @return false if the file could not be created or mapped.
+     */
+    bool create(const std::string &path, const Params &pp, const mpz_class &alpha,
+                const std::vector<mpz_class> &d, const std::vector<mpz_class> &b,
+                const mpz_class &M, int t, const std::vector<mpz_class> &ids,
+                const std::string &commonBlob, const std::string &commonDigest);
+
+    /**
+     * @brief Maps an existing store and checks its magic, version and checksum.
+     * @return false if there is no valid store at `path`.
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Reads the global section back into the TA state.
+     */
+    void loadState(Params &pp, mpz_class &alpha, std::vector<mpz_class> &d, std::vector<mpz_class> &b,
+                   mpz_class &M, int &t) const;
+
+    int size() const;           // number of registered IDs (n)
+    int maxThreshold() const;   // tm
+
+    /**
+     * @brief Registered ID of serial `i`, read from the map.
+     */
+    mpz_class id(int i) const;
+
+    std::string commonBlob() const;
+    std::string commonDigest() const;
+
+    /**
+     * @brief Issues the next serial number; persistent across restarts.
+     * @return The serial, or -1 once all n have been issued.
+     */
+    int claimSerial();
+
+    /**
+     * @brief Number of serials issued so far (at most n).
+     */
+    int issued() const;
+
+    /**
+     * @brief Whether the keys of serial `i` are stored and pass their checksum.
+     */
+    bool hasKeys(int i) const;
+
+    /**
+     * @brief Stores the keys of serial `i`; the record becomes visible to hasKeys once complete.
+     * @return false if the keys do not fit the record (wrong threshold or point encoding).
+     */
+    bool putKeys(int i, const UAV &uav);
+
+    /**
+     * @brief The keys of serial `i` as Keys_to_str would serialize them: ID, c1, c2 and serial,
+     *        built from the stored bytes.
+     */
+    std::string keysString(int i) const;
+
+    /**
+     * @brief The keys of serial `i` as Keys_to_bin would serialize them (WireFormat.h):
+     *        ID, c1, c2 and serial, built from the stored bytes.
+     */
+    std::string keysBinary(int i) const;
+
+    /**
+     * @brief PK[index] of serial `i` as its stored compressed octet (kPointBytes), the
+     *        format ECP2Array::fromOctets takes.
+     */
+    const uint8_t *pkOctet(int i, int index) const;
+
+private:
+    struct Header;
+
+    const Header *header() const;
+    Header *header();
+    uint8_t *record(int i) const;
+    size_t recordBytes() const;
+    uint64_t recordChecksum(int i) const;
+    std::string stateChecksum() const;
+    bool map(int fd, size_t bytes);
+
+    uint8_t *base = nullptr;
+    size_t length = 0;
+};
+
+#endif // KEY_STORE_H
@@ -0,0 +1,95 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @file Latency.h
+ * @brief Round-trip time estimation and latency percentiles.
+ *
+ * RttEstimator follows the smoothed RTT / RTT variance rules of TCP (RFC 6298)
+ * and yields a retransmission deadline per peer. LatencyStats keeps a sliding
+ * window of samples from which percentiles are computed and exported as CSV.
+ * PeerHealth tracks liveness and an RTT EWMA per peer for signer selection.
+ * Neither type is synchronized: callers sharing one instance must lock.
+ */
+
+struct RttEstimator {
+    double srtt = 0;            // smoothed RTT (ms)
+    double rttvar = 0;          // RTT variation (ms)
+    bool hasSample = false;
+    double initialRto = 1000;   // deadline used before the first sample (ms)
+    double minRto = 50;
+    double maxRto = 60000;
+};
+
+/**
+ * @brief Feeds one RTT measurement into the estimator.
+ * @param est    Estimator of one peer.
+ * @param sample Measured round trip in milliseconds.
+ */
+void rttUpdate(RttEstimator &est, double sample);
+
+/**
+ * @brief Current deadline for a request to this peer: srtt + 4 * rttvar,
+ *        clamped to [minRto, maxRto]; `initialRto` while no sample exists.
+ * @return Timeout in milliseconds.
+ */
+double rttTimeout(const RttEstimator &est);
+
+struct LatencyStats {
+    std::vector<double> samples;    // ring buffer of the latest `window` samples (ms)
+    size_t next = 0;
+    size_t window = 4096;
+    size_t total = 0;               // samples ever recorded
+};
+
+/**
+ * @brief Records one latency sample, evicting the oldest once the window is full.
+ */
+void latencyAdd(LatencyStats &stats, double ms);
+
+/**
+ * @brief Nearest-rank percentile of the recorded window.
+ * @param stats Recorded samples.
+ * @param p     Percentile in [0, 100].
+ * @return The percentile in milliseconds, or -1 if no sample was recorded.
+ */
+double latencyPercentile(const LatencyStats &stats, double p);
+
+/**
+ * @brief Appends "timestamp,role,metric,count,p50,p90,p99,max" to a CSV file,
+ *        writing the header first if the file is new.
+ * @param stats  Recorded samples.
+ * @param role   Reporting process (e.g. "UAVh").
+ * @param metric Measured quantity (e.g. "uav_rtt").
+ * @param path   Output file.
+ * @return true on success, false if the file could not be written.
+ */
+bool latencyExport(const LatencyStats &stats, const std::string &role, const std::string &metric,
+                   const std::string &path);
+
+struct PeerHealth {
+    bool alive = true;      // unknown peers are given the benefit of the doubt
+    double ewma = -1;       // exponentially weighted RTT (ms), -1 while never measured
+    int missed = 0;         // consecutive unanswered probes
+};
+
+/**
+ * @brief Records an answered probe or request: the peer is alive again.
+ * @param h      Health record of one peer.
+ * @param sample Measured round trip in milliseconds.
+ * @param alpha  EWMA weight of the new sample.
+ */
+void healthReply(PeerHealth &h, double sample, double alpha = 0.2);
+
+/**
+ * @brief Records an unanswered probe or request.
+ * @param h         Health record of one peer.
+ * @param maxMissed Consecutive misses after which the peer is considered dead.
+ */
+void healthMiss(PeerHealth &h, int maxMissed);
+
+#endif // LATENCY_H
@@ -0,0 +1,93 @@
+#ifndef NODE_CACHE_H
+#define NODE_CACHE_H
+
+#include "Serializer.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file NodeCache.h
+ * @brief Node-local cache of the registration state a UAV, UAVh or Verifier received from TA.
+ *
+ * A node saves what it parsed from its TA package in a binary file. On its next start it
+ * asks TA for the digest of the common data ("DIGEST") and, if the digest still matches,
+ * restores its state from the file instead of downloading the package again.
+ * Points are stored in their in-memory form, so restoring them needs no decompression;
+ * the file is therefore only valid on the machine (and build) that wrote it, which the
+ * header checks. The whole file is covered by a SHA-256 checksum.
+ *
+ * Layout: magic, version, sizeof(ECP2), role, digest, payload, checksum.
+ * The payload is written and read back field by field, in the same order, by the role.
+ */
+
+/**
+ * @brief Path of the cache file `name` in NODE_CACHE_DIR (scripts/config.env), or "" if
+ *        NODE_CACHE_DIR is empty (caching disabled).
+ */
+std::string nodeCachePath(const std::string &name);
+
+class CacheWriter {
+public:
+    void u32(uint32_t value);
+    void scalar(const mpz_class &value);
+    void scalars(const std::vector<mpz_class> &values);
+    void point(const ECP2 &value);
+    void points(const std::vector<ECP2> &values);
+    void bytes(const std::string &value);
+    void params(const Params &pp);
+
+    /**
+     * @brief Writes the cache atomically (temporary file, then rename).
+     * @param digest digest of the TA common data the state belongs to
+     * @return false if the file could not be written
+     */
+    bool save(const std::string &path, const std::string &role, const std::string &digest) const;
+
+private:
+    std::string payload;
+};
+
+class CacheReader {
+public:
+    /**
+     * @brief Reads a cache file written by `role` and checks its header and checksum.
+     * @return false if there is no valid cache for `role` at `path`
+     */
+    bool load(const std::string &path, const std::string &role);
+
+    /**
+     * @brief Digest of the TA common data the cached state belongs to.
+     */
+    const std::string &digest() const { return cachedDigest; }
+
+    uint32_t u32();
+    mpz_class scalar();
+    std::vector<mpz_class> scalars();
+    ECP2 point();
+    std::vector<ECP2> points();
+    std::string bytes();
+    Params params();
+
+    /**
+     * @brief false once a read went past the end of the payload (the values read are then meaningless).
+     */
+    bool ok() const { return !overrun; }
+
+private:
+    const char *take(size_t count);
+
+    std::string payload;
+    std::string cachedDigest;
+    size_t pos = 0;
+    bool overrun = false;
+};
+
+/**
+ * @brief Parses TA's reply to "DIGEST": "DIGEST#<digest of the common data>#<serials issued>".
+ * @return false if the reply is malformed
+ */
+bool parseDigestReply(const std::string &reply, std::string &digest, int &issued);
+
+#endif // NODE_CACHE_H
@@ -1,37 +1,144 @@
+#ifndef SERIALIZER_H
+#define SERIALIZER_H
+
 #include "Tools.h"
+#include "Latency.h"
+#include "IDRegistry.h"
 #include "../../RTS-websocket/include/RTS.h"
 
 using namespace RTS_web;
 
+/**
+ * @brief Registration requests, as TA answers them (TA.cpp, onRegister); it refuses any other.
+ *        kRegisterUAVKeysOnly asks for the keys alone, the common data travelling between UAVs.
+ */
+const char kRegisterUAV[] = "UAV";
+const char kRegisterUAVKeysOnly[] = "UAV#P2P";
+const char kRegisterHead[] = "UAVh";
+const char kRegisterVerifier[] = "Verifier";
+const char kRequestCommon[] = "COMMON";
+const char kRequestDigest[] = "DIGEST";
+
 /**
  * @struct TransmissionPackage
- * @brief A data structure used to encapsulate transmission information between entities.
+ * @brief Registration package TA sends to a UAV.
  *
- * This structure contains public parameters, signature, keys, and other
- * essential elements used during a multi-party communication protocol.
+ * It carries what SignInit, SignShare and a swarm split use and nothing else: of pp only
+ * n, tm, q, and g and beta, against which a UAV checks a split key (SplitVerify); P2 is
+ * left at infinity and PK empty. The keys come without their PK fragments, which only the
+ * Verifier checks.
  */
 typedef struct {
     Params pp;
-    mpz_class M;        ///< Secret key of participant i
-    int t;            ///< Public key of the original signer
-    UAV uav;
-    vector<mpz_class> registeredIDs;
+    mpz_class M;        ///< Message to sign
+    int t;              ///< Threshold
+    UAV uav;            ///< ID, c1, c2 and serial number; PK empty
+    std::string registrySeed;           ///< Seed the registered IDs derive from (IDRegistry.h); sent instead of them
+    vector<mpz_class> registeredIDs;    ///< Expanded from registrySeed by the parsers
 //    long long timestamp;   ///< Current timestamp (ms)
 } TransmissionPackage;
 
+/**
+ * @struct HeadPackage
+ * @brief Registration package TA sends to the cluster head UAVh: what AggInit and
+ *        Transform use. Of pp only n (the size of the swarm), tm, q, g and beta.
+ */
+typedef struct {
+    Params pp;
+    mpz_class M;        ///< Message to sign
+    int t;              ///< Threshold
+    UAV_h uavh;         ///< ID and transformation key alpha
+} HeadPackage;
+
+/**
+ * @struct VerifierPackage
+ * @brief Registration package TA sends to the Verifier.
+ *
+ * Of pp.PK only PK[t - 2], the one VerifyFinal pairs with; the parsers leave the other
+ * tm - 2 entries at infinity. PK_s holds the fragment PK[t - 2] of every UAV registered.
+ */
+typedef struct {
+    Params pp;
+    mpz_class M;        ///< Message to sign
+    int t;              ///< Threshold
+    ECP2Array PK_s;     ///< PK fragments, by serial number
+    std::string registrySeed;           ///< As in TransmissionPackage
+    vector<mpz_class> registeredIDs;    ///< Expanded from registrySeed by the parsers
+} VerifierPackage;
+
 /**
  * @brief Serializes a TransmissionPackage into a string for transmission.
  * @param pkg The TransmissionPackage to serialize.
  * @return A string representation of the package.
  */
-std::string Package_to_str(TransmissionPackage pkg);
+std::string Package_to_str(const TransmissionPackage &pkg);
 
 /**
  * @brief Deserializes a string into a TransmissionPackage.
  * @param str The string representation of a TransmissionPackage.
  * @return The deserialized TransmissionPackage.
  */
-TransmissionPackage str_to_Package(std::string str);
+TransmissionPackage str_to_Package(const std::string &str);
+
+/**
+ * @brief Serializes the part of a TransmissionPackage that TA sends to every UAV alike
+ *        (n, tm, q, g, beta, M, t and the registry seed), so that UAVs can pass it on to each other.
+ * @param pkg The package to take the common data from.
+ * @return A string representation of the common data.
+ */
+std::string Common_to_str(const TransmissionPackage &pkg);
+
+/**
+ * @brief Deserializes the common data into n, tm, q, g, beta, M, t and the registry of a package
+ *        (registrySeed, and registeredIDs expanded from it).
+ * @param str The string produced by Common_to_str.
+ * @param pkg The package receiving the common data; its keys are left untouched.
+ */
+void str_to_Common(const std::string &str, TransmissionPackage &pkg);
+
+/**
+ * @brief Serializes the keys TA issues to one UAV (ID, c1, c2, serial number).
+ * @param uav The UAV keys to serialize.
+ * @return A string representation of the keys.
+ */
+std::string Keys_to_str(const UAV &uav);
+
+/**
+ * @brief Deserializes the keys of one UAV.
+ * @param str The string produced by Keys_to_str.
+ * @return The reconstructed keys.
+ */
+UAV str_to_Keys(const std::string &str);
+
+/**
+ * @brief Serializes the registration package of UAVh.
+ * @param pkg The package to serialize.
+ * @return A string representation of the package.
+ */
+std::string HeadPackage_to_str(const HeadPackage &pkg);
+
+/**
+ * @brief Deserializes the registration package of UAVh.
+ * @param str The string produced by HeadPackage_to_str.
+ * @return The reconstructed package.
+ */
+HeadPackage str_to_HeadPackage(const std::string &str);
+
+/**
+ * @brief Serializes the registration package of the Verifier; takes PK[t - 2] from pkg.pp.PK.
+ *        PK fragments parsed from a message or built with ECP2Array::fromOctets are
+ *        written from their octets, without decompressing them.
+ * @param pkg The package to serialize.
+ * @return A string representation of the package.
+ */
+std::string VerifierPackage_to_str(const VerifierPackage &pkg);
+
+/**
+ * @brief Deserializes the registration package of the Verifier.
+ * @param str The string produced by VerifierPackage_to_str.
+ * @return The reconstructed package.
+ */
+VerifierPackage str_to_VerifierPackage(const std::string &str);
 
 /**
  * @brief Displays the contents of a TransmissionPackage for debugging or logging.
@@ -64,9 +171,11 @@ void showParSig(parSig& sig);
 /**
  * @brief Serializes a Sigma (final aggregated signature) into a string for transmission.
  * @param sg The Sigma object to serialize.
+ * @param compressed Whether to compress the points; uncompressed ones double in size but
+ *        save the receiver a square root each.
  * @return A string representation of the Sigma.
  */
-std::string Sigma_to_str(const Sigma &sg);
+std::string Sigma_to_str(const Sigma &sg, bool compressed = true);
 
 /**
  * @brief Deserializes a string into a Sigma (final aggregated signature) object.
@@ -81,6 +190,63 @@ Sigma str_to_Sigma(const std::string &str);
  */
 void showSigma(Sigma& sigma);
 
+/**
+ * @brief Serializes one transformed Sigma element for streamed delivery.
+ * @param share The (aux_i, sig_i, index) triple to serialize.
+ * @param compressed Whether to compress the point (see Sigma_to_str).
+ * @return A string representation of the share.
+ */
+std::string SigmaShare_to_str(const SigmaShare &share, bool compressed = true);
+
+/**
+ * @brief Deserializes one streamed Sigma element.
+ * @param str The serialized share string.
+ * @return The reconstructed SigmaShare.
+ */
+SigmaShare str_to_SigmaShare(const std::string &str);
+
+/**
+ * @brief Serializes the health table of the swarm ("alive:ewma" per UAV index, comma separated).
+ * @param health One entry per UAV index.
+ * @return A string representation of the table.
+ */
+std::string Health_to_str(const std::vector<PeerHealth> &health);
+
+/**
+ * @brief Deserializes a swarm health table.
+ * @param str The serialized table.
+ * @return One entry per UAV index.
+ */
+std::vector<PeerHealth> str_to_Health(const std::string &str);
+
+/**
+ * @brief Serializes the transformation key of a swarm split ("g^t#stk#shares#k#first#end").
+ * @param key The key to serialize.
+ * @return A string representation of the key.
+ */
+std::string SplitKey_to_str(const SplitKey &key);
+
+/**
+ * @brief Deserializes the transformation key of a swarm split.
+ * @param str The string produced by SplitKey_to_str.
+ * @return The reconstructed key.
+ */
+SplitKey str_to_SplitKey(const std::string &str);
+
+/**
+ * @brief Serializes the split order of TA ("k#issued#g^t#s").
+ * @param order The order to serialize.
+ * @return A string representation of the order.
+ */
+std::string SplitOrder_to_str(const SplitOrder &order);
+
+/**
+ * @brief Deserializes the split order of TA.
+ * @param str The string produced by SplitOrder_to_str.
+ * @return The reconstructed order.
+ */
+SplitOrder str_to_SplitOrder(const std::string &str);
+
 
 /**
  * Converts an mpz_class to a std::string
@@ -99,9 +265,10 @@ mpz_class str_to_mpz(const std::string& str);
 /**
  * Converts an ECP point to a std::string
  * @param ecp The ECP point to be converted
+ * @param compressed Whether to use compressed format
  * @return The converted string
  */
-std::string ECP_to_str(ECP ecp);
+std::string ECP_to_str(ECP ecp, bool compressed = true);
 
 /**
  * Converts a string to an ECP point
@@ -182,6 +349,4 @@ std::string ECP2Arr_to_str(const std::vector<ECP2>& ecp2s, bool compressed = tru
  */
 std::vector<ECP2> str_to_ECP2Arr(const std::string& str);
 
-static std::string binToHex(const std::string& input);
-
-static std::string hexToBin(const std::string& input);
\ No newline at end of file
+#endif // SERIALIZER_H
@@ -0,0 +1,66 @@
+#ifndef SIGNER_SET_H
+#define SIGNER_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file SignerSet.h
+ * @brief Self-describing encoding of a signer set S over the n registered UAVs.
+ *
+ * Encoding: a kind byte, n as a LEB128 varint, then one of
+ *  - SIGNERS_BITMAP:     ceil(n / 8) bytes, bit i (LSB first) set if index i is in S;
+ *  - SIGNERS_LIST:       |S| as a varint, then the indices of S in increasing order, each
+ *                        as the gap to the previous one (the first as the index itself);
+ *  - SIGNERS_COMPLEMENT: as SIGNERS_LIST, over the indices that are not in S.
+ * encodeSignerSet picks the shortest: the list for t << n, the complement for t close to
+ * n, the bitmap in between. The indices are decoded directly, so no receiver scans n bits.
+ */
+
+enum SignerSetKind : uint8_t {
+    SIGNERS_BITMAP = 0,
+    SIGNERS_LIST = 1,
+    SIGNERS_COMPLEMENT = 2
+};
+
+/**
+ * @brief Encodes the signer set S.
+ * @param S Indices in [0, n), in any order, without duplicates
+ * @param n Number of registered UAVs
+ */
+std::string encodeSignerSet(const std::vector<int> &S, int n);
+
+/**
+ * @brief Encodes S in the given representation (benchmarks).
+ */
+std::string encodeSignerSet(const std::vector<int> &S, int n, SignerSetKind kind);
+
+/**
+ * @brief Decodes a signer set.
+ * @param n Number of registered UAVs the receiver knows; a set over another universe is
+ *          rejected before anything is allocated for it
+ * @param S receives the indices in increasing order
+ * @return false if `encoded` is malformed or not over n UAVs
+ */
+bool decodeSignerSet(const std::string &encoded, int n, std::vector<int> &S);
+
+/**
+ * @brief Representation chosen for an encoded set.
+ */
+SignerSetKind signerSetKind(const std::string &encoded);
+
+const char *signerSetKindName(SignerSetKind kind);
+
+/**
+ * @brief Position of `index` in the sorted set S, or -1 if it is not in S.
+ */
+int signerRank(const std::vector<int> &S, int index);
+
+/**
+ * @brief Number of indices of the sorted set S in [first, end).
+ */
+int countSigners(const std::vector<int> &S, int first, int end);
+
+#endif // SIGNER_SET_H
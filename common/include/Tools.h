@@ -1,3 +1,6 @@
+#ifndef TOOLS_H
+#define TOOLS_H
+
 #include <iostream>
 #include <pair_BLS12381.h>
 #include <bls_BLS12381.h>
@@ -212,6 +215,13 @@ bool concatOctet(octet *oc1, const octet *oc2);
  */
 void hashZp256(BIG res, octet *ct, BIG q);
 
+/**
+ * Computes the SHA-256 digest of a byte string
+ * @param data Bytes to hash
+ * @return Digest as 64 lowercase hex characters
+ */
+string sha256Hex(const string &data);
+
 /**
  * Hashes a BIG integer to a 256-bit integer
  * @param res Hash result
@@ -275,3 +285,5 @@ void showFP12(FP12 fp12);
  * @param text Text content of the separator line
  */
 void printLine(const string& text);
+
+#endif // TOOLS_H
@@ -0,0 +1,216 @@
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include "Serializer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file WireFormat.h
+ * @brief Versioned binary encoding of the Serializer messages.
+ *
+ * Every binary message starts with kWireVersion and a WireType byte. No text message
+ * starts with a byte >= 0x80, so a receiver tells both formats apart by the first byte:
+ * the wire_to_* functions accept either, the *_to_wire functions produce the format
+ * selected with setWireFormat (WIRE_FORMAT in scripts/config.env).
+ *
+ * Encoding:
+ *  - scalars: 32 bytes, big-endian (every value sent is below q);
+ *  - points:  compressed, 48 bytes (G1) or 96 bytes (G2): the x coordinate with the
+ *             sign of y (0x20) and the point at infinity (0x40) in its unused top bits;
+ *             or, where the receiver asked for it, uncompressed: x flagged with 0x80, then y;
+ *  - counts and lengths: LEB128 varints;
+ *  - Sigma indices: bit-packed, each with the width of the largest one.
+ * A UAV package is [header PACKAGE][n, tm, q, g, beta, M, t][Keys message][registry seed]
+ * and the common data [header COMMON][n, tm, q, g, beta, M, t][registry seed], so that TA
+ * can splice the keys of each UAV into the serialized common data, as it does with the text
+ * format. The seed takes kRegistrySeedBytes; the registered IDs are expanded from it
+ * (IDRegistry.h).
+ * UAVh and the Verifier get packages of their own (HEAD_PACKAGE, VERIFIER_PACKAGE) with
+ * the fields listed in Serializer.h. A swarm split only sends the transformation key
+ * (SPLIT_KEY); every member derives its updated shares from it (SplitUpdate in RTS.h).
+ */
+
+const uint8_t kWireVersion = 0xB1;
+const size_t kWireScalarBytes = 32;
+const size_t kWireG1Bytes = 48;
+const size_t kWireG2Bytes = 96;
+
+enum WireType : uint8_t {
+    WIRE_PACKAGE = 1,
+    WIRE_COMMON = 2,
+    WIRE_KEYS = 3,
+    WIRE_PARSIG = 4,
+    WIRE_SIGMA = 5,
+    WIRE_SIGMA_SHARE = 6,
+    WIRE_HEALTH = 7,
+    WIRE_HEAD_PACKAGE = 8,
+    WIRE_VERIFIER_PACKAGE = 9,
+    WIRE_SPLIT_KEY = 10,
+    WIRE_SPLIT_ORDER = 11
+};
+
+/**
+ * @brief Selects the format of the *_to_wire functions: "binary" or "text".
+ */
+void setWireFormat(const std::string &name);
+
+/**
+ * @brief Whether the *_to_wire functions produce the binary format.
+ *        Messages in this format are sent as binary WebSocket frames.
+ */
+bool wireBinary();
+
+/**
+ * @brief Whether `msg` holds a binary message at `pos`.
+ */
+bool isWireBinary(const std::string &msg, size_t pos = 0);
+
+/**
+ * @brief Appends binary fields to a message.
+ */
+class WireWriter {
+public:
+    /** @param compressed Whether points are written compressed (see the file comment). */
+    explicit WireWriter(bool compressed = true) : compressedPoints(compressed) {}
+
+    void header(WireType type);
+    void u8(uint8_t value);
+    void varint(uint64_t value);
+    void scalar(const mpz_class &value);
+    /** Scalar given as big-endian bytes (leading zeros allowed). */
+    void scalarBytes(const uint8_t *bytes, size_t length);
+    void scalars(const std::vector<mpz_class> &values);
+    void g1(const ECP &point);
+    void g2(const ECP2 &point);
+    /** G2 point given as its MIRACL compressed octet (0x02/0x03, x; or 0x00 for infinity). */
+    void g2Octet(const uint8_t *octet, size_t length);
+    void g1s(const std::vector<ECP> &points);
+    /** Points parsed from a message are copied from their octets, without decompressing them. */
+    void g2s(const ECP2Array &points);
+    void indices(const std::vector<short> &values);
+    void raw(const std::string &bytes);
+    /** Keys message: ID, c1, c2 and serial number. */
+    void keys(const UAV &uav);
+
+    const std::string &data() const { return out; }
+
+private:
+    std::string out;
+    bool compressedPoints;
+};
+
+/**
+ * @brief Reads binary fields; throws std::runtime_error on malformed input.
+ */
+class WireReader {
+public:
+    explicit WireReader(const std::string &msg, size_t pos = 0);
+
+    /** Checks the version and the type of the message. */
+    void header(WireType type);
+    uint8_t u8();
+    uint64_t varint();
+    mpz_class scalar();
+    std::vector<mpz_class> scalars();
+    ECP g1();
+    ECP2 g2();
+    std::vector<ECP> g1s();
+    /** Points are decompressed (and checked) when first used, see ECP2Array. */
+    ECP2Array g2s();
+    std::vector<short> indices();
+    std::string bytes(size_t count);
+    UAV keys();
+
+    size_t pos() const { return at; }
+    bool atEnd() const { return at == msg.size(); }
+
+private:
+    const uint8_t *take(size_t count);
+    uint64_t count(size_t minBytes);
+    int pointOctet(const uint8_t *x, size_t xBytes, char *octet);
+
+    const std::string &msg;
+    size_t at;
+};
+
+// ------------------------------
+// Binary messages
+// ------------------------------
+
+std::string Package_to_bin(const TransmissionPackage &pkg);
+TransmissionPackage bin_to_Package(const std::string &msg);
+
+std::string Common_to_bin(const TransmissionPackage &pkg);
+void bin_to_Common(const std::string &msg, TransmissionPackage &pkg);
+
+std::string HeadPackage_to_bin(const HeadPackage &pkg);
+HeadPackage bin_to_HeadPackage(const std::string &msg);
+
+std::string VerifierPackage_to_bin(const VerifierPackage &pkg);
+VerifierPackage bin_to_VerifierPackage(const std::string &msg);
+
+std::string Keys_to_bin(const UAV &uav);
+/** Reads a Keys message starting at `pos`; returns the position after it. */
+size_t bin_to_Keys(const std::string &msg, size_t pos, UAV &uav);
+
+std::string parSig_to_bin(const parSig &sig);
+parSig bin_to_parSig(const std::string &msg);
+
+/** @param compressed false: uncompressed points, for a receiver with CPU to save rather than bytes */
+std::string Sigma_to_bin(const Sigma &sg, bool compressed = true);
+Sigma bin_to_Sigma(const std::string &msg);
+
+std::string SigmaShare_to_bin(const SigmaShare &share, bool compressed = true);
+SigmaShare bin_to_SigmaShare(const std::string &msg);
+
+/** Alive flags bit-packed, RTT EWMAs in 0.1 ms steps (as precise as the text format). */
+std::string Health_to_bin(const std::vector<PeerHealth> &health);
+std::vector<PeerHealth> bin_to_Health(const std::string &msg);
+
+/** g^t, stk, the share count, k and the UAV range: 72 bytes for up to 127 shares and 16,384 UAVs. */
+std::string SplitKey_to_bin(const SplitKey &key);
+SplitKey bin_to_SplitKey(const std::string &msg);
+
+/** k, the time of signing, g^t and s. */
+std::string SplitOrder_to_bin(const SplitOrder &order);
+SplitOrder bin_to_SplitOrder(const std::string &msg);
+
+// ------------------------------
+// Selected format on send, either format on receive
+// ------------------------------
+
+std::string Package_to_wire(const TransmissionPackage &pkg);
+TransmissionPackage wire_to_Package(const std::string &msg);
+
+std::string Common_to_wire(const TransmissionPackage &pkg);
+void wire_to_Common(const std::string &msg, TransmissionPackage &pkg);
+
+std::string HeadPackage_to_wire(const HeadPackage &pkg);
+HeadPackage wire_to_HeadPackage(const std::string &msg);
+
+std::string VerifierPackage_to_wire(const VerifierPackage &pkg);
+VerifierPackage wire_to_VerifierPackage(const std::string &msg);
+
+std::string parSig_to_wire(const parSig &sig);
+parSig wire_to_parSig(const std::string &msg);
+
+std::string Sigma_to_wire(const Sigma &sg, bool compressed = true);
+Sigma wire_to_Sigma(const std::string &msg);
+
+std::string SigmaShare_to_wire(const SigmaShare &share, bool compressed = true);
+SigmaShare wire_to_SigmaShare(const std::string &msg);
+
+std::string Health_to_wire(const std::vector<PeerHealth> &health);
+std::vector<PeerHealth> wire_to_Health(const std::string &msg);
+
+std::string SplitKey_to_wire(const SplitKey &key);
+SplitKey wire_to_SplitKey(const std::string &msg);
+
+std::string SplitOrder_to_wire(const SplitOrder &order);
+SplitOrder wire_to_SplitOrder(const std::string &msg);
+
+#endif // WIRE_FORMAT_H
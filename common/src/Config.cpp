@@ -0,0 +1,105 @@
+#include "../include/Config.h"
+
+#include <fstream>
+#include <iostream>
+
+static std::string trimValue(const std::string &str) {
+    size_t first = str.find_first_not_of(" \t\n\r\"'");
+    if (first == std::string::npos) return "";
+    size_t last = str.find_last_not_of(" \t\n\r\"'");
+    return str.substr(first, last - first + 1);
+}
+
+Config loadConfig(const std::string &path) {
+    Config cfg;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "[Config] Warning: Could not open config file: " << path
+                  << ". Using default values." << std::endl;
+        return cfg;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Remove the annotations
+        size_t commentPos = line.find('#');
+        if (commentPos != std::string::npos) {
+            line = line.substr(0, commentPos);
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+
+        std::string key = trimValue(line.substr(0, eq));
+        if (!key.empty()) {
+            cfg[key] = trimValue(line.substr(eq + 1));
+        }
+    }
+    return cfg;
+}
+
+std::string configStr(const Config &cfg, const std::string &key, const std::string &def) {
+    auto it = cfg.find(key);
+    return it == cfg.end() || it->second.empty() ? def : it->second;
+}
+
+int configInt(const Config &cfg, const std::string &key, int def) {
+    auto it = cfg.find(key);
+    if (it == cfg.end()) return def;
+    try {
+        return std::stoi(it->second);
+    } catch (...) {
+        return def;
+    }
+}
+
+double configRate(const Config &cfg, const std::string &key, double def) {
+    auto it = cfg.find(key);
+    if (it == cfg.end()) return def;
+    try {
+        size_t pos;
+        double value = std::stod(it->second, &pos);
+        std::string unit = it->second.substr(pos);
+        // Same units as tc: k/m/g are decimal, "bps" means bytes per second
+        double scale = 1;
+        if (!unit.empty() && (unit[0] == 'k' || unit[0] == 'K')) scale = 1e3, unit = unit.substr(1);
+        else if (!unit.empty() && (unit[0] == 'm' || unit[0] == 'M')) scale = 1e6, unit = unit.substr(1);
+        else if (!unit.empty() && (unit[0] == 'g' || unit[0] == 'G')) scale = 1e9, unit = unit.substr(1);
+        if (unit == "bps") scale *= 8;
+        else if (!unit.empty() && unit != "bit") return def;
+        return value * scale > 0 ? value * scale : def;
+    } catch (...) {
+        return def;
+    }
+}
+
+double configMillis(const Config &cfg, const std::string &key, double def) {
+    auto it = cfg.find(key);
+    if (it == cfg.end()) return def;
+    try {
+        size_t pos;
+        double value = std::stod(it->second, &pos);
+        std::string unit = it->second.substr(pos);
+        double scale;
+        if (unit.empty() || unit == "ms" || unit == "msec") scale = 1;
+        else if (unit == "us" || unit == "usec") scale = 1e-3;
+        else if (unit == "s" || unit == "sec") scale = 1e3;
+        else return def;
+        return value >= 0 ? value * scale : def;
+    } catch (...) {
+        return def;
+    }
+}
+
+double configPercent(const Config &cfg, const std::string &key, double def) {
+    auto it = cfg.find(key);
+    if (it == cfg.end()) return def;
+    try {
+        size_t pos;
+        double value = std::stod(it->second, &pos);
+        std::string unit = it->second.substr(pos);
+        if (!unit.empty() && unit != "%") return def;
+        return value >= 0 && value <= 100 ? value / 100 : def;
+    } catch (...) {
+        return def;
+    }
+}
@@ -0,0 +1,136 @@
+#include "../include/ECP2Array.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+// Per-point state of an array built from octets
+static const uint8_t kPending = 0;
+static const uint8_t kBusy = 1;
+static const uint8_t kReady = 2;
+
+// Below this many points per thread, starting a thread costs more than it saves
+static const size_t kPointsPerThread = 8;
+
+ECP2Array::ECP2Array(const std::vector<ECP2> &points) : store(std::make_shared<Store>()) {
+    store->points = points;
+}
+
+ECP2Array::ECP2Array(std::vector<ECP2> &&points) : store(std::make_shared<Store>()) {
+    store->points = std::move(points);
+}
+
+ECP2Array::ECP2Array(size_t count, const ECP2 &value) : store(std::make_shared<Store>()) {
+    store->points.assign(count, value);
+}
+
+ECP2Array ECP2Array::fromOctets(std::string octets, size_t count) {
+    if (octets.size() != count * kOctetBytes) {
+        throw std::invalid_argument("ECP2Array: octets do not hold the given number of points.");
+    }
+    ECP2Array array;
+    array.store = std::make_shared<Store>();
+    array.store->points.resize(count);
+    array.store->octets = std::move(octets);
+    array.store->state.reset(new std::atomic<uint8_t>[count]);
+    for (size_t i = 0; i < count; ++i) array.store->state[i].store(kPending, std::memory_order_relaxed);
+    return array;
+}
+
+size_t ECP2Array::size() const {
+    return store ? store->points.size() : 0;
+}
+
+// Decompresses point i once; a thread that finds it being decompressed by another waits for it
+void ECP2Array::ensure(Store &s, size_t i) {
+    if (s.state[i].load(std::memory_order_acquire) == kReady) return;
+    uint8_t expected = kPending;
+    if (!s.state[i].compare_exchange_strong(expected, kBusy, std::memory_order_acq_rel)) {
+        while (s.state[i].load(std::memory_order_acquire) != kReady) std::this_thread::yield();
+        return;
+    }
+
+    ECP2 &point = s.points[i];
+    const char *src = s.octets.data() + i * kOctetBytes;
+    if (src[0] == 0x00) {
+        ECP2_inf(&point);
+    } else {
+        char buffer[kOctetBytes];
+        memcpy(buffer, src, kOctetBytes);
+        octet S;
+        S.val = buffer;
+        S.max = sizeof(buffer);
+        S.len = sizeof(buffer);
+        if (ECP2_fromOctet(&point, &S) != 1) {
+            std::cerr << "Invalid ECP2 point representation." << std::endl;
+            ECP2_inf(&point);
+        }
+    }
+    s.state[i].store(kReady, std::memory_order_release);
+}
+
+const ECP2 &ECP2Array::operator[](size_t i) const {
+    Store &s = *store;
+    if (s.state) ensure(s, i);
+    return s.points[i];
+}
+
+bool ECP2Array::storedOctet(size_t i, const uint8_t *&bytes, size_t &length) const {
+    if (!store || store->octets.empty()) return false;
+    bytes = reinterpret_cast<const uint8_t *>(store->octets.data()) + i * kOctetBytes;
+    length = bytes[0] == 0x00 ? 1 : kOctetBytes;
+    return true;
+}
+
+bool ECP2Array::decompressed(size_t i) const {
+    return !store->state || store->state[i].load(std::memory_order_acquire) == kReady;
+}
+
+void ECP2Array::decompressAll(unsigned threads) const {
+    if (!store || !store->state) return;
+    Store &s = *store;
+    size_t n = s.points.size();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, (n + kPointsPerThread - 1) / kPointsPerThread));
+
+    // Threads take the next point from a shared counter; points already decompressed are skipped
+    std::atomic<size_t> next{0};
+    auto work = [&s, &next, n] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) ensure(s, i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto &thread : pool) thread.join();
+}
+
+const std::vector<ECP2> &ECP2Array::points() const {
+    static const std::vector<ECP2> none;
+    if (!store) return none;
+    decompressAll();
+    return store->points;
+}
+
+// The points to modify: a fresh store if they are shared or still tied to their octets
+ECP2Array::Store &ECP2Array::own() {
+    if (!store) {
+        store = std::make_shared<Store>();
+    } else if (store.use_count() > 1 || store->state) {
+        auto copy = std::make_shared<Store>();
+        copy->points = points();
+        store = std::move(copy);
+    }
+    return *store;
+}
+
+void ECP2Array::push_back(const ECP2 &point) {
+    own().points.push_back(point);
+}
+
+void ECP2Array::set(size_t i, const ECP2 &point) {
+    own().points[i] = point;
+}
+
+void ECP2Array::clear() {
+    store.reset();
+}
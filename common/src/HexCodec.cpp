@@ -0,0 +1,219 @@
+#include "../include/HexCodec.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HEX_X86 1
+#include <immintrin.h>
+#endif
+
+static const char kUpper[] = "0123456789ABCDEF";
+static const char kLower[] = "0123456789abcdef";
+
+// ============================================================
+// Scalar kernel
+// ============================================================
+
+// Value of every hex digit, 0xFF for any other byte
+struct HexTable {
+    uint8_t value[256];
+
+    HexTable() {
+        for (int c = 0; c < 256; ++c) value[c] = 0xFF;
+        for (int d = 0; d < 10; ++d) value['0' + d] = static_cast<uint8_t>(d);
+        for (int d = 0; d < 6; ++d) {
+            value['a' + d] = static_cast<uint8_t>(10 + d);
+            value['A' + d] = static_cast<uint8_t>(10 + d);
+        }
+    }
+};
+
+static const HexTable kTable;
+
+static void encodeScalar(const uint8_t *src, size_t length, char *dst, const char *digits) {
+    for (size_t i = 0; i < length; ++i) {
+        dst[2 * i] = digits[src[i] >> 4];
+        dst[2 * i + 1] = digits[src[i] & 0x0F];
+    }
+}
+
+static bool decodeScalar(const char *src, size_t length, uint8_t *dst) {
+    uint8_t bad = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t hi = kTable.value[static_cast<uint8_t>(src[2 * i])];
+        uint8_t lo = kTable.value[static_cast<uint8_t>(src[2 * i + 1])];
+        bad |= (hi | lo) & 0xF0;
+        dst[i] = static_cast<uint8_t>((hi << 4) | (lo & 0x0F));
+    }
+    return bad == 0;
+}
+
+#ifdef HEX_X86
+
+// ============================================================
+// SSSE3 kernel: 16 bytes per step
+// ============================================================
+
+// Nibble value of 16 hex digits; `bad` collects the lanes holding anything else.
+// Bytes >= 0x80 compare as negative and so are neither digits nor letters.
+__attribute__((target("ssse3")))
+static inline __m128i nibbles128(__m128i v, __m128i &bad) {
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                    _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                     _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    __m128i digit = _mm_and_si128(isDigit, _mm_sub_epi8(v, _mm_set1_epi8('0')));
+    __m128i letter = _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    bad = _mm_or_si128(bad, _mm_andnot_si128(_mm_or_si128(isDigit, isLetter), _mm_set1_epi8(-1)));
+    return _mm_or_si128(digit, letter);
+}
+
+__attribute__((target("ssse3")))
+static void encodeSSSE3(const uint8_t *src, size_t length, char *dst, const char *digits) {
+    const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(b, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(b, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    encodeScalar(src + i, length - i, dst + 2 * i, digits);
+}
+
+__attribute__((target("ssse3")))
+static bool decodeSSSE3(const char *src, size_t length, uint8_t *dst) {
+    // High nibble at even positions: value = 16 * even + odd
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i bad = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v0 = nibbles128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i)), bad);
+        __m128i v1 = nibbles128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i + 16)), bad);
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(v0, weights), _mm_maddubs_epi16(v1, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), bytes);
+    }
+    bool ok = _mm_movemask_epi8(bad) == 0;
+    return decodeScalar(src + 2 * i, length - i, dst + i) && ok;
+}
+
+
+// ============================================================
+// AVX2 kernel: 32 bytes per step
+// ============================================================
+
+__attribute__((target("avx2")))
+static inline __m256i nibbles256(__m256i v, __m256i &bad) {
+    __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                        _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    __m256i digit = _mm256_and_si256(isDigit, _mm256_sub_epi8(v, _mm256_set1_epi8('0')));
+    __m256i letter = _mm256_and_si256(isLetter, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)));
+    bad = _mm256_or_si256(bad, _mm256_andnot_si256(_mm256_or_si256(isDigit, isLetter), _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(digit, letter);
+}
+
+__attribute__((target("avx2")))
+static void encodeAVX2(const uint8_t *src, size_t length, char *dst, const char *digits) {
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(b, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(b, mask));
+        // The unpacks work per 128-bit lane: bytes 0-7 | 16-23 and 8-15 | 24-31
+        __m256i r0 = _mm256_unpacklo_epi8(hi, lo);
+        __m256i r1 = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i), _mm256_permute2x128_si256(r0, r1, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i + 32), _mm256_permute2x128_si256(r0, r1, 0x31));
+    }
+    encodeSSSE3(src + i, length - i, dst + 2 * i, digits);
+}
+
+__attribute__((target("avx2")))
+static bool decodeAVX2(const char *src, size_t length, uint8_t *dst) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    __m256i bad = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v0 = nibbles256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * i)), bad);
+        __m256i v1 = nibbles256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * i + 32)), bad);
+        // packus works per lane as well; restore the order of the 64-bit quarters
+        __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights), _mm256_maddubs_epi16(v1, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_permute4x64_epi64(bytes, 0xD8));
+    }
+    bool ok = _mm256_movemask_epi8(bad) == 0;
+    return decodeSSSE3(src + 2 * i, length - i, dst + i) && ok;
+}
+
+#endif // HEX_X86
+
+
+// ============================================================
+// Dispatch
+// ============================================================
+
+static bool supported(HexKernel kernel) {
+#ifdef HEX_X86
+    __builtin_cpu_init();
+    if (kernel == HexKernel::AVX2) return __builtin_cpu_supports("avx2");
+    if (kernel == HexKernel::SSSE3) return __builtin_cpu_supports("ssse3");
+#endif
+    return kernel == HexKernel::Scalar;
+}
+
+static HexKernel &activeKernel() {
+    static HexKernel kernel = supported(HexKernel::AVX2) ? HexKernel::AVX2
+                            : supported(HexKernel::SSSE3) ? HexKernel::SSSE3
+                            : HexKernel::Scalar;
+    return kernel;
+}
+
+HexKernel hexKernel() {
+    return activeKernel();
+}
+
+bool setHexKernel(HexKernel kernel) {
+    if (!supported(kernel)) return false;
+    activeKernel() = kernel;
+    return true;
+}
+
+const char *hexKernelName(HexKernel kernel) {
+    switch (kernel) {
+        case HexKernel::AVX2: return "avx2";
+        case HexKernel::SSSE3: return "ssse3";
+        default: return "scalar";
+    }
+}
+
+void hexEncode(const uint8_t *src, size_t length, char *dst, bool upper) {
+    const char *digits = upper ? kUpper : kLower;
+    switch (activeKernel()) {
+#ifdef HEX_X86
+        case HexKernel::AVX2: encodeAVX2(src, length, dst, digits); return;
+        case HexKernel::SSSE3: encodeSSSE3(src, length, dst, digits); return;
+#endif
+        default: encodeScalar(src, length, dst, digits);
+    }
+}
+
+void appendHex(std::string &out, const uint8_t *src, size_t length) {
+    size_t at = out.size();
+    out.resize(at + 2 * length);
+    hexEncode(src, length, &out[at]);
+}
+
+bool hexDecode(const char *src, size_t length, uint8_t *dst) {
+    switch (activeKernel()) {
+#ifdef HEX_X86
+        case HexKernel::AVX2: return decodeAVX2(src, length, dst);
+        case HexKernel::SSSE3: return decodeSSSE3(src, length, dst);
+#endif
+        default: return decodeScalar(src, length, dst);
+    }
+}
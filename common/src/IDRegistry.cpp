@@ -0,0 +1,42 @@
+#include "../include/IDRegistry.h"
+
+#include <algorithm>
+
+// Domain separation from the other uses of SHA-256
+static const char kRegistryTag[] = "RTS-ID";
+
+std::string newRegistrySeed(gmp_randstate_t state) {
+    mpz_class value;
+    mpz_urandomb(value.get_mpz_t(), state, 8 * kRegistrySeedBytes);
+    std::string seed(kRegistrySeedBytes, '\0');
+    size_t count = (mpz_sizeinbase(value.get_mpz_t(), 2) + 7) / 8;
+    mpz_export(&seed[kRegistrySeedBytes - count], nullptr, 1, 1, 1, 0, value.get_mpz_t());
+    return seed;
+}
+
+mpz_class registryID(const std::string &seed, int index, const mpz_class &q) {
+    hash256 h;
+    char digest[32];
+    HASH256_init(&h);
+    for (const char *c = kRegistryTag; *c; ++c) HASH256_process(&h, static_cast<unsigned char>(*c));
+    for (char c : seed) HASH256_process(&h, static_cast<unsigned char>(c));
+    for (int shift = 24; shift >= 0; shift -= 8) HASH256_process(&h, (static_cast<uint32_t>(index) >> shift) & 0xFF);
+    HASH256_hash(&h, digest);
+
+    mpz_class id;
+    mpz_import(id.get_mpz_t(), sizeof(digest), 1, 1, 1, 0, digest);
+    return id % q;
+}
+
+std::vector<mpz_class> expandRegistry(const std::string &seed, int n, const mpz_class &q) {
+    std::vector<mpz_class> ids;
+    ids.reserve(n);
+    for (int i = 0; i < n; ++i) ids.push_back(registryID(seed, i, q));
+    return ids;
+}
+
+bool registryUsable(const std::vector<mpz_class> &ids) {
+    std::vector<mpz_class> sorted(ids);
+    std::sort(sorted.begin(), sorted.end());
+    return (sorted.empty() || sorted.front() != 0) && std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+}
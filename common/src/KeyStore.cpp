@@ -0,0 +1,377 @@
+#include "../include/KeyStore.h"
+#include "../include/WireFormat.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================
+// On-disk layout
+// ============================================================
+
+struct KeyStore::Header {
+    char magic[8];              // "RTSKEYS"
+    uint32_t version;
+    uint32_t n;                 // registered IDs
+    uint32_t tm;                // maximum threshold
+    uint32_t k;                 // coefficients per UAV (tm - 1)
+    int32_t t;                  // threshold
+    uint32_t recordBytes;
+    uint64_t globalOffset, globalBytes;
+    uint64_t idsOffset;
+    uint64_t commonOffset, commonBytes;
+    uint64_t recordsOffset;
+    char commonDigest[64];
+    char checksum[64];          // sha256Hex of the fields above and of the global section
+    uint32_t issued;            // serials issued: changes after creation, not covered by the checksum
+};
+
+// Record of one UAV: state, checksum, then c1[k], c2[k] (scalars) and PK[k] (points)
+static const uint32_t kRecordEmpty = 0;
+static const uint32_t kRecordReady = 1;
+static const size_t kRecordHead = 16;
+
+static const char kMagic[8] = {'R', 'T', 'S', 'K', 'E', 'Y', 'S', 0};
+
+static size_t align8(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+static bool putScalar(uint8_t *dst, const mpz_class &value) {
+    size_t count = (mpz_sizeinbase(value.get_mpz_t(), 2) + 7) / 8;
+    if (value < 0 || count > KeyStore::kScalarBytes) return false;
+    memset(dst, 0, KeyStore::kScalarBytes);
+    mpz_export(dst + KeyStore::kScalarBytes - count, nullptr, 1, 1, 1, 0, value.get_mpz_t());
+    return true;
+}
+
+static mpz_class getScalar(const uint8_t *src) {
+    mpz_class value;
+    mpz_import(value.get_mpz_t(), KeyStore::kScalarBytes, 1, 1, 1, 0, src);
+    return value;
+}
+
+static bool putPoint(uint8_t *dst, const ECP2 &point) {
+    char buffer[2 * 48 * 2];
+    octet S;
+    S.val = buffer;
+    S.max = sizeof(buffer);
+    S.len = 0;
+    ECP2_toOctet(&S, const_cast<ECP2 *>(&point), true);
+    if (S.len != (int) KeyStore::kPointBytes) return false;
+    memcpy(dst, buffer, KeyStore::kPointBytes);
+    return true;
+}
+
+static ECP2 getPoint(const uint8_t *src) {
+    ECP2 point;
+    char buffer[KeyStore::kPointBytes];
+    memcpy(buffer, src, sizeof(buffer));
+    octet S;
+    S.val = buffer;
+    S.max = sizeof(buffer);
+    S.len = sizeof(buffer);
+    if (ECP2_fromOctet(&point, &S) != 1) {
+        std::cerr << "[KeyStore] Invalid ECP2 point representation." << std::endl;
+    }
+    return point;
+}
+
+// FNV-1a, enough to detect a record torn by a crash
+static uint64_t fnv1a(const uint8_t *data, size_t bytes) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+// ============================================================
+// Mapping
+// ============================================================
+
+KeyStore::~KeyStore() {
+    if (base) munmap(base, length);
+}
+
+bool KeyStore::map(int fd, size_t bytes) {
+    if (base) munmap(base, length);
+    base = nullptr;
+    length = 0;
+
+    void *addr = fd < 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                        : mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) return false;
+    base = static_cast<uint8_t *>(addr);
+    length = bytes;
+    return true;
+}
+
+const KeyStore::Header *KeyStore::header() const {
+    return reinterpret_cast<const Header *>(base);
+}
+
+KeyStore::Header *KeyStore::header() {
+    return reinterpret_cast<Header *>(base);
+}
+
+size_t KeyStore::recordBytes() const {
+    return header()->recordBytes;
+}
+
+uint8_t *KeyStore::record(int i) const {
+    return base + header()->recordsOffset + static_cast<size_t>(i) * recordBytes();
+}
+
+uint64_t KeyStore::recordChecksum(int i) const {
+    const Header *h = header();
+    return fnv1a(record(i) + kRecordHead, h->k * (2 * kScalarBytes + kPointBytes));
+}
+
+// Checksum over the fixed part of the header and the global section
+std::string KeyStore::stateChecksum() const {
+    const Header *h = header();
+    std::string data(reinterpret_cast<const char *>(base), offsetof(Header, checksum));
+    data.append(reinterpret_cast<const char *>(base + h->globalOffset), h->globalBytes);
+    return sha256Hex(data);
+}
+
+
+// ============================================================
+// Create / open
+// ============================================================
+
+bool KeyStore::create(const std::string &path, const Params &pp, const mpz_class &alpha,
+                      const std::vector<mpz_class> &d, const std::vector<mpz_class> &b,
+                      const mpz_class &M, int t, const std::vector<mpz_class> &ids,
+                      const std::string &commonBlob, const std::string &commonDigest) {
+    size_t n = ids.size();
+    size_t k = b.size();
+    if (d.size() != k || pp.PK.size() != k || commonDigest.size() != 64) return false;
+
+    Header h{};
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.n = static_cast<uint32_t>(n);
+    h.tm = static_cast<uint32_t>(pp.tm);
+    h.k = static_cast<uint32_t>(k);
+    h.t = t;
+    h.recordBytes = static_cast<uint32_t>(align8(kRecordHead + k * (2 * kScalarBytes + kPointBytes)));
+    h.globalOffset = align8(sizeof(Header));
+    h.globalBytes = (5 + 2 * k) * kScalarBytes + (1 + k) * kPointBytes;
+    h.idsOffset = align8(h.globalOffset + h.globalBytes);
+    h.commonOffset = align8(h.idsOffset + n * kScalarBytes);
+    h.commonBytes = commonBlob.size();
+    h.recordsOffset = align8(h.commonOffset + h.commonBytes);
+    memcpy(h.commonDigest, commonDigest.data(), sizeof(h.commonDigest));
+    size_t bytes = h.recordsOffset + n * h.recordBytes;
+
+    // Records stay zero (empty) until TA derives them; a new file is sparse until then
+    int fd = -1;
+    if (!path.empty()) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0 || ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            if (fd >= 0) ::close(fd);
+            std::cerr << "[KeyStore] Cannot create " << path << std::endl;
+            return false;
+        }
+    }
+    bool mapped = map(fd, bytes);
+    if (fd >= 0) ::close(fd);
+    if (!mapped) {
+        std::cerr << "[KeyStore] Cannot map " << (path.empty() ? "memory" : path) << std::endl;
+        return false;
+    }
+    memcpy(base, &h, sizeof(h));
+
+    // Global section
+    uint8_t *p = base + h.globalOffset;
+    bool ok = putScalar(p, alpha) && putScalar(p + kScalarBytes, pp.q) && putScalar(p + 2 * kScalarBytes, pp.g)
+              && putScalar(p + 3 * kScalarBytes, pp.beta) && putScalar(p + 4 * kScalarBytes, M);
+    p += 5 * kScalarBytes;
+    ok = ok && putPoint(p, pp.P2);
+    p += kPointBytes;
+    for (size_t i = 0; i < k; ++i, p += kPointBytes) ok = ok && putPoint(p, pp.PK[i]);
+    for (size_t i = 0; i < k; ++i, p += kScalarBytes) ok = ok && putScalar(p, d[i]);
+    for (size_t i = 0; i < k; ++i, p += kScalarBytes) ok = ok && putScalar(p, b[i]);
+
+    // Registered IDs and common data
+    p = base + h.idsOffset;
+    for (size_t i = 0; i < n; ++i, p += kScalarBytes) ok = ok && putScalar(p, ids[i]);
+    memcpy(base + h.commonOffset, commonBlob.data(), commonBlob.size());
+    if (!ok) {
+        std::cerr << "[KeyStore] TA state does not fit the store layout." << std::endl;
+        return false;
+    }
+
+    std::string sum = stateChecksum();
+    memcpy(header()->checksum, sum.data(), sizeof(h.checksum));
+    if (!path.empty()) msync(base, h.recordsOffset, MS_ASYNC);
+    return true;
+}
+
+bool KeyStore::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return false;
+    struct stat st{};
+    bool mapped = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)
+                  && map(fd, static_cast<size_t>(st.st_size));
+    ::close(fd);
+    if (!mapped) return false;
+
+    const Header *h = header();
+    bool valid = memcmp(h->magic, kMagic, sizeof(kMagic)) == 0 && h->version == kVersion
+                 && h->globalOffset + h->globalBytes <= length
+                 && h->idsOffset + static_cast<uint64_t>(h->n) * kScalarBytes <= length
+                 && h->commonOffset + h->commonBytes <= length
+                 && h->recordsOffset + static_cast<uint64_t>(h->n) * h->recordBytes <= length
+                 && h->recordBytes >= kRecordHead + h->k * (2 * kScalarBytes + kPointBytes);
+    if (valid && stateChecksum() != std::string(h->checksum, sizeof(h->checksum))) {
+        std::cerr << "[KeyStore] Checksum mismatch in " << path << std::endl;
+        valid = false;
+    }
+    if (!valid) {
+        munmap(base, length);
+        base = nullptr;
+        length = 0;
+    }
+    return valid;
+}
+
+
+// ============================================================
+// Global state
+// ============================================================
+
+void KeyStore::loadState(Params &pp, mpz_class &alpha, std::vector<mpz_class> &d, std::vector<mpz_class> &b,
+                         mpz_class &M, int &t) const {
+    const Header *h = header();
+    const uint8_t *p = base + h->globalOffset;
+    alpha = getScalar(p);
+    pp.q = getScalar(p + kScalarBytes);
+    pp.g = getScalar(p + 2 * kScalarBytes);
+    pp.beta = getScalar(p + 3 * kScalarBytes);
+    M = getScalar(p + 4 * kScalarBytes);
+    p += 5 * kScalarBytes;
+
+    pp.n = static_cast<int>(h->n);
+    pp.tm = static_cast<int>(h->tm);
+    pp.P2 = getPoint(p);
+    p += kPointBytes;
+    pp.PK.clear();
+    for (uint32_t i = 0; i < h->k; ++i, p += kPointBytes) pp.PK.push_back(getPoint(p));
+    d.clear();
+    for (uint32_t i = 0; i < h->k; ++i, p += kScalarBytes) d.push_back(getScalar(p));
+    b.clear();
+    for (uint32_t i = 0; i < h->k; ++i, p += kScalarBytes) b.push_back(getScalar(p));
+    t = h->t;
+}
+
+int KeyStore::size() const {
+    return base ? static_cast<int>(header()->n) : 0;
+}
+
+int KeyStore::maxThreshold() const {
+    return base ? static_cast<int>(header()->tm) : 0;
+}
+
+mpz_class KeyStore::id(int i) const {
+    return getScalar(base + header()->idsOffset + static_cast<size_t>(i) * kScalarBytes);
+}
+
+std::string KeyStore::commonBlob() const {
+    const Header *h = header();
+    return std::string(reinterpret_cast<const char *>(base + h->commonOffset), h->commonBytes);
+}
+
+std::string KeyStore::commonDigest() const {
+    return std::string(header()->commonDigest, sizeof(header()->commonDigest));
+}
+
+
+// ============================================================
+// Serials
+// ============================================================
+
+int KeyStore::claimSerial() {
+    Header *h = header();
+    uint32_t serial = __atomic_load_n(&h->issued, __ATOMIC_SEQ_CST);
+    do {
+        if (serial >= h->n) return -1;
+    } while (!__atomic_compare_exchange_n(&h->issued, &serial, serial + 1, false,
+                                          __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+    return static_cast<int>(serial);
+}
+
+int KeyStore::issued() const {
+    return base ? static_cast<int>(__atomic_load_n(&header()->issued, __ATOMIC_SEQ_CST)) : 0;
+}
+
+
+// ============================================================
+// Per-UAV records
+// ============================================================
+
+bool KeyStore::hasKeys(int i) const {
+    uint8_t *r = record(i);
+    uint32_t state = __atomic_load_n(reinterpret_cast<uint32_t *>(r), __ATOMIC_ACQUIRE);
+    uint64_t sum;
+    memcpy(&sum, r + 8, sizeof(sum));
+    return state == kRecordReady && sum == recordChecksum(i);
+}
+
+bool KeyStore::putKeys(int i, const UAV &uav) {
+    const Header *h = header();
+    size_t k = h->k;
+    if (uav.c1.size() != k || uav.c2.size() != k || uav.PK.size() != k) return false;
+
+    uint8_t *r = record(i);
+    __atomic_store_n(reinterpret_cast<uint32_t *>(r), kRecordEmpty, __ATOMIC_RELEASE);
+    uint8_t *p = r + kRecordHead;
+    bool ok = true;
+    for (size_t j = 0; j < k; ++j, p += kScalarBytes) ok = ok && putScalar(p, uav.c1[j]);
+    for (size_t j = 0; j < k; ++j, p += kScalarBytes) ok = ok && putScalar(p, uav.c2[j]);
+    for (size_t j = 0; j < k; ++j, p += kPointBytes) ok = ok && putPoint(p, uav.PK[j]);
+    if (!ok) return false;
+
+    uint64_t sum = recordChecksum(i);
+    memcpy(r + 8, &sum, sizeof(sum));
+    __atomic_store_n(reinterpret_cast<uint32_t *>(r), kRecordReady, __ATOMIC_RELEASE);
+    return true;
+}
+
+std::string KeyStore::keysString(int i) const {
+    size_t k = header()->k;
+    const uint8_t *p = record(i) + kRecordHead;
+
+    std::string out = mpz_to_str(id(i)) + "#";
+    for (size_t j = 0; j < k; ++j, p += kScalarBytes) out += getScalar(p).get_str() + ",";
+    out += "#";
+    for (size_t j = 0; j < k; ++j, p += kScalarBytes) out += getScalar(p).get_str() + ",";
+    out += "#" + std::to_string(i);
+    return out;
+}
+
+std::string KeyStore::keysBinary(int i) const {
+    size_t k = header()->k;
+    const uint8_t *p = record(i) + kRecordHead;
+
+    WireWriter w;
+    w.header(WIRE_KEYS);
+    w.scalar(id(i));
+    w.varint(k);
+    for (size_t j = 0; j < k; ++j, p += kScalarBytes) w.scalarBytes(p, kScalarBytes);
+    w.varint(k);
+    for (size_t j = 0; j < k; ++j, p += kScalarBytes) w.scalarBytes(p, kScalarBytes);
+    w.varint(static_cast<uint64_t>(i));
+    return w.data();
+}
+
+const uint8_t *KeyStore::pkOctet(int i, int index) const {
+    return record(i) + kRecordHead + header()->k * 2 * kScalarBytes + index * kPointBytes;
+}
@@ -0,0 +1,73 @@
+#include "../include/Latency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+void rttUpdate(RttEstimator &est, double sample) {
+    if (!est.hasSample) {
+        est.srtt = sample;
+        est.rttvar = sample / 2;
+        est.hasSample = true;
+        return;
+    }
+    // alpha = 1/8, beta = 1/4
+    est.rttvar = 0.75 * est.rttvar + 0.25 * std::fabs(est.srtt - sample);
+    est.srtt = 0.875 * est.srtt + 0.125 * sample;
+}
+
+double rttTimeout(const RttEstimator &est) {
+    if (!est.hasSample) return est.initialRto;
+    double rto = est.srtt + 4 * est.rttvar;
+    return std::min(est.maxRto, std::max(est.minRto, rto));
+}
+
+void latencyAdd(LatencyStats &stats, double ms) {
+    if (stats.samples.size() < stats.window) {
+        stats.samples.push_back(ms);
+    } else {
+        stats.samples[stats.next] = ms;
+    }
+    stats.next = (stats.next + 1) % stats.window;
+    stats.total++;
+}
+
+double latencyPercentile(const LatencyStats &stats, double p) {
+    if (stats.samples.empty()) return -1;
+    std::vector<double> sorted(stats.samples);
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    rank = std::min(sorted.size(), std::max<size_t>(1, rank));
+    std::nth_element(sorted.begin(), sorted.begin() + (rank - 1), sorted.end());
+    return sorted[rank - 1];
+}
+
+bool latencyExport(const LatencyStats &stats, const std::string &role, const std::string &metric,
+                   const std::string &path) {
+    bool exists = std::ifstream(path).good();
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "[Latency] Could not write " << path << std::endl;
+        return false;
+    }
+    if (!exists) {
+        file << "timestamp,role,metric,count,p50_ms,p90_ms,p99_ms,max_ms\n";
+    }
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    file << now << "," << role << "," << metric << "," << stats.samples.size() << ","
+         << latencyPercentile(stats, 50) << "," << latencyPercentile(stats, 90) << ","
+         << latencyPercentile(stats, 99) << "," << latencyPercentile(stats, 100) << "\n";
+    return true;
+}
+
+void healthReply(PeerHealth &h, double sample, double alpha) {
+    h.ewma = h.ewma < 0 ? sample : (1 - alpha) * h.ewma + alpha * sample;
+    h.missed = 0;
+    h.alive = true;
+}
+
+void healthMiss(PeerHealth &h, int maxMissed) {
+    if (++h.missed >= maxMissed) h.alive = false;
+}
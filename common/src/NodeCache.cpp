@@ -0,0 +1,211 @@
+#include "../include/NodeCache.h"
+#include "../include/Config.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+static const char kCacheMagic[8] = {'R', 'T', 'S', 'N', 'O', 'D', 'E', 0};
+static const uint32_t kCacheVersion = 3;   // 3: a UAV caches the beta and key of its last split
+static const size_t kChecksumChars = 64;    // sha256Hex
+
+// Points are cached as their in-memory representation
+static_assert(std::is_trivially_copyable<ECP2>::value, "ECP2 must be trivially copyable");
+
+std::string nodeCachePath(const std::string &name) {
+    std::string dir = configStr(loadConfig("scripts/config.env"), "NODE_CACHE_DIR", "");
+    if (dir.empty()) return "";
+    if (dir.back() != '/') dir += '/';
+    return dir + name + ".cache";
+}
+
+
+// ============================================================
+// Writer
+// ============================================================
+
+void CacheWriter::u32(uint32_t value) {
+    payload.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void CacheWriter::scalar(const mpz_class &value) {
+    // Length-prefixed big-endian magnitude
+    size_t count = (mpz_sizeinbase(value.get_mpz_t(), 2) + 7) / 8;
+    std::string raw(count, '\0');
+    mpz_export(&raw[0], &count, 1, 1, 1, 0, value.get_mpz_t());
+    raw.resize(count);
+    bytes(raw);
+}
+
+void CacheWriter::scalars(const std::vector<mpz_class> &values) {
+    u32(static_cast<uint32_t>(values.size()));
+    for (const auto &value : values) scalar(value);
+}
+
+void CacheWriter::point(const ECP2 &value) {
+    payload.append(reinterpret_cast<const char *>(&value), sizeof(ECP2));
+}
+
+void CacheWriter::points(const std::vector<ECP2> &values) {
+    u32(static_cast<uint32_t>(values.size()));
+    if (!values.empty()) {
+        payload.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(ECP2));
+    }
+}
+
+void CacheWriter::bytes(const std::string &value) {
+    u32(static_cast<uint32_t>(value.size()));
+    payload += value;
+}
+
+void CacheWriter::params(const Params &pp) {
+    u32(static_cast<uint32_t>(pp.n));
+    u32(static_cast<uint32_t>(pp.tm));
+    scalar(pp.q);
+    point(pp.P2);
+    scalar(pp.g);
+    scalar(pp.beta);
+    points(pp.PK);
+}
+
+bool CacheWriter::save(const std::string &path, const std::string &role, const std::string &digest) const {
+    std::string data(kCacheMagic, sizeof(kCacheMagic));
+    CacheWriter head;
+    head.u32(kCacheVersion);
+    head.u32(static_cast<uint32_t>(sizeof(ECP2)));
+    head.bytes(role);
+    head.bytes(digest);
+    data += head.payload;
+    data += payload;
+    data += sha256Hex(data);
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            std::cerr << "[NodeCache] Cannot write " << tmp << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "[NodeCache] Cannot replace " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+// ============================================================
+// Reader
+// ============================================================
+
+bool CacheReader::load(const std::string &path, const std::string &role) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    std::string data = oss.str();
+
+    if (data.size() < sizeof(kCacheMagic) + kChecksumChars ||
+        memcmp(data.data(), kCacheMagic, sizeof(kCacheMagic)) != 0) {
+        return false;
+    }
+    size_t body = data.size() - kChecksumChars;
+    if (sha256Hex(data.substr(0, body)) != data.substr(body)) {
+        std::cerr << "[NodeCache] Checksum mismatch in " << path << std::endl;
+        return false;
+    }
+
+    payload = data.substr(sizeof(kCacheMagic), body - sizeof(kCacheMagic));
+    pos = 0;
+    overrun = false;
+    bool valid = u32() == kCacheVersion && u32() == sizeof(ECP2) && bytes() == role;
+    cachedDigest = bytes();
+    return valid && ok();
+}
+
+const char *CacheReader::take(size_t count) {
+    if (overrun || count > payload.size() - pos) {
+        overrun = true;
+        return nullptr;
+    }
+    const char *p = payload.data() + pos;
+    pos += count;
+    return p;
+}
+
+uint32_t CacheReader::u32() {
+    uint32_t value = 0;
+    const char *p = take(sizeof(value));
+    if (p) memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+mpz_class CacheReader::scalar() {
+    std::string raw = bytes();
+    mpz_class value;
+    if (!raw.empty()) mpz_import(value.get_mpz_t(), raw.size(), 1, 1, 1, 0, raw.data());
+    return value;
+}
+
+std::vector<mpz_class> CacheReader::scalars() {
+    uint32_t count = u32();
+    std::vector<mpz_class> values;
+    for (uint32_t i = 0; i < count && ok(); ++i) values.push_back(scalar());
+    return values;
+}
+
+ECP2 CacheReader::point() {
+    ECP2 value;
+    const char *p = take(sizeof(ECP2));
+    if (p) memcpy(&value, p, sizeof(ECP2));
+    return value;
+}
+
+std::vector<ECP2> CacheReader::points() {
+    uint32_t count = u32();
+    std::vector<ECP2> values;
+    const char *p = take(static_cast<size_t>(count) * sizeof(ECP2));
+    if (p && count > 0) {
+        values.resize(count);
+        memcpy(values.data(), p, static_cast<size_t>(count) * sizeof(ECP2));
+    }
+    return values;
+}
+
+std::string CacheReader::bytes() {
+    uint32_t count = u32();
+    const char *p = take(count);
+    return p ? std::string(p, count) : std::string();
+}
+
+Params CacheReader::params() {
+    Params pp;
+    pp.n = static_cast<int>(u32());
+    pp.tm = static_cast<int>(u32());
+    pp.q = scalar();
+    pp.P2 = point();
+    pp.g = scalar();
+    pp.beta = scalar();
+    pp.PK = points();
+    return pp;
+}
+
+
+// ============================================================
+// TA digest
+// ============================================================
+
+bool parseDigestReply(const std::string &reply, std::string &digest, int &issued) {
+    size_t sep = reply.find('#', 7);
+    if (reply.rfind("DIGEST#", 0) != 0 || sep == std::string::npos) return false;
+    digest = reply.substr(7, sep - 7);
+    try {
+        issued = std::stoi(reply.substr(sep + 1));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
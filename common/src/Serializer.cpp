@@ -1,60 +1,440 @@
 #include "../include/Serializer.h"
+#include "../include/HexCodec.h"
 
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
 
-std::string Package_to_str(TransmissionPackage pkg) {
-    std::ostringstream oss;
-    oss << to_string(pkg.pp.n) << "#"
-        << to_string(pkg.pp.tm) << "#"
-        << mpz_to_str(pkg.pp.q) << "#"
-        << ECP2_to_str(pkg.pp.P2) << "#"
-        << mpz_to_str(pkg.pp.g) << "#"
-        << mpz_to_str(pkg.pp.beta) << "#"
-        << ECP2Arr_to_str(pkg.pp.PK) << "#"
-
-        << mpz_to_str(pkg.M) << "#"
-        << to_string(pkg.t) << "#"
-
-        << mpz_to_str(pkg.uav.ID) << "#"
-        << mpzArr_to_str(pkg.uav.c1) << "#"
-        << mpzArr_to_str(pkg.uav.c2) << "#"
-        << ECP2Arr_to_str(pkg.uav.PK) << "#"
-        << to_string(pkg.uav.serialNumber) << "#"
-        << mpzArr_to_str(pkg.registeredIDs);
-    return oss.str();
+// ============================================================
+// Field helpers
+// ============================================================
+// Parsing works on string_views of the message: no field is copied, and numbers,
+// scalars and points are converted from stack buffers.
+
+// Splits a `sep`-separated record into exactly `count` fields
+static bool splitFields(std::string_view str, char sep, std::string_view *fields, size_t count) {
+    size_t start = 0;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        size_t end = str.find(sep, start);
+        if (end == std::string_view::npos) return false;
+        fields[i] = str.substr(start, end - start);
+        start = end + 1;
+    }
+    fields[count - 1] = str.substr(start);
+    return fields[count - 1].find(sep) == std::string_view::npos;
+}
+
+// Calls fn on every item of a `sep`-separated list; as with std::getline, a trailing
+// separator does not start another item
+template <class Fn>
+static void forEachItem(std::string_view str, char sep, Fn fn) {
+    size_t start = 0;
+    for (size_t end; (end = str.find(sep, start)) != std::string_view::npos; start = end + 1) {
+        fn(str.substr(start, end - start));
+    }
+    if (start < str.size()) fn(str.substr(start));
 }
 
+static size_t countItems(std::string_view str, char sep) {
+    return static_cast<size_t>(std::count(str.begin(), str.end(), sep)) + 1;
+}
 
-TransmissionPackage str_to_Package(string str) {
+static int view_to_int(std::string_view str) {
+    int value = 0;
+    auto res = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (res.ec != std::errc() || res.ptr == str.data()) throw std::invalid_argument("stoi");
+    return value;
+}
 
-    TransmissionPackage pkg;
-    std::vector<std::string> fields;
-    size_t start = 0, end;
-    while ((end = str.find('#', start)) != std::string::npos) {
-        fields.push_back(str.substr(start, end - start));
-        start = end + 1;
+static uint64_t view_to_u64(std::string_view str) {
+    uint64_t value = 0;
+    auto res = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (res.ec != std::errc() || res.ptr == str.data()) throw std::invalid_argument("stoull");
+    return value;
+}
+
+static void appendInt(std::string &out, long long value) {
+    char buffer[24];
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, res.ptr);
+}
+
+static mpz_class view_to_mpz(std::string_view str, int base) {
+    // mpz_set_str needs a terminated string; scalars of the protocol fit the stack buffer
+    char stack[160];
+    std::string heap;
+    const char *cstr = stack;
+    if (str.size() < sizeof(stack)) {
+        memcpy(stack, str.data(), str.size());
+        stack[str.size()] = '\0';
+    } else {
+        heap.assign(str.data(), str.size());
+        cstr = heap.c_str();
+    }
+    mpz_class value;
+    if (mpz_set_str(value.get_mpz_t(), cstr, base) != 0) throw std::invalid_argument("mpz_set_str");
+    return value;
+}
+
+static void appendMpz(std::string &out, const mpz_class &value, int base) {
+    size_t at = out.size();
+    out.resize(at + mpz_sizeinbase(value.get_mpz_t(), base) + 2);
+    mpz_get_str(&out[at], base, value.get_mpz_t());
+    out.resize(at + strlen(&out[at]));
+}
+
+static void appendECP(std::string &out, ECP ecp, bool compressed = true) {
+    char buffer[2 * 48 + 1];
+    octet O;
+    O.len = 0;
+    O.max = sizeof(buffer);
+    O.val = buffer;
+    ECP_toOctet(&O, &ecp, compressed);
+    appendHex(out, reinterpret_cast<const uint8_t *>(O.val), O.len);
+}
+
+static ECP view_to_ECP(std::string_view str) {
+    ECP ecp;
+    if (str.size() & 1) throw std::invalid_argument("Odd length");
+    char buffer[2 * 48 + 1];
+    if (str.size() / 2 > sizeof(buffer)) throw std::runtime_error("ECP string too long");
+    octet O;
+    O.len = (int) (str.size() / 2);
+    O.max = sizeof(buffer);
+    O.val = buffer;
+    if (!hexDecode(str.data(), str.size() / 2, reinterpret_cast<uint8_t *>(buffer)) ||
+        ECP_fromOctet(&ecp, &O) != 1) {
+        std::cerr << "[Error] Failed to deserialize ECP (point not on curve)." << std::endl;
+        ECP_inf(&ecp);
+    }
+    return ecp;
+}
+
+static void appendECP2(std::string &out, const ECP2 &ecp2, bool compressed) {
+    char buffer[2 * 48 * 2 + 1];
+    octet S;
+    S.val = buffer;
+    S.max = sizeof(buffer);
+    S.len = 0;
+    ECP2_toOctet(&S, const_cast<ECP2 *>(&ecp2), compressed);
+    appendHex(out, reinterpret_cast<const uint8_t *>(S.val), S.len);
+}
+
+static ECP2 view_to_ECP2(std::string_view hex) {
+    ECP2 ecp2;
+    char buffer[2 * 48 * 2 + 1];
+    size_t len = hex.size() / 2;
+    octet S;
+    S.val = buffer;
+    S.max = sizeof(buffer);
+    S.len = (int) len;
+    if (len > sizeof(buffer) || !hexDecode(hex.data(), len, reinterpret_cast<uint8_t *>(buffer)) ||
+        ECP2_fromOctet(&ecp2, &S) != 1) {
+        std::cerr << "Invalid ECP2 point representation." << std::endl;
     }
-    fields.push_back(str.substr(start));
-    if (fields.size() != 15) {
+    return ecp2;
+}
+
+static void appendMpzArr(std::string &out, const std::vector<mpz_class> &mpzs) {
+    for (const auto &value : mpzs) {
+        appendMpz(out, value, 10);
+        out.push_back(',');
+    }
+}
+
+static std::vector<mpz_class> view_to_mpzArr(std::string_view str) {
+    std::vector<mpz_class> mpzs;
+    mpzs.reserve(countItems(str, ','));
+    forEachItem(str, ',', [&mpzs](std::string_view item) { mpzs.push_back(view_to_mpz(item, 0)); });
+    return mpzs;
+}
+
+static void appendECPArr(std::string &out, const std::vector<ECP> &ecps, bool compressed = true) {
+    for (size_t i = 0; i < ecps.size(); ++i) {
+        if (i != 0) out.push_back(';');
+        appendECP(out, ecps[i], compressed);
+    }
+}
+
+static std::vector<ECP> view_to_ECPArr(std::string_view str) {
+    std::vector<ECP> ecps;
+    ecps.reserve(countItems(str, ';'));
+    forEachItem(str, ';', [&ecps](std::string_view item) { ecps.push_back(view_to_ECP(item)); });
+    return ecps;
+}
+
+// Points parsed from a message are written back from their octets, without decompressing them
+static void appendECP2Arr(std::string &out, const ECP2Array &ecp2s, bool compressed) {
+    const uint8_t *octet;
+    size_t length;
+    for (size_t i = 0; i < ecp2s.size(); ++i) {
+        if (i != 0) out.push_back(';');
+        if (compressed && ecp2s.storedOctet(i, octet, length)) appendHex(out, octet, length);
+        else appendECP2(out, ecp2s[i], compressed);
+    }
+}
+
+static std::vector<ECP2> view_to_ECP2Arr(std::string_view str) {
+    std::vector<ECP2> ecp2s;
+    ecp2s.reserve(countItems(str, ';'));
+    forEachItem(str, ';', [&ecp2s](std::string_view item) { ecp2s.push_back(view_to_ECP2(item)); });
+    return ecp2s;
+}
+
+// As view_to_ECP2Arr, but keeps compressed points compressed until they are used (ECP2Array);
+// a list holding anything else is decompressed at once
+static ECP2Array view_to_lazyECP2Arr(std::string_view str) {
+    const size_t octetBytes = ECP2Array::kOctetBytes;
+    std::string octets(countItems(str, ';') * octetBytes, '\0');
+    size_t count = 0;
+    bool compressed = true;
+    forEachItem(str, ';', [&](std::string_view item) {
+        uint8_t *octet = reinterpret_cast<uint8_t *>(&octets[count++ * octetBytes]);
+        if (item.size() == 2 * octetBytes) {
+            compressed = compressed && hexDecode(item.data(), octetBytes, octet) && (octet[0] == 0x02 || octet[0] == 0x03);
+        } else {
+            // "00" is the point at infinity, left as zeros
+            compressed = compressed && item == "00";
+        }
+    });
+    if (!compressed) return view_to_ECP2Arr(str);
+    octets.resize(count * octetBytes);
+    return ECP2Array::fromOctets(std::move(octets), count);
+}
+
+// Upper bound of the text size of a package, so that it is built without reallocation
+static size_t packageTextBytes(const TransmissionPackage &pkg) {
+    const size_t hexScalar = 66, decScalar = 80;
+    return 5 * hexScalar + 32 + (pkg.uav.c1.size() + pkg.uav.c2.size()) * decScalar + 2 * kRegistrySeedBytes;
+}
+
+// n#tm#q#g#beta#M#t#  (the fields before the keys)
+static void appendHead(std::string &out, const TransmissionPackage &pkg) {
+    appendInt(out, pkg.pp.n);
+    out.push_back('#');
+    appendInt(out, pkg.pp.tm);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.q, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.g, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.beta, 16);
+    out.push_back('#');
+
+    appendMpz(out, pkg.M, 16);
+    out.push_back('#');
+    appendInt(out, pkg.t);
+    out.push_back('#');
+}
+
+static void parseHead(const std::string_view *fields, TransmissionPackage &pkg) {
+    pkg.pp.n = view_to_int(fields[0]);
+    pkg.pp.tm = view_to_int(fields[1]);
+    pkg.pp.q = view_to_mpz(fields[2], 16);
+    ECP2_inf(&pkg.pp.P2);
+    pkg.pp.g = view_to_mpz(fields[3], 16);
+    pkg.pp.beta = view_to_mpz(fields[4], 16);
+
+    pkg.M = view_to_mpz(fields[5], 16);
+    pkg.t = view_to_int(fields[6]);
+}
+
+// Registry seed as hex; the parsers expand the registered IDs from it
+static void appendRegistry(std::string &out, const std::string &seed) {
+    if (seed.size() != kRegistrySeedBytes) {
+        throw std::invalid_argument("Package without a registry seed.");
+    }
+    appendHex(out, reinterpret_cast<const uint8_t *>(seed.data()), kRegistrySeedBytes);
+}
+
+static void parseRegistry(std::string_view field, int n, const mpz_class &q,
+                          std::string &seed, std::vector<mpz_class> &ids) {
+    seed.assign(kRegistrySeedBytes, '\0');
+    if (field.size() != 2 * kRegistrySeedBytes ||
+        !hexDecode(field.data(), kRegistrySeedBytes, reinterpret_cast<uint8_t *>(&seed[0]))) {
+        throw std::runtime_error("Invalid registry seed.");
+    }
+    ids = expandRegistry(seed, n, q);
+}
+
+// ID#c1#c2#serial
+static void appendKeys(std::string &out, const UAV &uav) {
+    appendMpz(out, uav.ID, 16);
+    out.push_back('#');
+    appendMpzArr(out, uav.c1);
+    out.push_back('#');
+    appendMpzArr(out, uav.c2);
+    out.push_back('#');
+    appendInt(out, uav.serialNumber);
+}
+
+static void parseKeys(const std::string_view *fields, UAV &uav) {
+    uav.ID = view_to_mpz(fields[0], 16);
+    uav.c1 = view_to_mpzArr(fields[1]);
+    uav.c2 = view_to_mpzArr(fields[2]);
+    uav.serialNumber = view_to_int(fields[3]);
+}
+
+
+// ============================================================
+// Messages
+// ============================================================
+
+std::string Package_to_str(const TransmissionPackage &pkg) {
+    std::string out;
+    out.reserve(packageTextBytes(pkg));
+    appendHead(out, pkg);
+    appendKeys(out, pkg.uav);
+    out.push_back('#');
+    appendRegistry(out, pkg.registrySeed);
+    return out;
+}
+
+
+TransmissionPackage str_to_Package(const std::string &str) {
+    std::string_view fields[12];
+    if (!splitFields(str, '#', fields, 12)) {
         throw std::runtime_error("Invalid transmission package format.");
     }
-    pkg.pp.n = stoi(fields[0]);
-    pkg.pp.tm = stoi(fields[1]);
-    pkg.pp.q = str_to_mpz(fields[2]);
-    pkg.pp.P2 = str_to_ECP2(fields[3]);
-    pkg.pp.g = str_to_mpz(fields[4]);
-    pkg.pp.beta = str_to_mpz(fields[5]);
-    pkg.pp.PK = str_to_ECP2Arr(fields[6]);
+    TransmissionPackage pkg;
+    parseHead(fields, pkg);
+    parseKeys(fields + 7, pkg.uav);
+    parseRegistry(fields[11], pkg.pp.n, pkg.pp.q, pkg.registrySeed, pkg.registeredIDs);
+    return pkg;
+}
 
-    pkg.M = str_to_mpz(fields[7]);
-    pkg.t = stoi(fields[8]);
+std::string Common_to_str(const TransmissionPackage &pkg) {
+    std::string out;
+    out.reserve(packageTextBytes(pkg));
+    appendHead(out, pkg);
+    appendRegistry(out, pkg.registrySeed);
+    return out;
+}
 
-    pkg.uav.ID = str_to_mpz(fields[9]);
-    pkg.uav.c1 = str_to_mpzArr(fields[10]);
-    pkg.uav.c2 = str_to_mpzArr(fields[11]);
-    pkg.uav.PK = str_to_ECP2Arr(fields[12]);
-    pkg.uav.serialNumber = stoi(fields[13]);
-    pkg.registeredIDs = str_to_mpzArr(fields[14]);
+void str_to_Common(const std::string &str, TransmissionPackage &pkg) {
+    std::string_view fields[8];
+    if (!splitFields(str, '#', fields, 8)) {
+        throw std::runtime_error("Invalid common data format.");
+    }
+    parseHead(fields, pkg);
+    parseRegistry(fields[7], pkg.pp.n, pkg.pp.q, pkg.registrySeed, pkg.registeredIDs);
+}
+
+std::string Keys_to_str(const UAV &uav) {
+    std::string out;
+    appendKeys(out, uav);
+    return out;
+}
+
+UAV str_to_Keys(const std::string &str) {
+    std::string_view fields[4];
+    if (!splitFields(str, '#', fields, 4)) {
+        throw std::runtime_error("Invalid key package format.");
+    }
+    UAV uav;
+    parseKeys(fields, uav);
+    return uav;
+}
 
+// n#tm#q#g#beta#M#t#ID#alpha
+std::string HeadPackage_to_str(const HeadPackage &pkg) {
+    std::string out;
+    out.reserve(7 * 66 + 32);
+    appendInt(out, pkg.pp.n);
+    out.push_back('#');
+    appendInt(out, pkg.pp.tm);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.q, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.g, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.beta, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.M, 16);
+    out.push_back('#');
+    appendInt(out, pkg.t);
+    out.push_back('#');
+    appendMpz(out, pkg.uavh.ID, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.uavh.alpha, 16);
+    return out;
+}
+
+HeadPackage str_to_HeadPackage(const std::string &str) {
+    std::string_view fields[9];
+    if (!splitFields(str, '#', fields, 9)) {
+        throw std::runtime_error("Invalid head package format.");
+    }
+    HeadPackage pkg;
+    pkg.pp.n = view_to_int(fields[0]);
+    pkg.pp.tm = view_to_int(fields[1]);
+    pkg.pp.q = view_to_mpz(fields[2], 16);
+    ECP2_inf(&pkg.pp.P2);
+    pkg.pp.g = view_to_mpz(fields[3], 16);
+    pkg.pp.beta = view_to_mpz(fields[4], 16);
+    pkg.M = view_to_mpz(fields[5], 16);
+    pkg.t = view_to_int(fields[6]);
+    pkg.uavh.ID = view_to_mpz(fields[7], 16);
+    pkg.uavh.alpha = view_to_mpz(fields[8], 16);
+    return pkg;
+}
+
+// n#tm#q#P2#g#beta#M#t#PK[t-2]#PK_s#seed
+std::string VerifierPackage_to_str(const VerifierPackage &pkg) {
+    if (pkg.t < 2 || static_cast<size_t>(pkg.t - 2) >= pkg.pp.PK.size()) {
+        throw std::invalid_argument("Verifier package without PK[t - 2].");
+    }
+    const size_t point = 2 * ECP2Array::kOctetBytes + 1;
+    std::string out;
+    out.reserve(5 * 66 + 32 + (2 + pkg.PK_s.size()) * point + 2 * kRegistrySeedBytes);
+    appendInt(out, pkg.pp.n);
+    out.push_back('#');
+    appendInt(out, pkg.pp.tm);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.q, 16);
+    out.push_back('#');
+    appendECP2(out, pkg.pp.P2, true);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.g, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.pp.beta, 16);
+    out.push_back('#');
+    appendMpz(out, pkg.M, 16);
+    out.push_back('#');
+    appendInt(out, pkg.t);
+    out.push_back('#');
+    appendECP2(out, pkg.pp.PK[pkg.t - 2], true);
+    out.push_back('#');
+    appendECP2Arr(out, pkg.PK_s, true);
+    out.push_back('#');
+    appendRegistry(out, pkg.registrySeed);
+    return out;
+}
+
+VerifierPackage str_to_VerifierPackage(const std::string &str) {
+    std::string_view fields[11];
+    if (!splitFields(str, '#', fields, 11)) {
+        throw std::runtime_error("Invalid verifier package format.");
+    }
+    VerifierPackage pkg;
+    pkg.pp.n = view_to_int(fields[0]);
+    pkg.pp.tm = view_to_int(fields[1]);
+    pkg.pp.q = view_to_mpz(fields[2], 16);
+    pkg.pp.P2 = view_to_ECP2(fields[3]);
+    pkg.pp.g = view_to_mpz(fields[4], 16);
+    pkg.pp.beta = view_to_mpz(fields[5], 16);
+    pkg.M = view_to_mpz(fields[6], 16);
+    pkg.t = view_to_int(fields[7]);
+    if (pkg.t < 2 || pkg.t > pkg.pp.tm) {
+        throw std::runtime_error("Invalid verifier package format.");
+    }
+    ECP2 infinity;
+    ECP2_inf(&infinity);
+    pkg.pp.PK = ECP2Array(pkg.pp.tm - 1, infinity);
+    pkg.pp.PK.set(pkg.t - 2, view_to_ECP2(fields[8]));
+    pkg.PK_s = view_to_lazyECP2Arr(fields[9]);
+    parseRegistry(fields[10], pkg.pp.n, pkg.pp.q, pkg.registrySeed, pkg.registeredIDs);
     return pkg;
 }
 
@@ -73,7 +453,8 @@ void showPackage(TransmissionPackage pkg) {
     cout << "PK (" << pkg.pp.PK.size() << " items):" << endl;
     for (size_t i = 0; i < pkg.pp.PK.size(); i++) {
         cout << "  PK[" << i << "]: ";
-        ECP2_output(&pkg.pp.PK[i]);
+        ECP2 point = pkg.pp.PK[i];
+        ECP2_output(&point);
     }
 
     cout << "M: ";
@@ -92,7 +473,8 @@ void showPackage(TransmissionPackage pkg) {
     }
     cout << "uav.PK (" << pkg.uav.PK.size() << " items):" << endl;
     for (size_t i = 0; i < pkg.uav.PK.size(); i++) {
-        ECP2_output(&pkg.uav.PK[i]);
+        ECP2 point = pkg.uav.PK[i];
+        ECP2_output(&point);
     }
     cout << "==================" << endl;
 }
@@ -100,33 +482,26 @@ void showPackage(TransmissionPackage pkg) {
 
 
 std::string parSig_to_str(const parSig &sig) {
-    std::ostringstream oss;
-    oss << mpz_to_str(sig.cj) << "#"
-        << ECP_to_str(sig.sig) << "#"
-        << sig.index;
-    return oss.str();
+    std::string out;
+    appendMpz(out, sig.cj, 16);
+    out.push_back('#');
+    appendECP(out, sig.sig);
+    out.push_back('#');
+    appendInt(out, sig.index);
+    return out;
 }
 
 parSig str_to_parSig(const std::string &str) {
-    parSig sig;
-
-    std::vector<std::string> fields;
-    size_t start = 0, end;
-
-    while ((end = str.find('#', start)) != std::string::npos) {
-        fields.push_back(str.substr(start, end - start));
-        start = end + 1;
-    }
-    fields.push_back(str.substr(start));
-
-    if (fields.size() != 3) {
+    std::string_view fields[3];
+    if (!splitFields(str, '#', fields, 3)) {
         throw std::runtime_error("Invalid parSig format.");
     }
 
-    sig.cj = str_to_mpz(fields[0]);
-    sig.sig = str_to_ECP(fields[1]);
+    parSig sig;
+    sig.cj = view_to_mpz(fields[0], 16);
+    sig.sig = view_to_ECP(fields[1]);
     try {
-        sig.index = static_cast<short>(std::stoi(fields[2]));
+        sig.index = static_cast<short>(view_to_int(fields[2]));
     } catch (...) {
         throw std::runtime_error("Invalid index format in parSig.");
     }
@@ -148,49 +523,39 @@ void showParSig(parSig& sig) {
     cout << "-------------------------" << endl;
 }
 
-std::string Sigma_to_str(const Sigma &sg) {
-    std::ostringstream oss;
-    oss << mpzArr_to_str(sg.aux) << "#";
-    oss << ECPArr_to_str(sg.sig) << "#";
+std::string Sigma_to_str(const Sigma &sg, bool compressed) {
+    std::string out;
+    out.reserve(sg.aux.size() * 80 + sg.sig.size() * (2 * (compressed ? 48 + 1 : 2 * 48 + 1) + 1)
+                + sg.indices.size() * 6 + 2);
+    appendMpzArr(out, sg.aux);
+    out.push_back('#');
+    appendECPArr(out, sg.sig, compressed);
+    out.push_back('#');
 
     for (size_t i = 0; i < sg.indices.size(); ++i) {
-        oss << sg.indices[i];
-        if (i != sg.indices.size() - 1) {
-            oss << ",";
-        }
+        if (i != 0) out.push_back(',');
+        appendInt(out, sg.indices[i]);
     }
 
-    return oss.str();
+    return out;
 }
 
 Sigma str_to_Sigma(const std::string &str) {
-    Sigma sg;
-    std::vector<std::string> fields;
-    size_t start = 0, end;
-
-    while ((end = str.find('#', start)) != std::string::npos) {
-        fields.push_back(str.substr(start, end - start));
-        start = end + 1;
-    }
-    fields.push_back(str.substr(start));
-
-    if (fields.size() != 3) {
+    std::string_view fields[3];
+    if (!splitFields(str, '#', fields, 3)) {
         throw std::runtime_error("Invalid Sigma format.");
     }
 
-    sg.aux = str_to_mpzArr(fields[0]);
-    sg.sig = str_to_ECPArr(fields[1]);
-    std::string indicesStr = fields[2];
-    if (!indicesStr.empty()) {
-        std::stringstream ss(indicesStr);
-        std::string item;
-        while (std::getline(ss, item, ',')) {
-            if (!item.empty()) {
-                // string -> int -> short
-                sg.indices.push_back(static_cast<short>(std::stoi(item)));
-            }
+    Sigma sg;
+    sg.aux = view_to_mpzArr(fields[0]);
+    sg.sig = view_to_ECPArr(fields[1]);
+    sg.indices.reserve(countItems(fields[2], ','));
+    forEachItem(fields[2], ',', [&sg](std::string_view item) {
+        if (!item.empty()) {
+            // string -> int -> short
+            sg.indices.push_back(static_cast<short>(view_to_int(item)));
         }
-    }
+    });
 
     return sg;
 }
@@ -217,75 +582,146 @@ void showSigma(Sigma& sigma) {
     cout << "============================" << endl;
 }
 
+std::string SigmaShare_to_str(const SigmaShare &share, bool compressed) {
+    std::string out;
+    appendMpz(out, share.aux, 16);
+    out.push_back('#');
+    appendECP(out, share.sig, compressed);
+    out.push_back('#');
+    appendInt(out, share.index);
+    return out;
+}
+
+SigmaShare str_to_SigmaShare(const std::string &str) {
+    std::string_view fields[3];
+    if (!splitFields(str, '#', fields, 3)) {
+        throw std::runtime_error("Invalid SigmaShare format.");
+    }
+
+    SigmaShare share;
+    share.aux = view_to_mpz(fields[0], 16);
+    share.sig = view_to_ECP(fields[1]);
+    try {
+        share.index = static_cast<short>(view_to_int(fields[2]));
+    } catch (...) {
+        throw std::runtime_error("Invalid index format in SigmaShare.");
+    }
+    return share;
+}
+
+std::string Health_to_str(const std::vector<PeerHealth> &health) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < health.size(); ++i) {
+        if (i != 0) oss << ",";
+        oss << (health[i].alive ? 1 : 0) << ":" << health[i].ewma;
+    }
+    return oss.str();
+}
+
+std::vector<PeerHealth> str_to_Health(const std::string &str) {
+    std::vector<PeerHealth> health;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error("Invalid health entry.");
+        }
+        PeerHealth h;
+        h.alive = item.substr(0, colon) == "1";
+        h.ewma = std::stod(item.substr(colon + 1));
+        health.push_back(h);
+    }
+    return health;
+}
+
+std::string SplitKey_to_str(const SplitKey &key) {
+    std::string out;
+    appendMpz(out, key.gt, 16);
+    out.push_back('#');
+    appendMpz(out, key.stk, 16);
+    out.push_back('#');
+    appendInt(out, key.shares);
+    out.push_back('#');
+    appendInt(out, key.k);
+    out.push_back('#');
+    appendInt(out, key.first);
+    out.push_back('#');
+    appendInt(out, key.end);
+    return out;
+}
+
+SplitKey str_to_SplitKey(const std::string &str) {
+    std::string_view fields[6];
+    if (!splitFields(str, '#', fields, 6)) {
+        throw std::runtime_error("Invalid split key format.");
+    }
+    SplitKey key;
+    key.gt = view_to_mpz(fields[0], 16);
+    key.stk = view_to_mpz(fields[1], 16);
+    key.shares = view_to_int(fields[2]);
+    key.k = view_to_int(fields[3]);
+    key.first = view_to_int(fields[4]);
+    key.end = view_to_int(fields[5]);
+    return key;
+}
+
+std::string SplitOrder_to_str(const SplitOrder &order) {
+    std::string out;
+    appendInt(out, order.k);
+    out.push_back('#');
+    appendInt(out, static_cast<long long>(order.issued));
+    out.push_back('#');
+    appendMpz(out, order.gt, 16);
+    out.push_back('#');
+    appendMpz(out, order.s, 16);
+    return out;
+}
+
+SplitOrder str_to_SplitOrder(const std::string &str) {
+    std::string_view fields[4];
+    if (!splitFields(str, '#', fields, 4)) {
+        throw std::runtime_error("Invalid split order format.");
+    }
+    SplitOrder order;
+    order.k = view_to_int(fields[0]);
+    order.issued = view_to_u64(fields[1]);
+    order.gt = view_to_mpz(fields[2], 16);
+    order.s = view_to_mpz(fields[3], 16);
+    return order;
+}
+
 // ----------------------------------------------------------------------------
 
 std::string mpz_to_str(const mpz_class &value) {
-    return value.get_str(16);
+    std::string out;
+    appendMpz(out, value, 16);
+    return out;
 }
 
 mpz_class str_to_mpz(const string &str) {
-    return mpz_class(str, 16);
+    return view_to_mpz(str, 16);
 }
 
-std::string ECP_to_str(ECP ecp) {
-    char buffer[64];
-    octet O;
-    O.len = 0;
-    O.max = sizeof(buffer);
-    O.val = buffer;
-    ECP_toOctet(&O, &ecp, true);
-    std::string binaryData(O.val, O.len);
-    return binToHex(binaryData);
+std::string ECP_to_str(ECP ecp, bool compressed) {
+    std::string out;
+    appendECP(out, ecp, compressed);
+    return out;
 }
 
 ECP str_to_ECP(const std::string &str) {
-    ECP ecp;
-    std::string binaryData = hexToBin(str);
-    char buffer[64];
-    if(binaryData.size() > 64) throw std::runtime_error("ECP string too long");
-    memcpy(buffer, binaryData.data(), binaryData.size());
-    octet O;
-    O.len = (int)binaryData.size();
-    O.max = sizeof(buffer);
-    O.val = buffer;
-    if (ECP_fromOctet(&ecp, &O) != 1) {
-        std::cerr << "[Error] Failed to deserialize ECP (point not on curve)." << std::endl;
-        ECP_inf(&ecp);
-    }
-    return ecp;
+    return view_to_ECP(str);
 }
 
 std::string ECP2_to_str(ECP2 ecp2, bool compressed) {
-    char buffer[2 * 48 * 2];
-    octet S;
-    S.val = buffer;
-    S.max = sizeof(buffer);
-    S.len = 0;
-    ECP2_toOctet(&S, const_cast<ECP2 *>(&ecp2), compressed);
-    std::string hex_string;
-    for (int i = 0; i < S.len; i++) {
-        char hex[3];
-        sprintf(hex, "%02X", (unsigned char) S.val[i]);
-        hex_string.append(hex);
-    }
-    return hex_string;
+    std::string out;
+    appendECP2(out, ecp2, compressed);
+    return out;
 }
 
 ECP2 str_to_ECP2(const std::string &hex_string) {
-    ECP2 ecp2;
-    size_t len = hex_string.length() / 2;
-    char buffer[len];
-    for (size_t i = 0; i < len; i++) {
-        sscanf(hex_string.substr(i * 2, 2).c_str(), "%2hhX", &buffer[i]);
-    }
-    octet S;
-    S.val = buffer;
-    S.max = len;
-    S.len = len;
-    if (ECP2_fromOctet(&ecp2, &S) != 1) {
-        std::cerr << "Invalid ECP2 point representation." << std::endl;
-    }
-    return ecp2;
+    return view_to_ECP2(hex_string);
 }
 
 
@@ -296,120 +732,52 @@ std::string FP12_to_str(FP12 fp12) {
     S.max = sizeof(buffer);
     S.len = 0;
     FP12_toOctet(&S, const_cast<FP12 *>(&fp12));
-    std::string hex_string;
-    for (int i = 0; i < S.len; i++) {
-        char hex[3];
-        sprintf(hex, "%02X", (unsigned char) S.val[i]);
-        hex_string.append(hex);
-    }
-    return hex_string;
+    std::string out;
+    appendHex(out, reinterpret_cast<const uint8_t *>(S.val), S.len);
+    return out;
 }
 
 FP12 str_to_FP12(const std::string &hex_string) {
     FP12 fp12;
-    size_t len = hex_string.length() / 2;
-    char buffer[len];
-    for (size_t i = 0; i < len; i++) {
-        sscanf(hex_string.substr(i * 2, 2).c_str(), "%2hhX", &buffer[i]);
-    }
+    char buffer[24 * 48];
+    size_t len = std::min(hex_string.length() / 2, sizeof(buffer));
+    hexDecode(hex_string.data(), len, reinterpret_cast<uint8_t *>(buffer));
     octet S;
     S.val = buffer;
-    S.max = len;
-    S.len = len;
+    S.max = sizeof(buffer);
+    S.len = (int) len;
     FP12_fromOctet(&fp12, &S);
     return fp12;
 }
 
 std::string mpzArr_to_str(const std::vector<mpz_class> &mpzs) {
-    string str;
-    for (int i = 0; i < mpzs.size(); i++) {
-        str += mpzs[i].get_str() + ",";
-    }
-    return str;
+    std::string out;
+    appendMpzArr(out, mpzs);
+    return out;
 }
 
 std::vector<mpz_class> str_to_mpzArr(const std::string &str) {
-    vector<mpz_class> mpzs;
-    stringstream ss(str);
-    string item;
-    while (getline(ss, item, ',')) {
-        mpzs.push_back(mpz_class(item));
-    }
-    return mpzs;
+    return view_to_mpzArr(str);
 }
 
 std::string ECPArr_to_str(const std::vector<ECP> &ecps) {
-    std::ostringstream oss;
-    for (size_t i = 0; i < ecps.size(); ++i) {
-        if (i != 0) oss << ";";
-        oss << ECP_to_str(ecps[i]);
-    }
-    return oss.str();
+    std::string out;
+    appendECPArr(out, ecps);
+    return out;
 }
 
 std::vector<ECP> str_to_ECPArr(const std::string &str) {
-    std::vector<ECP> ecps;
-    size_t start = 0;
-    size_t end = str.find(';');
-    while (end != std::string::npos) {
-        ecps.emplace_back(str_to_ECP(str.substr(start, end - start))); // 直接构造 ECP
-        start = end + 1;
-        end = str.find(';', start);
-    }
-    if (start < str.size()) {
-        ecps.emplace_back(str_to_ECP(str.substr(start)));
-    }
-    return ecps;
+    return view_to_ECPArr(str);
 }
 
 
 std::string ECP2Arr_to_str(const std::vector<ECP2> &ecp2s, bool compressed) {
-    std::ostringstream oss;
-    for (size_t i = 0; i < ecp2s.size(); ++i) {
-        if (i != 0) oss << ";";
-        oss << ECP2_to_str(ecp2s[i], compressed);
-    }
-    return oss.str();
+    std::string out;
+    out.reserve(ecp2s.size() * (2 * (compressed ? 2 * 48 + 1 : 4 * 48 + 1) + 1));
+    appendECP2Arr(out, ECP2Array(ecp2s), compressed);
+    return out;
 }
 
 vector<ECP2> str_to_ECP2Arr(const std::string &str) {
-    std::vector<ECP2> ecp2s;
-    size_t start = 0;
-    size_t end = str.find(';');
-    while (end != std::string::npos) {
-        ecp2s.emplace_back(str_to_ECP2(str.substr(start, end - start))); // 直接构造 ECP
-        start = end + 1;
-        end = str.find(';', start);
-    }
-    if (start < str.size()) {
-        ecp2s.emplace_back(str_to_ECP2(str.substr(start)));
-    }
-    return ecp2s;
+    return view_to_ECP2Arr(str);
 }
-
-
-static std::string binToHex(const std::string& input) {
-    static const char* const lut = "0123456789ABCDEF";
-    size_t len = input.length();
-    std::string output;
-    output.reserve(2 * len);
-    for (size_t i = 0; i < len; ++i) {
-        const unsigned char c = input[i];
-        output.push_back(lut[c >> 4]);
-        output.push_back(lut[c & 15]);
-    }
-    return output;
-}
-
-static std::string hexToBin(const std::string& input) {
-    size_t len = input.length();
-    if (len & 1) throw std::invalid_argument("Odd length");
-    std::string output;
-    output.reserve(len / 2);
-    for (size_t i = 0; i < len; i += 2) {
-        std::string byteString = input.substr(i, 2);
-        char byte = (char)strtol(byteString.c_str(), NULL, 16);
-        output.push_back(byte);
-    }
-    return output;
-}
\ No newline at end of file
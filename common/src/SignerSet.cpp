@@ -0,0 +1,182 @@
+#include "../include/SignerSet.h"
+
+#include <algorithm>
+
+static void appendVarint(std::string &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static size_t varintBytes(uint64_t value) {
+    size_t bytes = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++bytes;
+    }
+    return bytes;
+}
+
+static bool readVarint(const std::string &in, size_t &at, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && at < in.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(in[at++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// Count followed by the gaps between consecutive indices of a sorted list
+static void appendGaps(std::string &out, const std::vector<int> &sorted) {
+    appendVarint(out, sorted.size());
+    int next = 0;
+    for (int index : sorted) {
+        appendVarint(out, static_cast<uint64_t>(index - next));
+        next = index + 1;
+    }
+}
+
+static size_t gapBytes(const std::vector<int> &sorted) {
+    size_t bytes = varintBytes(sorted.size());
+    int next = 0;
+    for (int index : sorted) {
+        bytes += varintBytes(static_cast<uint64_t>(index - next));
+        next = index + 1;
+    }
+    return bytes;
+}
+
+static bool readGaps(const std::string &in, size_t &at, int n, std::vector<int> &out) {
+    uint64_t count;
+    if (!readVarint(in, at, count) || count > static_cast<uint64_t>(n)) return false;
+    out.clear();
+    out.reserve(count);
+    uint64_t next = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t gap;
+        if (!readVarint(in, at, gap) || gap >= static_cast<uint64_t>(n) - next) return false;
+        out.push_back(static_cast<int>(next + gap));
+        next += gap + 1;
+    }
+    return true;
+}
+
+static std::vector<int> complementOf(const std::vector<int> &sorted, int n) {
+    std::vector<int> missing;
+    missing.reserve(n - sorted.size());
+    size_t j = 0;
+    for (int i = 0; i < n; ++i) {
+        if (j < sorted.size() && sorted[j] == i) ++j;
+        else missing.push_back(i);
+    }
+    return missing;
+}
+
+std::string encodeSignerSet(const std::vector<int> &S, int n, SignerSetKind kind) {
+    std::vector<int> sorted(S);
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string out;
+    out.push_back(static_cast<char>(kind));
+    appendVarint(out, static_cast<uint64_t>(n));
+    if (kind == SIGNERS_LIST) {
+        appendGaps(out, sorted);
+    } else if (kind == SIGNERS_COMPLEMENT) {
+        appendGaps(out, complementOf(sorted, n));
+    } else {
+        size_t at = out.size();
+        out.append((n + 7) / 8, '\0');
+        for (int index : sorted) out[at + index / 8] = static_cast<char>(out[at + index / 8] | (1 << (index % 8)));
+    }
+    return out;
+}
+
+std::string encodeSignerSet(const std::vector<int> &S, int n) {
+    std::vector<int> sorted(S);
+    std::sort(sorted.begin(), sorted.end());
+
+    size_t bitmap = (n + 7) / 8;
+    size_t list = gapBytes(sorted);
+    // Only sets of more than half the swarm can have a shorter complement
+    size_t complement = 2 * sorted.size() > static_cast<size_t>(n) ? gapBytes(complementOf(sorted, n)) : SIZE_MAX;
+
+    SignerSetKind kind = SIGNERS_BITMAP;
+    if (list <= bitmap && list <= complement) kind = SIGNERS_LIST;
+    else if (complement < bitmap) kind = SIGNERS_COMPLEMENT;
+    return encodeSignerSet(sorted, n, kind);
+}
+
+bool decodeSignerSet(const std::string &encoded, int n, std::vector<int> &S) {
+    size_t at = 1;
+    uint64_t count;
+    // The universe comes off the wire: only the receiver's own n sizes the set
+    if (encoded.empty() || !readVarint(encoded, at, count) || n < 0 || count != static_cast<uint64_t>(n)) return false;
+    int universe = n;
+
+    switch (static_cast<uint8_t>(encoded[0])) {
+        case SIGNERS_LIST:
+            return readGaps(encoded, at, universe, S) && at == encoded.size();
+
+        case SIGNERS_COMPLEMENT: {
+            std::vector<int> missing;
+            if (!readGaps(encoded, at, universe, missing) || at != encoded.size()) return false;
+            S.clear();
+            S.reserve(universe - missing.size());
+            size_t j = 0;
+            for (int i = 0; i < universe; ++i) {
+                if (j < missing.size() && missing[j] == i) ++j;
+                else S.push_back(i);
+            }
+            return true;
+        }
+
+        case SIGNERS_BITMAP: {
+            size_t bytes = (static_cast<size_t>(universe) + 7) / 8;
+            if (encoded.size() - at != bytes) return false;
+            const uint8_t *bits = reinterpret_cast<const uint8_t *>(encoded.data()) + at;
+            S.clear();
+            // 64 bits at a time, jumping from one set bit to the next
+            for (size_t base = 0; base < bytes; base += 8) {
+                uint64_t word = 0;
+                for (size_t k = 0; k < 8 && base + k < bytes; ++k) {
+                    word |= static_cast<uint64_t>(bits[base + k]) << (8 * k);
+                }
+                while (word != 0) {
+                    int index = static_cast<int>(8 * base) + __builtin_ctzll(word);
+                    if (index >= universe) return false;
+                    S.push_back(index);
+                    word &= word - 1;
+                }
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+SignerSetKind signerSetKind(const std::string &encoded) {
+    return encoded.empty() ? SIGNERS_BITMAP : static_cast<SignerSetKind>(encoded[0]);
+}
+
+const char *signerSetKindName(SignerSetKind kind) {
+    switch (kind) {
+        case SIGNERS_LIST: return "list";
+        case SIGNERS_COMPLEMENT: return "complement";
+        default: return "bitmap";
+    }
+}
+
+int signerRank(const std::vector<int> &S, int index) {
+    auto it = std::lower_bound(S.begin(), S.end(), index);
+    return it != S.end() && *it == index ? static_cast<int>(it - S.begin()) : -1;
+}
+
+int countSigners(const std::vector<int> &S, int first, int end) {
+    if (end <= first) return 0;
+    return static_cast<int>(std::lower_bound(S.begin(), S.end(), end) - std::lower_bound(S.begin(), S.end(), first));
+}
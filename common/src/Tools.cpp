@@ -300,6 +300,22 @@ void hashZp256(BIG res, octet *ct, BIG q) {
     BIG_mod(res, q);
 }
 
+string sha256Hex(const string &data) {
+    hash256 h;
+    char digest[32];
+    HASH256_init(&h);
+    for (char c : data) {
+        HASH256_process(&h, static_cast<unsigned char>(c));
+    }
+    HASH256_hash(&h, digest);
+
+    std::ostringstream oss;
+    for (char c : digest) {
+        oss << std::hex << std::setw(2) << std::setfill('0') << (static_cast<unsigned>(c) & 0xff);
+    }
+    return oss.str();
+}
+
 void hashToZp256(BIG res, BIG beHashed, BIG q) {
     char idChar[48];
     BIG_toBytes(idChar, beHashed);
@@ -0,0 +1,753 @@
+#include "../include/WireFormat.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+static bool binaryFormat = true;
+
+// Flags in the top bits of a compressed x coordinate (a BLS12-381 field element uses 381 of 384 bits)
+static const uint8_t kFlagSign = 0x20;
+static const uint8_t kFlagInfinity = 0x40;
+static const uint8_t kFlagUncompressed = 0x80;   // y follows x
+static const uint8_t kFlagMask = 0xE0;
+
+static const uint16_t kHealthNever = 0xFFFF;
+
+void setWireFormat(const std::string &name) {
+    if (name == "binary") {
+        binaryFormat = true;
+    } else if (name == "text") {
+        binaryFormat = false;
+    } else {
+        std::cerr << "[WireFormat] Unknown WIRE_FORMAT '" << name << "', using binary" << std::endl;
+        binaryFormat = true;
+    }
+}
+
+bool wireBinary() {
+    return binaryFormat;
+}
+
+bool isWireBinary(const std::string &msg, size_t pos) {
+    return pos < msg.size() && static_cast<uint8_t>(msg[pos]) == kWireVersion;
+}
+
+
+// ============================================================
+// Writer
+// ============================================================
+
+void WireWriter::header(WireType type) {
+    u8(kWireVersion);
+    u8(type);
+}
+
+void WireWriter::u8(uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void WireWriter::varint(uint64_t value) {
+    while (value >= 0x80) {
+        u8(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    u8(static_cast<uint8_t>(value));
+}
+
+void WireWriter::scalar(const mpz_class &value) {
+    size_t count = (mpz_sizeinbase(value.get_mpz_t(), 2) + 7) / 8;
+    if (value < 0 || count > kWireScalarBytes) {
+        throw std::runtime_error("Scalar does not fit the wire format.");
+    }
+    uint8_t bytes[kWireScalarBytes] = {0};
+    if (value != 0) mpz_export(bytes + kWireScalarBytes - count, nullptr, 1, 1, 1, 0, value.get_mpz_t());
+    out.append(reinterpret_cast<const char *>(bytes), kWireScalarBytes);
+}
+
+void WireWriter::scalarBytes(const uint8_t *bytes, size_t length) {
+    size_t skip = 0;
+    while (length - skip > kWireScalarBytes) {
+        if (bytes[skip++] != 0) throw std::runtime_error("Scalar does not fit the wire format.");
+    }
+    out.append(kWireScalarBytes - (length - skip), '\0');
+    out.append(reinterpret_cast<const char *>(bytes + skip), length - skip);
+}
+
+void WireWriter::scalars(const std::vector<mpz_class> &values) {
+    varint(values.size());
+    for (const auto &value : values) scalar(value);
+}
+
+// Writes the x coordinate of a MIRACL compressed octet with the sign in its top bits
+static void appendCompressed(std::string &out, const char *octet, int length, size_t xBytes) {
+    if (length == static_cast<int>(xBytes) + 1) {
+        size_t at = out.size();
+        out.append(octet + 1, xBytes);
+        if (octet[0] == 0x03) out[at] = static_cast<char>(out[at] | kFlagSign);
+    } else {
+        // Point at infinity
+        out.push_back(static_cast<char>(kFlagInfinity));
+        out.append(xBytes - 1, '\0');
+    }
+}
+
+// Writes x and y of a MIRACL uncompressed octet (0x04, x, y), flagged in the top bits of x
+static void appendUncompressed(std::string &out, const char *octet, size_t xBytes) {
+    size_t at = out.size();
+    out.append(octet + 1, 2 * xBytes);
+    out[at] = static_cast<char>(out[at] | kFlagUncompressed);
+}
+
+void WireWriter::g1(const ECP &point) {
+    char buffer[2 * kWireG1Bytes + 1];
+    octet O;
+    O.val = buffer;
+    O.max = sizeof(buffer);
+    O.len = 0;
+    ECP copy = point;
+    if (ECP_isinf(&copy)) {
+        O.len = 1;
+    } else if (!compressedPoints) {
+        ECP_toOctet(&O, &copy, false);
+        appendUncompressed(out, buffer, kWireG1Bytes);
+        return;
+    } else {
+        ECP_toOctet(&O, &copy, true);
+    }
+    appendCompressed(out, buffer, O.len, kWireG1Bytes);
+}
+
+void WireWriter::g2(const ECP2 &point) {
+    char buffer[2 * kWireG2Bytes + 1];
+    octet S;
+    S.val = buffer;
+    S.max = sizeof(buffer);
+    S.len = 0;
+    ECP2 copy = point;
+    if (ECP2_isinf(&copy)) {
+        S.len = 1;
+    } else if (!compressedPoints) {
+        ECP2_toOctet(&S, &copy, false);
+        appendUncompressed(out, buffer, kWireG2Bytes);
+        return;
+    } else {
+        ECP2_toOctet(&S, &copy, true);
+    }
+    appendCompressed(out, buffer, S.len, kWireG2Bytes);
+}
+
+void WireWriter::g2Octet(const uint8_t *octet, size_t length) {
+    appendCompressed(out, reinterpret_cast<const char *>(octet), static_cast<int>(length), kWireG2Bytes);
+}
+
+void WireWriter::g1s(const std::vector<ECP> &points) {
+    varint(points.size());
+    for (const auto &point : points) g1(point);
+}
+
+void WireWriter::g2s(const ECP2Array &points) {
+    varint(points.size());
+    const uint8_t *octet;
+    size_t length;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (compressedPoints && points.storedOctet(i, octet, length)) g2Octet(octet, length);
+        else g2(points[i]);
+    }
+}
+
+void WireWriter::indices(const std::vector<short> &values) {
+    uint8_t width = 1;
+    for (short value : values) {
+        if (value < 0) throw std::runtime_error("Negative signer index.");
+        while ((value >> width) != 0) ++width;
+    }
+    varint(values.size());
+    u8(width);
+    std::string packed((values.size() * width + 7) / 8, '\0');
+    size_t bit = 0;
+    for (short value : values) {
+        for (uint8_t j = 0; j < width; ++j, ++bit) {
+            if ((value >> j) & 1) packed[bit / 8] = static_cast<char>(packed[bit / 8] | (1 << (bit % 8)));
+        }
+    }
+    out += packed;
+}
+
+void WireWriter::raw(const std::string &bytes) {
+    out += bytes;
+}
+
+void WireWriter::keys(const UAV &uav) {
+    header(WIRE_KEYS);
+    scalar(uav.ID);
+    scalars(uav.c1);
+    scalars(uav.c2);
+    varint(static_cast<uint64_t>(uav.serialNumber));
+}
+
+
+// ============================================================
+// Reader
+// ============================================================
+
+WireReader::WireReader(const std::string &msg, size_t pos) : msg(msg), at(pos) {}
+
+const uint8_t *WireReader::take(size_t count) {
+    if (at > msg.size() || count > msg.size() - at) {
+        throw std::runtime_error("Truncated binary message.");
+    }
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(msg.data()) + at;
+    at += count;
+    return p;
+}
+
+// A count of elements taking at least minBytes each, checked against the bytes left
+uint64_t WireReader::count(size_t minBytes) {
+    uint64_t value = varint();
+    if (minBytes != 0 && value > (msg.size() - at) / minBytes) {
+        throw std::runtime_error("Element count exceeds the binary message.");
+    }
+    return value;
+}
+
+void WireReader::header(WireType type) {
+    if (u8() != kWireVersion) throw std::runtime_error("Unsupported wire format version.");
+    if (u8() != type) throw std::runtime_error("Unexpected binary message type.");
+}
+
+uint8_t WireReader::u8() {
+    return *take(1);
+}
+
+uint64_t WireReader::varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = u8();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("Invalid varint.");
+}
+
+mpz_class WireReader::scalar() {
+    mpz_class value;
+    mpz_import(value.get_mpz_t(), kWireScalarBytes, 1, 1, 1, 0, take(kWireScalarBytes));
+    return value;
+}
+
+std::string WireReader::bytes(size_t count) {
+    return std::string(reinterpret_cast<const char *>(take(count)), count);
+}
+
+std::vector<mpz_class> WireReader::scalars() {
+    std::vector<mpz_class> values(count(kWireScalarBytes));
+    for (auto &value : values) value = scalar();
+    return values;
+}
+
+// Rebuilds the MIRACL compressed octet; returns false for the point at infinity
+static bool readCompressed(const uint8_t *src, size_t xBytes, char *octet) {
+    if (src[0] & kFlagInfinity) return false;
+    octet[0] = (src[0] & kFlagSign) ? 0x03 : 0x02;
+    memcpy(octet + 1, src, xBytes);
+    octet[1] = static_cast<char>(src[0] & ~kFlagMask);
+    return true;
+}
+
+// Rebuilds the MIRACL octet of a point whose x was just read: uncompressed (y follows x)
+// or compressed; returns its length, 0 for the point at infinity
+int WireReader::pointOctet(const uint8_t *x, size_t xBytes, char *octet) {
+    if ((x[0] & kFlagUncompressed) == 0) return readCompressed(x, xBytes, octet) ? static_cast<int>(xBytes) + 1 : 0;
+    octet[0] = 0x04;
+    memcpy(octet + 1, x, xBytes);
+    octet[1] = static_cast<char>(x[0] & ~kFlagMask);
+    memcpy(octet + 1 + xBytes, take(xBytes), xBytes);
+    return static_cast<int>(2 * xBytes) + 1;
+}
+
+ECP WireReader::g1() {
+    ECP point;
+    char buffer[2 * kWireG1Bytes + 1];
+    int length = pointOctet(take(kWireG1Bytes), kWireG1Bytes, buffer);
+    if (length == 0) {
+        ECP_inf(&point);
+        return point;
+    }
+    octet O;
+    O.val = buffer;
+    O.max = sizeof(buffer);
+    O.len = length;
+    if (ECP_fromOctet(&point, &O) != 1) throw std::runtime_error("Invalid G1 point.");
+    return point;
+}
+
+ECP2 WireReader::g2() {
+    ECP2 point;
+    char buffer[2 * kWireG2Bytes + 1];
+    int length = pointOctet(take(kWireG2Bytes), kWireG2Bytes, buffer);
+    if (length == 0) {
+        ECP2_inf(&point);
+        return point;
+    }
+    octet S;
+    S.val = buffer;
+    S.max = sizeof(buffer);
+    S.len = length;
+    if (ECP2_fromOctet(&point, &S) != 1) throw std::runtime_error("Invalid G2 point.");
+    return point;
+}
+
+std::vector<ECP> WireReader::g1s() {
+    std::vector<ECP> points(count(kWireG1Bytes));
+    for (auto &point : points) point = g1();
+    return points;
+}
+
+ECP2Array WireReader::g2s() {
+    size_t n = count(kWireG2Bytes);
+    size_t first = at;
+    std::string octets(n * ECP2Array::kOctetBytes, '\0');
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t *x = take(kWireG2Bytes);
+        if (x[0] & kFlagUncompressed) {
+            // Uncompressed points need no square root: read them all now
+            at = first;
+            std::vector<ECP2> points(n);
+            for (auto &point : points) point = g2();
+            return points;
+        }
+        // The point at infinity stays all zeros
+        readCompressed(x, kWireG2Bytes, &octets[i * ECP2Array::kOctetBytes]);
+    }
+    return ECP2Array::fromOctets(std::move(octets), n);
+}
+
+std::vector<short> WireReader::indices() {
+    uint64_t n = varint();
+    uint8_t width = u8();
+    if (width == 0 || width > 15) throw std::runtime_error("Invalid signer index width.");
+    if (n > (msg.size() - at) * 8 / width) throw std::runtime_error("Element count exceeds the binary message.");
+    const uint8_t *packed = take((n * width + 7) / 8);
+    std::vector<short> values(n);
+    size_t bit = 0;
+    for (auto &value : values) {
+        int v = 0;
+        for (uint8_t j = 0; j < width; ++j, ++bit) {
+            v |= ((packed[bit / 8] >> (bit % 8)) & 1) << j;
+        }
+        value = static_cast<short>(v);
+    }
+    return values;
+}
+
+UAV WireReader::keys() {
+    header(WIRE_KEYS);
+    UAV uav;
+    uav.ID = scalar();
+    uav.c1 = scalars();
+    uav.c2 = scalars();
+    uav.serialNumber = static_cast<int>(varint());
+    return uav;
+}
+
+
+// ============================================================
+// Messages
+// ============================================================
+
+// The registry seed ends a package and the common data; the IDs are expanded from it
+static void writeRegistry(WireWriter &w, const std::string &seed) {
+    if (seed.size() != kRegistrySeedBytes) {
+        throw std::invalid_argument("Package without a registry seed.");
+    }
+    w.raw(seed);
+}
+
+static void readRegistry(WireReader &r, int n, const mpz_class &q, std::string &seed, std::vector<mpz_class> &ids) {
+    seed = r.bytes(kRegistrySeedBytes);
+    ids = expandRegistry(seed, n, q);
+}
+
+// n, tm, q, g, beta, M, t: the fields of a UAV package before the keys
+static void writeHead(WireWriter &w, const TransmissionPackage &pkg) {
+    w.varint(static_cast<uint64_t>(pkg.pp.n));
+    w.varint(static_cast<uint64_t>(pkg.pp.tm));
+    w.scalar(pkg.pp.q);
+    w.scalar(pkg.pp.g);
+    w.scalar(pkg.pp.beta);
+    w.scalar(pkg.M);
+    w.varint(static_cast<uint64_t>(pkg.t));
+}
+
+static void readHead(WireReader &r, TransmissionPackage &pkg) {
+    pkg.pp.n = static_cast<int>(r.varint());
+    pkg.pp.tm = static_cast<int>(r.varint());
+    pkg.pp.q = r.scalar();
+    ECP2_inf(&pkg.pp.P2);
+    pkg.pp.g = r.scalar();
+    pkg.pp.beta = r.scalar();
+    pkg.M = r.scalar();
+    pkg.t = static_cast<int>(r.varint());
+}
+
+std::string Package_to_bin(const TransmissionPackage &pkg) {
+    WireWriter w;
+    w.header(WIRE_PACKAGE);
+    writeHead(w, pkg);
+    w.keys(pkg.uav);
+    writeRegistry(w, pkg.registrySeed);
+    return w.data();
+}
+
+TransmissionPackage bin_to_Package(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_PACKAGE);
+    TransmissionPackage pkg;
+    readHead(r, pkg);
+    pkg.uav = r.keys();
+    readRegistry(r, pkg.pp.n, pkg.pp.q, pkg.registrySeed, pkg.registeredIDs);
+    if (!r.atEnd()) throw std::runtime_error("Invalid transmission package format.");
+    return pkg;
+}
+
+std::string Common_to_bin(const TransmissionPackage &pkg) {
+    WireWriter w;
+    w.header(WIRE_COMMON);
+    writeHead(w, pkg);
+    writeRegistry(w, pkg.registrySeed);
+    return w.data();
+}
+
+void bin_to_Common(const std::string &msg, TransmissionPackage &pkg) {
+    WireReader r(msg);
+    r.header(WIRE_COMMON);
+    readHead(r, pkg);
+    readRegistry(r, pkg.pp.n, pkg.pp.q, pkg.registrySeed, pkg.registeredIDs);
+    if (!r.atEnd()) throw std::runtime_error("Invalid common data format.");
+}
+
+std::string HeadPackage_to_bin(const HeadPackage &pkg) {
+    WireWriter w;
+    w.header(WIRE_HEAD_PACKAGE);
+    w.varint(static_cast<uint64_t>(pkg.pp.n));
+    w.varint(static_cast<uint64_t>(pkg.pp.tm));
+    w.scalar(pkg.pp.q);
+    w.scalar(pkg.pp.g);
+    w.scalar(pkg.pp.beta);
+    w.scalar(pkg.M);
+    w.varint(static_cast<uint64_t>(pkg.t));
+    w.scalar(pkg.uavh.ID);
+    w.scalar(pkg.uavh.alpha);
+    return w.data();
+}
+
+HeadPackage bin_to_HeadPackage(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_HEAD_PACKAGE);
+    HeadPackage pkg;
+    pkg.pp.n = static_cast<int>(r.varint());
+    pkg.pp.tm = static_cast<int>(r.varint());
+    pkg.pp.q = r.scalar();
+    ECP2_inf(&pkg.pp.P2);
+    pkg.pp.g = r.scalar();
+    pkg.pp.beta = r.scalar();
+    pkg.M = r.scalar();
+    pkg.t = static_cast<int>(r.varint());
+    pkg.uavh.ID = r.scalar();
+    pkg.uavh.alpha = r.scalar();
+    if (!r.atEnd()) throw std::runtime_error("Invalid head package format.");
+    return pkg;
+}
+
+std::string VerifierPackage_to_bin(const VerifierPackage &pkg) {
+    if (pkg.t < 2 || static_cast<size_t>(pkg.t - 2) >= pkg.pp.PK.size()) {
+        throw std::invalid_argument("Verifier package without PK[t - 2].");
+    }
+    WireWriter w;
+    w.header(WIRE_VERIFIER_PACKAGE);
+    w.varint(static_cast<uint64_t>(pkg.pp.n));
+    w.varint(static_cast<uint64_t>(pkg.pp.tm));
+    w.scalar(pkg.pp.q);
+    w.g2(pkg.pp.P2);
+    w.scalar(pkg.pp.g);
+    w.scalar(pkg.pp.beta);
+    w.scalar(pkg.M);
+    w.varint(static_cast<uint64_t>(pkg.t));
+    w.g2(pkg.pp.PK[pkg.t - 2]);
+    w.g2s(pkg.PK_s);
+    writeRegistry(w, pkg.registrySeed);
+    return w.data();
+}
+
+VerifierPackage bin_to_VerifierPackage(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_VERIFIER_PACKAGE);
+    VerifierPackage pkg;
+    pkg.pp.n = static_cast<int>(r.varint());
+    pkg.pp.tm = static_cast<int>(r.varint());
+    pkg.pp.q = r.scalar();
+    pkg.pp.P2 = r.g2();
+    pkg.pp.g = r.scalar();
+    pkg.pp.beta = r.scalar();
+    pkg.M = r.scalar();
+    pkg.t = static_cast<int>(r.varint());
+    if (pkg.t < 2 || pkg.t > pkg.pp.tm) throw std::runtime_error("Invalid verifier package format.");
+    ECP2 infinity;
+    ECP2_inf(&infinity);
+    pkg.pp.PK = ECP2Array(pkg.pp.tm - 1, infinity);
+    pkg.pp.PK.set(pkg.t - 2, r.g2());
+    pkg.PK_s = r.g2s();
+    readRegistry(r, pkg.pp.n, pkg.pp.q, pkg.registrySeed, pkg.registeredIDs);
+    if (!r.atEnd()) throw std::runtime_error("Invalid verifier package format.");
+    return pkg;
+}
+
+std::string Keys_to_bin(const UAV &uav) {
+    WireWriter w;
+    w.keys(uav);
+    return w.data();
+}
+
+size_t bin_to_Keys(const std::string &msg, size_t pos, UAV &uav) {
+    WireReader r(msg, pos);
+    uav = r.keys();
+    return r.pos();
+}
+
+std::string parSig_to_bin(const parSig &sig) {
+    WireWriter w;
+    w.header(WIRE_PARSIG);
+    w.scalar(sig.cj);
+    w.g1(sig.sig);
+    w.varint(static_cast<uint16_t>(sig.index));
+    return w.data();
+}
+
+parSig bin_to_parSig(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_PARSIG);
+    parSig sig;
+    sig.cj = r.scalar();
+    sig.sig = r.g1();
+    sig.index = static_cast<short>(r.varint());
+    if (!r.atEnd()) throw std::runtime_error("Invalid parSig format.");
+    return sig;
+}
+
+std::string Sigma_to_bin(const Sigma &sg, bool compressed) {
+    WireWriter w(compressed);
+    w.header(WIRE_SIGMA);
+    w.scalars(sg.aux);
+    w.g1s(sg.sig);
+    w.indices(sg.indices);
+    return w.data();
+}
+
+Sigma bin_to_Sigma(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_SIGMA);
+    Sigma sg;
+    sg.aux = r.scalars();
+    sg.sig = r.g1s();
+    sg.indices = r.indices();
+    if (!r.atEnd()) throw std::runtime_error("Invalid Sigma format.");
+    return sg;
+}
+
+std::string SigmaShare_to_bin(const SigmaShare &share, bool compressed) {
+    WireWriter w(compressed);
+    w.header(WIRE_SIGMA_SHARE);
+    w.scalar(share.aux);
+    w.g1(share.sig);
+    w.varint(static_cast<uint16_t>(share.index));
+    return w.data();
+}
+
+SigmaShare bin_to_SigmaShare(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_SIGMA_SHARE);
+    SigmaShare share;
+    share.aux = r.scalar();
+    share.sig = r.g1();
+    share.index = static_cast<short>(r.varint());
+    if (!r.atEnd()) throw std::runtime_error("Invalid SigmaShare format.");
+    return share;
+}
+
+std::string Health_to_bin(const std::vector<PeerHealth> &health) {
+    WireWriter w;
+    w.header(WIRE_HEALTH);
+    w.varint(health.size());
+    std::string alive((health.size() + 7) / 8, '\0');
+    for (size_t i = 0; i < health.size(); ++i) {
+        if (health[i].alive) alive[i / 8] = static_cast<char>(alive[i / 8] | (1 << (i % 8)));
+    }
+    w.raw(alive);
+    for (const auto &h : health) {
+        uint16_t tenths = kHealthNever;
+        if (h.ewma >= 0) tenths = static_cast<uint16_t>(std::min(std::lround(h.ewma * 10), 0xFFFEL));
+        w.u8(static_cast<uint8_t>(tenths));
+        w.u8(static_cast<uint8_t>(tenths >> 8));
+    }
+    return w.data();
+}
+
+std::vector<PeerHealth> bin_to_Health(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_HEALTH);
+    uint64_t n = r.varint();
+    if (n > msg.size() * 8) throw std::runtime_error("Invalid health table.");
+    std::vector<PeerHealth> health(n);
+    std::vector<uint8_t> alive((n + 7) / 8);
+    for (auto &byte : alive) byte = r.u8();
+    for (size_t i = 0; i < n; ++i) {
+        health[i].alive = (alive[i / 8] >> (i % 8)) & 1;
+        uint16_t tenths = r.u8();
+        tenths |= static_cast<uint16_t>(r.u8() << 8);
+        health[i].ewma = tenths == kHealthNever ? -1 : tenths / 10.0;
+    }
+    if (!r.atEnd()) throw std::runtime_error("Invalid health table.");
+    return health;
+}
+
+std::string SplitKey_to_bin(const SplitKey &key) {
+    WireWriter w;
+    w.header(WIRE_SPLIT_KEY);
+    w.scalar(key.gt);
+    w.scalar(key.stk);
+    w.varint(static_cast<uint64_t>(key.shares));
+    w.varint(static_cast<uint64_t>(key.k));
+    w.varint(static_cast<uint64_t>(key.first));
+    w.varint(static_cast<uint64_t>(key.end));
+    return w.data();
+}
+
+SplitKey bin_to_SplitKey(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_SPLIT_KEY);
+    SplitKey key;
+    key.gt = r.scalar();
+    key.stk = r.scalar();
+    uint64_t shares = r.varint();
+    uint64_t k = r.varint();
+    uint64_t first = r.varint();
+    uint64_t end = r.varint();
+    if (shares > INT32_MAX || k > INT32_MAX || first > INT32_MAX || end > INT32_MAX || !r.atEnd()) {
+        throw std::runtime_error("Invalid split key format.");
+    }
+    key.shares = static_cast<int>(shares);
+    key.k = static_cast<int>(k);
+    key.first = static_cast<int>(first);
+    key.end = static_cast<int>(end);
+    return key;
+}
+
+std::string SplitOrder_to_bin(const SplitOrder &order) {
+    WireWriter w;
+    w.header(WIRE_SPLIT_ORDER);
+    w.varint(static_cast<uint64_t>(order.k));
+    w.varint(order.issued);
+    w.scalar(order.gt);
+    w.scalar(order.s);
+    return w.data();
+}
+
+SplitOrder bin_to_SplitOrder(const std::string &msg) {
+    WireReader r(msg);
+    r.header(WIRE_SPLIT_ORDER);
+    SplitOrder order;
+    uint64_t k = r.varint();
+    order.issued = r.varint();
+    order.gt = r.scalar();
+    order.s = r.scalar();
+    if (k > INT32_MAX || !r.atEnd()) throw std::runtime_error("Invalid split order format.");
+    order.k = static_cast<int>(k);
+    return order;
+}
+
+
+// ============================================================
+// Selected format
+// ============================================================
+
+std::string Package_to_wire(const TransmissionPackage &pkg) {
+    return binaryFormat ? Package_to_bin(pkg) : Package_to_str(pkg);
+}
+
+TransmissionPackage wire_to_Package(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_Package(msg) : str_to_Package(msg);
+}
+
+std::string Common_to_wire(const TransmissionPackage &pkg) {
+    return binaryFormat ? Common_to_bin(pkg) : Common_to_str(pkg);
+}
+
+void wire_to_Common(const std::string &msg, TransmissionPackage &pkg) {
+    if (isWireBinary(msg)) bin_to_Common(msg, pkg);
+    else str_to_Common(msg, pkg);
+}
+
+std::string HeadPackage_to_wire(const HeadPackage &pkg) {
+    return binaryFormat ? HeadPackage_to_bin(pkg) : HeadPackage_to_str(pkg);
+}
+
+HeadPackage wire_to_HeadPackage(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_HeadPackage(msg) : str_to_HeadPackage(msg);
+}
+
+std::string VerifierPackage_to_wire(const VerifierPackage &pkg) {
+    return binaryFormat ? VerifierPackage_to_bin(pkg) : VerifierPackage_to_str(pkg);
+}
+
+VerifierPackage wire_to_VerifierPackage(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_VerifierPackage(msg) : str_to_VerifierPackage(msg);
+}
+
+std::string parSig_to_wire(const parSig &sig) {
+    return binaryFormat ? parSig_to_bin(sig) : parSig_to_str(sig);
+}
+
+parSig wire_to_parSig(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_parSig(msg) : str_to_parSig(msg);
+}
+
+std::string Sigma_to_wire(const Sigma &sg, bool compressed) {
+    return binaryFormat ? Sigma_to_bin(sg, compressed) : Sigma_to_str(sg, compressed);
+}
+
+Sigma wire_to_Sigma(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_Sigma(msg) : str_to_Sigma(msg);
+}
+
+std::string SigmaShare_to_wire(const SigmaShare &share, bool compressed) {
+    return binaryFormat ? SigmaShare_to_bin(share, compressed) : SigmaShare_to_str(share, compressed);
+}
+
+SigmaShare wire_to_SigmaShare(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_SigmaShare(msg) : str_to_SigmaShare(msg);
+}
+
+std::string Health_to_wire(const std::vector<PeerHealth> &health) {
+    return binaryFormat ? Health_to_bin(health) : Health_to_str(health);
+}
+
+std::vector<PeerHealth> wire_to_Health(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_Health(msg) : str_to_Health(msg);
+}
+
+std::string SplitKey_to_wire(const SplitKey &key) {
+    return binaryFormat ? SplitKey_to_bin(key) : SplitKey_to_str(key);
+}
+
+SplitKey wire_to_SplitKey(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_SplitKey(msg) : str_to_SplitKey(msg);
+}
+
+std::string SplitOrder_to_wire(const SplitOrder &order) {
+    return binaryFormat ? SplitOrder_to_bin(order) : SplitOrder_to_str(order);
+}
+
+SplitOrder wire_to_SplitOrder(const std::string &msg) {
+    return isWireBinary(msg) ? bin_to_SplitOrder(msg) : str_to_SplitOrder(msg);
+}
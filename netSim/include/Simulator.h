@@ -0,0 +1,242 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "TA.h"
+#include "UAV.h"
+#include "UAVh.h"
+#include "Verifier.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @file Simulator.h
+ * @brief Virtual-time discrete-event simulation of the netSim topology.
+ *
+ * The namespace scripts shape each node's egress with `tc`, so a run is limited
+ * to the addresses of one bridge, needs root and lasts as long as the real links.
+ * The simulator keeps the same topology, but every link is a model of that
+ * egress qdisc and time only advances from event to event:
+ *  - netem: delay, uniform jitter and independent loss;
+ *  - tbf: rate, burst and latency (packets that would queue longer are dropped);
+ *  - WebSocket connections are TCP: handshake, MSS segments, retransmission with
+ *    exponential backoff; datagrams are sent once per copy.
+ *
+ * The node code is the real one (TA setup, signForSigners, deliverPartialSignature,
+ * AggInit/AggAppend, selectSigners, Verify ...). Its CPU time is measured and
+ * charged to the node that executed it, so that crypto cost shows up in
+ * virtual time as it would on a node with one core.
+ */
+
+namespace simulator_NS {
+
+    // ============================================================
+    // Links and nodes
+    // ============================================================
+
+    /**
+     * @brief Egress qdisc of one network namespace (veth-*-ns root).
+     */
+    struct Link {
+        double delayMs = 0;     // netem delay
+        double jitterMs = 0;    // netem jitter (uniform in +-jitter)
+        double loss = 0;        // netem loss probability
+        double rate = 0;        // tbf rate (bit/s), 0 = unshaped
+        double burst = 0;       // tbf bucket size (bits)
+        double limitMs = 0;     // tbf latency: longest time a packet may wait for tokens
+
+        double tokens = 0;      // bucket content (bits), negative while a backlog drains
+        double tokensAt = 0;    // virtual time of the last bucket update (ms)
+    };
+
+    /**
+     * @brief One simulated host: its egress link and a single CPU.
+     */
+    struct Node {
+        std::string name;       // namespace name in build_uav_net.sh ("UAVh", "Verifier", "UAV1" ...)
+        Link egress;
+        double cpuScale = 1;    // slowdown of this node's CPU relative to the simulating host
+        double cpuFree = 0;     // virtual time at which the CPU becomes idle (ms)
+        double cpuMs = 0;       // CPU time charged during the current run (ms)
+    };
+
+    /**
+     * @brief Applies the NET_* entries present in `cfg` to a link (same keys and units as config.env).
+     */
+    void applyLinkConfig(Link &link, const Config &cfg);
+
+
+    // ============================================================
+    // Event engine
+    // ============================================================
+
+    struct Event {
+        double at;              // virtual time (ms)
+        uint64_t seq;           // insertion order, keeps simultaneous events FIFO
+        std::function<void()> fn;
+    };
+
+    struct EventOrder {
+        bool operator()(const Event &a, const Event &b) const {
+            return a.at > b.at || (a.at == b.at && a.seq > b.seq);
+        }
+    };
+
+    struct SimStats {
+        uint64_t packets = 0;       // packets handed to an egress link (incl. retransmissions)
+        uint64_t bytes = 0;         // their size on the wire
+        uint64_t drops = 0;         // lost by netem or dropped by tbf
+        uint64_t retransmits = 0;   // TCP segment retransmissions and UDP signature retransmissions
+    };
+
+    struct Simulation {
+        double now = 0;             // current virtual time (ms)
+        uint64_t seq = 0;
+        std::priority_queue<Event, std::vector<Event>, EventOrder> events;
+        std::mt19937_64 rng;        // link randomness (jitter, loss), seeded by SIM_SEED
+        SimStats stats;
+    };
+
+    extern Simulation sim;
+
+    /**
+     * @brief Queues `fn` at virtual time `at` (never earlier than now).
+     */
+    void schedule(double at, std::function<void()> fn);
+
+    /**
+     * @brief Executes events in time order until none is left or `stop` returns true.
+     */
+    void runEvents(const std::function<bool()> &stop);
+
+    /**
+     * @brief Runs node code now and charges its measured CPU time to `node`.
+     *        The work starts once the node's CPU is idle; stdout of the node code is muted.
+     * @return Virtual time at which the work completes.
+     */
+    double compute(Node &node, const std::function<void()> &work);
+
+
+    // ============================================================
+    // Packets and messages
+    // ============================================================
+
+    /**
+     * @brief Puts one packet of `bytes` on the egress link of `from`.
+     * @return Arrival time at the peer, or -1 if the packet was dropped.
+     */
+    double transmit(Node &from, size_t bytes);
+
+    /**
+     * @brief Sends one TCP segment, retransmitting it with exponential backoff until it arrives.
+     */
+    void sendSegment(Node &from, size_t bytes, double rtoMs, const std::function<void()> &onArrival);
+
+    /**
+     * @brief One direction of a TCP connection: messages are handed over in the order they were sent.
+     */
+    struct Stream {
+        uint64_t nextSend = 0;
+        uint64_t nextDeliver = 0;
+        std::map<uint64_t, std::function<void()>> complete;   // fully received, waiting for earlier ones
+    };
+
+    using StreamPtr = std::shared_ptr<Stream>;
+
+    /**
+     * @brief Sends one WebSocket message over an open connection.
+     * @param masked client-to-server frames carry a masking key
+     */
+    void sendMessage(Node &from, const StreamPtr &stream, size_t payload, bool masked,
+                     const std::function<void()> &onDelivered);
+
+    /**
+     * @brief Opens a WebSocket connection: TCP handshake followed by the HTTP upgrade.
+     */
+    void openConnection(Node &client, Node &server, const std::function<void()> &onOpen);
+
+    /**
+     * @brief Sends `copies` copies of one datagram; `onDelivered` runs for the first copy that arrives.
+     */
+    void sendDatagramCopies(Node &from, size_t payload, int copies, const std::function<void()> &onDelivered);
+
+
+    // ============================================================
+    // Sweep
+    // ============================================================
+
+    /**
+     * @brief Simulated UAV: its namespace and the keys TA issued to it.
+     *        Keys are only derived once the UAV is first selected.
+     */
+    struct SimUAV {
+        Node node;
+        bool keyed = false;
+        UAV keys;
+    };
+
+    /**
+     * @brief Outcome of one authentication.
+     */
+    struct RunResult {
+        double authMs = -1;         // challenge sent -> verification finished, -1 if it never finished
+        int verified = 0;           // result of Verify / VerifyFinal
+        int signatures = 0;         // partial signatures transformed by UAVh
+        int hedges = 0;             // duplicate requests sent by UAVh
+        int timeouts = 0;           // selected UAVs given up on
+        SimStats stats;
+        double verifierCpuMs = 0, uavhCpuMs = 0, uavCpuMs = 0;
+    };
+
+    /**
+     * @brief Outcome of one swarm split.
+     */
+    struct SplitResult {
+        double splitMs = -1;        // key drawn -> last member acknowledged, -1 if one never did
+        int acked = 0;              // members that updated their keys
+        size_t keyBytes = 0;        // split request sent to each member
+        size_t reregisterBytes = 0; // registration packages the members would be sent instead
+        SimStats stats;
+        double uavhCpuMs = 0, uavCpuMs = 0;
+    };
+
+    /**
+     * @brief Registers a swarm of `numUAV` UAVs with threshold `threshold` (TA setup, not timed).
+     */
+    void setupSwarm(int numUAV, int threshold);
+
+    /**
+     * @brief Configures every link for a scenario of the tc scripts:
+     *        none | latency | bandwidth | loss | all.
+     */
+    void applyScenario(const std::string &scenario);
+
+    /**
+     * @brief Simulates one authentication of the Verifier against the swarm.
+     * @param sid session id of the challenge
+     */
+    RunResult runSession(uint32_t sid);
+
+    /**
+     * @brief Simulates splitting the UAVs [0, members) off the swarm (SIM_SPLIT).
+     *        UAVh plays the root and the new sub-head: it draws and checks the transformation
+     *        key (SplitInit, SplitVerify), then sends it to the members over up to
+     *        kSplitConnections connections at a time; each member runs applySplit and
+     *        acknowledges. The members' keys are restored afterwards, so that later runs
+     *        authenticate against the unsplit swarm.
+     */
+    SplitResult runSplit(int members);
+
+    /**
+     * @brief Loads the options and sweeps every swarm size and scenario.
+     */
+    int run();
+
+} // namespace simulator_NS
+
+#endif // SIMULATOR_H
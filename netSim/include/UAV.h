@@ -1,15 +1,24 @@
+#ifndef UAV_H
+#define UAV_H
+
 #include "../../common/include/Tools.h"
 
 #include "../../common/include/Serializer.h"
-
-#include <websocketpp/config/asio_no_tls_client.hpp>
-#include <websocketpp/client.hpp>
-
-#include <websocketpp/config/asio_no_tls.hpp>
-#include <websocketpp/server.hpp>
+#include "../../common/include/Config.h"
+#include "../../common/include/NodeCache.h"
+#include "../../common/include/WireFormat.h"
+#include "../../RTS-websocket/include/Datagram.h"
+#include "../../RTS-websocket/include/Transport.h"
 
 #include <thread>
+#include <chrono>
 #include <algorithm>
+#include <deque>
+#include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 
 /**
@@ -17,30 +26,91 @@
  * @brief Declarations for the UAV node.
  *
  * This header mirrors the implementation in src/UAV.cpp.
- * The websocketpp type aliases are declared here so that
- * function signatures match exactly between declaration and definition.
+ * All key material lives in a UAVContext rather than in globals, so that
+ * several UAVs can share one process (see src/InProcess.cpp and src/UAVHost.cpp).
+ * The parameters TA hands to every UAV alike live in one SwarmParams that the
+ * UAVs of a process share.
  */
 
 namespace UAVNode_NS {
 
     // ------------------------------
-    // websocketpp concrete aliases
+    // Per-UAV state
     // ------------------------------
-    using Client     = websocketpp::client<websocketpp::config::asio_client>;
-    using MsgClient  = websocketpp::config::asio_client::message_type::ptr;
-    using Server     = websocketpp::server<websocketpp::config::asio>;
-    using MsgServer  = Server::message_ptr;
-    using websocketpp::connection_hdl;
+
+    /**
+     * @brief Parameters TA sends to every UAV of the swarm alike.
+     */
+    struct SwarmParams {
+        Params          pp;             // public parameters from TA
+        mpz_class       message;        // message M
+        int             threshold = 0;  // threshold t
+        vector<mpz_class> registeredIDs;
+        std::string     commonBlob;     // the above as serialized by TA (COMMON_P2P), served to later peers
+        std::string     commonDigest;   // sha256Hex(commonBlob)
+    };
+
+    /**
+     * @brief What a keys-only TA reply says about the common data (COMMON_P2P).
+     */
+    struct CommonRef {
+        std::string     digest;         // sha256Hex of the serialized common data
+        size_t          size = 0;       // its length in bytes
+        std::string     blob;           // the data itself, if TA appended it
+    };
+
+    /**
+     * @brief Signing context of the latest signer set, shared by the UAVs of one process.
+     *        SignInit then runs once per request instead of once per hosted UAV.
+     */
+    struct SignCache {
+        std::mutex      mtx;
+        std::string     signers;        // encoded signer set `ctx` was computed for
+        std::shared_ptr<const SignContext> ctx;
+    };
+
+    /**
+     * @brief Work done on behalf of one UAV (read by the host's usage report).
+     */
+    struct UAVUsage {
+        std::atomic<uint64_t> requests{0};      // signing requests addressed to this UAV
+        std::atomic<uint64_t> signatures{0};    // partial signatures generated
+        std::atomic<uint64_t> cpuUs{0};         // thread CPU time spent answering them (us)
+    };
+
+    /**
+     * @brief Keys and parameters one UAV received from TA.
+     */
+    struct UAVContext {
+        std::shared_ptr<const SwarmParams> swarm;   // shared with the other UAVs of this process
+        std::shared_ptr<SignCache> signCache;       // null: every signature runs SignInit itself
+        UAV             uav;            // UAV's private information (struct defined in common)
+        UAVUsage        usage;
+        std::mutex      keysMtx;        // guards uav.c2, lastSplit and splitBeta while a split updates them
+        mpz_class       lastSplit;      // stk of the last split applied (SPLIT), 0 if none
+        mpz_class       splitBeta;      // beta of the sub-swarm after the last split (SplitBeta), 0: swarm->pp.beta
+        std::string     cachePath;      // NODE_CACHE_DIR file rewritten after a split, "" if not cached
+    };
 
     // ------------------------------
-    // Global state (defined in UAV.cpp)
+    // Process-wide options (defined in UAV.cpp)
     // ------------------------------
-    extern gmp_randstate_t state;
-    extern Params          pp;        // public parameters from TA
-    extern UAV             uav;       // UAV's private information (struct defined in common)
-    extern mpz_class       message;   // message M
-    extern int             threshold; // threshold t
-    extern vector<mpz_class> registeredIDs;
+    extern bool useDatagrams;   // TRANSPORT=udp: also answer DG_REQUEST datagrams (heartbeats are always answered)
+    extern int udpRedundancy;   // UDP_REDUNDANCY: copies sent of every datagram
+    extern int udpRetryMs;      // UDP_RETRY_MS: retransmission interval of unacknowledged signatures
+    extern int udpRetries;      // UDP_RETRIES: retransmissions before a signature is given up
+    extern std::string mcastGroup;  // MCAST_GROUP: multicast group of the swarm
+    extern int mcastPort;           // MCAST_PORT
+    extern bool commonP2P;          // COMMON_P2P: TA sends keys only, the common data comes from the peers
+    extern int commonChunk;         // COMMON_CHUNK: bytes per requested piece of the common data
+    extern int commonPeers;         // COMMON_PEERS: earlier UAVs the pieces are spread over
+
+    /**
+     * @brief Reads the process-wide options from scripts/config.env.
+     *
+     * @param transportOverride "ws" or "udp" to override TRANSPORT, or nullptr
+     */
+    void loadOptions(const char* transportOverride = nullptr);
 
     // ------------------------------
     // TA connection handlers (client mode)
@@ -49,26 +119,107 @@ namespace UAVNode_NS {
     /**
      * @brief Called when UAV successfully connects to TA.
      *
-     * @param c   pointer to websocketpp client instance
-     * @param hdl connection handle
+     * @param c    transport endpoint of the TA connection
+     * @param conn connection to TA
      */
-    void handleTAOpen(Client* c, connection_hdl hdl);
+    void handleTAOpen(Transport* c, ConnId conn);
 
     /**
      * @brief Called when TA sends UAV's key and system parameters.
+     *        Parameters already present in `ctx.swarm` are kept and shared.
+     *        A keys-only reply ("KEYS#...") leaves `ctx.swarm` empty unless TA appended the common data.
      *
-     * @param c   pointer to websocketpp client instance
-     * @param hdl connection handle
-     * @param msg received message pointer
+     * @param ctx    receives the keys and parameters
+     * @param c      transport endpoint of the TA connection
+     * @param conn   connection to TA
+     * @param msg    received registration package
+     * @param common receives the digest and size of the common data of a keys-only reply
      */
-    void handleTAMessage(Client* c, connection_hdl hdl, MsgClient msg);
+    void handleTAMessage(UAVContext& ctx, Transport* c, ConnId conn, const std::string& msg, CommonRef& common);
 
     /**
      * @brief Connect to TA (ws://ip:9002) and receive parameters.
+     *        With COMMON_P2P, TA only sends keys and the common data is obtained with obtainCommon.
      *
+     * @param ctx receives the keys and parameters
      * @return 0 on success, -1 on failure
      */
-    int connectToTA();
+    int connectToTA(UAVContext& ctx);
+
+    /**
+     * @brief Registers several UAVs over one TA connection, one "UAV" request after the other.
+     *        The first package provides the shared SwarmParams, later ones only keys.
+     *
+     * @param uavs contexts receiving the keys, in registration order
+     * @return number of UAVs registered (stops at the first failure)
+     */
+    int connectToTA(const std::vector<std::shared_ptr<UAVContext>>& uavs);
+
+    // ------------------------------
+    // Cached registration (NODE_CACHE_DIR)
+    // ------------------------------
+
+    /**
+     * @brief Restores the keys and parameters saved by saveRegistration, after checking with
+     *        one "DIGEST" round trip that TA still has the same common data and issued this serial.
+     *
+     * @param ctx  receives the keys and parameters
+     * @param path cache file, or "" (caching disabled)
+     * @return false if there is no cache or it is out of date: register with connectToTA
+     */
+    bool restoreRegistration(UAVContext& ctx, const std::string& path);
+
+    /**
+     * @brief Saves the keys and parameters of a registered UAV for restoreRegistration.
+     */
+    void saveRegistration(const UAVContext& ctx, const std::string& path);
+
+    // ------------------------------
+    // Common data from peers (COMMON_P2P)
+    // ------------------------------
+
+    /**
+     * @brief Address of the UAV server of the UAV with serial number `serial`.
+     */
+    std::string peerUri(int serial);
+
+    /**
+     * @brief Checks `blob` against `digest` and makes it the SwarmParams of `ctx`.
+     *
+     * @return false if the digest does not match or the data is malformed
+     */
+    bool installCommon(UAVContext& ctx, const std::string& blob, const std::string& digest);
+
+    /**
+     * @brief Fetches the common data in COMMON_CHUNK pieces from up to COMMON_PEERS UAVs registered
+     *        before `serial`. The pieces are spread over the peers and re-asked of another peer if
+     *        one fails; the result is not checked against the digest yet.
+     *
+     * @param serial serial number of the fetching UAV
+     * @param common digest and size from TA
+     * @param blob   receives the reassembled data
+     * @return false if some piece could not be obtained within the timeout
+     */
+    bool fetchCommonFromPeers(int serial, const CommonRef& common, std::string& blob);
+
+    /**
+     * @brief Asks TA for the common data ("COMMON").
+     */
+    bool fetchCommonFromTA(std::string& blob);
+
+    /**
+     * @brief Installs the common data from the peers, or from TA if the peers cannot provide data
+     *        that matches the digest.
+     *
+     * @return 0 on success, -1 on failure
+     */
+    int obtainCommon(UAVContext& ctx, const CommonRef& common);
+
+    /**
+     * @brief Answers "COMMON#digest#chunk#chunkSize" with "COMMON#chunk#data".
+     *        The data is empty if this UAV does not hold common data with that digest.
+     */
+    void serveCommonChunk(const UAVContext& ctx, Transport* server, ConnId conn, const std::string& request);
 
 
     // ------------------------------
@@ -79,28 +230,98 @@ namespace UAVNode_NS {
      * @brief Callback function executed when a message (signer set) is received from UAVh.
      *
      * This function handles the "Sign Request" logic on the UAV side.
-     * It receives the selected signer set encoded as a compact bitmap to save bandwidth.
+     * It receives the selected signer set in the shortest of the SignerSet.h encodings.
      *
      * Workflow:
-     * 1. **Self-Check**: Checks if the local UAV is selected using bitwise operations on the received payload (O(1) complexity).
-     * 2. **Set Reconstruction**: If selected, iterates through the bitmap to reconstruct the full
+     * 1. **Self-Check**: Decodes the indices of S and looks the local UAV up among them (binary search).
+     * 2. **Set Reconstruction**: If selected, maps the indices of S to the full
      * `signerSet` (vector of IDs) using the local `registeredIDs` lookup table.
      * This is required to calculate Lagrange coefficients during signing.
      * 3. **Signing**: Generates a partial signature using the reconstructed set and local private key.
      * 4. **Response**: Sends the partial signature string (or "null" if not selected) back to UAVh.
      *
-     * @param server Pointer to the WebSocket++ server endpoint instance.
-     * @param hdl    The handle identifying the connection to UAVh.
-     * @param msg    The received message object containing the binary bitmap payload.
+     * @param ctx     Keys of the UAV the request is addressed to.
+     * @param server  Listening transport endpoint.
+     * @param conn    The connection to UAVh.
+     * @param payload The received frame containing the encoded signer set.
      */
-    void serverOnMessage(Server* server, connection_hdl hdl, MsgServer msg);
+    void serverOnMessage(UAVContext& ctx, Transport* server, ConnId conn, const std::string& payload);
 
     /**
-     * @brief Start UAV server to listen for UAVh (port provided by main).
+     * @brief Signs M for the signer set S if this UAV belongs to it.
+     *        The request and the thread CPU time it took are added to `ctx.usage`.
+     *
+     * @param ctx     keys of this UAV
+     * @param signers encoded signer set received from UAVh (keys the SignCache)
+     * @param S       its indices, as decoded by parsePacedRequest
+     * @return serialized partial signature, or "null" if not selected
+     */
+    std::string signForSigners(UAVContext& ctx, const std::string& signers, const std::vector<int>& S);
+
+    /**
+     * @brief Applies the transformation key of a swarm split ("SPLIT#key" from the head of the
+     *        new sub-swarm): the first key.shares entries of c2 are multiplied by c1^stk (SplitUpdate).
+     *        The key must name a range of serials that holds this UAV's and verify against the
+     *        beta of the UAV's current swarm (SplitVerify), that of TA or of its last split. So
+     *        only the holder of that swarm's alpha can rewrite the shares, a key for another
+     *        range does not apply here, and a key of an earlier split no longer verifies. The UAV then moves to the
+     *        beta of the sub-swarm (SplitBeta). A key already applied is only acknowledged again,
+     *        so that a head may repeat it after a lost acknowledgement.
+     *
+     * @param ctx  keys of this UAV, updated in place
+     * @param body the serialized SplitKey
+     * @return "SPLIT#OK" or "SPLIT#FAIL"
+     */
+    std::string applySplit(UAVContext& ctx, const std::string& body);
+
+    /**
+     * @brief Splits a request body "slot#signers", decodes the signer set and returns the
+     *        pacing delay of this UAV: its rank among the selected signers times the slot width.
+     *
+     * @param ctx     keys of this UAV
+     * @param body    request body after the session id
+     * @param signers receives the encoded signer set
+     * @param S       receives its indices in increasing order (empty if malformed)
+     * @return reply delay in microseconds (0 if unpaced or not selected)
+     */
+    uint64_t parsePacedRequest(const UAVContext& ctx, const std::string& body, std::string& signers,
+                               std::vector<int>& S);
+
+    /**
+     * @brief Start UAV server to listen for UAVh on port 8002.
+     *
+     * @param ctx keys of this UAV
+     */
+    void startUAVServer(UAVContext& ctx);
+
+    /**
+     * @brief Serve DG_REQUEST datagrams from UAVh on the given UDP port.
+     *        DG_PING heartbeats are answered with DG_PONG in every transport mode.
+     *
+     * Each signature is sent UDP_REDUNDANCY times in the pacing slot of this UAV and retransmitted every
+     * UDP_RETRY_MS until UAVh acknowledges it. Replies are cached per session id,
+     * so a duplicated or replayed request is answered from the cache and never
+     * triggers a second signature for the same session.
+     * Multicast requests of the swarm group are received as well; a gap in their
+     * sequence numbers is reported to UAVh with DG_NACK for a unicast repair.
+     *
+     * @param ctx  keys of this UAV
+     * @param port listening UDP port
+     */
+    void startUAVDatagram(const std::shared_ptr<UAVContext>& ctx, int port);
+
+    /**
+     * @brief Serves the datagrams of several UAVs of this process in one loop.
+     *
+     * Requests and acknowledgements are dispatched by their index to the UAV with that
+     * serial number; multicast requests (kSwarmIndex) are handed to every UAV. A single
+     * UAV answers every datagram, whatever its index. Each UAV keeps its own reply cache
+     * and retransmissions, as in startUAVDatagram.
      *
-     * @param port listening port
+     * @param uavs  UAVs answered by this loop
+     * @param ports UDP ports to receive on (one socket each)
      */
-    void startUAVServer();
+    void serveDatagrams(const std::vector<std::shared_ptr<UAVContext>>& uavs, const std::vector<int>& ports);
 
 
     // ------------------------------
@@ -108,12 +329,14 @@ namespace UAVNode_NS {
     // ------------------------------
 
     /**
-     * @brief High-level run: register with TA, then start server.
+     * @brief High-level run: register with TA (or restore the cached registration), then start server.
+     *        With the in-process transport backend no datagram socket is opened.
      *
-     * @param port server listening port for UAVh
+     * @param transportOverride "ws" or "udp" to override TRANSPORT for this node, or nullptr
      * @return 0 on success, -1 on failure
      */
-    int run(int port);
+    int run(const char* transportOverride = nullptr);
 
 } // namespace UAVNode
 
+#endif // UAV_H
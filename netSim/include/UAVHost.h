@@ -0,0 +1,61 @@
+#ifndef UAVHOST_H
+#define UAVHOST_H
+
+#include "UAV.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file UAVHost.h
+ * @brief One process serving many virtual UAVs.
+ *
+ * scripts/run_uavs.sh starts one UAV process per namespace, each with its own TA
+ * connection, event loop and copy of the public parameters. The host registers
+ * all of its UAVs over a single TA connection and serves them from one transport
+ * endpoint and one datagram loop:
+ *  - SwarmParams (Params, M, t, registered IDs) exist once and are shared;
+ *  - the signing context of a signer set (SignInit) is computed once per request
+ *    and shared through a SignCache;
+ *  - every virtual UAV keeps its own keys, serial number and WebSocket address
+ *    10.0.30.(101 + serial):8002, so UAVh addresses it exactly like a standalone UAV.
+ *    The addresses are aliases of the UAVHost namespace (UAV_HOST=1 in build_uav_net.sh),
+ *    whose one UDP socket on port 8002 dispatches datagrams by their index.
+ * The work done for each UAV is accounted in its UAVUsage and exported as CSV.
+ */
+
+namespace UAVHostNode_NS {
+
+    // ------------------------------
+    // Process-wide options (defined in UAVHost.cpp)
+    // ------------------------------
+    extern std::string usageCsv;    // HOST_USAGE_CSV: per-UAV usage snapshot, empty disables it
+    extern int usageMs;             // HOST_USAGE_MS: interval of the snapshot
+
+    /**
+     * @brief Raises the soft limit of open files to the hard limit.
+     *        Every virtual UAV needs a listening socket, a UDP socket and a connection from UAVh.
+     */
+    void raiseFileLimit();
+
+    /**
+     * @brief Writes one line "serial,requests,signatures,cpu_ms" per hosted UAV.
+     *
+     * @param uavs hosted UAVs
+     * @param path target file, overwritten
+     */
+    void writeUsage(const std::vector<std::shared_ptr<UAVNode_NS::UAVContext>>& uavs, const std::string& path);
+
+    /**
+     * @brief Registers `count` UAVs with TA and serves them until the process is stopped.
+     *
+     * @param count number of virtual UAVs
+     * @param transportOverride "ws" or "udp" to override TRANSPORT, or nullptr
+     * @return -1 if no UAV could be registered or served
+     */
+    int run(int count, const char* transportOverride = nullptr);
+
+} // namespace UAVHostNode_NS
+
+#endif // UAVHOST_H
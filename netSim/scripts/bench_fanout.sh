@@ -0,0 +1,87 @@
+#!/bin/bash
+set -e
+
+# Compares unicast and multicast bitmap fan-out (BITMAP_FANOUT) over the UDP transport.
+# For each mode: starts TA, all UAVs and UAVh in their namespaces, runs the Verifier
+# RUNS times and reports the mean authentication time together with the bytes and
+# packets UAVh put on the swarm link.
+#
+# Usage (from the netSim build directory, after build_uav_net.sh):
+#   sudo ./scripts/bench_fanout.sh [RUNS]
+
+# ================= 0. Permission & Configuration Check =================
+if [[ $EUID -ne 0 ]]; then echo "Error: Please run as root (sudo)."; exit 1; fi
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+CONFIG_FILE="$SCRIPT_DIR/config.env"
+BUILD_DIR="$( dirname "$SCRIPT_DIR" )"
+RUNS=${1:-10}
+
+if [ -f "$CONFIG_FILE" ]; then
+    source "$CONFIG_FILE"
+else
+    echo "Error: Configuration file not found: $CONFIG_FILE"; exit 1
+fi
+if ! ip netns list | grep -q "^UAVh"; then
+    echo "Error: Swarm namespaces not found. Run: sudo ./scripts/build_uav_net.sh"; exit 1
+fi
+
+cd "$BUILD_DIR"
+
+# The binaries read scripts/config.env: patch it per mode and restore it on exit
+cp "$CONFIG_FILE" "$CONFIG_FILE.bak"
+cleanup() {
+    pkill -9 -f _netSim 2>/dev/null || true
+    mv -f "$CONFIG_FILE.bak" "$CONFIG_FILE"
+}
+trap cleanup EXIT
+
+set_option() {
+    sed -i "s/^$1=[^ ]*/$1=$2/" "$CONFIG_FILE"
+}
+
+# Traffic sent by UAVh = traffic received by its host-side veth
+uavh_bytes()   { cat /sys/class/net/veth-uavh/statistics/rx_bytes; }
+uavh_packets() { cat /sys/class/net/veth-uavh/statistics/rx_packets; }
+
+# ================= 1. Benchmark Loop =================
+RESULTS=""
+for MODE in unicast multicast; do
+    echo "================================================================"
+    echo "[*] Mode: $MODE (N=$NUM_UAV, runs=$RUNS)"
+    set_option TRANSPORT udp
+    set_option BITMAP_FANOUT $MODE
+
+    pkill -9 -f _netSim 2>/dev/null || true
+    sleep 1
+
+    ip netns exec TA ./TA_netSim > /dev/null 2>&1 &
+    sleep 1
+    "$SCRIPT_DIR/run_uavs.sh" > /dev/null
+    sleep 2
+    ip netns exec UAVh ./UAVh_netSim > /dev/null 2>&1 &
+    sleep 2
+
+    BYTES_0=$(uavh_bytes); PACKETS_0=$(uavh_packets)
+    TOTAL=0; OK=0
+    for r in $(seq 1 $RUNS); do
+        T=$(ip netns exec Verifier ./Verifier_netSim 2>/dev/null | \
+            grep "Total Authentication Time" | awk '{print $5}' | head -n1)
+        if [[ -n "$T" ]]; then
+            TOTAL=$((TOTAL + T)); OK=$((OK + 1))
+            echo " -> run $r: ${T} ms"
+        else
+            echo " -> run $r: failed"
+        fi
+    done
+    BYTES=$(( $(uavh_bytes) - BYTES_0 )); PACKETS=$(( $(uavh_packets) - PACKETS_0 ))
+
+    MEAN="n/a"
+    if [[ $OK -gt 0 ]]; then MEAN=$((TOTAL / OK)); fi
+    RESULTS+=$(printf "%-10s %10s %8s %12s %10s" "$MODE" "$MEAN" "$OK/$RUNS" "$((BYTES / RUNS))" "$((PACKETS / RUNS))")$'\n'
+done
+
+# ================= 2. Report =================
+echo "================================================================"
+printf "%-10s %10s %8s %12s %10s\n" "fan-out" "mean(ms)" "ok" "UAVh B/run" "pkts/run"
+printf "%s" "$RESULTS"
@@ -0,0 +1,106 @@
+#!/bin/bash
+set -e
+
+# Compares a flat UAVh with a root UAVh over K sub-cluster heads (SUB_HEADS).
+# For each K: starts TA, all UAVs, the K sub-heads and the root UAVh in their
+# namespaces, runs the Verifier RUNS times and reports the mean authentication
+# time, the bytes and packets the root put on the swarm link and its CPU time.
+#
+# Usage (from the netSim build directory, after build_uav_net.sh with SUB_HEADS
+# set to the largest K; larger K values are skipped):
+#   sudo ./scripts/bench_hierarchy.sh [RUNS] ["K1 K2 ..."]
+
+# ================= 0. Permission & Configuration Check =================
+if [[ $EUID -ne 0 ]]; then echo "Error: Please run as root (sudo)."; exit 1; fi
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+CONFIG_FILE="$SCRIPT_DIR/config.env"
+BUILD_DIR="$( dirname "$SCRIPT_DIR" )"
+RUNS=${1:-10}
+K_VALUES=${2:-"0 2 4 8"}
+
+if [ -f "$CONFIG_FILE" ]; then
+    source "$CONFIG_FILE"
+else
+    echo "Error: Configuration file not found: $CONFIG_FILE"; exit 1
+fi
+if ! ip netns list | grep -q "^UAVh"; then
+    echo "Error: Swarm namespaces not found. Run: sudo ./scripts/build_uav_net.sh"; exit 1
+fi
+
+cd "$BUILD_DIR"
+
+# The binaries read scripts/config.env: patch it per K and restore it on exit
+cp "$CONFIG_FILE" "$CONFIG_FILE.bak"
+cleanup() {
+    pkill -9 -f _netSim 2>/dev/null || true
+    mv -f "$CONFIG_FILE.bak" "$CONFIG_FILE"
+}
+trap cleanup EXIT
+
+set_option() {
+    sed -i "s/^$1=[^ ]*/$1=$2/" "$CONFIG_FILE"
+}
+
+# Traffic sent by the root = traffic received by its host-side veth
+uavh_bytes()   { cat /sys/class/net/veth-uavh/statistics/rx_bytes; }
+uavh_packets() { cat /sys/class/net/veth-uavh/statistics/rx_packets; }
+
+# CPU time (ms) of a process: utime + stime from /proc/PID/stat
+cpu_ms() {
+    local ticks
+    ticks=$(awk '{print $14 + $15}' "/proc/$1/stat")
+    echo $(( ticks * 1000 / $(getconf CLK_TCK) ))
+}
+
+# ================= 1. Benchmark Loop =================
+RESULTS=""
+for K in $K_VALUES; do
+    if [[ $K -gt 0 ]] && ! ip netns list | grep -q "^SubHead$((K - 1))\b"; then
+        echo "[!] Skipping K=$K: network built with fewer sub-heads."
+        continue
+    fi
+    echo "================================================================"
+    echo "[*] Sub-heads: $K (N=$NUM_UAV, runs=$RUNS)"
+    set_option SUB_HEADS $K
+
+    pkill -9 -f _netSim 2>/dev/null || true
+    sleep 1
+
+    ip netns exec TA ./TA_netSim > /dev/null 2>&1 &
+    sleep 1
+    "$SCRIPT_DIR/run_uavs.sh" > /dev/null
+    sleep 2
+    if [[ $K -gt 0 ]]; then
+        "$SCRIPT_DIR/run_subheads.sh" > /dev/null
+        sleep 2
+    fi
+    ip netns exec UAVh ./UAVh_netSim > /dev/null 2>&1 &
+    ROOT_PID=$!
+    sleep 2
+
+    BYTES_0=$(uavh_bytes); PACKETS_0=$(uavh_packets); CPU_0=$(cpu_ms $ROOT_PID)
+    TOTAL=0; OK=0
+    for r in $(seq 1 $RUNS); do
+        T=$(ip netns exec Verifier ./Verifier_netSim 2>/dev/null | \
+            grep "Total Authentication Time" | awk '{print $5}' | head -n1)
+        if [[ -n "$T" ]]; then
+            TOTAL=$((TOTAL + T)); OK=$((OK + 1))
+            echo " -> run $r: ${T} ms"
+        else
+            echo " -> run $r: failed"
+        fi
+    done
+    BYTES=$(( $(uavh_bytes) - BYTES_0 )); PACKETS=$(( $(uavh_packets) - PACKETS_0 ))
+    CPU=$(( $(cpu_ms $ROOT_PID) - CPU_0 ))
+
+    MEAN="n/a"
+    if [[ $OK -gt 0 ]]; then MEAN=$((TOTAL / OK)); fi
+    RESULTS+=$(printf "%-10s %10s %8s %12s %10s %12s" "$K" "$MEAN" "$OK/$RUNS" \
+        "$((BYTES / RUNS))" "$((PACKETS / RUNS))" "$((CPU / RUNS))")$'\n'
+done
+
+# ================= 2. Report =================
+echo "================================================================"
+printf "%-10s %10s %8s %12s %10s %12s\n" "sub-heads" "mean(ms)" "ok" "root B/run" "pkts/run" "root CPU ms"
+printf "%s" "$RESULTS"
@@ -0,0 +1,100 @@
+#!/bin/bash
+set -e
+
+# Compares paced (PACE_REPLIES=1) and unpaced partial-signature collection on a
+# bandwidth-limited swarm link. The link into UAVh, where all replies converge,
+# is shaped with the token bucket of config.env (NET_BANDWIDTH / NET_BURST / NET_LATENCY).
+# For each mode the Verifier runs RUNS times; reported are the mean authentication
+# time, the UAVh collection latency percentiles (LATENCY_CSV) and the tbf drops.
+#
+# Usage (from the netSim build directory, after build_uav_net.sh):
+#   sudo ./scripts/bench_pacing.sh [RUNS]
+
+# ================= 0. Permission & Configuration Check =================
+if [[ $EUID -ne 0 ]]; then echo "Error: Please run as root (sudo)."; exit 1; fi
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+CONFIG_FILE="$SCRIPT_DIR/config.env"
+BUILD_DIR="$( dirname "$SCRIPT_DIR" )"
+RUNS=${1:-10}
+
+if [ -f "$CONFIG_FILE" ]; then
+    source "$CONFIG_FILE"
+else
+    echo "Error: Configuration file not found: $CONFIG_FILE"; exit 1
+fi
+if ! ip netns list | grep -q "^UAVh"; then
+    echo "Error: Swarm namespaces not found. Run: sudo ./scripts/build_uav_net.sh"; exit 1
+fi
+NET_BURST=${NET_BURST:-"32kbit"}
+NET_LATENCY=${NET_LATENCY:-"400ms"}
+LATENCY_CSV=${LATENCY_CSV:-"latency.csv"}
+
+cd "$BUILD_DIR"
+
+# The binaries read scripts/config.env: patch it per mode and restore it on exit
+cp "$CONFIG_FILE" "$CONFIG_FILE.bak"
+cleanup() {
+    pkill -9 -f _netSim 2>/dev/null || true
+    tc qdisc del dev veth-uavh root 2>/dev/null || true
+    mv -f "$CONFIG_FILE.bak" "$CONFIG_FILE"
+}
+trap cleanup EXIT
+
+set_option() {
+    sed -i "s/^$1=[^ ]*/$1=$2/" "$CONFIG_FILE"
+}
+
+# ================= 1. Shape the link into UAVh =================
+echo "[*] Shaping bridge -> UAVh: $NET_BANDWIDTH (burst $NET_BURST, latency $NET_LATENCY)"
+tc qdisc del dev veth-uavh root 2>/dev/null || true
+tc qdisc add dev veth-uavh root tbf rate "$NET_BANDWIDTH" burst "$NET_BURST" latency "$NET_LATENCY"
+
+tbf_drops() {
+    tc -s qdisc show dev veth-uavh | grep -o "dropped [0-9]*" | awk '{print $2}' | head -n1
+}
+
+# ================= 2. Benchmark Loop =================
+RESULTS=""
+for PACE in 0 1; do
+    echo "================================================================"
+    echo "[*] PACE_REPLIES=$PACE (N=$NUM_UAV, runs=$RUNS)"
+    set_option PACE_REPLIES $PACE
+    set_option PACE_RATE "\"$NET_BANDWIDTH\""
+
+    pkill -9 -f _netSim 2>/dev/null || true
+    sleep 1
+    rm -f "$LATENCY_CSV"
+
+    ip netns exec TA ./TA_netSim > /dev/null 2>&1 &
+    sleep 1
+    "$SCRIPT_DIR/run_uavs.sh" > /dev/null
+    sleep 2
+    ip netns exec UAVh ./UAVh_netSim > /dev/null 2>&1 &
+    sleep 2
+
+    DROPS_0=$(tbf_drops)
+    TOTAL=0; OK=0
+    for r in $(seq 1 $RUNS); do
+        T=$(ip netns exec Verifier ./Verifier_netSim 2>/dev/null | \
+            grep "Total Authentication Time" | awk '{print $5}' | head -n1)
+        if [[ -n "$T" ]]; then
+            TOTAL=$((TOTAL + T)); OK=$((OK + 1))
+            echo " -> run $r: ${T} ms"
+        else
+            echo " -> run $r: failed"
+        fi
+    done
+    DROPS=$(( $(tbf_drops) - DROPS_0 ))
+
+    MEAN="n/a"
+    if [[ $OK -gt 0 ]]; then MEAN=$((TOTAL / OK)); fi
+    # Last cumulative row of the UAVh session latency: p50 / p99 columns
+    SESSION=$(grep ",UAVh,session," "$LATENCY_CSV" 2>/dev/null | tail -n1 | awk -F, '{printf "%.0f/%.0f", $5, $7}')
+    RESULTS+=$(printf "%-8s %10s %8s %16s %8s" "$PACE" "$MEAN" "$OK/$RUNS" "${SESSION:-n/a}" "$DROPS")$'\n'
+done
+
+# ================= 3. Report =================
+echo "================================================================"
+printf "%-8s %10s %8s %16s %8s\n" "paced" "mean(ms)" "ok" "UAVh p50/p99(ms)" "drops"
+printf "%s" "$RESULTS"
@@ -65,6 +65,8 @@ ip netns exec Verifier ip route add default via ${NET_VF}.1
 # ================= 5. Build Zone C: Swarm =================
 echo "[+] Building Zone C Infrastructure (br-swarm)..."
 ip link add name br-swarm type bridge
+# Flood multicast to every port: the swarm has no IGMP querier, so snooping would drop BITMAP_FANOUT=multicast
+ip link set br-swarm type bridge mcast_snooping 0
 ip addr add ${NET_SWARM}.1/24 dev br-swarm
 ip link set br-swarm up
 
@@ -80,7 +82,40 @@ ip netns exec UAVh ip link set veth-uavh-ns up
 ip netns exec UAVh ip link set lo up
 ip netns exec UAVh ip route add default via ${NET_SWARM}.1
 
+# --- Sub-Cluster Heads (SUB_HEADS > 0: sub-head k at .(10+k)) ---
+SUB_HEADS=${SUB_HEADS:-0}
+if (( SUB_HEADS > 90 )); then echo "Error: at most 90 sub-heads (${NET_SWARM}.10 - .99)."; exit 1; fi
+for ((k=0; k<SUB_HEADS; k++)); do
+    NS_NAME="SubHead$k"
+    ip netns add $NS_NAME
+    ip link add veth-sub$k type veth peer name veth-sub$k-ns
+    ip link set veth-sub$k master br-swarm
+    ip link set veth-sub$k up
+    ip link set veth-sub$k-ns netns $NS_NAME
+    ip netns exec $NS_NAME ip addr add ${NET_SWARM}.$((10+k))/24 dev veth-sub$k-ns
+    ip netns exec $NS_NAME ip link set veth-sub$k-ns up
+    ip netns exec $NS_NAME ip link set lo up
+    ip netns exec $NS_NAME ip route add default via ${NET_SWARM}.1
+    echo "[+] Attaching $NS_NAME success..."
+done
+
 # --- UAV Members ---
+if [[ "$UAV_HOST" == "1" ]]; then
+    # One namespace carries the address of every UAV; UAVHost_netSim serves them all
+    if (( NUM_UAV > 154 )); then echo "Error: ${NET_SWARM}.0/24 holds at most 154 UAV addresses."; exit 1; fi
+    echo "[+] Attaching UAVHost with $NUM_UAV UAV addresses..."
+    ip netns add UAVHost
+    ip link add veth-uavhost type veth peer name veth-uavhost-ns
+    ip link set veth-uavhost master br-swarm
+    ip link set veth-uavhost up
+    ip link set veth-uavhost-ns netns UAVHost
+    for i in $(seq 1 $NUM_UAV); do
+        ip netns exec UAVHost ip addr add ${NET_SWARM}.$((100+i))/24 dev veth-uavhost-ns
+    done
+    ip netns exec UAVHost ip link set veth-uavhost-ns up
+    ip netns exec UAVHost ip link set lo up
+    ip netns exec UAVHost ip route add default via ${NET_SWARM}.1
+else
 echo "[+] Attaching $NUM_UAV UAV Member nodes..."
 for i in $(seq 1 $NUM_UAV); do
     NS_NAME="UAV$i"
@@ -99,6 +134,7 @@ for i in $(seq 1 $NUM_UAV); do
     ip netns exec $NS_NAME ip route add default via ${NET_SWARM}.1
     echo "[+] Attaching $NS_NAME success..."
 done
+fi
 
 # ================= Completion Report =================
 echo ""
@@ -107,5 +143,8 @@ echo "=== Experiment Launch Steps ==="
 echo "0. Configure Network Simulation:  sudo ./scripts/tc_latency.sh (Auto-reads config)"
 echo "1. Start TA Server:               sudo ip netns exec TA ./TA_netSim"
 echo "2. Start UAV Members:             sudo ./scripts/run_uavs.sh (Auto-reads config)"
+if (( SUB_HEADS > 0 )); then
+echo "2b. Start Sub-Heads:              sudo ./scripts/run_subheads.sh (Auto-reads config)"
+fi
 echo "3. Start UAVh (Cluster Head):     sudo ip netns exec UAVh ./UAVh_netSim"
 echo "4. Start Verifier:                sudo ip netns exec Verifier ./Verifier_netSim"
\ No newline at end of file
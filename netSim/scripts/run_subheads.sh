@@ -0,0 +1,39 @@
+#!/bin/bash
+set -e
+
+# ================= 0. Permission & Configuration Check =================
+if [[ $EUID -ne 0 ]]; then echo "Error: Please run as root (sudo)."; exit 1; fi
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+CONFIG_FILE="$SCRIPT_DIR/config.env"
+
+if [ -f "$CONFIG_FILE" ]; then
+    source "$CONFIG_FILE"
+    echo "[Config] Loaded config file: $CONFIG_FILE"
+else
+    echo "Error: Configuration file not found: $CONFIG_FILE"; exit 1
+fi
+
+if [[ -z "$SUB_HEADS" || "$SUB_HEADS" -le 0 ]]; then
+    echo "Error: SUB_HEADS must be > 0 in the config file."; exit 1
+fi
+
+# ================= 1. Batch Startup Logic =================
+# Sub-head k runs in namespace SubHead$k (${NET_SWARM}.(10+k), port 8100+k), which
+# build_uav_net.sh creates for the SUB_HEADS it was run with
+echo "[*] Starting $SUB_HEADS sub-heads in the background..."
+
+for ((k=0; k<SUB_HEADS; k++)); do
+    NS_NAME="SubHead$k"
+    if ! ip netns list | grep -q "^$NS_NAME\b"; then
+        echo "Error: $NS_NAME not found. Rebuild the network with this SUB_HEADS: sudo ./scripts/build_uav_net.sh"; exit 1
+    fi
+    echo " -> Starting $NS_NAME..."
+    ip netns exec $NS_NAME ./UAVh_netSim $k > /dev/null 2>&1 &
+    sleep 0.2
+done
+
+# ================= 2. Completion Prompt =================
+echo ""
+echo "=== All sub-heads started (Total: $SUB_HEADS) ==="
+echo "Hint: Start the root afterwards: sudo ip netns exec UAVh ./UAVh_netSim"
@@ -20,6 +20,16 @@ fi
 if [[ -z "$NUM_UAV" ]]; then echo "Error: NUM_UAV is undefined in the config file."; exit 1; fi
 
 # ================= 1. Batch Startup Logic =================
+if [[ "$UAV_HOST" == "1" ]]; then
+    # Built with UAV_HOST=1: one process serves every UAV address of the UAVHost namespace
+    echo "[*] Starting UAVHost with $NUM_UAV UAVs in the background..."
+    ulimit -n "$(ulimit -Hn)"
+    ip netns exec UAVHost ./UAVHost_netSim $NUM_UAV > /dev/null 2>&1 &
+    echo "=== UAVHost started (Total: $NUM_UAV UAVs) ==="
+    echo "Hint: Per-UAV usage is written to $HOST_USAGE_CSV."
+    exit 0
+fi
+
 echo "[*] Starting $NUM_UAV UAV nodes in the background..."
 
 for i in $(seq 1 $NUM_UAV); do
@@ -33,7 +43,8 @@ for i in $(seq 1 $NUM_UAV); do
     # 2. ./UAV_netSim: Run your program (Assuming execution from build dir)
     # 3. > /dev/null 2>&1: Discard output (Prevents terminal freeze due to mixed logs from 64 processes)
     # 4. &: Run in background
-    ip netns exec $NS_NAME ./UAV_netSim > /dev/null 2>&1 &
+    # NODE_NAME names the cached registration of this UAV (NODE_CACHE_DIR)
+    ip netns exec $NS_NAME env NODE_NAME=$NS_NAME ./UAV_netSim > /dev/null 2>&1 &
 
     # Slight sleep to prevent CPU spikes or packet loss from instantaneous high concurrency
     sleep 0.05
@@ -35,9 +35,13 @@ echo "[*] Configuring Scenario 2: Ultra-low Bandwidth (UAVh Upload Limit)..."
 # ================= 3. Clean Old Rules =================
 # Critical! Must clear netem delay on UAV nodes in case the latency script was run previously.
 echo " -> Cleaning normal UAV node rules (Prevent residual latency)..."
-for i in $(seq 1 $NUM_UAV); do
-    clean_tc "UAV$i" "veth-uav$i-ns"
-done
+if [[ "$UAV_HOST" == "1" ]]; then
+    clean_tc "UAVHost" "veth-uavhost-ns"
+else
+    for i in $(seq 1 $NUM_UAV); do
+        clean_tc "UAV$i" "veth-uav$i-ns"
+    done
+fi
 
 # Clean Verifier
 clean_tc "Verifier" "veth-vf-ns"
@@ -54,4 +58,13 @@ ip netns exec UAVh tc qdisc add dev veth-uavh-ns root tbf \
     burst "$NET_BURST" \
     latency "$NET_LATENCY"
 
+# Sub-heads forward their part of Sigma over a link like the one of UAVh
+for ((k=0; k<${SUB_HEADS:-0}; k++)); do
+    clean_tc "SubHead$k" "veth-sub$k-ns"
+    ip netns exec SubHead$k tc qdisc add dev veth-sub$k-ns root tbf \
+        rate "$NET_BANDWIDTH" \
+        burst "$NET_BURST" \
+        latency "$NET_LATENCY"
+done
+
 echo "[*] Scenario 2 (Bandwidth Limit) Configuration Complete."
\ No newline at end of file
@@ -50,6 +50,12 @@ clean_tc "UAVh" "veth-uavh-ns"
 echo " -> Setting UAVh ($NET_DELAY ± $NET_JITTER)"
 ip netns exec UAVh tc qdisc add dev veth-uavh-ns root netem delay "$NET_DELAY" "$NET_JITTER"
 
+# --- Configure Sub-Heads (same link as UAVh) ---
+for ((k=0; k<${SUB_HEADS:-0}; k++)); do
+    clean_tc "SubHead$k" "veth-sub$k-ns"
+    ip netns exec SubHead$k tc qdisc add dev veth-sub$k-ns root netem delay "$NET_DELAY" "$NET_JITTER"
+done
+
 # --- Configure Verifier ---
 clean_tc "Verifier" "veth-vf-ns"
 echo " -> Setting Verifier ($NET_DELAY ± $NET_JITTER)"
@@ -30,14 +30,20 @@ echo "[*] Configuring Scenario 3: High Packet Loss (Internal Swarm Loss) [Loss:
 
 # ================= 3. Configure UAV Members =================
 # Simulate loss of signature data reported by UAVs (Uplink)
-for i in $(seq 1 $NUM_UAV); do
-    NS_NAME="UAV$i"
-    DEV_NAME="veth-uav$i-ns"
+if [[ "$UAV_HOST" == "1" ]]; then
+    # All UAVs share the UAVHost link, losses stay independent per packet
+    clean_tc "UAVHost" "veth-uavhost-ns"
+    ip netns exec UAVHost tc qdisc add dev veth-uavhost-ns root netem loss "$NET_LOSS"
+else
+    for i in $(seq 1 $NUM_UAV); do
+        NS_NAME="UAV$i"
+        DEV_NAME="veth-uav$i-ns"
 
-    clean_tc $NS_NAME $DEV_NAME
-    # Use NET_LOSS from config
-    ip netns exec $NS_NAME tc qdisc add dev $DEV_NAME root netem loss "$NET_LOSS"
-done
+        clean_tc $NS_NAME $DEV_NAME
+        # Use NET_LOSS from config
+        ip netns exec $NS_NAME tc qdisc add dev $DEV_NAME root netem loss "$NET_LOSS"
+    done
+fi
 echo " -> Packet loss rate set for $NUM_UAV UAV nodes."
 
 # ================= 4. Configure Core Nodes =================
@@ -47,6 +53,12 @@ clean_tc "UAVh" "veth-uavh-ns"
 echo " -> Setting UAVh loss: $NET_LOSS"
 ip netns exec UAVh tc qdisc add dev veth-uavh-ns root netem loss "$NET_LOSS"
 
+# --- Configure Sub-Heads (same link as UAVh) ---
+for ((k=0; k<${SUB_HEADS:-0}; k++)); do
+    clean_tc "SubHead$k" "veth-sub$k-ns"
+    ip netns exec SubHead$k tc qdisc add dev veth-sub$k-ns root netem loss "$NET_LOSS"
+done
+
 # --- Clean Verifier (Keep external link perfect) ---
 clean_tc "Verifier" "veth-vf-ns"
 echo " -> Verifier network is perfect (Rules cleared)"
@@ -0,0 +1,997 @@
+#include "../include/Simulator.h"
+
+#include <ctime>
+#include <fstream>
+#include <memory>
+
+
+namespace simulator_NS {
+
+// ============================================================
+// Wire constants
+// ============================================================
+
+    const size_t kMss = 1448;               // TCP payload per segment (1500 MTU, timestamps)
+    const size_t kTcpOverhead = 66;         // Ethernet + IPv4 + TCP with timestamps
+    const size_t kUdpOverhead = 42;         // Ethernet + IPv4 + UDP
+    const size_t kSynBytes = 74;            // SYN / SYN-ACK with options
+    const size_t kUpgradeRequest = 220;     // HTTP upgrade request of the websocketpp client
+    const size_t kUpgradeResponse = 160;    // "101 Switching Protocols"
+    const double kSynRtoMs = 1000;          // Linux TCP_TIMEOUT_INIT
+    const double kRtoMs = 200;              // Linux TCP_RTO_MIN
+    const int kMaxRetransmits = 15;         // Linux tcp_retries2: the connection is given up afterwards
+    const double kScanMs = 1;               // UAVh checks for overdue UAVs once per ms
+
+
+// ============================================================
+// Global state
+// ============================================================
+
+    Simulation sim;
+
+    static Config cfg;
+    static Node verifierNode, uavhNode;
+    static std::vector<SimUAV> swarm;
+    static UAVNode_NS::UAVContext swarmCtx;   // parameters shared by all simulated UAVs, keys swapped in per call
+
+    static double initTimeoutMs = 1000;       // INIT_TIMEOUT_MS
+    static size_t initialReplyBytes = 256;    // PACE_REPLY_BYTES
+    static double uavCpuScale = 1;            // SIM_UAV_CPU_SCALE
+    static double timeLimitMs = 600000;       // SIM_TIME_LIMIT
+    static bool taStateReady = false;
+
+    // One line of SIM_TRACE: "time_ms,link,KEY=VALUE"
+    struct TraceEntry {
+        double atMs;
+        std::string link;
+        Config change;
+    };
+    static std::vector<TraceEntry> trace;
+
+    // Node code reports every step on stdout; the simulator only keeps its own output
+    struct MuteStdout {
+        std::streambuf *saved;
+        MuteStdout() : saved(std::cout.rdbuf(nullptr)) {}
+        ~MuteStdout() { std::cout.rdbuf(saved); }
+    };
+
+    static double threadCpuMs() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+    }
+
+
+// ============================================================
+// Links
+// ============================================================
+
+    void applyLinkConfig(Link &link, const Config &change) {
+        link.delayMs = configMillis(change, "NET_DELAY", link.delayMs);
+        link.jitterMs = configMillis(change, "NET_JITTER", link.jitterMs);
+        link.loss = configPercent(change, "NET_LOSS", link.loss);
+        link.rate = configRate(change, "NET_BANDWIDTH", link.rate);
+        // The bucket is written like a rate ("64kbit") and read as a number of bits
+        link.burst = configRate(change, "NET_BURST", link.burst);
+        link.limitMs = configMillis(change, "NET_LATENCY", link.limitMs);
+    }
+
+    // Nodes a link name of the trace refers to: "UAVh", "Verifier", "UAV<i>" or "UAV*"
+    static std::vector<Node *> nodesNamed(const std::string &name) {
+        std::vector<Node *> nodes;
+        if (name == verifierNode.name) nodes.push_back(&verifierNode);
+        if (name == uavhNode.name) nodes.push_back(&uavhNode);
+        for (SimUAV &u: swarm) {
+            if (name == "UAV*" || name == u.node.name) nodes.push_back(&u.node);
+        }
+        return nodes;
+    }
+
+    // Entries of config.env that one of the tc scripts applies
+    static Config pick(const std::vector<std::string> &keys) {
+        Config out;
+        for (const std::string &key: keys) {
+            auto it = cfg.find(key);
+            if (it != cfg.end()) out.insert(*it);
+        }
+        return out;
+    }
+
+    void applyScenario(const std::string &scenario) {
+        verifierNode.egress = Link();
+        uavhNode.egress = Link();
+        for (SimUAV &u: swarm) u.node.egress = Link();
+
+        bool every = scenario == "all";
+        // tc_latency.sh: netem delay on the UAVh and Verifier egress
+        if (every || scenario == "latency") {
+            Config c = pick({"NET_DELAY", "NET_JITTER"});
+            applyLinkConfig(uavhNode.egress, c);
+            applyLinkConfig(verifierNode.egress, c);
+        }
+        // tc_bandwidth.sh: tbf on the UAVh egress, shared by every request and the answer
+        if (every || scenario == "bandwidth") {
+            applyLinkConfig(uavhNode.egress, pick({"NET_BANDWIDTH", "NET_BURST", "NET_LATENCY"}));
+        }
+        // tc_loss.sh: netem loss on every UAV and on UAVh
+        if (every || scenario == "loss") {
+            Config c = pick({"NET_LOSS"});
+            applyLinkConfig(uavhNode.egress, c);
+            for (SimUAV &u: swarm) applyLinkConfig(u.node.egress, c);
+        }
+    }
+
+    static bool loadTrace(const std::string &path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "[Sim] Could not open link trace " << path << std::endl;
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t commentPos = line.find('#');
+            if (commentPos != std::string::npos) line = line.substr(0, commentPos);
+            size_t c1 = line.find(','), c2 = line.find(',', c1 + 1), eq = line.find('=', c2 + 1);
+            if (c1 == std::string::npos || c2 == std::string::npos || eq == std::string::npos) continue;
+            try {
+                TraceEntry entry;
+                entry.atMs = std::stod(line.substr(0, c1));
+                entry.link = line.substr(c1 + 1, c2 - c1 - 1);
+                entry.change[line.substr(c2 + 1, eq - c2 - 1)] = line.substr(eq + 1);
+                trace.push_back(entry);
+            } catch (...) {
+                std::cerr << "[Sim] Invalid trace line ignored: " << line << std::endl;
+            }
+        }
+        std::cout << "[Sim] Loaded " << trace.size() << " link changes from " << path << std::endl;
+        return true;
+    }
+
+
+// ============================================================
+// Event engine
+// ============================================================
+
+    void schedule(double at, std::function<void()> fn) {
+        sim.events.push(Event{std::max(at, sim.now), sim.seq++, std::move(fn)});
+    }
+
+    void runEvents(const std::function<bool()> &stop) {
+        while (!sim.events.empty() && !stop()) {
+            Event ev = sim.events.top();
+            sim.events.pop();
+            sim.now = ev.at;
+            ev.fn();
+        }
+    }
+
+    double compute(Node &node, const std::function<void()> &work) {
+        double start = std::max(sim.now, node.cpuFree);
+        double used;
+        {
+            MuteStdout mute;
+            double before = threadCpuMs();
+            work();
+            used = threadCpuMs() - before;
+        }
+        double cost = used * node.cpuScale;
+        node.cpuFree = start + cost;
+        node.cpuMs += cost;
+        return node.cpuFree;
+    }
+
+
+// ============================================================
+// Packets and messages
+// ============================================================
+
+    double transmit(Node &from, size_t bytes) {
+        Link &link = from.egress;
+        sim.stats.packets++;
+        sim.stats.bytes += bytes;
+
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        if (link.loss > 0 && uniform(sim.rng) < link.loss) {
+            sim.stats.drops++;
+            return -1;
+        }
+
+        double depart = sim.now;
+        if (link.rate > 0) {
+            double bits = 8.0 * bytes;
+            link.tokens = std::min(link.burst, link.tokens + (sim.now - link.tokensAt) * link.rate / 1000);
+            link.tokensAt = sim.now;
+            double waitMs = link.tokens >= bits ? 0 : (bits - link.tokens) / link.rate * 1000;
+            // tbf drops what exceeds the bucket or would wait longer than its latency
+            if (bits > link.burst || waitMs > link.limitMs) {
+                sim.stats.drops++;
+                return -1;
+            }
+            link.tokens -= bits;
+            depart += waitMs;
+        }
+
+        double jitter = link.jitterMs > 0 ? (2 * uniform(sim.rng) - 1) * link.jitterMs : 0;
+        return depart + std::max(0.0, link.delayMs + jitter);
+    }
+
+    // Retransmits a lost segment after `rtoMs` until the connection is given up
+    static void sendSegmentAttempt(Node *from, size_t bytes, double rtoMs, int attempt,
+                                   const std::function<void()> &onArrival) {
+        double arrival = transmit(*from, bytes);
+        if (arrival >= 0) {
+            schedule(arrival, onArrival);
+            return;
+        }
+        if (attempt >= kMaxRetransmits) return;
+        schedule(sim.now + rtoMs, [from, bytes, rtoMs, attempt, onArrival]() {
+            sim.stats.retransmits++;
+            sendSegmentAttempt(from, bytes, std::min(2 * rtoMs, 120000.0), attempt + 1, onArrival);
+        });
+    }
+
+    void sendSegment(Node &from, size_t bytes, double rtoMs, const std::function<void()> &onArrival) {
+        sendSegmentAttempt(&from, bytes, rtoMs, 0, onArrival);
+    }
+
+    void sendMessage(Node &from, const StreamPtr &stream, size_t payload, bool masked,
+                     const std::function<void()> &onDelivered) {
+        size_t frame = payload + (payload < 126 ? 2 : payload < 65536 ? 4 : 10) + (masked ? 4 : 0);
+        size_t segments = (frame + kMss - 1) / kMss;
+        uint64_t seq = stream->nextSend++;
+        auto missing = std::make_shared<size_t>(segments);
+
+        // TCP hands the message over once all its segments and all earlier messages arrived
+        auto onSegment = [stream, seq, missing, onDelivered]() {
+            if (--*missing > 0) return;
+            stream->complete[seq] = onDelivered;
+            while (!stream->complete.empty() && stream->complete.begin()->first == stream->nextDeliver) {
+                std::function<void()> deliver = stream->complete.begin()->second;
+                stream->complete.erase(stream->complete.begin());
+                stream->nextDeliver++;
+                deliver();
+            }
+        };
+        for (size_t k = 0; k < segments; ++k) {
+            sendSegment(from, std::min(kMss, frame - k * kMss) + kTcpOverhead, kRtoMs, onSegment);
+        }
+    }
+
+    void openConnection(Node &client, Node &server, const std::function<void()> &onOpen) {
+        Node *c = &client, *s = &server;
+        sendSegment(client, kSynBytes, kSynRtoMs, [c, s, onOpen]() {
+            sendSegment(*s, kSynBytes, kSynRtoMs, [c, s, onOpen]() {
+                sendSegment(*c, kTcpOverhead + kUpgradeRequest, kRtoMs, [s, onOpen]() {
+                    sendSegment(*s, kTcpOverhead + kUpgradeResponse, kRtoMs, onOpen);
+                });
+            });
+        });
+    }
+
+    void sendDatagramCopies(Node &from, size_t payload, int copies, const std::function<void()> &onDelivered) {
+        auto delivered = std::make_shared<bool>(false);
+        size_t bytes = kUdpOverhead + kDatagramHeader + payload;
+        for (int k = 0; k < copies; ++k) {
+            double arrival = transmit(from, bytes);
+            if (arrival < 0) continue;
+            schedule(arrival, [delivered, onDelivered]() {
+                if (*delivered) return;
+                *delivered = true;
+                onDelivered();
+            });
+        }
+    }
+
+
+// ============================================================
+// Swarm
+// ============================================================
+
+    // TA issues the keys of UAV i as if it registered i-th
+    static void issueKeys(int i) {
+        SimUAV &u = swarm[i];
+        if (u.keyed) return;
+        u.keys = getUAV(TA_NS::pp, TA_NS::poly_d, TA_NS::poly_b, TA_NS::registeredIDs[i], i, TA_NS::state);
+        verifier_NS::PK_s.set(i, u.keys.PK[TA_NS::thresholdT - 2]);
+        u.keyed = true;
+    }
+
+    // A new deployment: UAVh has not measured any UAV yet
+    static void resetUAVh() {
+        RttEstimator initial;
+        initial.initialRto = initTimeoutMs;
+        UAVhNode_NS::uavRtt.assign(UAVhNode_NS::numUAV, initial);
+        UAVhNode_NS::rttStats = LatencyStats();
+        UAVhNode_NS::sessionStats = LatencyStats();
+        UAVhNode_NS::uavHealth.assign(UAVhNode_NS::numUAV, PeerHealth());
+        UAVhNode_NS::replyBytes = initialReplyBytes;
+    }
+
+    void setupSwarm(int numUAV, int threshold) {
+        {
+            MuteStdout mute;
+            if (taStateReady) gmp_randclear(TA_NS::state);
+            TA_NS::kNumUAV = numUAV;
+            TA_NS::kThresholdMax = threshold;
+            TA_NS::poly_d.clear();
+            TA_NS::poly_b.clear();
+            TA_NS::registeredIDs.clear();
+            TA_NS::initParams();
+            taStateReady = true;
+        }
+
+        // Every simulated UAV is its own machine: no SignCache, each one runs SignInit
+        auto params = std::make_shared<UAVNode_NS::SwarmParams>();
+        params->pp = TA_NS::pp;
+        params->message = TA_NS::messageM;
+        params->threshold = TA_NS::thresholdT;
+        params->registeredIDs = TA_NS::registeredIDs;
+        swarmCtx.swarm = params;
+        swarmCtx.uav = UAV();
+
+        UAVhNode_NS::pp = TA_NS::pp;
+        UAVhNode_NS::uavh.ID = 0;
+        UAVhNode_NS::uavh.alpha = TA_NS::alpha;
+        UAVhNode_NS::message = TA_NS::messageM;
+        UAVhNode_NS::threshold = TA_NS::thresholdT;
+        UAVhNode_NS::numUAV = numUAV;
+        UAVhNode_NS::ownFirst = 0;      // one flat head requests the whole swarm
+        UAVhNode_NS::ownEnd = numUAV;
+        resetUAVh();
+
+        verifier_NS::params = TA_NS::pp;
+        verifier_NS::messageM = TA_NS::messageM;
+        verifier_NS::thresholdT = TA_NS::thresholdT;
+        verifier_NS::registeredIDs = TA_NS::registeredIDs;
+        verifier_NS::PK_s = ECP2Array(numUAV, ECP2());
+        verifier_NS::swarmHealth.clear();
+
+        swarm.clear();
+        swarm.resize(numUAV);
+        for (int i = 0; i < numUAV; ++i) {
+            swarm[i].node.name = "UAV" + std::to_string(i + 1);
+            swarm[i].node.cpuScale = uavCpuScale;
+        }
+    }
+
+
+// ============================================================
+// One authentication
+// ============================================================
+
+    struct SessionState {
+        uint32_t sid = 0;
+        bool done = false;
+        RunResult result;
+
+        // Verifier
+        verifier_NS::AuthSession vs;
+        StreamPtr toUAVh = std::make_shared<Stream>();
+        StreamPtr toVerifier = std::make_shared<Stream>();
+
+        // UAVh
+        UAVhNode_NS::SessionPtr session;
+        AggContext agg;
+        Sigma sigma;
+        int needed = 0;
+        std::string prefix;
+        std::vector<bool> seen;
+        std::vector<int> waiting;
+        std::vector<double> paceOffset, firstSent, lastSent;   // virtual ms
+
+        // UAV datagram servers: reply cache and acknowledgement per UAV
+        std::vector<std::string> cached;
+        std::vector<double> sendAt;
+        std::vector<bool> acked;
+    };
+    using StatePtr = std::shared_ptr<SessionState>;
+
+    static void uavOnRequest(const StatePtr &s, int i, const std::string &body, bool datagram);
+
+    static void verifierOnMessage(const StatePtr &s, const std::string &payload) {
+        verifier_NS::AuthSession &vs = s->vs;
+        std::string body = payload.substr(payload.find('#') + 1);
+
+        if (verifier_NS::streamSigma && body != "END") {
+            compute(verifierNode, [&]() {
+                VerifyAppend(vs.ctx, verifier_NS::params, wire_to_SigmaShare(body));
+            });
+            return;
+        }
+
+        int res = 0;
+        double end = compute(verifierNode, [&]() {
+            if (verifier_NS::streamSigma) {
+                res = VerifyFinal(vs.ctx, verifier_NS::params);
+            } else {
+                res = Verify(wire_to_Sigma(body), vs.sk_v, verifier_NS::params, verifier_NS::messageM,
+                             verifier_NS::registeredIDs, verifier_NS::PK_s);
+            }
+        });
+        schedule(end, [s, res]() {
+            s->result.authMs = sim.now;
+            s->result.verified = res;
+            s->done = true;
+        });
+    }
+
+    static void uavhFinish(const StatePtr &s) {
+        s->session->collecting.store(false, std::memory_order_release);
+        s->result.signatures = (int) s->sigma.indices.size();
+        s->result.timeouts = (int) s->session->timedOut.size();
+
+        std::string sigStr;
+        double ready = compute(uavhNode, [&]() {
+            sigStr = s->prefix + (s->session->stream ? "END" : Sigma_to_wire(s->sigma, s->session->compressed));
+        });
+        schedule(ready, [s, sigStr]() {
+            sendMessage(uavhNode, s->toVerifier, sigStr.size(), false, [s, sigStr]() {
+                verifierOnMessage(s, sigStr);
+            });
+        });
+    }
+
+    // Signer-set request to UAV i, on a new connection (ws) or as datagrams (udp)
+    static void uavhRequest(const StatePtr &s, int i, bool paced) {
+        uint32_t slotUs = paced ? s->session->slotUs : 0;
+        std::string body = std::to_string(slotUs) + "#" + s->session->signers;
+
+        if (UAVhNode_NS::useDatagrams) {
+            sendDatagramCopies(uavhNode, body.size(), UAVhNode_NS::udpRedundancy, [s, i, body]() {
+                uavOnRequest(s, i, body, true);
+            });
+            return;
+        }
+        openConnection(uavhNode, swarm[i].node, [s, i, body]() {
+            std::string frame = std::to_string(s->sid) + "#" + body;
+            sendMessage(uavhNode, std::make_shared<Stream>(), frame.size(), true, [s, i, body]() {
+                uavOnRequest(s, i, body, false);
+            });
+        });
+    }
+
+    // The collector: transform what arrived, as in collectPartialSignatures()
+    static void uavhCollect(const StatePtr &s) {
+        UAVhNode_NS::SessionPtr session = s->session;
+        const std::vector<int> &S = session->S;
+        auto isSelected = [&S](int idx) { return signerRank(S, idx) >= 0; };
+
+        parSig sig;
+        while (session->collecting.load(std::memory_order_acquire) && session->arrivals->pop(sig)) {
+            int idx = sig.index;
+            if (!isSelected(idx) || s->seen[idx]) continue;
+            s->seen[idx] = true;
+            s->waiting.erase(std::remove(s->waiting.begin(), s->waiting.end(), idx), s->waiting.end());
+
+            if (session->attempts[idx] == 1) {
+                double rtt = std::max(0.0, sim.now - s->firstSent[idx] - s->paceOffset[idx]);
+                rttUpdate(UAVhNode_NS::uavRtt[idx], rtt);
+                latencyAdd(UAVhNode_NS::rttStats, rtt);
+                healthReply(UAVhNode_NS::uavHealth[idx], rtt);
+            }
+
+            std::string shareStr;
+            double done = compute(uavhNode, [&]() {
+                AggAppend(s->agg, UAVhNode_NS::pp, sig, s->sigma);
+                if (session->stream) {
+                    SigmaShare share;
+                    share.aux = s->sigma.aux.back();
+                    ECP_copy(&share.sig, &s->sigma.sig.back());
+                    share.index = s->sigma.indices.back();
+                    shareStr = s->prefix + SigmaShare_to_wire(share, session->compressed);
+                }
+            });
+            if (session->stream) {
+                schedule(done, [s, shareStr]() {
+                    sendMessage(uavhNode, s->toVerifier, shareStr.size(), false, [s, shareStr]() {
+                        verifierOnMessage(s, shareStr);
+                    });
+                });
+            }
+            if ((int) s->sigma.indices.size() == s->needed) {
+                uavhFinish(s);
+                return;
+            }
+        }
+    }
+
+    static void uavhOnReply(const StatePtr &s, const std::string &body) {
+        double at = compute(uavhNode, [&]() {
+            UAVhNode_NS::deliverPartialSignature(s->sid, body);
+        });
+        schedule(at, [s]() { uavhCollect(s); });
+    }
+
+    // Hedge or give up on overdue UAVs, as in collectPartialSignatures()
+    static void uavhScan(const StatePtr &s) {
+        UAVhNode_NS::SessionPtr session = s->session;
+        if (!session->collecting.load(std::memory_order_acquire)) return;
+
+        double hedgeAt = UAVhNode_NS::rttStats.samples.size() < 16 ? -1 :
+                         latencyPercentile(UAVhNode_NS::rttStats, UAVhNode_NS::hedgePercentile);
+        std::vector<int> stillWaiting;
+        for (int idx: s->waiting) {
+            double deadline = rttTimeout(UAVhNode_NS::uavRtt[idx]);
+            double silent = sim.now - s->lastSent[idx];
+            if (session->attempts[idx] == 1) silent -= s->paceOffset[idx];
+            double hedgeAfter = hedgeAt < 0 ? deadline : std::min(deadline, hedgeAt);
+            if (session->attempts[idx] <= UAVhNode_NS::maxRetries && silent >= hedgeAfter) {
+                uavhRequest(s, idx, false);
+                session->attempts[idx]++;
+                s->lastSent[idx] = sim.now;
+                s->result.hedges++;
+            } else if (session->attempts[idx] > UAVhNode_NS::maxRetries && silent >= deadline) {
+                session->timedOut.push_back(idx);
+                healthMiss(UAVhNode_NS::uavHealth[idx], UAVhNode_NS::heartbeatMiss);
+                continue;
+            }
+            stillWaiting.push_back(idx);
+        }
+        s->waiting.swap(stillWaiting);
+
+        if (s->waiting.empty()) {
+            uavhFinish(s);
+            return;
+        }
+        schedule(sim.now + kScanMs, [s]() { uavhScan(s); });
+    }
+
+    static void uavhStartCollection(const StatePtr &s) {
+        UAVhNode_NS::SessionPtr session = s->session;
+        int n = UAVhNode_NS::numUAV;
+        session->arrivals.reset(new LockFreeQueue<parSig>(n * (UAVhNode_NS::maxRetries + 1)));
+        session->collecting.store(true, std::memory_order_release);
+        session->attempts.assign(n, 1);
+        session->timedOut.clear();
+        session->slotUs = UAVhNode_NS::paceSlotMicros();
+
+        s->firstSent.assign(n, sim.now);
+        s->lastSent.assign(n, sim.now);
+        s->seen.assign(n, false);
+        s->paceOffset.assign(n, 0);
+        for (int i : session->S) {
+            s->paceOffset[i] = s->waiting.size() * session->slotUs / 1000.0;
+            s->waiting.push_back(i);
+        }
+
+        if (UAVhNode_NS::useDatagrams && UAVhNode_NS::multicastFanout) {
+            // One transmission on the UAVh egress, replicated by the bridge to every member
+            std::string body = std::to_string(session->slotUs) + "#" + session->signers;
+            sendDatagramCopies(uavhNode, body.size(), UAVhNode_NS::udpRedundancy, [s, n, body]() {
+                for (int i = 0; i < n; ++i) uavOnRequest(s, i, body, true);
+            });
+        } else {
+            for (int i = 0; i < n; ++i) uavhRequest(s, i, true);
+        }
+
+        // rk, g^e and beta^e are computed while UAVs sign
+        compute(uavhNode, [&]() {
+            s->agg = AggInit(UAVhNode_NS::pp, UAVhNode_NS::uavh, session->PK_v, session->state);
+        });
+        schedule(sim.now + kScanMs, [s]() { uavhScan(s); });
+    }
+
+    static void uavhOnChallenge(const StatePtr &s, const std::string &payload) {
+        bool valid = true;
+        double ready = compute(uavhNode, [&]() {
+            std::vector<std::string> fields;
+            size_t start = 0, end;
+            while ((end = payload.find('#', start)) != std::string::npos) {
+                fields.push_back(payload.substr(start, end - start));
+                start = end + 1;
+            }
+            fields.push_back(payload.substr(start));
+
+            auto session = std::make_shared<UAVhNode_NS::AuthSession>();
+            try {
+                session->id = static_cast<uint32_t>(std::stoul(fields.at(0)));
+                session->PK_v = str_to_mpz(fields.at(1));
+                session->signers = UAVhNode_NS::hexToString(fields.at(2));
+            } catch (...) {
+                valid = false;
+                return;
+            }
+            if (!decodeSignerSet(session->signers, UAVhNode_NS::numUAV, session->S)) {
+                valid = false;
+                return;
+            }
+            for (size_t i = 3; i < fields.size(); ++i) {
+                if (fields[i] == "S") session->stream = true;
+                else if (fields[i] == "U") session->compressed = false;
+            }
+            s->needed += static_cast<int>(session->S.size());
+            s->prefix = std::to_string(session->id) + "#";
+            s->session = session;
+            UAVhNode_NS::sessions[session->id] = session;
+        });
+        if (!valid) {
+            std::cerr << "[Sim] UAVh rejected challenge " << s->sid << std::endl;
+            return;
+        }
+        schedule(ready, [s]() { uavhStartCollection(s); });
+    }
+
+    static void uavSendSignature(const StatePtr &s, int i, int retriesLeft) {
+        std::string payload = s->cached[i] == "null" ? "" : s->cached[i];
+        sendDatagramCopies(swarm[i].node, payload.size(), UAVNode_NS::udpRedundancy, [s, i, payload]() {
+            // udpReceiveLoop(): acknowledge, then hand the signature to the session
+            sendDatagramCopies(uavhNode, 0, UAVhNode_NS::udpRedundancy, [s, i]() { s->acked[i] = true; });
+            uavhOnReply(s, payload.empty() ? "null" : payload);
+        });
+        // Only real signatures are worth retransmitting
+        if (payload.empty() || retriesLeft <= 0) return;
+        schedule(sim.now + UAVNode_NS::udpRetryMs, [s, i, retriesLeft]() {
+            if (s->acked[i]) return;
+            sim.stats.retransmits++;
+            uavSendSignature(s, i, retriesLeft - 1);
+        });
+    }
+
+    static void uavOnRequest(const StatePtr &s, int i, const std::string &body, bool datagram) {
+        // The datagram server answers repeated requests from its reply cache
+        if (datagram && !s->cached[i].empty()) {
+            if (sim.now >= s->sendAt[i]) uavSendSignature(s, i, UAVNode_NS::udpRetries);
+            return;
+        }
+
+        SimUAV &u = swarm[i];
+        double received = sim.now;
+        uint64_t delayUs = 0;
+        std::string reply;
+        double signedAt = compute(u.node, [&]() {
+            if (u.keyed) std::swap(swarmCtx.uav, u.keys);
+            else swarmCtx.uav.serialNumber = i;
+            std::string signers;
+            std::vector<int> S;
+            delayUs = UAVNode_NS::parsePacedRequest(swarmCtx, body, signers, S);
+            reply = UAVNode_NS::signForSigners(swarmCtx, signers, S);
+            if (u.keyed) std::swap(swarmCtx.uav, u.keys);
+        });
+        double sendAt = std::max(signedAt, received + delayUs / 1000.0);
+
+        if (datagram) {
+            s->cached[i] = reply;
+            s->sendAt[i] = sendAt;
+            schedule(sendAt, [s, i]() { uavSendSignature(s, i, UAVNode_NS::udpRetries); });
+            return;
+        }
+        std::string frame = std::to_string(s->sid) + "#" + reply;
+        schedule(sendAt, [s, i, frame, reply]() {
+            sendMessage(swarm[i].node, std::make_shared<Stream>(), frame.size(), false, [s, reply]() {
+                uavhOnReply(s, reply);
+            });
+        });
+    }
+
+    // Virtual time, statistics, CPUs and buckets start afresh; trace times are relative to the start
+    static void resetRun() {
+        sim.now = 0;
+        sim.seq = 0;
+        sim.events = decltype(sim.events)();
+        sim.stats = SimStats();
+        std::vector<Node *> nodes = nodesNamed("UAV*");
+        nodes.push_back(&verifierNode);
+        nodes.push_back(&uavhNode);
+        for (Node *node: nodes) {
+            node->cpuFree = node->cpuMs = 0;
+            node->egress.tokens = node->egress.burst;
+            node->egress.tokensAt = 0;
+        }
+
+        for (const TraceEntry &entry: trace) {
+            schedule(entry.atMs, [entry]() {
+                for (Node *node: nodesNamed(entry.link)) applyLinkConfig(node->egress, entry.change);
+            });
+        }
+    }
+
+    RunResult runSession(uint32_t sid) {
+        resetRun();
+
+        auto s = std::make_shared<SessionState>();
+        s->sid = sid;
+        s->cached.assign(swarm.size(), "");
+        s->sendAt.assign(swarm.size(), 0);
+        s->acked.assign(swarm.size(), false);
+
+        // The Verifier fetched the swarm statistics (STATS) before its session started
+        verifier_NS::swarmHealth = UAVhNode_NS::uavHealth;
+
+        std::string challenge;
+        verifier_NS::AuthSession &vs = s->vs;
+        double sent = compute(verifierNode, [&]() {
+            const Params &params = verifier_NS::params;
+            vs.id = sid;
+            vs.sk_v = rand_mpz(verifier_NS::state);
+            mpz_class PK_v = pow_mpz(params.g, vs.sk_v, params.q);
+            vs.S = verifier_NS::selectSigners(0, params.n, params.tm);
+
+            std::string signers = encodeSignerSet(std::vector<int>(vs.S.begin(), vs.S.end()), params.n);
+            challenge = std::to_string(sid) + "#" + mpz_to_str(PK_v) + "#" + verifier_NS::stringToHex(signers);
+            if (verifier_NS::streamSigma) challenge += "#S";
+            if (verifier_NS::uncompressedPoints) challenge += "#U";
+        });
+
+        // Keys are issued at registration, which is not part of the measured run
+        for (short idx: vs.S) issueKeys(idx);
+
+        schedule(sent, [s, challenge]() {
+            sendMessage(verifierNode, s->toUAVh, challenge.size(), true, [s, challenge]() {
+                uavhOnChallenge(s, challenge);
+            });
+        });
+        if (verifier_NS::streamSigma) {
+            compute(verifierNode, [&]() {
+                vs.ctx = VerifyInit(verifier_NS::params, vs.sk_v, verifier_NS::messageM, vs.S,
+                                    verifier_NS::registeredIDs, verifier_NS::PK_s);
+            });
+        }
+
+        runEvents([s]() { return s->done || sim.now > timeLimitMs; });
+
+        if (s->session) {
+            s->session->collecting.store(false, std::memory_order_release);
+            UAVhNode_NS::sessions.erase(s->session->id);
+        }
+        RunResult result = s->result;
+        result.stats = sim.stats;
+        result.verifierCpuMs = verifierNode.cpuMs;
+        result.uavhCpuMs = uavhNode.cpuMs;
+        for (SimUAV &u: swarm) result.uavCpuMs += u.node.cpuMs;
+        return result;
+    }
+
+
+// ============================================================
+// Swarm splitting
+// ============================================================
+
+    struct SplitState {
+        std::string request;        // "SPLIT#key", the same for every member
+        int members = 0;
+        int next = 0;               // next member to contact
+        SplitResult result;
+    };
+    using SplitPtr = std::shared_ptr<SplitState>;
+
+    // distributeSplitKey(): one connection per member, the next one opened when a member acknowledged
+    static void splitContact(const SplitPtr &sp) {
+        if (sp->next >= sp->members) return;
+        int i = sp->next++;
+        openConnection(uavhNode, swarm[i].node, [sp, i]() {
+            sendMessage(uavhNode, std::make_shared<Stream>(), sp->request.size(), true, [sp, i]() {
+                SimUAV &u = swarm[i];
+                std::string reply;
+                double done = compute(u.node, [&]() {
+                    // Every member is its own machine with its own record of the last split
+                    std::swap(swarmCtx.uav, u.keys);
+                    swarmCtx.lastSplit = 0;
+                    swarmCtx.splitBeta = 0;
+                    reply = UAVNode_NS::applySplit(swarmCtx, sp->request.substr(6));
+                    std::swap(swarmCtx.uav, u.keys);
+                });
+                schedule(done, [sp, i, reply]() {
+                    sendMessage(swarm[i].node, std::make_shared<Stream>(), reply.size(), false, [sp, reply]() {
+                        if (reply == "SPLIT#OK") sp->result.acked++;
+                        if (sp->result.acked == sp->members) sp->result.splitMs = sim.now;
+                        splitContact(sp);
+                    });
+                });
+            });
+        });
+    }
+
+    SplitResult runSplit(int members) {
+        members = std::max(1, std::min(members, static_cast<int>(swarm.size())));
+        auto sp = std::make_shared<SplitState>();
+        sp->members = members;
+
+        // Keys were issued at registration, not part of the measured split
+        std::vector<UAV> before;
+        for (int i = 0; i < members; ++i) {
+            issueKeys(i);
+            before.push_back(swarm[i].keys);
+            TransmissionPackage pkg;
+            pkg.pp = TA_NS::pp;
+            pkg.M = TA_NS::messageM;
+            pkg.t = TA_NS::thresholdT;
+            pkg.uav = swarm[i].keys;
+            pkg.registrySeed = TA_NS::registrySeed;
+            sp->result.reregisterBytes += Package_to_wire(pkg).size();
+        }
+
+        resetRun();
+        bool valid = false;
+        double ready = compute(uavhNode, [&]() {
+            const Params &pp = UAVhNode_NS::pp;
+            // The first members UAVs, as the range of sub-head 0
+            SplitKey key = SplitInit(pp, UAVhNode_NS::uavh, 0, 0, members, std::min(pp.tm - 1, members), TA_NS::state);
+            sp->request = "SPLIT#" + SplitKey_to_wire(key);
+            valid = SplitVerify(pp, key);
+        });
+        if (!valid) {
+            std::cerr << "[Sim] Split key did not verify" << std::endl;
+            return sp->result;
+        }
+        sp->result.keyBytes = sp->request.size();
+        schedule(ready, [sp]() {
+            for (int c = 0; c < UAVhNode_NS::kSplitConnections; ++c) splitContact(sp);
+        });
+
+        runEvents([sp]() { return sp->result.acked == sp->members || sim.now > timeLimitMs; });
+
+        SplitResult result = sp->result;
+        result.stats = sim.stats;
+        result.uavhCpuMs = uavhNode.cpuMs;
+        for (int i = 0; i < members; ++i) {
+            result.uavCpuMs += swarm[i].node.cpuMs;
+            swarm[i].keys = before[i];
+        }
+        return result;
+    }
+
+
+// ============================================================
+// Sweep
+// ============================================================
+
+    static std::vector<std::string> splitList(const std::string &list) {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    int run() {
+        cfg = loadConfig("scripts/config.env");
+
+        // Protocol options, read as the role mains do
+        UAVhNode_NS::hedgePercentile = configInt(cfg, "HEDGE_PERCENTILE", UAVhNode_NS::hedgePercentile);
+        UAVhNode_NS::maxRetries = std::max(0, configInt(cfg, "MAX_RETRIES", UAVhNode_NS::maxRetries));
+        UAVhNode_NS::heartbeatMiss = std::max(1, configInt(cfg, "HEARTBEAT_MISS", UAVhNode_NS::heartbeatMiss));
+        UAVhNode_NS::useDatagrams = configStr(cfg, "TRANSPORT", "ws") == "udp";
+        UAVhNode_NS::udpRedundancy = std::max(1, configInt(cfg, "UDP_REDUNDANCY", UAVhNode_NS::udpRedundancy));
+        UAVhNode_NS::multicastFanout = configStr(cfg, "BITMAP_FANOUT", "unicast") == "multicast";
+        UAVhNode_NS::paceReplies = configInt(cfg, "PACE_REPLIES", 0) != 0;
+        UAVhNode_NS::paceRate = configRate(cfg, "PACE_RATE", configRate(cfg, "NET_BANDWIDTH", UAVhNode_NS::paceRate));
+        initialReplyBytes = static_cast<size_t>(std::max(1, configInt(cfg, "PACE_REPLY_BYTES", (int) initialReplyBytes)));
+        initTimeoutMs = configInt(cfg, "INIT_TIMEOUT_MS", (int) initTimeoutMs);
+        setWireFormat(configStr(cfg, "WIRE_FORMAT", "binary"));
+
+        UAVNode_NS::useDatagrams = UAVhNode_NS::useDatagrams;
+        UAVNode_NS::udpRedundancy = UAVhNode_NS::udpRedundancy;
+        UAVNode_NS::udpRetryMs = configInt(cfg, "UDP_RETRY_MS", UAVNode_NS::udpRetryMs);
+        UAVNode_NS::udpRetries = configInt(cfg, "UDP_RETRIES", UAVNode_NS::udpRetries);
+
+        verifier_NS::streamSigma = configInt(cfg, "STREAM_SIGMA", 0) != 0;
+        verifier_NS::uncompressedPoints = configStr(cfg, "VERIFIER_POINTS", "compressed") == "uncompressed";
+        verifier_NS::selection = configStr(cfg, "SELECTION", "alive");
+
+        // Simulator options
+        std::vector<int> sizes;
+        for (const std::string &item: splitList(configStr(cfg, "SIM_UAVS", configStr(cfg, "NUM_UAV", "64")))) {
+            try {
+                sizes.push_back(std::stoi(item));
+            } catch (...) {
+                std::cerr << "[Sim] Invalid swarm size ignored: " << item << std::endl;
+            }
+        }
+        std::vector<std::string> scenarios;
+        for (const std::string &item: splitList(configStr(cfg, "SIM_SCENARIOS", "none"))) {
+            if (item == "none" || item == "latency" || item == "bandwidth" || item == "loss" || item == "all") {
+                scenarios.push_back(item);
+            } else {
+                std::cerr << "[Sim] Unknown scenario ignored: " << item << std::endl;
+            }
+        }
+        int runs = std::max(1, configInt(cfg, "SIM_RUNS", 5));
+        int seed = configInt(cfg, "SIM_SEED", 1);
+        int thresholdM = configInt(cfg, "THRESHOLD_M", 2);
+        std::string csvPath = configStr(cfg, "SIM_CSV", "sim.csv");
+        int splitMembers = std::max(0, configInt(cfg, "SIM_SPLIT", 0));
+        std::string splitCsvPath = configStr(cfg, "SIM_SPLIT_CSV", "sim_split.csv");
+        std::string tracePath = configStr(cfg, "SIM_TRACE", "");
+        try {
+            uavCpuScale = std::stod(configStr(cfg, "SIM_UAV_CPU_SCALE", "1"));
+        } catch (...) {
+            uavCpuScale = 1;
+        }
+        timeLimitMs = configMillis(cfg, "SIM_TIME_LIMIT", timeLimitMs);
+
+        if (!tracePath.empty() && !loadTrace(tracePath)) return -1;
+
+        std::ofstream csv(csvPath);
+        if (!csv.is_open()) {
+            std::cerr << "[Sim] Could not write " << csvPath << std::endl;
+            return -1;
+        }
+        csv << "uavs,threshold,scenario,transport,run,auth_ms,verified,signatures,hedges,timeouts,"
+               "packets,bytes,drops,retransmits,verifier_cpu_ms,uavh_cpu_ms,uav_cpu_ms\n";
+
+        std::ofstream splitCsv;
+        if (splitMembers > 0) {
+            splitCsv.open(splitCsvPath);
+            if (!splitCsv.is_open()) {
+                std::cerr << "[Sim] Could not write " << splitCsvPath << std::endl;
+                return -1;
+            }
+            splitCsv << "uavs,members,scenario,transport,run,split_ms,acked,key_bytes,reregister_bytes,"
+                        "packets,bytes,drops,retransmits,uavh_cpu_ms,uav_cpu_ms\n";
+        }
+
+        initState(verifier_NS::state);
+        verifierNode.name = "Verifier";
+        uavhNode.name = "UAVh";
+        std::string transport = UAVhNode_NS::useDatagrams ?
+                                (UAVhNode_NS::multicastFanout ? "udp-multicast" : "udp") : "ws";
+
+        std::cout << "[Sim] " << sizes.size() << " swarm sizes x " << scenarios.size() << " scenarios x "
+                  << runs << " runs, transport " << transport << std::endl;
+        for (int numUAV: sizes) {
+            if (numUAV < 2) continue;
+            int t = std::max(2, std::min(thresholdM, numUAV));
+            setupSwarm(numUAV, t);
+
+            for (const std::string &scenario: scenarios) {
+                auto wallStart = std::chrono::steady_clock::now();
+                applyScenario(scenario);
+                // Every scenario is a fresh deployment; UAVh keeps its estimates across the runs of one
+                resetUAVh();
+
+                LatencyStats auth;
+                int verified = 0;
+                for (int r = 0; r < runs; ++r) {
+                    sim.rng.seed(static_cast<uint64_t>(seed) * 1000003u + r);
+                    RunResult res = runSession(static_cast<uint32_t>(r + 1));
+                    if (res.authMs >= 0) latencyAdd(auth, res.authMs);
+                    verified += res.verified == 1;
+
+                    csv << numUAV << "," << t << "," << scenario << "," << transport << "," << r << ","
+                        << res.authMs << "," << res.verified << "," << res.signatures << ","
+                        << res.hedges << "," << res.timeouts << "," << res.stats.packets << ","
+                        << res.stats.bytes << "," << res.stats.drops << "," << res.stats.retransmits << ","
+                        << res.verifierCpuMs << "," << res.uavhCpuMs << "," << res.uavCpuMs << "\n";
+                }
+
+                double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+                std::cout << "[Sim] N=" << numUAV << " t=" << t << " " << scenario << ": auth p50 = "
+                          << latencyPercentile(auth, 50) << " ms, p99 = " << latencyPercentile(auth, 99)
+                          << " ms, verified " << verified << "/" << runs << " (simulated in "
+                          << wallSec << " s)" << std::endl;
+
+                if (splitMembers == 0) continue;
+                LatencyStats split;
+                int complete = 0, members = std::min(splitMembers, numUAV);
+                SplitResult res;
+                for (int r = 0; r < runs; ++r) {
+                    sim.rng.seed(static_cast<uint64_t>(seed) * 1000003u + runs + r);
+                    res = runSplit(members);
+                    if (res.splitMs >= 0) latencyAdd(split, res.splitMs);
+                    complete += res.splitMs >= 0;
+
+                    splitCsv << numUAV << "," << members << "," << scenario << "," << transport << "," << r << ","
+                             << res.splitMs << "," << res.acked << "," << res.keyBytes << ","
+                             << res.reregisterBytes << "," << res.stats.packets << "," << res.stats.bytes << ","
+                             << res.stats.drops << "," << res.stats.retransmits << ","
+                             << res.uavhCpuMs << "," << res.uavCpuMs << "\n";
+                }
+                std::cout << "[Sim] N=" << numUAV << " split of " << members << " " << scenario << ": p50 = "
+                          << latencyPercentile(split, 50) << " ms, p99 = " << latencyPercentile(split, 99)
+                          << " ms, complete " << complete << "/" << runs << ", " << res.keyBytes
+                          << " bytes per member instead of " << res.reregisterBytes / members << std::endl;
+            }
+        }
+        std::cout << "[Sim] Results written to " << csvPath << std::endl;
+        if (splitMembers > 0) std::cout << "[Sim] Split results written to " << splitCsvPath << std::endl;
+        return 0;
+    }
+
+} // namespace simulator_NS
+
+
+int main() {
+    return simulator_NS::run();
+}
@@ -11,6 +11,8 @@ namespace TA_NS {
 
     int kNumUAV = 2;       // Total number of UAVs
     int kThresholdMax = 2; // Max threshold parameter
+    int kThreads = 0;      // 0: one per core
+    std::string kStorePath;  // Empty: keys in memory only
 
 
 // ============================================================
@@ -27,70 +29,72 @@ namespace TA_NS {
     mpz_class messageM;              // Test message to be signed
     int thresholdT = 2;              // Threshold t = TM
 
+    std::string registrySeed;               // Public seed of the registered IDs (IDRegistry.h)
     std::vector<mpz_class> registeredIDs;   // All UAV IDs that have registered
-    std::vector<ECP2> uavPKs_t;      // All UAV public key at threshold t
-    std::atomic<int> serialNumber{0};
 
+    std::string commonBlob;          // Data common to all UAVs, serialized once
+    std::string commonDigest;
+    static std::string packagePrefix; // package fields before the keys (pp, M, t)
+    static std::string packageRegistry; // package field after the keys (registry seed)
+    static bool binaryBlob = false;   // commonBlob, and so every reply, in the binary wire format
+
+    KeyStore keyStore;               // Keys of every UAV and the serials issued
+    std::atomic<int> preparedCount{0};
+    static std::mutex prepMtx;                    // guards preparedDone and waiters
+    static std::vector<char> preparedDone;        // serials finished, possibly out of order
+    static std::multimap<int, std::function<void()>> waiters;   // by prepared count they need
 
-    // ============================================================
-    // Helper: Trim string
-    // ============================================================
-    std::string trim(const std::string& str) {
-        size_t first = str.find_first_not_of(" \t\n\r");
-        if (std::string::npos == first) return str;
-        size_t last = str.find_last_not_of(" \t\n\r");
-        return str.substr(first, (last - first + 1));
-    }
 
     // ============================================================
     // Implementation of LoadConfig
     // ============================================================
     void LoadConfig(const std::string& configPath) {
-        std::ifstream file(configPath);
-        if (!file.is_open()) {
-            std::cerr << "[Config] Warning: Could not open config file: " << configPath
-                      << ". Using default values." << std::endl;
-            return;
-        }
-
-        std::string line;
         std::cout << "[Config] Loading parameters from " << configPath << "..." << std::endl;
-
-        while (std::getline(file, line)) {
-            // Remove the annotations
-            size_t commentPos = line.find('#');
-            if (commentPos != std::string::npos) {
-                line = line.substr(0, commentPos);
-            }
-
-            if (line.find("NUM_UAV=") != std::string::npos) {
-                std::string valStr = line.substr(line.find('=') + 1);
-                try {
-                    kNumUAV = std::stoi(trim(valStr));
-                    std::cout << "  -> Set kNumUAV = " << kNumUAV << std::endl;
-                } catch (...) { }
-            }
-            else if (line.find("THRESHOLD_M=") != std::string::npos) {
-                std::string valStr = line.substr(line.find('=') + 1);
-                try {
-                    kThresholdMax = std::stoi(trim(valStr));
-                    std::cout << "  -> Set kThresholdMax = " << kThresholdMax << std::endl;
-                } catch (...) { }
-            }
-        }
-        file.close();
+        Config cfg = loadConfig(configPath);
+
+        kNumUAV = configInt(cfg, "NUM_UAV", kNumUAV);
+        kThresholdMax = configInt(cfg, "THRESHOLD_M", kThresholdMax);
+        kThreads = configInt(cfg, "TA_THREADS", kThreads);
+        kStorePath = configStr(cfg, "TA_STORE", kStorePath);
+        setWireFormat(configStr(cfg, "WIRE_FORMAT", "binary"));
+        std::cout << "  -> kNumUAV = " << kNumUAV << ", kThresholdMax = " << kThresholdMax
+                  << ", kThreads = " << kThreads << ", kStorePath = " << kStorePath
+                  << ", wire format = " << (wireBinary() ? "binary" : "text") << std::endl;
     }
 
 // ============================================================
 // Initialize system parameters
 // ============================================================
+    // A full package is the common data with the keys spliced in before the registry seed;
+    // the seed itself is read back from it as well, for the Verifier package after a restart
+    static void splitCommonBlob() {
+        binaryBlob = isWireBinary(commonBlob);
+        if (!binaryBlob) {
+            // The registry seed is the last of the 8 fields of the common data
+            size_t seedStart = 0;
+            for (int field = 0; field < 7; ++field) seedStart = commonBlob.find('#', seedStart) + 1;
+            packagePrefix = commonBlob.substr(0, seedStart);
+            packageRegistry = commonBlob.substr(seedStart);
+            registrySeed.assign(kRegistrySeedBytes, '\0');
+            hexDecode(packageRegistry.data(), kRegistrySeedBytes, reinterpret_cast<uint8_t *>(&registrySeed[0]));
+            return;
+        }
+        // Binary: the seed takes its last kRegistrySeedBytes; the header turns into a package header
+        WireWriter prefix;
+        prefix.header(WIRE_PACKAGE);
+        prefix.raw(commonBlob.substr(2, commonBlob.size() - 2 - kRegistrySeedBytes));
+        packagePrefix = prefix.data();
+        packageRegistry = commonBlob.substr(commonBlob.size() - kRegistrySeedBytes);
+        registrySeed = packageRegistry;
+    }
+
     void initParams() {
         std::cout << "[TA] Initializing system parameters..." << std::endl;
 
         initState(state);
 
         // Setup returns public params + generates UAV_h's conversion key masterSK
-        pp = Setup(alpha, kNumUAV, kThresholdMax);
+        pp = Setup(alpha, kNumUAV, kThresholdMax, state);
 
         // Generate threshold polynomial coefficients
         poly_d.reserve(kThresholdMax - 1);
@@ -110,99 +114,244 @@ namespace TA_NS {
         // Example message to sign
         messageM = 123456789;
 
-        // Generate UAV IDs
-        for (int i = 0; i < pp.n; ++i) {
-            registeredIDs.push_back(rand_mpz(state));
+        // Generate UAV IDs: derived from a public seed, which is all the packages carry
+        do {
+            registrySeed = newRegistrySeed(state);
+            registeredIDs = expandRegistry(registrySeed, pp.n, pp.q);
+        } while (!registryUsable(registeredIDs));
+
+        // The common data never changes after setup: serialize and hash it once
+        TransmissionPackage common;
+        common.pp = pp;
+        common.M = messageM;
+        common.t = thresholdT;
+        common.registrySeed = registrySeed;
+        commonBlob = Common_to_wire(common);
+        commonDigest = sha256Hex(commonBlob);
+        splitCommonBlob();
+
+        // Fresh store: no keys derived, no serial issued
+        if (!keyStore.create(kStorePath, pp, alpha, poly_d, poly_b, messageM, thresholdT,
+                             registeredIDs, commonBlob, commonDigest)) {
+            std::cerr << "[TA] Key store unavailable, keeping the keys in memory only." << std::endl;
+            keyStore.create("", pp, alpha, poly_d, poly_b, messageM, thresholdT,
+                            registeredIDs, commonBlob, commonDigest);
         }
 
         std::cout << "[TA] Initialization complete. Threshold t = "
                   << thresholdT << std::endl;
     }
 
+    bool restoreState() {
+        if (kStorePath.empty()) return false;
+        auto start = std::chrono::steady_clock::now();
+        if (!keyStore.open(kStorePath)) return false;
+        if (keyStore.size() != kNumUAV || keyStore.maxThreshold() != kThresholdMax) {
+            std::cout << "[TA] " << kStorePath << " holds another NUM_UAV / THRESHOLD_M, starting afresh." << std::endl;
+            return false;
+        }
 
-// ============================================================
-// Handle UAV / UAVh / Verifier registration requests
-// ============================================================
-    void onRegister(Server *server, connection_hdl hdl, MessagePtr msg) {
-        const std::string type = msg->get_payload();
-        std::cout << "[TA] Received registration message: " << type << std::endl;
-
-        TransmissionPackage pkg;
-        pkg.pp = pp;
-        pkg.M = messageM;
-        pkg.t = thresholdT;
+        initState(state);
+        keyStore.loadState(pp, alpha, poly_d, poly_b, messageM, thresholdT);
+        registeredIDs.clear();   // read from the store when needed
+        commonBlob = keyStore.commonBlob();
+        commonDigest = keyStore.commonDigest();
+
+        splitCommonBlob();
+        if (binaryBlob != wireBinary()) {
+            std::cout << "[TA] " << kStorePath << " was created with WIRE_FORMAT="
+                      << (binaryBlob ? "binary" : "text") << ", keeping it." << std::endl;
+        }
 
-        pkg.registeredIDs = registeredIDs;
-        // Normal UAV
-        if (type == "UAV") {
-            pkg.uav = getUAV(pkg.pp, poly_d, poly_b, registeredIDs[serialNumber.fetch_add(1)]);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "[TA] Restored " << kStorePath << " in " << elapsed.count() << " ms: "
+                  << keyStore.issued() << "/" << keyStore.size() << " serials issued, threshold t = "
+                  << thresholdT << std::endl;
+        return true;
+    }
 
-            // Store the PK fragment at index t-2 (required by UAVh)
-            uavPKs_t.push_back(pkg.uav.PK[thresholdT - 2]);
-        }
 
-            // Cluster head UAVh (special) or Verifier
-        else {
-            pkg.uav.PK = uavPKs_t;   // Send all UAV PK fragments to UAVh for verifying the legitimacy of partial signatures
-            pkg.uav.c2 = {alpha, kNumUAV};
+// ============================================================
+// Background key derivation
+// ============================================================
+    static int workerCount() {
+        if (kThreads > 0) return kThreads;
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
 
-            std::cout << "[TA] UAVh registered. Transformation key key α = ";
-            show_mpz(alpha.get_mpz_t());
+    // Marks `serial` prepared and runs the waiters whose prefix is now complete
+    static void markPrepared(int serial) {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(prepMtx);
+            preparedDone[serial] = 1;
+            int count = preparedCount.load();
+            while (count < (int) preparedDone.size() && preparedDone[count]) ++count;
+            preparedCount = count;
+            for (auto it = waiters.begin(); it != waiters.end() && it->first <= count;) {
+                ready.push_back(std::move(it->second));
+                it = waiters.erase(it);
+            }
         }
+        for (auto &fn : ready) fn();
+    }
 
-        // Serialize and send response
-        std::string output = Package_to_str(pkg);
-
-        try {
-            server->send(hdl, output, websocketpp::frame::opcode::text);
+    void startPrecompute() {
+        int n = keyStore.size();
+        preparedDone.assign(n, 0);
+        preparedCount = 0;
+
+        auto next = std::make_shared<std::atomic<int>>(0);
+        int workers = workerCount();
+        for (int w = 0; w < workers; ++w) {
+            // gmp random states are not thread-safe: one per worker, seeded from the TA state
+            mpz_class seed = rand_mpz(state);
+            std::thread([next, seed, n]() {
+                gmp_randstate_t rs;
+                gmp_randinit_default(rs);
+                gmp_randseed(rs, seed.get_mpz_t());
+                for (int serial = next->fetch_add(1); serial < n; serial = next->fetch_add(1)) {
+                    // Keys stored before a restart are kept: they may already have been issued
+                    if (!keyStore.hasKeys(serial)) {
+                        UAV uav = getUAV(pp, poly_d, poly_b, keyStore.id(serial), serial, rs);
+                        if (!keyStore.putKeys(serial, uav)) {
+                            std::cerr << "[TA] Cannot store the keys of UAV " << serial << std::endl;
+                        }
+                    }
+                    markPrepared(serial);
+                }
+                gmp_randclear(rs);
+            }).detach();
         }
-        catch (const websocketpp::exception &e) {
-            std::cerr << "[TA] Error sending message: " << e.what() << std::endl;
+        std::cout << "[TA] Preparing " << n << " key packages on " << workers << " workers." << std::endl;
+    }
+
+    void whenPrepared(int count, std::function<void()> fn) {
+        {
+            std::lock_guard<std::mutex> lock(prepMtx);
+            if (preparedCount.load() < count) {
+                waiters.emplace(count, std::move(fn));
+                return;
+            }
         }
+        fn();
     }
 
 
 // ============================================================
-// Start TA WebSocket server
+// Handle UAV / UAVh / Verifier registration requests
 // ============================================================
-    int startServer() {
-        Server server;
+    void onRegister(Transport *server, ConnId conn, const std::string &type) {
+        std::cout << "[TA] Received registration message: " << type << std::endl;
 
-        try {
-            server.set_access_channels(websocketpp::log::alevel::all);
-            server.clear_access_channels(websocketpp::log::alevel::frame_payload);
+        auto reply = [server, conn](const std::string &output, bool binary = binaryBlob) {
+            if (!server->send(conn, output, binary)) {
+                std::cerr << "[TA] Error sending message." << std::endl;
+            }
+        };
 
-            server.init_asio();
+        // Common data only: the UAV could not fetch it from its peers
+        if (type == kRequestCommon) {
+            reply(commonBlob);
+            return;
+        }
 
-            // Bind message handler
-            server.set_message_handler(
-                    websocketpp::lib::bind(
-                            &onRegister,
-                            &server,
-                            websocketpp::lib::placeholders::_1,
-                            websocketpp::lib::placeholders::_2
-                    )
-            );
+        // Digest only: a node checks whether its cached registration is still valid
+        if (type == kRequestDigest) {
+            reply("DIGEST#" + commonDigest + "#" + std::to_string(keyStore.issued()), false);
+            return;
+        }
 
-            // Bind to port 9002
-            auto ip = boost::asio::ip::address::from_string("0.0.0.0");
-            server.listen(boost::asio::ip::tcp::endpoint(ip, 9002));
-            server.start_accept();
+        // Normal UAV: full package, or keys only if the common data travels between the UAVs
+        if (type == kRegisterUAV || type == kRegisterUAVKeysOnly) {
+            int serial = keyStore.claimSerial();
+            if (serial < 0) {
+                std::cerr << "[TA] No ID left (NUM_UAV = " << keyStore.size() << ")." << std::endl;
+                server->close(conn);
+                return;
+            }
+            bool keysOnly = type == kRegisterUAVKeysOnly;
+            whenPrepared(serial + 1, [reply, serial, keysOnly]() {
+                std::string keys = binaryBlob ? keyStore.keysBinary(serial) : keyStore.keysString(serial);
+                if (!keysOnly) {
+                    reply(packagePrefix + keys + (binaryBlob ? "" : "#") + packageRegistry);
+                    return;
+                }
+                std::string output = "KEYS#" + commonDigest + "#" + std::to_string(commonBlob.size()) + "#" + keys;
+                if (serial == 0) output += "#" + commonBlob;   // no peer has it yet
+                reply(output);
+            });
+            return;
+        }
 
-            std::cout << "[TA] Listening on ws://0.0.0.0:9002" << std::endl;
+        // Cluster head UAVh: what AggInit and Transform use, alpha among it; no UAV key
+        if (type == kRegisterHead) {
+            std::cout << "[TA] UAVh registered. Transformation key key α = ";
+            show_mpz(alpha.get_mpz_t());
 
-            // Run event loop
-            server.run();
+            HeadPackage pkg;
+            pkg.pp = pp;
+            pkg.M = messageM;
+            pkg.t = thresholdT;
+            pkg.uavh.ID = 0;
+            pkg.uavh.alpha = alpha;
+            reply(binaryBlob ? HeadPackage_to_bin(pkg) : HeadPackage_to_str(pkg));
+            return;
         }
-        catch (const std::exception &e) {
-            std::cerr << "[TA] Exception: " << e.what() << std::endl;
-            return -1;
+
+        if (type != kRegisterVerifier) {
+            std::cerr << "[TA] Unknown registration type." << std::endl;
+            server->close(conn);
+            return;
         }
-        catch (...) {
-            std::cerr << "[TA] Unknown exception occurred!" << std::endl;
+
+        // Verifier: PK fragment of every UAV registered so far, for verifying the legitimacy of
+        // partial signatures; they are copied from the store as they are, without decompressing them
+        int registered = keyStore.issued();
+        whenPrepared(registered, [reply, registered]() {
+            std::string octets;
+            octets.reserve(registered * KeyStore::kPointBytes);
+            for (int i = 0; i < registered; ++i) {
+                octets.append(reinterpret_cast<const char *>(keyStore.pkOctet(i, thresholdT - 2)), KeyStore::kPointBytes);
+            }
+            VerifierPackage pkg;
+            pkg.pp = pp;
+            pkg.M = messageM;
+            pkg.t = thresholdT;
+            pkg.PK_s = ECP2Array::fromOctets(std::move(octets), registered);
+            pkg.registrySeed = registrySeed;
+            reply(binaryBlob ? VerifierPackage_to_bin(pkg) : VerifierPackage_to_str(pkg));
+        });
+    }
+
+
+// ============================================================
+// Start TA server
+// ============================================================
+    int startServer() {
+        TransportPtr server = makeTransport();
+        Transport *endpoint = server.get();
+
+        // Bind message handler
+        TransportHandlers handlers;
+        handlers.onMessage = [endpoint](ConnId conn, const std::string &msg) {
+            onRegister(endpoint, conn, msg);
+        };
+
+        // Bind to port 9002
+        if (!server->listen("ws://0.0.0.0:9002", handlers)) {
+            std::cerr << "[TA] Failed to listen on port 9002." << std::endl;
             return -1;
         }
+        std::cout << "[TA] Listening on ws://0.0.0.0:9002" << std::endl;
 
+        // Run event loop on every thread
+        std::vector<std::thread> loops;
+        for (int i = 1; i < workerCount(); ++i) {
+            loops.emplace_back([server]() { server->run(); });
+        }
+        server->run();
+        for (auto &loop : loops) loop.join();
         return 0;
     }
 
@@ -211,14 +360,17 @@ namespace TA_NS {
 // Main entry
 // ============================================================
     int run() {
-        initParams();
+        if (!restoreState()) initParams();
+        startPrecompute();
         return startServer();
     }
 } // namespace TA
 
 
 // Standalone main (optional)
+#ifndef RTS_IN_PROCESS
 int main() {
     TA_NS::LoadConfig("scripts/config.env");
     return TA_NS::run();
 }
+#endif
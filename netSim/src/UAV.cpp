@@ -1,17 +1,46 @@
 #include "../include/UAV.h"
 
+#include <ctime>
+
 namespace UAVNode_NS {
 
 // ============================================================
-// Global state for UAV (isolated inside namespace)
+// Process-wide options (keys live in each UAVContext)
 // ============================================================
 
-    gmp_randstate_t state;
-    Params          pp;      // public parameters from TA
-    UAV             uav;     // UAV's private information
-    mpz_class       message; // message M
-    int             threshold; // threshold t
-    vector<mpz_class> registeredIDs;
+    bool useDatagrams = false;
+    int udpRedundancy = 2;
+    int udpRetryMs = 100;
+    int udpRetries = 5;
+    std::string mcastGroup = "239.0.30.1";
+    int mcastPort = 9100;
+    bool commonP2P = false;
+    int commonChunk = 4096;
+    int commonPeers = 3;
+
+    static const int kCommonTimeoutMs = 5000;   // a peer fetch is given up after this
+
+    void loadOptions(const char* transportOverride) {
+        Config cfg = loadConfig("scripts/config.env");
+        useDatagrams  = configStr(cfg, "TRANSPORT", "ws") == "udp";
+        udpRedundancy = std::max(1, configInt(cfg, "UDP_REDUNDANCY", udpRedundancy));
+        udpRetryMs    = configInt(cfg, "UDP_RETRY_MS", udpRetryMs);
+        udpRetries    = configInt(cfg, "UDP_RETRIES", udpRetries);
+        if (transportOverride) useDatagrams = std::string(transportOverride) == "udp";
+        mcastGroup    = configStr(cfg, "MCAST_GROUP", mcastGroup);
+        mcastPort     = configInt(cfg, "MCAST_PORT", mcastPort);
+        commonP2P     = configInt(cfg, "COMMON_P2P", 0) != 0;
+        commonChunk   = std::max(1, configInt(cfg, "COMMON_CHUNK", commonChunk));
+        commonPeers   = std::max(1, configInt(cfg, "COMMON_PEERS", commonPeers));
+        setWireFormat(configStr(cfg, "WIRE_FORMAT", "binary"));
+    }
+
+// CPU time of the calling thread (us); the UAVs of a host share its threads
+    static uint64_t threadCpuMicros() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    }
 
 
 // ============================================================
@@ -19,36 +48,92 @@ namespace UAVNode_NS {
 // ============================================================
 
 // Called when UAV successfully connects to TA (ws://ip:9002)
-    void handleTAOpen(Client* c, connection_hdl hdl) {
-        initState(state);
+    void handleTAOpen(Transport* c, ConnId conn) {
+        // register to TA (keys only if the common data comes from the peers)
+        std::string type = commonP2P ? kRegisterUAVKeysOnly : kRegisterUAV;
+
+        if (!c->send(conn, type)) {
+            std::cerr << "[UAV] Failed to send ID to TA." << std::endl;
+        } else {
+            std::cout << "[UAV] Sent UAV ID to TA." << std::endl;
+        }
+    }
 
-        // register to TA
-        std::string type = "UAV";
 
-        websocketpp::lib::error_code ec;
-        c->send(hdl, type, websocketpp::frame::opcode::text, ec);
+    bool installCommon(UAVContext& ctx, const std::string& blob, const std::string& digest) {
+        if (sha256Hex(blob) != digest) {
+            std::cerr << "[UAV] Common data does not match the digest from TA." << std::endl;
+            return false;
+        }
+        TransmissionPackage pkg;
+        try {
+            wire_to_Common(blob, pkg);
+        } catch (const std::exception& e) {
+            std::cerr << "[UAV] Malformed common data: " << e.what() << std::endl;
+            return false;
+        }
+        auto swarm = std::make_shared<SwarmParams>();
+        swarm->pp            = pkg.pp;
+        swarm->message       = pkg.M;
+        swarm->threshold     = pkg.t;
+        swarm->registeredIDs = pkg.registeredIDs;
+        swarm->commonBlob    = blob;
+        swarm->commonDigest  = digest;
+        ctx.swarm = swarm;
+        return true;
+    }
 
-        if (ec) {
-            std::cerr << "[UAV] Failed to send ID to TA: " << ec.message() << std::endl;
+// Splits "KEYS#digest#size#keys[#blob]" into the keys and the common reference;
+// the keys are either the four text fields of Keys_to_str or a binary Keys message
+    static void storeKeys(UAVContext& ctx, const std::string& msg, CommonRef& common) {
+        size_t digestEnd = msg.find('#', 5);
+        size_t sizeEnd = digestEnd == std::string::npos ? digestEnd : msg.find('#', digestEnd + 1);
+        if (sizeEnd == std::string::npos) throw std::runtime_error("Invalid key package format.");
+        common.digest = msg.substr(5, digestEnd - 5);
+        common.size = std::stoull(msg.substr(digestEnd + 1, sizeEnd - digestEnd - 1));
+
+        // Anything after the keys is the common data
+        size_t keysEnd = sizeEnd;
+        if (isWireBinary(msg, sizeEnd + 1)) {
+            keysEnd = bin_to_Keys(msg, sizeEnd + 1, ctx.uav);
+            if (keysEnd == msg.size()) keysEnd = std::string::npos;
         } else {
-            std::cout << "[UAV] Sent UAV ID to TA." << std::endl;
+            for (int field = 0; field < 4 && keysEnd != std::string::npos; ++field) {
+                keysEnd = msg.find('#', keysEnd + 1);
+            }
+            ctx.uav = str_to_Keys(msg.substr(sizeEnd + 1, keysEnd == std::string::npos
+                                                           ? std::string::npos : keysEnd - sizeEnd - 1));
         }
+        common.blob = keysEnd == std::string::npos ? "" : msg.substr(keysEnd + 1);
+        if (!ctx.swarm && !common.blob.empty()) installCommon(ctx, common.blob, common.digest);
     }
 
+// Stores the keys of a TA package; the swarm parameters only if ctx has none yet
+    static void storePackage(UAVContext& ctx, const std::string& msg, CommonRef& common) {
+        if (msg.rfind("KEYS#", 0) == 0) {
+            storeKeys(ctx, msg, common);
+            return;
+        }
+        TransmissionPackage pkg = wire_to_Package(msg);
+        ctx.uav = pkg.uav;
+        if (!ctx.swarm) {
+            auto swarm = std::make_shared<SwarmParams>();
+            swarm->pp            = pkg.pp;
+            swarm->message       = pkg.M;
+            swarm->threshold     = pkg.t;
+            swarm->registeredIDs = pkg.registeredIDs;
+            ctx.swarm = swarm;
+        }
+    }
 
 // Called when TA returns UAV's key + system parameters
-    void handleTAMessage(Client* c, connection_hdl hdl, MsgClient msg) {
+    void handleTAMessage(UAVContext& ctx, Transport* c, ConnId conn, const std::string& msg, CommonRef& common) {
         std::cout << "[UAV] Received parameters from TA." << std::endl;
 
-        TransmissionPackage pkg = str_to_Package(msg->get_payload());
-        pp        = pkg.pp;
-        uav       = pkg.uav;
-        message   = pkg.M;
-        threshold = pkg.t;
-        registeredIDs = pkg.registeredIDs;
+        storePackage(ctx, msg, common);
 
         // Close the client connection after receiving TA package
-        c->close(hdl, websocketpp::close::status::normal, "TA done");
+        c->close(conn);
     }
 
 
@@ -56,43 +141,332 @@ namespace UAVNode_NS {
 // Connect UAV to TA (client mode)
 // ============================================================
 
-    int connectToTA() {
-        Client client;
+    int connectToTA(UAVContext& ctx) {
+        TransportPtr client = makeTransport();
+        Transport* endpoint = client.get();
+        bool registered = false;
+        CommonRef common;
 
         const std::string uri = "ws://10.0.10.2:9002";
 
-        try {
-            client.set_access_channels(websocketpp::log::alevel::none);
-            client.init_asio();
-
-            // Register event handlers
-            client.set_open_handler(
-                    websocketpp::lib::bind(&handleTAOpen, &client, websocketpp::lib::placeholders::_1)
-            );
-            client.set_message_handler(
-                    websocketpp::lib::bind(&handleTAMessage, &client,
-                                           websocketpp::lib::placeholders::_1,
-                                           websocketpp::lib::placeholders::_2)
-            );
-
-            websocketpp::lib::error_code ec;
-            auto con = client.get_connection(uri, ec);
-            if (ec) {
-                std::cerr << "[UAV] Failed to connect to TA: " << ec.message() << std::endl;
-                return -1;
+        // Register event handlers
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint](ConnId conn) {
+            handleTAOpen(endpoint, conn);
+        };
+        handlers.onMessage = [&ctx, &common, &registered, endpoint](ConnId conn, const std::string& msg) {
+            handleTAMessage(ctx, endpoint, conn, msg, common);
+            registered = true;
+        };
+
+        if (!client->connect(uri, handlers)) {
+            std::cerr << "[UAV] Failed to connect to TA." << std::endl;
+            return -1;
+        }
+
+        // Returns once TA closed or refused the connection
+        client->run();
+
+        if (!registered) {
+            std::cerr << "[UAV] Connection to TA closed before registration." << std::endl;
+            return -1;
+        }
+        // Keys only: the common data comes from the UAVs registered before this one
+        if (!ctx.swarm) return obtainCommon(ctx, common);
+        return 0;
+    }
+
+    int connectToTA(const std::vector<std::shared_ptr<UAVContext>>& uavs) {
+        TransportPtr client = makeTransport();
+        Transport* endpoint = client.get();
+        size_t registered = 0;
+        CommonRef common;
+
+        const std::string uri = "ws://10.0.10.2:9002";
+
+        // One request at a time: TA numbers the UAVs in the order of its replies
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint, &uavs](ConnId conn) {
+            if (!uavs.empty()) handleTAOpen(endpoint, conn);
+        };
+        handlers.onMessage = [&uavs, &registered, &common, endpoint](ConnId conn, const std::string& msg) {
+            UAVContext& ctx = *uavs[registered];
+            if (registered > 0) ctx.swarm = uavs[0]->swarm;
+            storePackage(ctx, msg, common);
+            ++registered;
+
+            if (registered < uavs.size()) {
+                endpoint->send(conn, commonP2P ? kRegisterUAVKeysOnly : kRegisterUAV);
+            } else {
+                endpoint->close(conn);
             }
+        };
 
-            client.connect(con);
+        if (!client->connect(uri, handlers)) {
+            std::cerr << "[UAV] Failed to connect to TA." << std::endl;
+            return 0;
+        }
 
-            std::thread th([&client]() { client.run(); });
-            if (th.joinable()) th.join();
+        // Returns once TA closed or refused the connection
+        client->run();
+
+        if (registered < uavs.size()) {
+            std::cerr << "[UAV] Connection to TA closed after " << registered << " of "
+                      << uavs.size() << " registrations." << std::endl;
         }
-        catch (const std::exception& e) {
-            std::cerr << "[UAV Exception] " << e.what() << std::endl;
-            return -1;
+
+        // Keys only: one copy of the common data serves every hosted UAV
+        if (registered > 0 && !uavs[0]->swarm) {
+            if (obtainCommon(*uavs[0], common) != 0) return 0;
+            for (size_t i = 1; i < registered; ++i) uavs[i]->swarm = uavs[0]->swarm;
         }
+        return static_cast<int>(registered);
+    }
 
-        return 0;
+
+// ============================================================
+// Cached registration (NODE_CACHE_DIR)
+// ============================================================
+
+    bool restoreRegistration(UAVContext& ctx, const std::string& path) {
+        CacheReader cache;
+        if (path.empty() || !cache.load(path, "UAV")) return false;
+
+        auto swarm = std::make_shared<SwarmParams>();
+        swarm->pp            = cache.params();
+        swarm->message       = cache.scalar();
+        swarm->threshold     = static_cast<int>(cache.u32());
+        swarm->registeredIDs = cache.scalars();
+        swarm->commonBlob    = cache.bytes();
+        swarm->commonDigest  = cache.bytes();
+        UAV uav;
+        uav.ID           = cache.scalar();
+        uav.c1           = cache.scalars();
+        uav.c2           = cache.scalars();
+        uav.serialNumber = static_cast<int>(cache.u32());
+        mpz_class lastSplit = cache.scalar();
+        mpz_class splitBeta = cache.scalar();
+        if (!cache.ok()) return false;
+
+        // Valid as long as TA runs with the same parameters and keys (TA_STORE)
+        std::string reply, digest;
+        int issued = 0;
+        if (!requestOnce("ws://10.0.10.2:9002", kRequestDigest, reply) || !parseDigestReply(reply, digest, issued)) {
+            std::cerr << "[UAV] Cannot check the cached registration with TA." << std::endl;
+            return false;
+        }
+        if (digest != cache.digest() || uav.serialNumber >= issued) {
+            std::cout << "[UAV] Cached registration is out of date." << std::endl;
+            return false;
+        }
+
+        ctx.swarm = swarm;
+        ctx.uav = uav;
+        ctx.lastSplit = lastSplit;
+        ctx.splitBeta = splitBeta;
+        std::cout << "[UAV] Restored registration of UAV " << uav.serialNumber << " from " << path << std::endl;
+        return true;
+    }
+
+    void saveRegistration(const UAVContext& ctx, const std::string& path) {
+        const SwarmParams& swarm = *ctx.swarm;
+
+        // A full package does not carry the digest of the common data: ask TA for it
+        std::string digest = swarm.commonDigest, reply;
+        int issued = 0;
+        if (digest.empty() && (!requestOnce("ws://10.0.10.2:9002", kRequestDigest, reply) || !parseDigestReply(reply, digest, issued))) {
+            std::cerr << "[UAV] No digest from TA, registration not cached." << std::endl;
+            return;
+        }
+
+        CacheWriter cache;
+        cache.params(swarm.pp);
+        cache.scalar(swarm.message);
+        cache.u32(static_cast<uint32_t>(swarm.threshold));
+        cache.scalars(swarm.registeredIDs);
+        cache.bytes(swarm.commonBlob);
+        cache.bytes(swarm.commonDigest);
+        cache.scalar(ctx.uav.ID);
+        cache.scalars(ctx.uav.c1);
+        cache.scalars(ctx.uav.c2);
+        cache.u32(static_cast<uint32_t>(ctx.uav.serialNumber));
+        cache.scalar(ctx.lastSplit);
+        cache.scalar(ctx.splitBeta);
+        cache.save(path, "UAV", digest);
+    }
+
+
+// ============================================================
+// Common data from peers (COMMON_P2P)
+// ============================================================
+
+    std::string peerUri(int serial) {
+        return "ws://10.0.30." + std::to_string(101 + serial) + ":8002";
+    }
+
+    bool fetchCommonFromPeers(int serial, const CommonRef& common, std::string& blob) {
+        size_t chunk = static_cast<size_t>(commonChunk);
+        size_t count = (common.size + chunk - 1) / chunk;
+        std::vector<int> peers;
+        for (int j = serial - 1; j >= 0 && (int) peers.size() < commonPeers; --j) peers.push_back(j);
+        if (peers.empty() || count == 0) return false;
+
+        std::vector<std::string> parts(count);
+        std::vector<bool> have(count, false);
+        size_t received = 0;
+        std::map<ConnId, std::vector<size_t>> asked;    // open peer connection -> chunks it still owes
+        size_t connecting = 0;
+        std::vector<size_t> orphans;                    // chunks of peers that failed
+
+        // Declared after the state its handlers use, so that it is destroyed first
+        TransportPtr client = makeTransport();
+        Transport* endpoint = client.get();
+
+        auto request = [endpoint, &common, chunk](ConnId conn, size_t c) {
+            endpoint->send(conn, "COMMON#" + common.digest + "#" + std::to_string(c) + "#" + std::to_string(chunk));
+        };
+        // Hands the chunks of a failed peer to the open ones; stops once nobody is left
+        auto reassign = [&]() {
+            if (asked.empty()) {
+                if (connecting == 0 && received < count) endpoint->stop();
+                return;
+            }
+            auto it = asked.begin();
+            for (size_t c : orphans) {
+                request(it->first, c);
+                it->second.push_back(c);
+                if (++it == asked.end()) it = asked.begin();
+            }
+            orphans.clear();
+        };
+
+        for (size_t p = 0; p < peers.size(); ++p) {
+            // Chunk c is first asked of peer c % peers
+            std::vector<size_t> mine;
+            for (size_t c = p; c < count; c += peers.size()) mine.push_back(c);
+
+            TransportHandlers handlers;
+            handlers.onOpen = [&, mine](ConnId conn) {
+                connecting--;
+                asked[conn] = mine;
+                for (size_t c : mine) request(conn, c);
+                reassign();
+            };
+            handlers.onMessage = [&](ConnId conn, const std::string& msg) {
+                // "COMMON#chunk#data"; no data: the peer does not hold this digest
+                size_t sep = msg.find('#', 7);
+                size_t c = count;
+                if (msg.rfind("COMMON#", 0) == 0 && sep != std::string::npos) {
+                    try { c = std::stoull(msg.substr(7, sep - 7)); } catch (...) { c = count; }
+                }
+                std::string data = sep == std::string::npos ? "" : msg.substr(sep + 1);
+                size_t expected = c + 1 == count ? common.size - c * chunk : chunk;
+                if (c >= count || data.size() != expected) {
+                    endpoint->close(conn);
+                    return;
+                }
+                auto& owed = asked[conn];
+                owed.erase(std::remove(owed.begin(), owed.end(), c), owed.end());
+                if (!have[c]) {
+                    have[c] = true;
+                    parts[c] = std::move(data);
+                    if (++received == count) endpoint->stop();
+                }
+            };
+            handlers.onClose = [&](ConnId conn) {
+                auto it = asked.find(conn);
+                if (it == asked.end()) {
+                    connecting--;   // connect failed
+                    for (size_t c : mine) if (!have[c]) orphans.push_back(c);
+                } else {
+                    for (size_t c : it->second) if (!have[c]) orphans.push_back(c);
+                    asked.erase(it);
+                }
+                reassign();
+            };
+
+            connecting++;
+            if (!client->connect(peerUri(peers[p]), handlers)) {
+                connecting--;
+                for (size_t c : mine) orphans.push_back(c);
+            }
+        }
+        if (connecting == 0) return false;
+
+        endpoint->setTimer(kCommonTimeoutMs, [endpoint]() { endpoint->stop(); });
+        client->run();
+        if (received < count) return false;
+
+        blob.clear();
+        blob.reserve(common.size);
+        for (auto& part : parts) blob += part;
+        std::cout << "[UAV] Received " << blob.size() << " bytes of common data in " << count
+                  << " chunks from up to " << peers.size() << " peers." << std::endl;
+        return true;
+    }
+
+    bool fetchCommonFromTA(std::string& blob) {
+        TransportPtr client = makeTransport();
+        Transport* endpoint = client.get();
+        bool received = false;
+
+        const std::string uri = "ws://10.0.10.2:9002";
+
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint](ConnId conn) {
+            endpoint->send(conn, kRequestCommon);
+        };
+        handlers.onMessage = [&blob, &received, endpoint](ConnId conn, const std::string& msg) {
+            blob = msg;
+            received = true;
+            endpoint->close(conn);
+        };
+
+        if (!client->connect(uri, handlers)) {
+            std::cerr << "[UAV] Failed to connect to TA." << std::endl;
+            return false;
+        }
+        client->run();
+        return received;
+    }
+
+    int obtainCommon(UAVContext& ctx, const CommonRef& common) {
+        std::string blob;
+        if (fetchCommonFromPeers(ctx.uav.serialNumber, common, blob) && installCommon(ctx, blob, common.digest)) {
+            return 0;
+        }
+        std::cout << "[UAV] Common data not available from peers, asking TA." << std::endl;
+        if (fetchCommonFromTA(blob) && installCommon(ctx, blob, common.digest)) {
+            return 0;
+        }
+        std::cerr << "[UAV] No common data: registration incomplete." << std::endl;
+        return -1;
+    }
+
+    void serveCommonChunk(const UAVContext& ctx, Transport* server, ConnId conn, const std::string& request) {
+        // "COMMON#digest#chunk#chunkSize"
+        std::string reply;
+        size_t digestEnd = request.find('#', 7);
+        size_t chunkEnd = digestEnd == std::string::npos ? digestEnd : request.find('#', digestEnd + 1);
+        if (chunkEnd == std::string::npos) return;
+        std::string chunkStr = request.substr(digestEnd + 1, chunkEnd - digestEnd - 1);
+        reply = "COMMON#" + chunkStr + "#";
+
+        size_t c = 0, size = 0;
+        try {
+            c = std::stoull(chunkStr);
+            size = std::stoull(request.substr(chunkEnd + 1));
+        } catch (...) {
+            size = 0;
+        }
+        if (ctx.swarm && size > 0 && ctx.swarm->commonDigest == request.substr(7, digestEnd - 7) &&
+            c < (ctx.swarm->commonBlob.size() + size - 1) / size) {
+            reply += ctx.swarm->commonBlob.substr(c * size, size);
+        }
+        bool binary = ctx.swarm && isWireBinary(ctx.swarm->commonBlob);
+        if (!server->send(conn, reply, binary)) {
+            std::cerr << "[UAV Error] Failed to send common data chunk." << std::endl;
+        }
     }
 
 
@@ -100,67 +474,377 @@ namespace UAVNode_NS {
 // UAV server: receives signer-set S from UAVh and returns partial signature
 // ============================================================
 
-    void serverOnMessage(Server* server, connection_hdl hdl, MsgServer msg) {
-        // 1. Retrieve the bitmap payload (Binary Data)
-        std::string bitmap = msg->get_payload();
-        std::string sigStr = "null";
+    void serverOnMessage(UAVContext& ctx, Transport* server, ConnId conn, const std::string& payload) {
+        auto received = std::chrono::steady_clock::now();
 
-        // 2. Retrieve local serial number
-        int myIndex = uav.serialNumber;
+        // 0. A peer fetching the common data (COMMON_P2P)
+        if (payload.rfind("COMMON#", 0) == 0) {
+            serveCommonChunk(ctx, server, conn, payload);
+            return;
+        }
 
-        // 3. Check if the current UAV is selected in the bitmap
-        bool isSelected = false;
-        int myByteIndex = myIndex / 8;
-        int myBitIndex  = myIndex % 8;
+        // 0b. The head of a new sub-swarm distributing the transformation key
+        if (payload.rfind("SPLIT#", 0) == 0) {
+            std::string reply = applySplit(ctx, payload.substr(6));
+            if (!server->send(conn, reply)) {
+                std::cerr << "[UAV Error] Failed to acknowledge the split." << std::endl;
+            }
+            // The cached keys would restore the shares of the former swarm
+            if (reply == "SPLIT#OK" && !ctx.cachePath.empty()) saveRegistration(ctx, ctx.cachePath);
+            return;
+        }
 
-        if (myByteIndex < bitmap.size()) {
-            uint8_t byteVal = static_cast<uint8_t>(bitmap[myByteIndex]);
-            isSelected = (byteVal >> myBitIndex) & 1;
+        // 1. Retrieve "sid#slot#" + signer set payload (Binary Data)
+        size_t delPos = payload.find('#');
+        if (delPos == std::string::npos) {
+            std::cerr << "[UAV Error] Request without session id ignored." << std::endl;
+            return;
+        }
+        std::string sid = payload.substr(0, delPos);
+        std::string signers;
+        std::vector<int> S;
+        uint64_t delayUs = parsePacedRequest(ctx, payload.substr(delPos + 1), signers, S);
+
+        // 2. Sign if selected
+        std::string reply = sid + "#" + signForSigners(ctx, signers, S);
+        bool binary = isWireBinary(reply, sid.size() + 1);
+
+        // 3. Send response back to UAVh (Aggregator), tagged with the session id
+        auto sendReply = [server, conn, reply, binary]() {
+            if (!server->send(conn, reply, binary)) {
+                std::cerr << "[UAV Error] Failed to send reply of session." << std::endl;
+            }
+        };
+
+        // Signing already used part of the slot delay; wait for the rest off the server thread
+        auto slot = received + std::chrono::microseconds(delayUs);
+        if (std::chrono::steady_clock::now() < slot) {
+            std::thread([sendReply, slot]() {
+                std::this_thread::sleep_until(slot);
+                sendReply();
+            }).detach();
+        } else {
+            sendReply();
         }
+    }
 
-        // 4. If selected, generate partial signature
-        if (isSelected) {
-            parSig sig = Sign(pp, uav, threshold, message, bitmap, registeredIDs);
-            sigStr = parSig_to_str(sig);
+    uint64_t parsePacedRequest(const UAVContext& ctx, const std::string& body, std::string& signers,
+                               std::vector<int>& S) {
+        size_t delPos = body.find('#');
+        uint64_t slotUs = 0;
+        try {
+            slotUs = std::stoull(body.substr(0, delPos));
+        } catch (...) {
+            slotUs = 0;
+        }
+        signers = delPos == std::string::npos ? "" : body.substr(delPos + 1);
+        if (!ctx.swarm || !decodeSignerSet(signers, ctx.swarm->pp.n, S)) {
+            std::cerr << "[UAV Error] Malformed signer set ignored." << std::endl;
+            S.clear();
+        }
+
+        // Rank of this UAV among the selected signers
+        int rank = signerRank(S, ctx.uav.serialNumber);
+        return rank < 0 ? 0 : static_cast<uint64_t>(rank) * slotUs;
+    }
+
+    std::string signForSigners(UAVContext& ctx, const std::string& signers, const std::vector<int>& S) {
+        std::string sigStr = "null";
+        uint64_t cpuStart = threadCpuMicros();
+        ctx.usage.requests++;
+
+        // 1. Retrieve local serial number
+        int myIndex = ctx.uav.serialNumber;
+
+        // 2. Check if the current UAV is selected in S
+        bool isSelected = signerRank(S, myIndex) >= 0;
+
+        // 3. If selected, generate partial signature over a set SignInit can index: IDs it has, t at least
+        if (isSelected && (S.back() >= static_cast<int>(ctx.swarm->registeredIDs.size())
+                           || static_cast<int>(S.size()) < ctx.swarm->threshold)) {
+            std::cerr << "[UAV " << myIndex << "] Signer set outside the registry or below t, ignored." << std::endl;
+        } else if (isSelected) {
+            const SwarmParams& swarm = *ctx.swarm;
+            std::shared_ptr<const SignContext> signCtx;
+            if (ctx.signCache) {
+                // Computed by the first UAV of this process that signs for this signer set
+                std::lock_guard<std::mutex> lock(ctx.signCache->mtx);
+                if (!ctx.signCache->ctx || ctx.signCache->signers != signers) {
+                    ctx.signCache->ctx = std::make_shared<SignContext>(
+                            SignInit(swarm.pp, swarm.threshold, swarm.message, S, swarm.registeredIDs));
+                    ctx.signCache->signers = signers;
+                }
+                signCtx = ctx.signCache->ctx;
+            } else {
+                signCtx = std::make_shared<SignContext>(
+                        SignInit(swarm.pp, swarm.threshold, swarm.message, S, swarm.registeredIDs));
+            }
+            parSig sig;
+            {
+                std::lock_guard<std::mutex> lock(ctx.keysMtx);
+                sig = SignShare(*signCtx, swarm.pp, ctx.uav);
+            }
+            sigStr = parSig_to_wire(sig);
+            ctx.usage.signatures++;
             std::cout << "[UAV " << myIndex << "] Generated signature." << std::endl;
         } else {
             std::cout << "[UAV " << myIndex << "] Not selected. Idle." << std::endl;
         }
+        ctx.usage.cpuUs += threadCpuMicros() - cpuStart;
+        return sigStr;
+    }
 
-        // 5. Send response back to UAVh (Aggregator)
+    std::string applySplit(UAVContext& ctx, const std::string& body) {
+        int myIndex = ctx.uav.serialNumber;
+        SplitKey key;
         try {
-            server->send(hdl, sigStr, websocketpp::frame::opcode::text);
+            key = wire_to_SplitKey(body);
+        } catch (const std::exception& e) {
+            std::cerr << "[UAV Error] Invalid split key: " << e.what() << std::endl;
+            return "SPLIT#FAIL";
         }
-        catch (const websocketpp::exception& e) {
-            std::cerr << "[UAV Error] Failed to send: " << e.what() << std::endl;
+        if (!ctx.swarm) {
+            std::cerr << "[UAV Error] Split before the parameters were received." << std::endl;
+            return "SPLIT#FAIL";
+        }
+        // The key names the serials of its sub-swarm, under the signature
+        if (myIndex < key.first || myIndex >= key.end) {
+            std::cerr << "[UAV " << myIndex << "] Split key for UAVs " << key.first << ".." << key.end - 1
+                      << ", rejected." << std::endl;
+            return "SPLIT#FAIL";
         }
-    }
 
-// Start UAV server (listening for UAVh)
-    void startUAVServer() {
-        Server server;
-        int port = 8002;
+        std::lock_guard<std::mutex> lock(ctx.keysMtx);
+        if (key.stk == ctx.lastSplit) {
+            std::cout << "[UAV " << myIndex << "] Split already applied." << std::endl;
+            return "SPLIT#OK";
+        }
+        // Checked against the swarm this UAV belongs to now: TA's, or the sub-swarm of its last split
+        Params pp = ctx.swarm->pp;
+        if (ctx.splitBeta != 0) pp.beta = ctx.splitBeta;
+        if (!SplitVerify(pp, key)) {
+            std::cerr << "[UAV " << myIndex << "] Split key not signed with the key of its swarm, rejected." << std::endl;
+            return "SPLIT#FAIL";
+        }
+        SplitUpdate(pp, key, ctx.uav);
+        ctx.lastSplit = key.stk;
+        ctx.splitBeta = SplitBeta(pp, key);
+        std::cout << "[UAV " << myIndex << "] Updated " << key.shares << " shares for the new sub-swarm." << std::endl;
+        return "SPLIT#OK";
+    }
 
-        try {
-            server.set_access_channels(websocketpp::log::alevel::none);
-            server.init_asio();
+// Serve UAVh over UDP
+    void startUAVDatagram(const std::shared_ptr<UAVContext>& ctx, int port) {
+        serveDatagrams({ctx}, {port});
+    }
 
-            server.set_message_handler(
-                    websocketpp::lib::bind(&serverOnMessage, &server,
-                                           websocketpp::lib::placeholders::_1,
-                                           websocketpp::lib::placeholders::_2)
-            );
+    void serveDatagrams(const std::vector<std::shared_ptr<UAVContext>>& uavs, const std::vector<int>& ports) {
+        std::vector<int> fds;
+        for (int port : ports) {
+            int fd = openDatagramSocket(port);
+            if (fd < 0) return;
+            fds.push_back(fd);
+        }
+        if (uavs.empty() || fds.empty()) return;
+        size_t ownSockets = fds.size();
+        int mfd = openMulticastSocket(mcastGroup, static_cast<uint16_t>(mcastPort));
+        if (mfd >= 0) fds.push_back(mfd);
+        std::cout << "[UAV] Listening for datagrams of " << uavs.size() << " UAV(s) on " << ownSockets
+                  << " UDP port(s)" << (mfd < 0 ? "" : " and multicast " + mcastGroup) << std::endl;
+
+        using Clock = std::chrono::steady_clock;
+        struct Pending {
+            Datagram dg;
+            int fd;             // socket the request came in on
+            sockaddr_in to;
+            int retriesLeft;
+            Clock::time_point next;
+            bool scheduled;     // waiting for its paced slot, not sent yet
+        };
+        struct Answer {
+            Datagram dg;
+            Clock::time_point slot;   // paced send time of the first reply
+        };
+        const size_t kReplayWindow = 1024;
+
+        // Per-UAV datagram state
+        struct Served {
+            UAVContext* ctx;
+            std::map<uint32_t, Pending> pending;     // signatures not acknowledged yet, by session id
+            std::map<uint32_t, Answer> answered;     // replies of the latest sessions (replay cache)
+            std::deque<uint32_t> answeredOrder;
+        };
+        std::vector<Served> served;
+        std::map<int, Served*> bySerial;
+        served.reserve(uavs.size());
+        for (auto& ctx : uavs) {
+            served.push_back(Served{ctx.get()});
+        }
+        for (auto& s : served) {
+            bySerial[s.ctx->uav.serialNumber] = &s;
+        }
 
-            server.listen(port);
-            server.start_accept();
+        // UAVs a datagram is addressed to: a lone UAV takes everything, as before hosts existed
+        auto recipients = [&served, &bySerial](uint16_t index, std::vector<Served*>& out) {
+            out.clear();
+            if (served.size() == 1) {
+                out.push_back(&served[0]);
+            } else if (index == kSwarmIndex) {
+                for (auto& s : served) out.push_back(&s);
+            } else {
+                auto it = bySerial.find(index);
+                if (it != bySerial.end()) out.push_back(it->second);
+            }
+        };
 
-            std::cout << "[UAV] Listening on port " << port << std::endl;
+        // Unicast replies leave through the socket of the request, multicast ones through the first own socket
+        auto replySocket = [&fds, ownSockets](int fd) {
+            for (size_t k = 0; k < ownSockets; ++k) {
+                if (fds[k] == fd) return fd;
+            }
+            return fds[0];
+        };
+
+        uint32_t lastSeq = 0;   // highest multicast sequence number seen
+        sockaddr_in lastSender{};   // UAVh that sent it
+        // A sequence number this far behind the highest one comes from a restarted UAVh;
+        // UAVh repairs only its latest 256 requests, so older ones are never asked for
+        const uint32_t kSeqRestart = 256;
+
+        Datagram dg;
+        sockaddr_in from{};
+        std::vector<Served*> targets;
+        for (;;) {
+            // Wake up in time for the next scheduled (paced or repeated) send
+            int timeoutMs = 10;
+            for (auto& s : served) {
+                for (auto& entry : s.pending) {
+                    auto until = std::chrono::duration_cast<std::chrono::milliseconds>(entry.second.next - Clock::now());
+                    timeoutMs = std::max(0, std::min<int>(timeoutMs, (int) until.count()));
+                }
+            }
+            int ready = waitDatagram(fds.data(), (int) fds.size(), timeoutMs);
+            if (ready >= 0 && recvDatagram(ready, dg, from, 0)) {
+                int fd = replySocket(ready);
+                recipients(dg.index, targets);
+
+                if (dg.type == DG_PING) {
+                    dg.type = DG_PONG;
+                    if (!targets.empty()) sendDatagram(fd, from, dg);
+                    continue;
+                }
+                if (dg.type == DG_REQUEST && !useDatagrams) continue;
+                if (dg.type == DG_REQUEST && dg.seq != 0) {
+                    // A restarted UAVh numbers its requests from 1 again, from another socket
+                    bool newSender = from.sin_addr.s_addr != lastSender.sin_addr.s_addr || from.sin_port != lastSender.sin_port;
+                    if (lastSeq != 0 && (newSender || dg.seq + kSeqRestart < lastSeq)) {
+                        std::cout << "[UAV] UAVh restarted, multicast sequence reset." << std::endl;
+                        lastSeq = 0;
+                    }
+                    lastSender = from;
+                    // Ask for every multicast request skipped since the last one (bounded);
+                    // a host asks once for all of its UAVs
+                    if (lastSeq != 0 && dg.seq > lastSeq + 1) {
+                        for (uint32_t missed = std::max(lastSeq + 1, dg.seq - 16); missed < dg.seq; ++missed) {
+                            Datagram nack;
+                            nack.type = DG_NACK;
+                            nack.index = served.size() == 1
+                                         ? static_cast<uint16_t>(served[0].ctx->uav.serialNumber) : kSwarmIndex;
+                            nack.seq = missed;
+                            sendDatagram(fd, from, nack, udpRedundancy);
+                        }
+                    }
+                    lastSeq = std::max(lastSeq, dg.seq);
+                }
+                if (dg.type == DG_REQUEST) {
+                    for (Served* s : targets) {
+                        UAVContext& ctx = *s->ctx;
+                        auto received = Clock::now();
+                        auto sendAt = received;
+                        Datagram reply;
+                        auto it = s->answered.find(dg.sid);
+                        if (it != s->answered.end()) {
+                            // A redundant copy of the request: the scheduled reply keeps its slot
+                            auto waiting = s->pending.find(dg.sid);
+                            if (waiting != s->pending.end() && waiting->second.scheduled) continue;
+                            reply = it->second.dg;
+                            sendAt = std::max(received, it->second.slot);
+                        } else {
+                            std::string signers;
+                            std::vector<int> S;
+                            sendAt += std::chrono::microseconds(parsePacedRequest(ctx, dg.payload, signers, S));
+                            std::string sigStr = signForSigners(ctx, signers, S);
+                            reply.type = DG_SIGNATURE;
+                            reply.sid = dg.sid;
+                            reply.index = static_cast<uint16_t>(ctx.uav.serialNumber);
+                            reply.payload = sigStr == "null" ? "" : sigStr;
+
+                            s->answered[dg.sid] = Answer{reply, sendAt};
+                            s->answeredOrder.push_back(dg.sid);
+                            if (s->answeredOrder.size() > kReplayWindow) {
+                                s->answered.erase(s->answeredOrder.front());
+                                s->answeredOrder.pop_front();
+                            }
+                        }
+                        // A multicast request only needs answers from the UAVs it selected
+                        if (targets.size() > 1 && reply.payload.empty()) continue;
+                        if (Clock::now() >= sendAt) {
+                            sendDatagram(fd, from, reply, udpRedundancy);
+                            // Only real signatures are worth retransmitting
+                            if (!reply.payload.empty()) {
+                                s->pending[dg.sid] = Pending{reply, fd, from, udpRetries,
+                                                             Clock::now() + std::chrono::milliseconds(udpRetryMs), false};
+                            }
+                        } else {
+                            // Not our slot yet: the retransmission loop sends it on time
+                            s->pending[dg.sid] = Pending{reply, fd, from, udpRetries + 1, sendAt, true};
+                        }
+                    }
+                } else if (dg.type == DG_ACK) {
+                    for (Served* s : targets) s->pending.erase(dg.sid);
+                }
+            }
 
-            server.run();
+            auto now = Clock::now();
+            for (auto& s : served) {
+                for (auto it = s.pending.begin(); it != s.pending.end();) {
+                    Pending &p = it->second;
+                    if (now < p.next) {
+                        ++it;
+                    } else if (p.retriesLeft-- <= 0) {
+                        std::cerr << "[UAV " << s.ctx->uav.serialNumber << "] Signature of session "
+                                  << it->first << " never acknowledged." << std::endl;
+                        it = s.pending.erase(it);
+                    } else {
+                        sendDatagram(p.fd, p.to, p.dg, udpRedundancy);
+                        p.next = now + std::chrono::milliseconds(udpRetryMs);
+                        p.scheduled = false;
+                        ++it;
+                    }
+                }
+            }
         }
-        catch (const std::exception& e) {
-            std::cerr << "[UAV Server Exception] " << e.what() << std::endl;
+    }
+
+// Start UAV server (listening for UAVh)
+    void startUAVServer(UAVContext& ctx) {
+        TransportPtr server = makeTransport();
+        Transport* endpoint = server.get();
+        int port = 8002;
+
+        TransportHandlers handlers;
+        handlers.onMessage = [&ctx, endpoint](ConnId conn, const std::string& msg) {
+            serverOnMessage(ctx, endpoint, conn, msg);
+        };
+
+        if (!server->listen("ws://0.0.0.0:" + std::to_string(port), handlers)) {
+            std::cerr << "[UAV Server] Failed to listen on port " << port << std::endl;
+            return;
         }
+
+        std::cout << "[UAV] Listening on port " << port << std::endl;
+
+        server->run();
     }
 
 
@@ -168,12 +852,28 @@ namespace UAVNode_NS {
 // Entry point for UAV process
 // ============================================================
 
-    int run() {
-        // Step 1: connect to TA (client)
-        connectToTA();
+    int run(const char* transportOverride) {
+        loadOptions(transportOverride);
+
+        // Keys outlive run() for the detached datagram thread
+        auto ctx = std::make_shared<UAVContext>();
 
-        // Step 2: act as server and wait for UAVh
-        startUAVServer();
+        // Step 1: connect to TA (client), unless the registration of the last run is still valid.
+        // Every UAV listens on the same port here: the cache is named after NODE_NAME (run_uavs.sh)
+        const char* node = std::getenv("NODE_NAME");
+        std::string cachePath = node ? nodeCachePath(std::string("uav_") + node) : "";
+        if (!restoreRegistration(*ctx, cachePath)) {
+            if (connectToTA(*ctx) != 0) return -1;
+            if (!cachePath.empty()) saveRegistration(*ctx, cachePath);
+        }
+        ctx->cachePath = cachePath;
+
+        // Step 2: act as server and wait for UAVh (UDP on the same port number, always on for heartbeats;
+        // in-process runs have no sockets)
+        if (transportBackend() != "memory") {
+            std::thread([ctx]() { startUAVDatagram(ctx, 8002); }).detach();
+        }
+        startUAVServer(*ctx);
 
         return 0;
     }
@@ -184,6 +884,9 @@ namespace UAVNode_NS {
 // ============================================================
 // Standalone main
 // ============================================================
-int main() {
-    return UAVNode_NS::run();
+#ifndef RTS_IN_PROCESS
+int main(int argc, char* argv[]) {
+    // Optional: ./UAV_netSim [ws|udp] selects the transport for this node
+    return UAVNode_NS::run(argc > 1 ? argv[1] : nullptr);
 }
+#endif
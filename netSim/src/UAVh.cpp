@@ -1,36 +1,80 @@
 #include "../include/UAVh.h"
 
+
 namespace UAVhNode_NS {
 
 // ============================================================
 // Global state for UAVh (Cluster Head)
 // ============================================================
 
-    gmp_randstate_t state;
     Params pp;          // system parameters from TA
     UAV_h uavh;        // cluster head's private data
     mpz_class message;     // message M
     int threshold;   // t
     int numUAV;      // n
-    std::vector<parSig> partialSigs;      // collected partial signatures
 
-    std::mutex sigMutex;
-    string bitmap;
+    int hedgePercentile = 95;
+    int maxRetries = 2;
+    std::string latencyCsv = "latency.csv";
+
+    bool useDatagrams = false;
+    int udpRedundancy = 2;
+    int udpSocket = -1;
+
+    bool multicastFanout = false;
+    sockaddr_in mcastAddr{};
+    uint32_t mcastSeq = 0;
+    std::map<uint32_t, uint32_t> mcastSessions;
+    std::mutex mcastMtx;
+
+    bool paceReplies = false;
+    double paceRate = 128e3;
+    std::atomic<size_t> replyBytes{256};
+
+    std::vector<RttEstimator> uavRtt;
+    LatencyStats rttStats;
+    LatencyStats sessionStats;
+    std::mutex latencyMtx;
+
+    int heartbeatMs = 1000;
+    int heartbeatMiss = 3;
+    std::vector<PeerHealth> uavHealth;
+
+    int subHeads = 0;
+    int subHeadIndex = -1;
+    int ownFirst = 0, ownEnd = 0;
+    std::mutex keyMtx;
+    std::vector<bool> splitOff;
+    std::map<int, SplitKey> splitKeys;
+    int splitOrderTtl = 300;
+    int splitIntervalMs = 1000;
+
+    // Split request in progress and the time the last one was admitted, guarded by splitMtx
+    static std::mutex splitMtx;
+    static bool splitRunning = false;
+    static std::chrono::steady_clock::time_point lastSplitRequest;
+
+    // NODE_CACHE_DIR file of this head, rewritten after a split
+    static std::string registrationCache;
+
+    // Heartbeat round in flight, guarded by latencyMtx
+    static uint32_t heartbeatRound = 0;
+    static std::vector<bool> pongPending;
+    static std::chrono::steady_clock::time_point pingSentAt;
+
+    std::map<uint32_t, SessionPtr> sessions;   // active authentication sessions
+    std::mutex sessionsMtx;
 
 // ============================================================
 // TA connection handlers (client mode)
 // ============================================================
 
 // Called when UAVh connects to TA (ws://ip:9002)
-    void handleTAOpen(Client *c, connection_hdl hdl) {
-        initState(state);
+    void handleTAOpen(Transport *c, ConnId conn) {
+        std::string type = kRegisterHead;
 
-        std::string type = "UAVh";
-        websocketpp::lib::error_code ec;
-
-        c->send(hdl, type, websocketpp::frame::opcode::text, ec);
-        if (ec) {
-            std::cerr << "[UAVh] Failed to send ID to TA: " << ec.message() << std::endl;
+        if (!c->send(conn, type)) {
+            std::cerr << "[UAVh] Failed to send ID to TA." << std::endl;
         } else {
             std::cout << "[UAVh] Aggregator ID sent to TA." << std::endl;
         }
@@ -38,23 +82,22 @@ namespace UAVhNode_NS {
 
 
 // Called when TA replies with parameters and UAVh secret
-    void handleTAMessage(Client *c, connection_hdl hdl, MsgClient msg) {
+    void handleTAMessage(Transport *c, ConnId conn, const std::string &msg) {
         std::cout << "[UAVh] Received registration package from TA." << std::endl;
 
-        TransmissionPackage pkg = str_to_Package(msg->get_payload());
+        HeadPackage pkg = wire_to_HeadPackage(msg);
 
         pp = pkg.pp;
-        uavh.ID = pkg.uav.ID;
-        uavh.alpha = pkg.uav.c2[0];
+        uavh = pkg.uavh;
         message = pkg.M;
         threshold = pkg.t;
-        numUAV = pkg.uav.c2[1].get_si();
+        numUAV = pkg.pp.n;
 
         std::cout << "[UAVh] Alpha received = ";
         show_mpz(uavh.alpha.get_mpz_t());
 
         // Close connection after loading parameters
-        c->close(hdl, websocketpp::close::status::normal, "TA done");
+        c->close(conn);
     }
 
 
@@ -63,143 +106,764 @@ namespace UAVhNode_NS {
 // ============================================================
 
     int connectToTA() {
-        Client client;
+        TransportPtr client = makeTransport();
+        Transport *endpoint = client.get();
         const std::string uri = "ws://10.0.10.2:9002";
+        bool registered = false;
+
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint](ConnId conn) {
+            handleTAOpen(endpoint, conn);
+        };
+        handlers.onMessage = [endpoint, &registered](ConnId conn, const std::string &msg) {
+            handleTAMessage(endpoint, conn, msg);
+            registered = true;
+        };
+
+        if (!client->connect(uri, handlers)) {
+            std::cerr << "[UAVh] Failed to connect to TA." << std::endl;
+            return -1;
+        }
 
-        try {
-            client.set_access_channels(websocketpp::log::alevel::none);
-            client.init_asio();
-
-            client.set_open_handler(
-                    websocketpp::lib::bind(&handleTAOpen, &client, websocketpp::lib::placeholders::_1)
-            );
-            client.set_message_handler(
-                    websocketpp::lib::bind(
-                            &handleTAMessage,
-                            &client,
-                            websocketpp::lib::placeholders::_1,
-                            websocketpp::lib::placeholders::_2
-                    )
-            );
-
-            websocketpp::lib::error_code ec;
-            auto con = client.get_connection(uri, ec);
-            if (ec) {
-                std::cerr << "[UAVh] Failed to connect to TA: " << ec.message() << std::endl;
-                return -1;
-            }
+        // Returns once TA closed or refused the connection
+        client->run();
 
-            client.connect(con);
+        if (!registered) {
+            std::cerr << "[UAVh] Connection to TA closed before registration." << std::endl;
+            return -1;
+        }
+        return 0;
+    }
 
-            std::thread t([&client]() { client.run(); });
-            if (t.joinable()) t.join();
+// ============================================================
+// Cached registration (NODE_CACHE_DIR)
+// ============================================================
+
+    bool restoreRegistration(const std::string &path) {
+        CacheReader cache;
+        if (path.empty() || !cache.load(path, "UAVh")) return false;
+
+        Params cachedPP = cache.params();
+        UAV_h cachedUAVh;
+        cachedUAVh.ID = cache.scalar();
+        cachedUAVh.alpha = cache.scalar();
+        mpz_class cachedMessage = cache.scalar();
+        int cachedThreshold = static_cast<int>(cache.u32());
+        int cachedNumUAV = static_cast<int>(cache.u32());
+        if (!cache.ok()) return false;
+
+        std::string reply, digest;
+        int issued = 0;
+        if (!requestOnce("ws://10.0.10.2:9002", kRequestDigest, reply) || !parseDigestReply(reply, digest, issued)) {
+            std::cerr << "[UAVh] Cannot check the cached registration with TA." << std::endl;
+            return false;
         }
-        catch (const std::exception &e) {
-            std::cerr << "[UAVh Exception] " << e.what() << std::endl;
-            return -1;
+        if (digest != cache.digest()) {
+            std::cout << "[UAVh] Cached registration is out of date." << std::endl;
+            return false;
         }
 
-        return 0;
+        pp = cachedPP;
+        uavh = cachedUAVh;
+        message = cachedMessage;
+        threshold = cachedThreshold;
+        numUAV = cachedNumUAV;
+        std::cout << "[UAVh] Restored registration from " << path << std::endl;
+        return true;
+    }
+
+    void saveRegistration(const std::string &path) {
+        std::string reply, digest;
+        int issued = 0;
+        if (!requestOnce("ws://10.0.10.2:9002", kRequestDigest, reply) || !parseDigestReply(reply, digest, issued)) {
+            std::cerr << "[UAVh] No digest from TA, registration not cached." << std::endl;
+            return;
+        }
+
+        CacheWriter cache;
+        cache.params(pp);
+        cache.scalar(uavh.ID);
+        cache.scalar(uavh.alpha);
+        cache.scalar(message);
+        cache.u32(static_cast<uint32_t>(threshold));
+        cache.u32(static_cast<uint32_t>(numUAV));
+        cache.save(path, "UAVh", digest);
     }
 
+
 // ============================================================
 // Collect partial signatures from UAV_i
 // ============================================================
 
-// Called when connection to UAV_i is opened: send the bitmap provided by Verifier
-    void handleUAVOpen(Client *c, connection_hdl hdl) {
-        websocketpp::lib::error_code ec;
+// Called when connection to UAV_i is opened: send "sid#" + the signer set provided by Verifier
+    void handleUAVOpen(Transport *c, ConnId conn, SessionPtr session, uint32_t slotUs) {
+        std::string frame = std::to_string(session->id) + "#" + std::to_string(slotUs) + "#" + session->signers;
 
-        c->send(hdl, bitmap, websocketpp::frame::opcode::binary, ec);
-
-        if (ec) {
-            std::cerr << "[UAVh] Error sending bitmap: " << ec.message() << std::endl;
+        if (!c->send(conn, frame, true)) {
+            std::cerr << "[UAVh] Error sending signer set." << std::endl;
         }
         else {
             std::cout << "[UAVh] Bitmap sent to UAV." << std::endl;
         }
     }
 
-// Handle the partial signature returned by UAV_i
-    void handleUAVMessage(Client *c, connection_hdl hdl, MsgClient msg) {
-        std::string payload = msg->get_payload();
+// Look up an active session by id
+    SessionPtr findSession(uint32_t id) {
+        std::lock_guard<std::mutex> lock(sessionsMtx);
+        auto it = sessions.find(id);
+        return it == sessions.end() ? nullptr : it->second;
+    }
+
+// Handle the "sid#partial signature" returned by UAV_i
+    void handleUAVMessage(Transport *c, ConnId conn, const std::string &payload) {
+        size_t delPos = payload.find('#');
+        if (delPos == std::string::npos) {
+            std::cerr << "[UAVh] Message without session id ignored." << std::endl;
+        } else {
+            try {
+                deliverPartialSignature(static_cast<uint32_t>(std::stoul(payload.substr(0, delPos))),
+                                        payload.substr(delPos + 1));
+            } catch (const std::exception &e) {
+                std::cerr << "[UAVh] Invalid message from UAV: " << e.what() << std::endl;
+            }
+        }
+
+        c->close(conn);
+    }
+
 
-        std::cout << "[UAVh] Sent aggregated signature (size: " << payload.size() << " bytes).\n";
+    void deliverPartialSignature(uint32_t sid, const std::string &body) {
+        SessionPtr session = findSession(sid);
 
-        if (payload != "null") {
-            parSig sig = str_to_parSig(payload);
+        // Pacing slots are sized after the largest reply observed
+        size_t seen = replyBytes.load();
+        while (body.size() > seen && !replyBytes.compare_exchange_weak(seen, body.size())) { }
 
-            // lock
-            {
-                std::lock_guard<std::mutex> lock(sigMutex);
-                partialSigs.push_back(sig);
+        if (!session) {
+            std::cerr << "[UAVh] Message for unknown session ignored." << std::endl;
+        } else if (body != "null") {
+            if (session->collecting.load(std::memory_order_acquire)) {
+                if (!session->arrivals->push(wire_to_parSig(body))) {
+                    std::cerr << "[UAVh] Arrival queue full, partial signature dropped." << std::endl;
+                }
+                std::cout << "[UAVh] Partial signature received (session " << session->id << ")." << std::endl;
+            } else {
+                std::cout << "[UAVh] Late partial signature ignored." << std::endl;
             }
-            std::cout << "[UAVh] Partial signature received." << std::endl;
         } else {
             std::cout << "[UAVh] UAV_i not selected in S.\n";
         }
+    }
+
+    void udpReceiveLoop() {
+        Datagram dg;
+        sockaddr_in from{};
+        for (;;) {
+            if (!recvDatagram(udpSocket, dg, from, 1000)) continue;
+
+            if (dg.type == DG_PONG) {
+                std::lock_guard<std::mutex> lock(latencyMtx);
+                if (dg.seq == heartbeatRound && dg.index < pongPending.size() && pongPending[dg.index]) {
+                    pongPending[dg.index] = false;
+                    healthReply(uavHealth[dg.index], std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - pingSentAt).count());
+                }
+                continue;
+            }
+
+            if (dg.type == DG_NACK) {
+                uint32_t sid;
+                {
+                    std::lock_guard<std::mutex> lock(mcastMtx);
+                    auto it = mcastSessions.find(dg.seq);
+                    if (it == mcastSessions.end()) continue;
+                    sid = it->second;
+                }
+                SessionPtr session = findSession(sid);
+                if (!session || !session->collecting.load(std::memory_order_acquire)) continue;
+
+                Datagram repair;
+                repair.type = DG_REQUEST;
+                repair.sid = sid;
+                repair.index = dg.index;
+                repair.payload = "0#" + session->signers;
+                sendDatagram(udpSocket, from, repair, udpRedundancy);
+                std::cout << "[UAVh] Repaired multicast request " << dg.seq << " for UAV " << dg.index << "." << std::endl;
+                continue;
+            }
+            if (dg.type != DG_SIGNATURE) continue;
+
+            Datagram ack;
+            ack.type = DG_ACK;
+            ack.sid = dg.sid;
+            ack.index = dg.index;
+            sendDatagram(udpSocket, from, ack, udpRedundancy);
+
+            try {
+                deliverPartialSignature(dg.sid, dg.payload.empty() ? "null" : dg.payload);
+            } catch (const std::exception &e) {
+                std::cerr << "[UAVh] Invalid datagram from UAV: " << e.what() << std::endl;
+            }
+        }
+    }
+
+// Address of the i-th UAV server
+    std::string uavUri(int i) {
+        return "ws://10.0.30." + std::to_string(101 + i) + ":8002";
+    }
+
+// UDP endpoint of the i-th UAV (same port number as its WebSocket server)
+    sockaddr_in uavUdpAddr(int i) {
+        return datagramAddr("10.0.30." + std::to_string(101 + i), 8002);
+    }
+
+    void heartbeatLoop() {
+        for (;;) {
+            Datagram ping;
+            ping.type = DG_PING;
+            {
+                std::lock_guard<std::mutex> lock(latencyMtx);
+                for (int i = ownFirst; i < ownEnd; ++i) {
+                    if (pongPending[i]) healthMiss(uavHealth[i], heartbeatMiss);
+                    pongPending[i] = true;
+                }
+                ping.seq = ++heartbeatRound;
+                pingSentAt = std::chrono::steady_clock::now();
+            }
+            for (int i = ownFirst; i < ownEnd; ++i) {
+                ping.index = static_cast<uint16_t>(i);
+                sendDatagram(udpSocket, uavUdpAddr(i), ping);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(heartbeatMs));
+        }
+    }
+
+    bool requestUAV(SessionPtr session, int i, bool paced) {
+        uint32_t slotUs = paced ? session->slotUs : 0;
+
+        if (useDatagrams) {
+            // Repeated copies stand in for an erasure code; the reply acknowledges the request
+            Datagram dg;
+            dg.type = DG_REQUEST;
+            dg.sid = session->id;
+            dg.index = static_cast<uint16_t>(i);
+            dg.payload = std::to_string(slotUs) + "#" + session->signers;
+            return sendDatagram(udpSocket, uavUdpAddr(i), dg, udpRedundancy);
+        }
+
+        TransportPtr client = makeTransport();
+        Transport *endpoint = client.get();
+
+        // Endpoint is fully set up here so that finishCollection() may stop it at any time
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint, session, slotUs](ConnId conn) {
+            handleUAVOpen(endpoint, conn, session, slotUs);
+        };
+        handlers.onMessage = [endpoint](ConnId conn, const std::string &msg) {
+            handleUAVMessage(endpoint, conn, msg);
+        };
+        if (!client->connect(uavUri(i), handlers)) {
+            return false;
+        }
+
+        session->uavClients.push_back(client);
+        session->uavThreads.emplace_back([client]() { client->run(); });
+        return true;
+    }
 
-        c->close(hdl, websocketpp::close::status::normal, "done");
+    uint32_t paceSlotMicros() {
+        if (!paceReplies) return 0;
+        // IP + UDP/TCP + WebSocket framing of one reply
+        const size_t overhead = 80;
+        double bits = 8.0 * (replyBytes.load() + overhead);
+        return static_cast<uint32_t>(bits / paceRate * 1e6);
     }
 
+    void startCollection(SessionPtr session) {
+        session->arrivals.reset(new LockFreeQueue<parSig>(numUAV * (maxRetries + 1)));
+        session->collecting.store(true, std::memory_order_release);
+
+        auto now = std::chrono::steady_clock::now();
+        session->attempts.assign(numUAV, 1);
+        session->firstSent.assign(numUAV, now);
+        session->lastSent.assign(numUAV, now);
+        session->timedOut.clear();
+        session->slotUs = paceSlotMicros();
+
+        if (useDatagrams && multicastFanout) {
+            Datagram dg;
+            dg.type = DG_REQUEST;
+            dg.sid = session->id;
+            dg.index = kSwarmIndex;
+            dg.payload = std::to_string(session->slotUs) + "#" + session->signers;
+            {
+                std::lock_guard<std::mutex> lock(mcastMtx);
+                dg.seq = ++mcastSeq;
+                mcastSessions[dg.seq] = session->id;
+                // Repairs are only served for the latest requests
+                while (mcastSessions.size() > 256) mcastSessions.erase(mcastSessions.begin());
+            }
+            sendDatagram(udpSocket, mcastAddr, dg, udpRedundancy);
+            return;
+        }
 
-// Connect UAVh to each UAV_i to collect partial signatures (Parallel)
-    int collectPartialSignatures() {
+        for (int i = ownFirst; i < ownEnd; ++i) {
+            requestUAV(session, i);
+        }
+    }
 
-        std::string baseIp = "10.0.30.";
-        int startIpSuffix = 101;
-        std::string port = "8002";
+    int collectPartialSignatures(SessionPtr session, const AggContext &ctx, int needed, Sigma &sigma,
+                                 const std::function<void(const SigmaShare &)> &onShare) {
+        using Clock = std::chrono::steady_clock;
+        const std::vector<int> &S = session->S;
+        std::vector<bool> seen(numUAV, false);
+        parSig sig;
+
+        // A sub-head only awaits the UAVs of its own range
+        auto isSelected = [&S](int idx) {
+            return idx >= ownFirst && idx < ownEnd && signerRank(S, idx) >= 0;
+        };
+        std::vector<int> waiting;   // selected UAVs that neither answered nor timed out
+        std::vector<double> paceOffset(numUAV, 0);   // planned reply delay of the first request (ms)
+        for (int i : S) {
+            if (isSelected(i)) {
+                paceOffset[i] = waiting.size() * session->slotUs / 1000.0;
+                waiting.push_back(i);
+            }
+        }
 
-        std::vector<std::shared_ptr<Client>> clients;
-        std::vector<std::thread> threads;
+        auto lastScan = Clock::now();
+        while ((int) sigma.indices.size() < needed && !waiting.empty()) {
+            if (session->arrivals->pop(sig)) {
+                int idx = sig.index;
+                if (!isSelected(idx) || seen[idx]) continue;
+                seen[idx] = true;
+                waiting.erase(std::remove(waiting.begin(), waiting.end(), idx), waiting.end());
+
+                // Karn's rule: a reply to a repeated request cannot be matched to one send time
+                if (session->attempts[idx] == 1) {
+                    double rtt = std::chrono::duration<double, std::milli>(
+                            Clock::now() - session->firstSent[idx]).count() - paceOffset[idx];
+                    rtt = std::max(0.0, rtt);
+                    std::lock_guard<std::mutex> lock(latencyMtx);
+                    rttUpdate(uavRtt[idx], rtt);
+                    latencyAdd(rttStats, rtt);
+                    healthReply(uavHealth[idx], rtt);
+                }
 
-        std::cout << "[UAVh] Starting PARALLEL collection..." << std::endl;
+                AggAppend(ctx, pp, sig, sigma);
 
-        for (int i = 0; i < numUAV; ++i) {
-            auto client = std::make_shared<Client>();
-            clients.push_back(client);
+                if (onShare) {
+                    SigmaShare share;
+                    share.aux = sigma.aux.back();
+                    ECP_copy(&share.sig, &sigma.sig.back());
+                    share.index = sigma.indices.back();
+                    onShare(share);
+                }
+                continue;
+            }
 
-            std::string targetIp = baseIp + std::to_string(startIpSuffix + i);
-            std::string uri = "ws://" + targetIp + ":" + port;
+            // Nothing arrived: hedge or give up on UAVs that are overdue (checked once per ms)
+            auto now = Clock::now();
+            if (now - lastScan < std::chrono::milliseconds(1)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                continue;
+            }
+            lastScan = now;
 
-            threads.emplace_back([client, uri]() {
-                try {
-                    client->set_access_channels(websocketpp::log::alevel::none);
-                    client->init_asio();
+            std::vector<double> deadline(waiting.size());
+            double hedgeAt;
+            {
+                std::lock_guard<std::mutex> lock(latencyMtx);
+                for (size_t k = 0; k < waiting.size(); ++k) {
+                    deadline[k] = rttTimeout(uavRtt[waiting[k]]);
+                }
+                // Percentiles are only trusted once a few samples exist
+                hedgeAt = rttStats.samples.size() < 16 ? -1 : latencyPercentile(rttStats, hedgePercentile);
+            }
 
-                    client->set_open_handler(
-                            websocketpp::lib::bind(&handleUAVOpen, client.get(), websocketpp::lib::placeholders::_1)
-                    );
-                    client->set_message_handler(
-                            websocketpp::lib::bind(&handleUAVMessage, client.get(),
-                                                   websocketpp::lib::placeholders::_1,
-                                                   websocketpp::lib::placeholders::_2)
-                    );
+            std::vector<int> stillWaiting;
+            for (size_t k = 0; k < waiting.size(); ++k) {
+                int idx = waiting[k];
+                double silent = std::chrono::duration<double, std::milli>(now - session->lastSent[idx]).count();
+                // A paced UAV is not late before its slot has come
+                if (session->attempts[idx] == 1) silent -= paceOffset[idx];
+                double hedgeAfter = hedgeAt < 0 ? deadline[k] : std::min(deadline[k], hedgeAt);
+
+                if (session->attempts[idx] <= maxRetries && silent >= hedgeAfter) {
+                    requestUAV(session, idx, false);
+                    session->attempts[idx]++;
+                    session->lastSent[idx] = now;
+                    std::cout << "[UAVh] Hedged request " << session->attempts[idx]
+                              << " to UAV " << idx << " after " << (int) silent << " ms." << std::endl;
+                } else if (session->attempts[idx] > maxRetries && silent >= deadline[k]) {
+                    session->timedOut.push_back(idx);
+                    std::lock_guard<std::mutex> lock(latencyMtx);
+                    healthMiss(uavHealth[idx], heartbeatMiss);
+                    continue;
+                }
+                stillWaiting.push_back(idx);
+            }
+            waiting.swap(stillWaiting);
+        }
+        session->collecting.store(false, std::memory_order_release);
+
+        std::cout << "[UAVh] Session " << session->id << " collection finished. Transformed "
+                  << sigma.indices.size() << "/" << needed << " signatures." << std::endl;
+        if (!session->timedOut.empty()) {
+            std::sort(session->timedOut.begin(), session->timedOut.end());
+            std::cout << "[UAVh] Session " << session->id << " timed out UAVs:";
+            for (int idx: session->timedOut) std::cout << " " << idx;
+            std::cout << std::endl;
+        }
+        return (int) sigma.indices.size() == needed ? 0 : -1;
+    }
 
-                    websocketpp::lib::error_code ec;
-                    auto con = client->get_connection(uri, ec);
-                    if (ec) {
-                        std::cerr << "[UAVh] Connect failed: " << uri << " - " << ec.message() << std::endl;
-                        return;
-                    }
+    void finishCollection(SessionPtr session) {
+        session->collecting.store(false, std::memory_order_release);
+        for (auto &client: session->uavClients) {
+            client->stop();
+        }
+        for (auto &t: session->uavThreads) {
+            if (t.joinable()) t.join();
+        }
+        session->uavThreads.clear();
+        // Drops the handlers that keep a reference to the session
+        session->uavClients.clear();
+    }
+
+// ============================================================
+// Hierarchical aggregation (root head <-> sub-heads)
+// ============================================================
 
-                    client->connect(con);
-                    client->run();
+    void subHeadRange(int k, int &first, int &end) {
+        first = (int) ((long long) numUAV * k / subHeads);
+        end = (int) ((long long) numUAV * (k + 1) / subHeads);
+    }
+
+// Address of sub-head k's server
+    std::string subHeadUri(int k) {
+        return "ws://10.0.30." + std::to_string(10 + k) + ":" + std::to_string(8100 + k);
+    }
+
+    void collectFromSubHeads(SessionPtr session, Sigma &sigma,
+                             const std::function<void(const SigmaShare &)> &onShare) {
+        // Answers of the sub-heads, handed over from their connection threads
+        struct Replies {
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::deque<std::string> frames;
+            int pending = 0;                // sub-heads that have not answered completely
+        };
+        auto replies = std::make_shared<Replies>();
+        bool stream = session->stream;
+
+        for (int k = 0; k < subHeads; ++k) {
+            int first, end;
+            subHeadRange(k, first, end);
+            if (countSigners(session->S, first, end) == 0) continue;
+
+            TransportPtr client = makeTransport();
+            Transport *endpoint = client.get();
+            auto finished = std::make_shared<bool>(false);
+
+            TransportHandlers handlers;
+            handlers.onOpen = [endpoint, session](ConnId conn) {
+                if (!endpoint->send(conn, session->request)) {
+                    std::cerr << "[UAVh] Error forwarding request to sub-head." << std::endl;
                 }
-                catch (const std::exception &e) {
-                    std::cerr << "[UAVh Thread Exception] " << e.what() << std::endl;
+            };
+            handlers.onMessage = [replies, finished, stream](ConnId, const std::string &msg) {
+                std::lock_guard<std::mutex> lock(replies->mtx);
+                if (*finished) return;
+                bool last = !stream || msg.compare(msg.find('#') + 1, std::string::npos, "END") == 0;
+                if (last) {
+                    *finished = true;
+                    replies->pending--;
                 }
-            });
+                replies->frames.push_back(msg);
+                replies->cv.notify_one();
+            };
+            handlers.onClose = [replies, finished, k](ConnId) {
+                std::lock_guard<std::mutex> lock(replies->mtx);
+                if (*finished) return;
+                std::cerr << "[UAVh] Sub-head " << k << " closed before answering." << std::endl;
+                *finished = true;
+                replies->pending--;
+                replies->cv.notify_one();
+            };
+
+            {
+                std::lock_guard<std::mutex> lock(replies->mtx);
+                replies->pending++;
+            }
+            if (!client->connect(subHeadUri(k), handlers)) {
+                std::lock_guard<std::mutex> lock(replies->mtx);
+                replies->pending--;
+                continue;
+            }
+            session->uavClients.push_back(client);
+            session->uavThreads.emplace_back([client]() { client->run(); });
         }
 
-        for (auto& t : threads) {
-            if (t.joinable()) {
-                t.join();
+        // Concatenate the parts (or forward the shares) as they come in
+        for (;;) {
+            std::string frame;
+            {
+                std::unique_lock<std::mutex> lock(replies->mtx);
+                replies->cv.wait(lock, [&replies]() { return !replies->frames.empty() || replies->pending == 0; });
+                if (replies->frames.empty()) break;
+                frame = std::move(replies->frames.front());
+                replies->frames.pop_front();
+            }
+            std::string body = frame.substr(frame.find('#') + 1);
+            try {
+                if (stream) {
+                    if (body == "END") continue;
+                    SigmaShare share = wire_to_SigmaShare(body);
+                    sigma.aux.push_back(share.aux);
+                    sigma.sig.push_back(share.sig);
+                    sigma.indices.push_back(share.index);
+                    if (onShare) onShare(share);
+                } else {
+                    Sigma part = wire_to_Sigma(body);
+                    sigma.aux.insert(sigma.aux.end(), part.aux.begin(), part.aux.end());
+                    sigma.sig.insert(sigma.sig.end(), part.sig.begin(), part.sig.end());
+                    sigma.indices.insert(sigma.indices.end(), part.indices.begin(), part.indices.end());
+                }
+            } catch (const std::exception &e) {
+                std::cerr << "[UAVh] Invalid answer from sub-head: " << e.what() << std::endl;
             }
         }
+        std::cout << "[UAVh] Session " << session->id << " merged " << sigma.indices.size()
+                  << " shares from the sub-heads." << std::endl;
+    }
 
-        std::cout << "[UAVh] Collection finished. Total signatures: " << partialSigs.size() << std::endl;
-        return 0;
+    void subHeadStatsLoop() {
+        TransportPtr client = makeTransport();
+        Transport *endpoint = client.get();
+        // Per sub-head: connection (0 while down) and whether a connect is under way
+        auto conns = std::make_shared<std::vector<ConnId>>(subHeads, 0);
+        auto connecting = std::make_shared<std::vector<bool>>(subHeads, false);
+
+        auto poll = std::make_shared<std::function<void()>>();
+        *poll = [endpoint, conns, connecting, poll]() {
+            for (int k = 0; k < subHeads; ++k) {
+                if ((*conns)[k] != 0) {
+                    endpoint->send((*conns)[k], "STATS");
+                    continue;
+                }
+                if ((*connecting)[k]) continue;
+
+                TransportHandlers handlers;
+                handlers.onOpen = [endpoint, conns, connecting, k](ConnId conn) {
+                    (*conns)[k] = conn;
+                    (*connecting)[k] = false;
+                    endpoint->send(conn, "STATS");
+                };
+                handlers.onMessage = [k](ConnId, const std::string &msg) {
+                    if (msg.compare(0, 6, "STATS#") != 0) return;
+                    std::vector<PeerHealth> health = wire_to_Health(msg.substr(6));
+                    int first, end;
+                    subHeadRange(k, first, end);
+                    std::lock_guard<std::mutex> lock(latencyMtx);
+                    for (int i = first; i < end && i < (int) health.size() && i < (int) uavHealth.size(); ++i) {
+                        uavHealth[i] = health[i];
+                    }
+                };
+                handlers.onClose = [conns, connecting, k](ConnId) {
+                    (*conns)[k] = 0;
+                    (*connecting)[k] = false;
+                };
+                (*connecting)[k] = endpoint->connect(subHeadUri(k), handlers);
+            }
+            endpoint->setTimer(heartbeatMs, *poll);
+        };
+        endpoint->setTimer(0, *poll);
+        client->run();
+    }
+
+
+// ============================================================
+// Swarm splitting
+// ============================================================
+
+    static std::vector<std::string> splitReply(const std::string &reply) {
+        std::vector<std::string> fields;
+        size_t start = 0, end;
+        while ((end = reply.find('#', start)) != std::string::npos) {
+            fields.push_back(reply.substr(start, end - start));
+            start = end + 1;
+        }
+        fields.push_back(reply.substr(start));
+        return fields;
+    }
+
+    std::string splitSubSwarm(int k) {
+        std::string fail = "SPLIT#FAIL#" + std::to_string(k);
+        if (k < 0 || k >= subHeads) {
+            std::cerr << "[UAVh] Split refused: no sub-head " << k << "." << std::endl;
+            return fail;
+        }
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            if (splitOff[k]) {
+                std::cerr << "[UAVh] Split refused: sub-head " << k << " is already split off." << std::endl;
+                return fail;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+
+        // As SwarmSplitting: a sub-swarm of m UAVs signs with at most m shares. It keeps the
+        // threshold of the swarm, so it needs at least t members
+        int first, end;
+        subHeadRange(k, first, end);
+        if (end - first < threshold) {
+            std::cerr << "[UAVh] Split refused: sub-head " << k << " has " << end - first
+                      << " UAVs, fewer than t = " << threshold << "." << std::endl;
+            return fail;
+        }
+        SplitKey key;
+        gmp_randstate_t state;
+        initState(state);
+        {
+            std::lock_guard<std::mutex> lock(keyMtx);
+            key = SplitInit(pp, uavh, k, first, end, std::min(pp.tm - 1, end - first), state);
+        }
+        gmp_randclear(state);
+
+        std::string reply;
+        std::vector<std::string> fields;
+        if (requestOnce(subHeadUri(k), "SPLIT#" + SplitKey_to_wire(key), reply, wireBinary())) {
+            fields = splitReply(reply);
+        }
+        if (fields.size() != 6 || fields[1] != "OK") {
+            std::cerr << "[UAVh] Sub-head " << k << " did not accept the split." << std::endl;
+            return fail;
+        }
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            splitOff[k] = true;
+            splitKeys[k] = key;
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[UAVh] Split sub-head " << k << " off the swarm: " << fields[2] << "/" << fields[3]
+                  << " UAVs updated in " << ms << " ms." << std::endl;
+        return "SPLIT#OK#" + std::to_string(k) + "#" + fields[2] + "#" + fields[3] + "#" +
+               std::to_string(ms) + "#" + fields[5];
+    }
+
+    std::string acceptSplitOrder(const std::string &body) {
+        SplitOrder order;
+        try {
+            order = wire_to_SplitOrder(body);
+        } catch (const std::exception &e) {
+            std::cerr << "[UAVh] Invalid split order: " << e.what() << std::endl;
+            return "SPLIT#FAIL";
+        }
+        std::string fail = "SPLIT#FAIL#" + std::to_string(order.k);
+
+        // An order outlives its use for SPLIT_ORDER_TTL seconds at most
+        auto now = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        if (std::abs(now - static_cast<int64_t>(order.issued)) > splitOrderTtl) {
+            std::cerr << "[UAVh] Split order for sub-head " << order.k << " expired, rejected." << std::endl;
+            return fail;
+        }
+        {
+            std::lock_guard<std::mutex> lock(keyMtx);
+            if (!SplitOrderVerify(pp, order)) {
+                std::cerr << "[UAVh] Split order not signed by TA, rejected." << std::endl;
+                return fail;
+            }
+        }
+        return splitSubSwarm(order.k);
+    }
+
+    std::string splitKeyReply(int k) {
+        SplitKey key;
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            auto it = splitKeys.find(k);
+            if (it == splitKeys.end()) return "SPLITKEY#FAIL#" + std::to_string(k);
+            key = it->second;
+        }
+        // Always text: the key travels inside a #-separated reply
+        return "SPLITKEY#" + std::to_string(k) + "#" + SplitKey_to_str(key);
+    }
+
+    static bool admitSplitRequest() {
+        std::lock_guard<std::mutex> lock(splitMtx);
+        auto now = std::chrono::steady_clock::now();
+        if (splitRunning || now - lastSplitRequest < std::chrono::milliseconds(splitIntervalMs)) return false;
+        splitRunning = true;
+        lastSplitRequest = now;
+        return true;
+    }
+
+    std::string acceptSplit(const std::string &body) {
+        auto start = std::chrono::steady_clock::now();
+        SplitKey key;
+        try {
+            key = wire_to_SplitKey(body);
+        } catch (const std::exception &e) {
+            std::cerr << "[UAVh] Invalid split key: " << e.what() << std::endl;
+            return "SPLIT#FAIL";
+        }
+        {
+            std::lock_guard<std::mutex> lock(keyMtx);
+            if (!SplitVerify(pp, key)) {
+                std::cerr << "[UAVh] Split key not signed with the key of the swarm, rejected." << std::endl;
+                return "SPLIT#FAIL";
+            }
+        }
+        // A key for another sub-head would switch this one without the root marking it split off
+        if (key.k != subHeadIndex || key.first != ownFirst || key.end != ownEnd) {
+            std::cerr << "[UAVh] Split key for sub-head " << key.k << ", rejected." << std::endl;
+            return "SPLIT#FAIL";
+        }
+
+        int acked = distributeSplitKey(body, ownFirst, ownEnd);
+        std::string beta;
+        {
+            std::lock_guard<std::mutex> lock(keyMtx);
+            SplitHead(pp, uavh, key);
+            beta = mpz_to_str(pp.beta);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            splitKeys[subHeadIndex] = key;
+        }
+        if (!registrationCache.empty()) saveRegistration(registrationCache);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[UAVh] Heading a swarm of its own: " << acked << "/" << ownEnd - ownFirst
+                  << " UAVs updated their keys in " << ms << " ms." << std::endl;
+        return "SPLIT#OK#" + std::to_string(acked) + "#" + std::to_string(ownEnd - ownFirst) + "#" +
+               std::to_string(ms) + "#" + beta;
+    }
+
+    int distributeSplitKey(const std::string &body, int first, int end) {
+        std::string request = "SPLIT#" + body;
+        bool binary = isWireBinary(body);
+        std::atomic<int> next{first}, acked{0};
+
+        auto worker = [&]() {
+            for (int i = next++; i < end; i = next++) {
+                bool ok = false;
+                for (int attempt = 0; attempt <= maxRetries && !ok; ++attempt) {
+                    std::string reply;
+                    ok = requestOnce(uavUri(i), request, reply, binary) && reply == "SPLIT#OK";
+                }
+                if (ok) acked++;
+                else std::cerr << "[UAVh] UAV " << i << " did not apply the split." << std::endl;
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int w = 0; w < std::min(end - first, kSplitConnections); ++w) workers.emplace_back(worker);
+        for (std::thread &w : workers) w.join();
+        return acked;
     }
 
 
@@ -221,58 +885,211 @@ namespace UAVhNode_NS {
         return output;
     }
 
-// Handle verifier request: receive "PK_v # HexBitmap"
-    void handleVerifierMessage(Server *s, connection_hdl hdl, MsgServer msg) {
-        std::string payload = msg->get_payload();
+// Handle verifier request: receive "sid # PK_v # HexSignerSet [# S] [# U]"
+    void handleVerifierMessage(Transport *s, ConnId conn, const std::string &payload) {
+        if (payload.rfind("SPLITKEY#", 0) == 0) {
+            int k = -1;
+            try {
+                k = std::stoi(payload.substr(9));
+            } catch (...) {}
+            if (!s->send(conn, splitKeyReply(k))) {
+                std::cerr << "[UAVh] Failed to send the split key." << std::endl;
+            }
+            return;
+        }
 
-        size_t delPos = payload.find('#');
-        if (delPos == std::string::npos) {
-            std::cerr << "[UAVh] Error: Invalid payload format from Verifier." << std::endl;
+        if (payload.rfind("SPLIT#", 0) == 0) {
+            // One split at a time, and none within SPLIT_INTERVAL_MS of the last request
+            if (!admitSplitRequest()) {
+                std::cerr << "[UAVh] Split request refused: too frequent." << std::endl;
+                if (!s->send(conn, "SPLIT#FAIL#busy")) {
+                    std::cerr << "[UAVh] Failed to answer the split request." << std::endl;
+                }
+                return;
+            }
+            // The split waits for every UAV of the sub-swarm
+            std::string body = payload.substr(6);
+            std::thread([s, conn, body]() {
+                std::string reply = "SPLIT#FAIL";
+                if (subHeadIndex >= 0) {
+                    reply = acceptSplit(body);
+                } else if (subHeads > 0) {
+                    reply = acceptSplitOrder(body);
+                } else {
+                    std::cerr << "[UAVh] Split refused: a flat head has no sub-swarm (SUB_HEADS=0)." << std::endl;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(splitMtx);
+                    splitRunning = false;
+                }
+                if (!s->send(conn, reply)) {
+                    std::cerr << "[UAVh] Failed to answer the split request." << std::endl;
+                }
+            }).detach();
+            return;
+        }
+
+        if (payload == "STATS") {
+            std::string stats;
+            {
+                std::lock_guard<std::mutex> lock(latencyMtx);
+                stats = "STATS#" + Health_to_wire(uavHealth);
+            }
+            if (!s->send(conn, stats, wireBinary())) {
+                std::cerr << "[UAVh] Failed to send swarm statistics." << std::endl;
+            }
             return;
         }
-        std::string pkStr = payload.substr(0, delPos);
-        std::string hexBitmap = payload.substr(delPos + 1);
-        mpz_class PK_v = str_to_mpz(pkStr);
-        bitmap = hexToString(hexBitmap);
-        collectPartialSignatures();
 
-        Sigma sigma = AggSig(partialSigs, pp, uavh, PK_v);
-        std::string sigStr = Sigma_to_str(sigma);
+        std::vector<std::string> fields;
+        size_t start = 0, end;
+        while ((end = payload.find('#', start)) != std::string::npos) {
+            fields.push_back(payload.substr(start, end - start));
+            start = end + 1;
+        }
+        fields.push_back(payload.substr(start));
+        if (fields.size() < 3) {
+            std::cerr << "[UAVh] Error: Invalid payload format from Verifier." << std::endl;
+            return;
+        }
 
+        auto session = std::make_shared<AuthSession>();
         try {
-            s->send(hdl, sigStr, websocketpp::frame::opcode::text);
-            std::cout << "[UAVh] Sent aggregated signature (size: " << sigStr.size() << " bytes).\n";
+            session->id = static_cast<uint32_t>(std::stoul(fields[0]));
+            session->PK_v = str_to_mpz(fields[1]);
+            session->signers = hexToString(fields[2]);
+        } catch (const std::exception &e) {
+            std::cerr << "[UAVh] Error: Invalid request from Verifier: " << e.what() << std::endl;
+            return;
+        }
+        // UAVs outside the registry would have no slot in the swarm state
+        if (!decodeSignerSet(session->signers, numUAV, session->S)) {
+            std::cerr << "[UAVh] Error: Invalid signer set from Verifier." << std::endl;
+            return;
+        }
+        // The ranges split off the swarm answer to heads of their own
+        if (!splitOff.empty()) {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            for (int k = 0; k < (int) splitOff.size(); ++k) {
+                int first, end;
+                subHeadRange(k, first, end);
+                if (splitOff[k] && countSigners(session->S, first, end) > 0) {
+                    std::cerr << "[UAVh] Error: Signer set includes UAVs split off the swarm." << std::endl;
+                    return;
+                }
+            }
+        }
+        // Flags after the signer set: S streams Sigma, U asks for uncompressed points. A sub-head
+        // answers the root head over the swarm link and keeps its points compressed.
+        for (size_t i = 3; i < fields.size(); ++i) {
+            if (fields[i] == "S") session->stream = true;
+            else if (fields[i] == "U") session->compressed = subHeadIndex >= 0;
         }
-        catch (const websocketpp::exception &e) {
-            std::cerr << "[UAVh] Failed to send aggregated signature: "
-                      << e.what() << std::endl;
+        session->request = payload;
+        session->server = s;
+        session->verifierConn = conn;
+
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            if (!sessions.emplace(session->id, session).second) {
+                std::cerr << "[UAVh] Session " << session->id << " already active, request rejected." << std::endl;
+                return;
+            }
         }
+
+        // Collection runs off the server thread so that sessions proceed concurrently
+        // and streamed shares are flushed while they are produced
+        std::thread(&serveVerifier, session).detach();
     }
 
-// Start server for verifier (port 8001)
-    void startUAVhServer() {
-        Server server;
+    void serveVerifier(SessionPtr session) {
+        Transport *s = session->server;
+        ConnId conn = session->verifierConn;
+        std::string prefix = std::to_string(session->id) + "#";
+        auto sessionStart = std::chrono::steady_clock::now();
+
+        // In streaming mode every transformed share leaves as its own frame
+        std::function<void(const SigmaShare &)> onShare;
+        size_t streamedBytes = 0;
+        if (session->stream) {
+            bool compressed = session->compressed;
+            onShare = [s, conn, compressed, &prefix, &streamedBytes](const SigmaShare &share) {
+                std::string shareStr = prefix + SigmaShare_to_wire(share, compressed);
+                if (!s->send(conn, shareStr, wireBinary())) {
+                    std::cerr << "[UAVh] Failed to stream share." << std::endl;
+                }
+                streamedBytes += shareStr.size();
+            };
+        }
 
-        try {
-            server.set_access_channels(websocketpp::log::alevel::none);
-            server.init_asio();
+        Sigma sigma;
+        if (subHeads > 0 && subHeadIndex < 0) {
+            // Root head: the sub-heads collect and transform, the root concatenates
+            collectFromSubHeads(session, sigma, onShare);
+            if ((int) sigma.indices.size() != (int) session->S.size()) {
+                std::cerr << "[UAVh] Not enough partial signatures for S." << std::endl;
+            }
+        } else {
+            // A sub-head only answers for the selected UAVs of its own range
+            int needed = countSigners(session->S, ownFirst, ownEnd);
 
-            server.set_message_handler(
-                    websocketpp::lib::bind(&handleVerifierMessage,
-                                           &server,
-                                           websocketpp::lib::placeholders::_1,
-                                           websocketpp::lib::placeholders::_2)
-            );
+            // Connections are opened first so that rk, g^e and beta^e are computed while UAVs sign
+            startCollection(session);
+            AggContext ctx;
+            {
+                std::lock_guard<std::mutex> lock(keyMtx);
+                ctx = AggInit(pp, uavh, session->PK_v, session->state);
+            }
+
+            if (collectPartialSignatures(session, ctx, needed, sigma, onShare) != 0) {
+                std::cerr << "[UAVh] Not enough partial signatures for S." << std::endl;
+            }
+        }
+        std::string sigStr = prefix + (session->stream ? "END" : Sigma_to_wire(sigma, session->compressed));
 
-            server.listen(8001);
-            server.start_accept();
+        if (s->send(conn, sigStr, isWireBinary(sigStr, prefix.size()))) {
+            std::cout << "[UAVh] Sent aggregated signature of session " << session->id
+                      << " (size: " << streamedBytes + sigStr.size()
+                      << " bytes" << (session->stream ? ", streamed" : "") << ").\n";
+        } else {
+            std::cerr << "[UAVh] Failed to send aggregated signature." << std::endl;
+        }
 
-            std::cout << "[UAVh] Server running on port 8001." << std::endl;
-            server.run();
+        double served = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - sessionStart).count();
+        {
+            std::lock_guard<std::mutex> lock(latencyMtx);
+            latencyAdd(sessionStats, served);
+            std::string role = subHeadIndex < 0 ? "UAVh" : "SubHead" + std::to_string(subHeadIndex);
+            latencyExport(rttStats, role, "uav_rtt", latencyCsv);
+            latencyExport(sessionStats, role, "session", latencyCsv);
         }
-        catch (const std::exception &e) {
-            std::cerr << "[UAVh Server Exception] " << e.what() << std::endl;
+
+        // Stragglers are only torn down after the verifier already has its answer
+        finishCollection(session);
+
+        std::lock_guard<std::mutex> lock(sessionsMtx);
+        sessions.erase(session->id);
+    }
+
+// Start server for verifier (port 8001)
+    void startUAVhServer() {
+        TransportPtr server = makeTransport();
+        Transport *endpoint = server.get();
+
+        TransportHandlers handlers;
+        handlers.onMessage = [endpoint](ConnId conn, const std::string &msg) {
+            handleVerifierMessage(endpoint, conn, msg);
+        };
+
+        int port = subHeadIndex < 0 ? 8001 : 8100 + subHeadIndex;
+        if (!server->listen("ws://0.0.0.0:" + std::to_string(port), handlers)) {
+            std::cerr << "[UAVh Server] Failed to listen on port " << port << "." << std::endl;
+            return;
         }
+
+        std::cout << "[UAVh] Server running on port " << port << "." << std::endl;
+        server->run();
     }
 
 
@@ -280,19 +1097,111 @@ namespace UAVhNode_NS {
 // Entry point for UAVh process
 // ============================================================
 
-    int run() {
-        connectToTA();
+    int run(const char *transportOverride, int subHead) {
+        Config cfg = loadConfig("scripts/config.env");
+        subHeads = std::max(0, configInt(cfg, "SUB_HEADS", subHeads));
+        subHeadIndex = subHead;
+        if (subHeadIndex >= subHeads) {
+            std::cerr << "[UAVh] Sub-head " << subHeadIndex << " does not exist (SUB_HEADS=" << subHeads << ")." << std::endl;
+            return -1;
+        }
+        bool root = subHeads > 0 && subHeadIndex < 0;
+        hedgePercentile = configInt(cfg, "HEDGE_PERCENTILE", hedgePercentile);
+        maxRetries = std::max(0, configInt(cfg, "MAX_RETRIES", maxRetries));
+        latencyCsv = configStr(cfg, "LATENCY_CSV", latencyCsv);
+        setWireFormat(configStr(cfg, "WIRE_FORMAT", "binary"));
+        heartbeatMs = configInt(cfg, "HEARTBEAT_MS", heartbeatMs);
+        heartbeatMiss = std::max(1, configInt(cfg, "HEARTBEAT_MISS", heartbeatMiss));
+        splitOrderTtl = std::max(1, configInt(cfg, "SPLIT_ORDER_TTL", splitOrderTtl));
+        splitIntervalMs = std::max(0, configInt(cfg, "SPLIT_INTERVAL_MS", splitIntervalMs));
+        useDatagrams = configStr(cfg, "TRANSPORT", "ws") == "udp";
+        udpRedundancy = std::max(1, configInt(cfg, "UDP_REDUNDANCY", udpRedundancy));
+        if (transportOverride) useDatagrams = std::string(transportOverride) == "udp";
+        // The swarm group would also reach the UAVs of the other sub-heads
+        multicastFanout = configStr(cfg, "BITMAP_FANOUT", "unicast") == "multicast" && subHeadIndex < 0;
+        paceReplies = configInt(cfg, "PACE_REPLIES", 0) != 0;
+        paceRate = configRate(cfg, "PACE_RATE", configRate(cfg, "NET_BANDWIDTH", paceRate));
+        replyBytes = static_cast<size_t>(std::max(1, configInt(cfg, "PACE_REPLY_BYTES", (int) replyBytes.load())));
+        mcastAddr = datagramAddr(configStr(cfg, "MCAST_GROUP", "239.0.30.1"),
+                                 static_cast<uint16_t>(configInt(cfg, "MCAST_PORT", 9100)));
+
+        // In-process runs have no sockets: requests go over the transport, heartbeats are off
+        bool inProcess = transportBackend() == "memory";
+        if (inProcess) {
+            useDatagrams = false;
+            heartbeatMs = 0;
+        }
+
+        // Register with TA, unless the registration of the last run is still valid
+        std::string cachePath = nodeCachePath(subHeadIndex < 0 ? "uavh" : "subhead_" + std::to_string(subHeadIndex));
+        if (!restoreRegistration(cachePath)) {
+            if (connectToTA() != 0) return -1;
+            if (!cachePath.empty()) saveRegistration(cachePath);
+        }
+        registrationCache = cachePath;
+
+        // No RTT is known yet: every UAV starts from the configured initial deadline
+        RttEstimator initial;
+        initial.initialRto = configInt(cfg, "INIT_TIMEOUT_MS", (int) initial.initialRto);
+        uavRtt.assign(numUAV, initial);
+        uavHealth.assign(numUAV, PeerHealth());
+        pongPending.assign(numUAV, false);
+        ownFirst = 0;
+        ownEnd = root ? 0 : numUAV;
+        if (subHeadIndex >= 0) {
+            subHeadRange(subHeadIndex, ownFirst, ownEnd);
+            std::cout << "[UAVh] Sub-head " << subHeadIndex << " of " << subHeads << ", UAVs "
+                      << ownFirst << ".." << ownEnd - 1 << "." << std::endl;
+        }
+
+        // The root only talks to its sub-heads; their health tables make up its STATS
+        if (root) {
+            splitOff.assign(subHeads, false);
+            std::cout << "[UAVh] Root head over " << subHeads << " sub-heads." << std::endl;
+            if (heartbeatMs > 0) std::thread(&subHeadStatsLoop).detach();
+            startUAVhServer();
+            return 0;
+        }
+
+        // Datagrams carry the heartbeats in every mode and the requests in UDP mode
+        if (!inProcess) {
+            udpSocket = openDatagramSocket(0);
+            if (udpSocket < 0) return -1;
+            std::thread(&udpReceiveLoop).detach();
+        }
+        if (useDatagrams) {
+            std::cout << "[UAVh] Using UDP transport towards UAVs (" << udpRedundancy << " copies, "
+                      << (multicastFanout ? "multicast" : "unicast") << " fan-out)." << std::endl;
+        }
+        if (heartbeatMs > 0) {
+            std::thread(&heartbeatLoop).detach();
+        }
+
         startUAVhServer();
         return 0;
     }
 
-} // namespace UAVhNode
+} // namespace UAVhNode_NS
 
 
 // ============================================================
 // Standalone main
 // ============================================================
 
-int main() {
-    return UAVhNode_NS::run();
-}
\ No newline at end of file
+#ifndef RTS_IN_PROCESS
+int main(int argc, char *argv[]) {
+    // Optional: ./UAVh [ws|udp] [k] selects the transport towards the UAVs for this node;
+    // k starts sub-head k of SUB_HEADS instead of the root head
+    const char *transport = nullptr;
+    int subHead = -1;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        if (arg == "ws" || arg == "udp") {
+            transport = argv[a];
+        } else {
+            subHead = std::stoi(arg);
+        }
+    }
+    return UAVhNode_NS::run(transport, subHead);
+}
+#endif
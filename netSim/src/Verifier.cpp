@@ -9,11 +9,23 @@ namespace verifier_NS {
     Params params;
     int thresholdT = 0;
     mpz_class messageM;
-    mpz_class sk_v;             // verifier's secret
-    std::vector<ECP2> PK_s;     // public keys of UAVs at threshold T
-    std::chrono::high_resolution_clock::time_point auth_start_time;
+    ECP2Array PK_s;             // public keys of UAVs at threshold T
+
     vector<mpz_class> registeredIDs;
 
+    bool streamSigma = false;
+    bool uncompressedPoints = false;
+    int authSessions = 1;
+    std::map<uint32_t, AuthSession> sessions;
+    LatencyStats authStats;
+
+    std::string selection = "alive";
+    std::vector<PeerHealth> swarmHealth;
+
+    std::string headUri = "ws://10.0.30.2:8001";
+    int signerFirst = 0, signerEnd = 0;
+    int verifiedSessions = 0;
+
 // ============================================================
 // TA connection callbacks
 // ============================================================
@@ -21,19 +33,13 @@ namespace verifier_NS {
  * @brief Called when connection to TA is opened.
  *        Send verifier ID to TA to register and request params.
  */
-    void onTAOpen(Client *c, connection_hdl hdl) {
+    void onTAOpen(Transport *c, ConnId conn) {
         initState(state);
 
-        // Use a fixed ID for verifier/test (same as other components)
-        mpz_class verID =
-                0x6666666666666666666666666666666666666666666666666666666666666666_mpz;
-        std::string idStr = mpz_to_str(verID);
-
-        websocketpp::lib::error_code ec;
-        c->send(hdl, idStr, websocketpp::frame::opcode::text, ec);
+        std::string type = kRegisterVerifier;
 
-        if (ec) {
-            std::cerr << "[Verifier] Failed to send ID to TA: " << ec.message() << std::endl;
+        if (!c->send(conn, type)) {
+            std::cerr << "[Verifier] Failed to send ID to TA." << std::endl;
         } else {
             std::cout << "[Verifier] Sent ID to TA." << std::endl;
         }
@@ -44,20 +50,24 @@ namespace verifier_NS {
  * @brief Called when TA sends registration package.
  *        Deserialize and store params needed for verification.
  */
-    void onTAMessage(Client *c, connection_hdl hdl, MsgClient msg) {
-        std::string payload = msg->get_payload();
+    void onTAMessage(Transport *c, ConnId conn, const std::string &payload) {
         std::cout << "[Verifier] Received TA package." << std::endl;
 
-        TransmissionPackage pkg = str_to_Package(payload);
+        VerifierPackage pkg = wire_to_VerifierPackage(payload);
 
         params = pkg.pp;
-        PK_s = pkg.uav.PK;   // store UAV PK fragments
+        PK_s = pkg.PK_s;   // store UAV PK fragments
         messageM = pkg.M;
         thresholdT = pkg.t;
 
         registeredIDs = pkg.registeredIDs;
+
+        // The PK fragments arrive compressed; decompress them in the background, a session
+        // that starts meanwhile decompresses those of its signers itself
+        std::thread([pks = PK_s] { pks.decompressAll(); }).detach();
+
         // Close connection to TA after receiving parameters
-        c->close(hdl, websocketpp::close::status::normal, "TA done");
+        c->close(conn);
     }
 
 
@@ -65,35 +75,82 @@ namespace verifier_NS {
 // Connect to TA helper
 // ============================================================
     int connectToTA() {
-        Client client;
+        TransportPtr client = makeTransport();
+        Transport *endpoint = client.get();
         const std::string uri = "ws://10.0.10.2:9002";
+        bool registered = false;
 
-        try {
-            client.set_access_channels(websocketpp::log::alevel::none);
-            client.init_asio();
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint](ConnId conn) { onTAOpen(endpoint, conn); };
+        handlers.onMessage = [endpoint, &registered](ConnId conn, const std::string &msg) {
+            onTAMessage(endpoint, conn, msg);
+            registered = true;
+        };
 
-            client.set_open_handler(bind(&onTAOpen, &client, _1));
-            client.set_message_handler(bind(&onTAMessage, &client, _1, _2));
+        if (!client->connect(uri, handlers)) {
+            std::cerr << "[Verifier] Connect to TA failed." << std::endl;
+            return -1;
+        }
 
-            websocketpp::lib::error_code ec;
-            auto con = client.get_connection(uri, ec);
-            if (ec) {
-                std::cerr << "[Verifier] Connect to TA failed: " << ec.message() << std::endl;
-                return -1;
-            }
+        // Returns once TA closed or refused the connection
+        client->run();
 
-            client.connect(con);
+        return registered ? 0 : -1;
+    }
 
-            std::thread th([&client]() { client.run(); });
-            if (th.joinable()) th.join();
-        } catch (const std::exception &e) {
-            std::cerr << "[Verifier] Exception: " << e.what() << std::endl;
-            return -1;
+
+// ============================================================
+// Cached registration (NODE_CACHE_DIR)
+// ============================================================
+    bool restoreRegistration(const std::string &path) {
+        CacheReader cache;
+        if (path.empty() || !cache.load(path, "Verifier")) return false;
+
+        Params cachedParams = cache.params();
+        std::vector<ECP2> cachedPKs = cache.points();
+        mpz_class cachedMessage = cache.scalar();
+        int cachedThreshold = static_cast<int>(cache.u32());
+        vector<mpz_class> cachedIDs = cache.scalars();
+        if (!cache.ok()) return false;
+
+        // The package holds one PK per UAV registered: it is out of date once another one registered
+        std::string reply, digest;
+        int issued = 0;
+        if (!requestOnce("ws://10.0.10.2:9002", kRequestDigest, reply) || !parseDigestReply(reply, digest, issued)) {
+            std::cerr << "[Verifier] Cannot check the cached registration with TA." << std::endl;
+            return false;
+        }
+        if (digest != cache.digest() || issued != (int) cachedPKs.size()) {
+            std::cout << "[Verifier] Cached registration is out of date." << std::endl;
+            return false;
         }
 
-        return 0;
+        initState(state);
+        params = cachedParams;
+        PK_s = cachedPKs;
+        messageM = cachedMessage;
+        thresholdT = cachedThreshold;
+        registeredIDs = cachedIDs;
+        std::cout << "[Verifier] Restored registration from " << path << std::endl;
+        return true;
     }
 
+    void saveRegistration(const std::string &path) {
+        std::string reply, digest;
+        int issued = 0;
+        if (!requestOnce("ws://10.0.10.2:9002", kRequestDigest, reply) || !parseDigestReply(reply, digest, issued)) {
+            std::cerr << "[Verifier] No digest from TA, registration not cached." << std::endl;
+            return;
+        }
+
+        CacheWriter cache;
+        cache.params(params);
+        cache.points(PK_s);
+        cache.scalar(messageM);
+        cache.u32(static_cast<uint32_t>(thresholdT));
+        cache.scalars(registeredIDs);
+        cache.save(path, "Verifier", digest);
+    }
 
     // Helper function: Converts a binary string to a Hex string to ensure safe transmission
     std::string stringToHex(const std::string& input) {
@@ -113,97 +170,274 @@ namespace verifier_NS {
 // UAVh connection callbacks
 // ============================================================
 
-    void onUAVhOpen(Client *c, connection_hdl hdl) {
-        auth_start_time = std::chrono::high_resolution_clock::now();
-        initState(state);
+    void sendChallenge(Transport *c, ConnId conn, uint32_t id) {
+        AuthSession &session = sessions[id];
+        session.id = id;
+        session.start = std::chrono::high_resolution_clock::now();
 
         // 1. Generate Verifier's ephemeral public/private key pair
-        sk_v = rand_mpz(state);
-        mpz_class PK_v = pow_mpz(params.g, sk_v, params.q);
+        session.sk_v = rand_mpz(state);
+        mpz_class PK_v = pow_mpz(params.g, session.sk_v, params.q);
         std::string pkStr = mpz_to_str(PK_v);
 
-        // 2. Generate a random bitmap (selecting 't' UAVs out of 'n')
+        // 2. Select 't' UAVs out of 'n' (or out of the sub-swarm), encoded in the shortest form for this density
         int n = params.n;
         int t = params.tm;
+        session.S = selectSigners(signerFirst, signerEnd > 0 ? signerEnd : n, t);
+        std::string signers = encodeSignerSet(std::vector<int>(session.S.begin(), session.S.end()), n);
+
+        // 3. Construct the payload: sid # PK_v # Hex(SignerSet) [# S] [# U]
+        std::string signersHex = stringToHex(signers);
+        std::string msg = std::to_string(id) + "#" + pkStr + "#" + signersHex;
+        if (streamSigma) msg += "#S";
+        if (uncompressedPoints) msg += "#U";
+
+        if (!c->send(conn, msg)) {
+            std::cerr << "[Verifier] Failed to send Challenge (PK+SignerSet)." << std::endl;
+            sessions.erase(id);
+            return;
+        }
+        std::cout << "[Verifier] Sent Challenge " << id << " to UAVh (t=" << t << ")." << std::endl;
 
-        // Create a list of indices [0, n-1] and shuffle them to select random signers
-        std::vector<int> indices(n);
-        std::iota(indices.begin(), indices.end(), 0);
-        std::shuffle(indices.begin(), indices.end(), std::mt19937(std::random_device()()));
+        // 4. Everything that only depends on S is computed while the swarm signs
+        if (streamSigma) {
+            session.ctx = VerifyInit(params, session.sk_v, messageM, session.S, registeredIDs, PK_s);
+        }
+    }
 
-        // Initialize the bitmap with zeros
-        int bitmapSize = (n + 7) / 8;
-        std::string bitmap(bitmapSize, 0);
+    std::vector<short> selectSigners(int first, int end, int t) {
+        std::mt19937 rng(std::random_device{}());
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        bool informed = selection != "random" && (int) swarmHealth.size() >= end;
+        int n = end - first;
+
+        // Efraimidis-Spirakis: key = u^(1/w), the t largest keys form a weighted sample
+        // without replacement; with equal weights this is a uniform shuffle.
+        std::vector<std::pair<double, int>> keyed(n);
+        for (int i = first; i < end; ++i) {
+            double w = 1.0;
+            if (informed && selection == "latency" && swarmHealth[i].ewma > 0) {
+                w = 1.0 / (swarmHealth[i].ewma + 1.0);
+            }
+            double key = std::pow(uniform(rng), 1.0 / w);
+            // Alive members always rank before dead ones
+            if (informed && swarmHealth[i].alive) key += 1.0;
+            keyed[i - first] = {key, i};
+        }
+        std::partial_sort(keyed.begin(), keyed.begin() + std::min(t, n), keyed.end(),
+                          [](const std::pair<double, int> &a, const std::pair<double, int> &b) {
+                              return a.first > b.first;
+                          });
+
+        std::vector<short> S;
+        int dead = 0;
+        for (int i = 0; i < t && i < n; ++i) {
+            S.push_back(static_cast<short>(keyed[i].second));
+            if (informed && !swarmHealth[keyed[i].second].alive) dead++;
+        }
+        if (dead > 0) {
+            std::cerr << "[Verifier] Only " << t - dead << " alive members for t=" << t
+                      << ", selecting " << dead << " unresponsive ones." << std::endl;
+        }
+        return S;
+    }
 
-        // Set the bits for the first 't' indices from the shuffled list
-        for(int i = 0; i < t; ++i) {
-            int idx = indices[i];
-            int byteIndex = idx / 8;
-            int bitIndex  = idx % 8;
-            bitmap[byteIndex] |= (1 << bitIndex);
+    void startSessions(Transport *c, ConnId conn) {
+        // Random base so that concurrent verifiers do not collide on the same UAVh
+        uint32_t base = std::random_device()();
+        for (int k = 0; k < authSessions; ++k) {
+            sendChallenge(c, conn, base + k);
+        }
+        if (sessions.empty()) {
+            c->close(conn);
         }
+    }
 
-        // 3. Construct the payload: PK_v # Hex(Bitmap)
-        std::string bitmapHex = stringToHex(bitmap);
-        std::string msg = pkStr + "#" + bitmapHex;
+    void onUAVhOpen(Transport *c, ConnId conn) {
+        initState(state);
 
-        websocketpp::lib::error_code ec;
-        c->send(hdl, msg, websocketpp::frame::opcode::text, ec);
+        if (selection == "random") {
+            startSessions(c, conn);
+            return;
+        }
 
-        if (ec) {
-            std::cerr << "[Verifier] Failed to send Challenge (PK+Bitmap): " << ec.message() << std::endl;
-        } else {
-            std::cout << "[Verifier] Sent Challenge to UAVh (t=" << t << ")." << std::endl;
+        if (!c->send(conn, "STATS")) {
+            std::cerr << "[Verifier] Failed to request swarm statistics." << std::endl;
+            startSessions(c, conn);
         }
     }
 
-    void onUAVhMessage(Client *c, connection_hdl hdl, MsgClient msg) {
-        std::string payload = msg->get_payload();
-        std::cout << "[Verifier] Received aggregated signature from UAVh." << std::endl;
+    void onUAVhMessage(Transport *c, ConnId conn, const std::string &payload) {
+        if (payload.compare(0, 6, "STATS#") == 0) {
+            try {
+                swarmHealth = wire_to_Health(payload.substr(6));
+            } catch (const std::exception &e) {
+                std::cerr << "[Verifier] Invalid swarm statistics: " << e.what() << std::endl;
+                swarmHealth.clear();
+            }
+            int alive = 0;
+            for (const PeerHealth &h : swarmHealth) alive += h.alive;
+            std::cout << "[Verifier] Swarm statistics: " << alive << "/" << swarmHealth.size()
+                      << " members alive." << std::endl;
+            startSessions(c, conn);
+            return;
+        }
 
-        Sigma sigma = str_to_Sigma(payload);
-        int res = Verify(sigma, sk_v, params, messageM, registeredIDs, PK_s);
+        size_t delPos = payload.find('#');
+        auto it = sessions.end();
+        if (delPos != std::string::npos) {
+            try {
+                it = sessions.find(static_cast<uint32_t>(std::stoul(payload.substr(0, delPos))));
+            } catch (...) { }
+        }
+        if (it == sessions.end()) {
+            std::cerr << "[Verifier] Response for unknown session ignored." << std::endl;
+            return;
+        }
+        AuthSession &session = it->second;
+        std::string body = payload.substr(delPos + 1);
+        int res;
+
+        if (streamSigma) {
+            if (body != "END") {
+                VerifyAppend(session.ctx, params, wire_to_SigmaShare(body));
+                return;
+            }
+            std::cout << "[Verifier] Received end of streamed signature " << session.id << " from UAVh." << std::endl;
+            res = VerifyFinal(session.ctx, params);
+        } else {
+            std::cout << "[Verifier] Received aggregated signature " << session.id << " from UAVh." << std::endl;
+            Sigma sigma = wire_to_Sigma(body);
+            res = Verify(sigma, session.sk_v, params, messageM, registeredIDs, PK_s);
+        }
+        if (res == 1) verifiedSessions++;
 
         auto auth_end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(auth_end_time - auth_start_time).count();
-        std::cout << "[Verifier] verify result = " << res << std::endl;
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(auth_end_time - session.start).count();
+        latencyAdd(authStats, std::chrono::duration<double, std::milli>(auth_end_time - session.start).count());
+        std::cout << "[Verifier] session " << session.id << " verify result = " << res << std::endl;
         std::cout << ">>> Total Authentication Time: " << duration << " ms <<<" << std::endl;
 
-        c->close(hdl, websocketpp::close::status::normal, "done");
+        sessions.erase(it);
+        if (sessions.empty()) {
+            c->close(conn);
+        }
     }
 
-
-
 // ============================================================
 // Connect to UAVh helper
 // ============================================================
     int connectToUAVh() {
-        Client client;
-        const std::string uri = "ws://10.0.30.2:8001";
+        TransportPtr client = makeTransport();
+        Transport *endpoint = client.get();
+        const std::string uri = headUri;
+        bool opened = false;
+
+        TransportHandlers handlers;
+        handlers.onOpen = [endpoint, &opened](ConnId conn) {
+            opened = true;
+            onUAVhOpen(endpoint, conn);
+        };
+        handlers.onMessage = [endpoint](ConnId conn, const std::string &msg) {
+            onUAVhMessage(endpoint, conn, msg);
+        };
+
+        if (!client->connect(uri, handlers)) {
+            std::cerr << "[Verifier] Connect to UAVh failed." << std::endl;
+            return -1;
+        }
+
+        // Returns once every session was answered and the connection closed
+        client->run();
 
+        return opened ? 0 : -1;
+    }
+
+// ============================================================
+// Authentication of a sub-swarm
+// ============================================================
+// Address of sub-head k's server, as UAVh has it
+    std::string subHeadUri(int k) {
+        return "ws://10.0.30." + std::to_string(10 + k) + ":" + std::to_string(8100 + k);
+    }
+
+    int adoptSubSwarm(int k) {
+        std::string reply;
+        if (!requestOnce(headUri, "SPLITKEY#" + std::to_string(k), reply)) {
+            std::cerr << "[Verifier] No split key of sub-swarm " << k << " from " << headUri << "." << std::endl;
+            return -1;
+        }
+
+        // SPLITKEY # k # key: only the key is taken, it names the range under its signature
+        std::string prefix = "SPLITKEY#" + std::to_string(k) + "#";
+        SplitKey key;
         try {
-            client.set_access_channels(websocketpp::log::alevel::none);
-            client.init_asio();
+            if (reply.compare(0, prefix.size(), prefix) != 0) {
+                std::cerr << "[Verifier] Sub-swarm " << k << " has not been split off." << std::endl;
+                return -1;
+            }
+            key = str_to_SplitKey(reply.substr(prefix.size()));
+        } catch (const std::exception &e) {
+            std::cerr << "[Verifier] Invalid split key: " << e.what() << std::endl;
+            return -1;
+        }
+        // Only the holder of alpha can sign a key that verifies against the beta of TA
+        if (!SplitVerify(params, key) || key.k != k || key.end > params.n || key.end - key.first < params.tm) {
+            std::cerr << "[Verifier] Split key of sub-swarm " << k << " rejected." << std::endl;
+            return -1;
+        }
 
-            client.set_open_handler(bind(&onUAVhOpen, &client, _1));
-            client.set_message_handler(bind(&onUAVhMessage, &client, _1, _2));
+        params.beta = SplitBeta(params, key);
+        signerFirst = key.first;
+        signerEnd = key.end;
+        headUri = subHeadUri(k);
+        std::cout << "[Verifier] Authenticating sub-swarm " << k << " (UAVs " << key.first << ".." << key.end - 1
+                  << ") through " << headUri << "." << std::endl;
+        return 0;
+    }
 
-            websocketpp::lib::error_code ec;
-            auto con = client.get_connection(uri, ec);
-            if (ec) {
-                std::cerr << "[Verifier] Connect to UAVh failed: " << ec.message() << std::endl;
+// ============================================================
+// Verifier run
+// ============================================================
+    int run() {
+        Config cfg = loadConfig("scripts/config.env");
+        streamSigma = configInt(cfg, "STREAM_SIGMA", 0) != 0;
+        uncompressedPoints = configStr(cfg, "VERIFIER_POINTS", "compressed") == "uncompressed";
+        authSessions = std::max(1, configInt(cfg, "AUTH_SESSIONS", 1));
+        selection = configStr(cfg, "SELECTION", "alive");
+        int subSwarm = configInt(cfg, "AUTH_SUBSWARM", -1);
+
+        // 1. Get params from TA, unless the registration of the last run is still valid
+        std::string cachePath = nodeCachePath("verifier");
+        if (!restoreRegistration(cachePath)) {
+            if (connectToTA() != 0) {
+                std::cerr << "[Main] Failed to connect to TA" << std::endl;
                 return -1;
             }
+            if (!cachePath.empty()) saveRegistration(cachePath);
+        }
 
-            client.connect(con);
+        // 2. A sub-swarm split off is authenticated under its own beta, through its head
+        if (subSwarm >= 0 && adoptSubSwarm(subSwarm) != 0) {
+            std::cerr << "[Main] Failed to adopt sub-swarm " << subSwarm << std::endl;
+            return -1;
+        }
 
-            std::thread th([&client]() { client.run(); });
-            if (th.joinable()) th.join();
-        } catch (const std::exception &e) {
-            std::cerr << "[Verifier] Exception: " << e.what() << std::endl;
+        // 3. Contact UAVh to obtain Sigma and verify
+        if (connectToUAVh() != 0) {
+            std::cerr << "[Main] Failed to connect to UAVh" << std::endl;
             return -1;
         }
 
+        // 4. Export authentication latency percentiles
+        const LatencyStats &stats = authStats;
+        if (!stats.samples.empty()) {
+            std::cout << "[Verifier] Authentication latency p50 = " << latencyPercentile(stats, 50)
+                      << " ms, p99 = " << latencyPercentile(stats, 99) << " ms over "
+                      << stats.samples.size() << " sessions, " << verifiedSessions << " verified." << std::endl;
+            latencyExport(stats, "Verifier", "auth", configStr(cfg, "LATENCY_CSV", "latency.csv"));
+        }
+
         return 0;
     }
 
@@ -213,18 +447,8 @@ namespace verifier_NS {
 // ============================================================
 // Program entry
 // ============================================================
+#ifndef RTS_IN_PROCESS
 int main() {
-    // 1. Get params from TA
-    if (verifier_NS::connectToTA() != 0) {
-        std::cerr << "[Main] Failed to connect to TA" << std::endl;
-        return -1;
-    }
-
-    // 2. Contact UAVh to obtain Sigma and verify
-    if (verifier_NS::connectToUAVh() != 0) {
-        std::cerr << "[Main] Failed to connect to UAVh" << std::endl;
-        return -1;
-    }
-
-    return 0;
+    return verifier_NS::run();
 }
+#endif
@@ -0,0 +1,53 @@
+#include "TestSupport.h"
+
+#include "../../include/TA.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+const std::string kTAUri = "ws://10.0.10.2:9002";
+
+static int failures = 0;
+
+void check(bool ok, const std::string &what) {
+    std::cout << (ok ? "[  OK  ] " : "[ FAIL ] ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+void finish(int rc) {
+    std::cout.flush();
+    std::cerr.flush();
+    std::_Exit(rc);
+}
+
+void finishChecks(const std::string &tag) {
+    std::cout << "[" << tag << "] " << (failures == 0 ? "All checks passed." : "Some checks failed.") << std::endl;
+    finish(failures == 0 ? 0 : 1);
+}
+
+bool waitListening(const std::string &address, const std::function<bool()> &gaveUp) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (!transportListening(address)) {
+        if ((gaveUp && gaveUp()) || std::chrono::steady_clock::now() > deadline) {
+            check(false, "Something listens on " + address);
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool startInProcessTA(int numUAV, int thresholdMax) {
+    TA_NS::LoadConfig("scripts/config.env");
+    TA_NS::kNumUAV = numUAV;
+    if (thresholdMax > 0) TA_NS::kThresholdMax = thresholdMax;
+    TA_NS::kStorePath.clear();   // fresh TA every run
+    TA_NS::initParams();
+    std::thread([]() {
+        TA_NS::startPrecompute();
+        TA_NS::startServer();
+    }).detach();
+    return waitListening(kTAUri);
+}